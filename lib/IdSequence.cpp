@@ -24,19 +24,63 @@
 #include "IdSequence.h"
 
 using namespace mrg::msgstore;
-using qpid::sys::Mutex;
 
-IdSequence::IdSequence() : id(1) {}
+IdSequence::IdSequence() : id(1), leaseSize(0), generation(0)
+{
+    ::pthread_key_create(&leaseKey, deleteLease);
+}
+
+IdSequence::~IdSequence()
+{
+    ::pthread_key_delete(leaseKey);
+}
 
 u_int64_t IdSequence::next()
 {
-    Mutex::ScopedLock guard(lock);
-    if (!id) id++; // avoid 0 when folding around
-    return id++;
+    const uint32_t size = leaseSize;
+    if (size > 1) return nextLeased(size);
+    uint64_t v = __sync_fetch_and_add(&id, 1);
+    if (!v) v = __sync_fetch_and_add(&id, 1); // avoid 0 when folding around
+    return v;
+}
+
+uint64_t IdSequence::nextLeased(uint32_t size)
+{
+    Lease* l = static_cast<Lease*>(::pthread_getspecific(leaseKey));
+    if (!l) {
+        l = new Lease();
+        l->next = l->end = 0;
+        l->generation = generation;
+        ::pthread_setspecific(leaseKey, l);
+    }
+    if (l->next == l->end || l->generation != generation) {
+        // Lease exhausted or invalidated by reset(); reserve a new block of ids
+        l->generation = generation;
+        l->next = __sync_fetch_and_add(&id, size);
+        l->end = l->next + size;
+    }
+    uint64_t v = l->next++;
+    if (!v) { // avoid 0 when folding around
+        if (l->next == l->end) return next();
+        v = l->next++;
+    }
+    return v;
+}
+
+void IdSequence::deleteLease(void* lease)
+{
+    delete static_cast<Lease*>(lease);
 }
 
 void IdSequence::reset(uint64_t value)
 {
     //deliberately not threadsafe, used only on recovery
     id = value;
+    __sync_add_and_fetch(&generation, 1);
+}
+
+void IdSequence::setLeaseSize(uint32_t size)
+{
+    leaseSize = size;
+    __sync_add_and_fetch(&generation, 1);
 }
@@ -25,20 +25,44 @@
 #define _IdSequence_
 
 #include <qpid/framing/amqp_types.h>
-#include <qpid/sys/Mutex.h>
+#include <pthread.h>
 #include <sys/types.h>
 
 namespace mrg{
 namespace msgstore{
 
+/**
+ * Thread-safe sequence of 64-bit ids, never returning 0.
+ *
+ * Ids are allocated with an atomic fetch-add. If a lease size greater than 1 is set, each thread
+ * instead reserves blocks of that many ids from the shared counter and allocates from its own
+ * block without touching the shared counter. Ids then remain unique but are only increasing per
+ * thread; ids left in a lease are never used. As the highest id in use is still the highest id
+ * allocated, recovery by reset(highest + 1) remains correct.
+ */
 class IdSequence
 {
-    qpid::sys::Mutex lock;
-    uint64_t id;
+    struct Lease
+    {
+        uint64_t next;
+        uint64_t end;
+        uint32_t generation;
+    };
+
+    volatile uint64_t id;
+    volatile uint32_t leaseSize;
+    volatile uint32_t generation;
+    pthread_key_t leaseKey;
+
+    uint64_t nextLeased(uint32_t size);
+    static void deleteLease(void* lease);
 public:
     IdSequence();
+    ~IdSequence();
     uint64_t next();
     void reset(uint64_t value);
+    void setLeaseSize(uint32_t size);
+    inline uint32_t getLeaseSize() const { return leaseSize; }
 };
 
 }}
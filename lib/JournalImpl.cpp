@@ -23,6 +23,8 @@
 
 #include "JournalImpl.h"
 
+#include <algorithm>
+#include <cstring>
 #include "jrnl/jerrno.hpp"
 #include "jrnl/jexception.hpp"
 #include "qpid/log/Statement.h"
@@ -62,14 +64,19 @@ JournalImpl::JournalImpl(qpid::sys::Timer& timer_,
                          jcntl(journalId, journalDirectory, journalBaseFilename),
                          timer(timer_),
                          getEventsTimerSetFlag(false),
-                         lastReadRid(0),
+                         maxReadCursors(1),
+                         rcursorUseCnt(0),
                          writeActivityFlag(false),
                          flushTriggeredFlag(true),
-                         _xidp(0),
-                         _datap(0),
-                         _dlen(0),
-                         _dtok(),
-                         _external(false),
+                         deqBatchSize(0),
+                         rcacheIdleSecs(0),
+                         contentCacheBytes(0),
+                         contentCacheMaxBytes(0),
+                         contentCacheHits(0),
+                         contentCacheMisses(0),
+                         msgPrefixSize(0),
+                         cacheMemBytes(0),
+                         indexMemBytes(0),
                          _mgmtObject(0),
                          deleteCallback(onDelete)
 {
@@ -97,7 +104,8 @@ JournalImpl::~JournalImpl()
 	}
     getEventsFireEventsPtr->cancel();
     inactivityFireEventPtr->cancel();
-    free_read_buffers();
+    closeReadCursors();
+    updateMemoryStats(true);
 
     if (_mgmtObject != 0) {
         _mgmtObject->resourceDestroy();
@@ -119,8 +127,8 @@ JournalImpl::initManagement(qpid::management::ManagementAgent* a)
         _mgmtObject->set_name(_jid);
         _mgmtObject->set_directory(_jdir.dirname());
         _mgmtObject->set_baseFileName(_base_filename);
-        _mgmtObject->set_readPageSize(JRNL_RMGR_PAGE_SIZE * JRNL_SBLK_SIZE * JRNL_DBLK_SIZE);
-        _mgmtObject->set_readPages(JRNL_RMGR_PAGES);
+        _mgmtObject->set_readPageSize(_rcache_pgsize_sblks * JRNL_SBLK_SIZE * JRNL_DBLK_SIZE);
+        _mgmtObject->set_readPages(_rcache_num_pages);
 
         // The following will be set on initialize(), but being properties, these must be set to 0 in the meantime
         _mgmtObject->set_initialFileCount(0);
@@ -160,6 +168,8 @@ JournalImpl::initialize(const u_int16_t num_jfiles,
         _mgmtObject->set_dataFileSize(_jfsize_sblks * JRNL_SBLK_SIZE * JRNL_DBLK_SIZE);
         _mgmtObject->set_writePageSize(wcache_pgsize_sblks * JRNL_SBLK_SIZE * JRNL_DBLK_SIZE);
         _mgmtObject->set_writePages(wcache_num_pages);
+        _mgmtObject->set_readPageSize(_rcache_pgsize_sblks * JRNL_SBLK_SIZE * JRNL_DBLK_SIZE);
+        _mgmtObject->set_readPages(_rcache_num_pages);
     }
     if (_agent != 0)
         _agent->raiseEvent(qmf::com::redhat::rhm::store::EventCreated(_jid, _jfsize_sblks * JRNL_SBLK_SIZE * JRNL_DBLK_SIZE, _lpmgr.num_jfiles()),
@@ -194,6 +204,8 @@ JournalImpl::recover(const u_int16_t num_jfiles,
         _mgmtObject->set_dataFileSize(_jfsize_sblks * JRNL_SBLK_SIZE * JRNL_DBLK_SIZE);
         _mgmtObject->set_writePageSize(wcache_pgsize_sblks * JRNL_SBLK_SIZE * JRNL_DBLK_SIZE);
         _mgmtObject->set_writePages(wcache_num_pages);
+        _mgmtObject->set_readPageSize(_rcache_pgsize_sblks * JRNL_SBLK_SIZE * JRNL_DBLK_SIZE);
+        _mgmtObject->set_readPages(_rcache_num_pages);
     }
 
     if (prep_tx_list_ptr) {
@@ -210,8 +222,9 @@ JournalImpl::recover(const u_int16_t num_jfiles,
                 cbp, 0, highest_rid);
     }
 
-    // Populate PreparedTransaction lists from _tmap
-    if (prep_tx_list_ptr)
+    // Populate PreparedTransaction lists from _tmap. A queue_id of 0 (a shared journal) leaves this to the store,
+    // as the queue of each record is only known once it is read.
+    if (prep_tx_list_ptr && queue_id)
     {
         for (msgstore::PreparedTransaction::list::iterator i = prep_tx_list_ptr->begin(); i != prep_tx_list_ptr->end(); i++) {
             txn_data_list tdl = _tmap.get_tdata_list(i->xid); // tdl will be empty if xid not found
@@ -257,92 +270,116 @@ JournalImpl::recover_complete()
 bool
 JournalImpl::loadMsgContent(u_int64_t rid, std::string& data, size_t length, size_t offset)
 {
-    qpid::sys::Mutex::ScopedLock sl(_read_lock);
-    if (_dtok.rid() != rid)
-    {
-        // Free any previous msg
-        free_read_buffers();
-
-        // Last read encountered out-of-order rids, check if this rid is in that list
-        bool oooFlag = false;
-        for (std::vector<u_int64_t>::const_iterator i=oooRidList.begin(); i!=oooRidList.end() && !oooFlag; i++) {
-            if (*i == rid) {
-                oooFlag = true;
-            }
+    if (contentCacheMaxBytes) {
+        if (loadCachedContent(rid, data, length, offset)) {
+            if (_mgmtObject != 0)
+                _mgmtObject->inc_contentCacheHits();
+            return true;
         }
+        if (_mgmtObject != 0)
+            _mgmtObject->inc_contentCacheMisses();
+    }
 
-        // TODO: This is a brutal approach - very inefficient and slow. Rather introduce a system of remembering
-        // jumpover points and allow the read to jump back to the first known jumpover point - but this needs
-        // a mechanism in rrfc to accomplish it. Also helpful is a struct containing a journal address - a
-        // combination of lid/offset.
-        // NOTE: The second part of the if stmt (rid < lastReadRid) is required to handle browsing.
-        if (oooFlag || rid < lastReadRid) {
-            _rmgr.invalidate();
-            oooRidList.clear();
-        }
-        _dlen = 0;
-        _dtok.reset();
-        _dtok.set_wstate(DataTokenImpl::ENQ);
-        _dtok.set_rid(0);
-        _external = false;
-        size_t xlen = 0;
-        bool transient = false;
-        bool done = false;
-        bool rid_found = false;
-        while (!done) {
-            iores res = read_data_record(&_datap, _dlen, &_xidp, xlen, transient, _external, &_dtok);
-            switch (res) {
-                case mrg::journal::RHM_IORES_SUCCESS:
-                    if (_dtok.rid() != rid) {
-                        // Check if this is an out-of-order rid that may impact next read
-                        if (_dtok.rid() > rid)
-                            oooRidList.push_back(_dtok.rid());
-                        free_read_buffers();
-                        // Reset data token for next read
-                        _dlen = 0;
-                        _dtok.reset();
-                        _dtok.set_wstate(DataTokenImpl::ENQ);
-                        _dtok.set_rid(0);
-                    } else {
-                        rid_found = _dtok.rid() == rid;
-                        lastReadRid = rid;
-                        done = true;
-                    }
-                    break;
-                case mrg::journal::RHM_IORES_PAGE_AIOWAIT:
-                    if (get_wr_events(&_aio_cmpl_timeout) == journal::jerrno::AIO_TIMEOUT) {
+    ReadCursor* rc = acquireReadCursor(rid);
+    try {
+        if (rc->dtok.rid() != rid)
+        {
+            // Free any previous msg
+            rc->freeBuffers();
+
+            // Last read encountered out-of-order rids, check if this rid is in that list
+            // TODO: This is a brutal approach - very inefficient and slow. Rather introduce a system of remembering
+            // jumpover points and allow the read to jump back to the first known jumpover point - but this needs
+            // a mechanism in rrfc to accomplish it. Also helpful is a struct containing a journal address - a
+            // combination of lid/offset.
+            // NOTE: The second part of the if stmt (rid < lastReadRid) is required to handle browsing.
+            if (rc->oooRid(rid) || rid < rc->lastReadRid) {
+                rc->rcp->invalidate();
+                rc->oooRidList.clear();
+            }
+            rc->dlen = 0;
+            rc->dtok.reset();
+            rc->dtok.set_wstate(DataTokenImpl::ENQ);
+            rc->dtok.set_rid(0);
+            rc->external = false;
+            size_t xlen = 0;
+            bool transient = false;
+            bool done = false;
+            bool rid_found = false;
+            while (!done) {
+                iores res = rc->rcp->read_data_record(&rc->datap, rc->dlen, &rc->xidp, xlen, transient, rc->external,
+                        &rc->dtok, rc->buf, &rc->pin);
+                switch (res) {
+                    case mrg::journal::RHM_IORES_SUCCESS:
+                        if (rc->dtok.rid() != rid) {
+                            // Check if this is an out-of-order rid that may impact next read
+                            if (rc->dtok.rid() > rid)
+                                rc->oooRidList.push_back(rc->dtok.rid());
+                            rc->freeBuffers();
+                            // Reset data token for next read
+                            rc->dlen = 0;
+                            rc->dtok.reset();
+                            rc->dtok.set_wstate(DataTokenImpl::ENQ);
+                            rc->dtok.set_rid(0);
+                        } else {
+                            rid_found = rc->dtok.rid() == rid;
+                            rc->lastReadRid = rid;
+                            done = true;
+                        }
+                        break;
+                    case mrg::journal::RHM_IORES_PAGE_AIOWAIT:
+                        if (get_wr_events(&_aio_cmpl_timeout) == journal::jerrno::AIO_TIMEOUT) {
+                            std::stringstream ss;
+                            ss << "read_data_record() returned " << mrg::journal::iores_str(res);
+                            ss << "; timed out waiting for page to be processed.";
+                            throw jexception(mrg::journal::jerrno::JERR__TIMEOUT, ss.str().c_str(), "JournalImpl",
+                                "loadMsgContent");
+                        }
+                        break;
+                    default:
                         std::stringstream ss;
                         ss << "read_data_record() returned " << mrg::journal::iores_str(res);
-                        ss << "; timed out waiting for page to be processed.";
-                        throw jexception(mrg::journal::jerrno::JERR__TIMEOUT, ss.str().c_str(), "JournalImpl",
+                        throw jexception(mrg::journal::jerrno::JERR__UNEXPRESPONSE, ss.str().c_str(), "JournalImpl",
                             "loadMsgContent");
-                    }
-                    break;
-                default:
-                    std::stringstream ss;
-                    ss << "read_data_record() returned " << mrg::journal::iores_str(res);
-                    throw jexception(mrg::journal::jerrno::JERR__UNEXPRESPONSE, ss.str().c_str(), "JournalImpl",
-                        "loadMsgContent");
+                }
+            }
+            if (!rid_found) {
+                std::stringstream ss;
+                ss << "read_data_record() was unable to find rid 0x" << std::hex << rid << std::dec;
+                ss << " (" << rid << "); last rid found was 0x" << std::hex << rc->dtok.rid() << std::dec;
+                ss << " (" << rc->dtok.rid() << ")";
+                throw jexception(mrg::journal::jerrno::JERR__RECNFOUND, ss.str().c_str(), "JournalImpl", "loadMsgContent");
             }
         }
-        if (!rid_found) {
-            std::stringstream ss;
-            ss << "read_data_record() was unable to find rid 0x" << std::hex << rid << std::dec;
-            ss << " (" << rid << "); last rid found was 0x" << std::hex << _dtok.rid() << std::dec;
-            ss << " (" << _dtok.rid() << ")";
-            throw jexception(mrg::journal::jerrno::JERR__RECNFOUND, ss.str().c_str(), "JournalImpl", "loadMsgContent");
-        }
+    } catch (...) {
+        releaseReadCursor(rc);
+        throw;
     }
 
-    if (_external) return false;
-
-    u_int32_t hdr_offs = qpid::framing::Buffer(static_cast<char*>(_datap), sizeof(u_int32_t)).getLong() + sizeof(u_int32_t);
-    if (hdr_offs + offset + length > _dlen) {
-        data.append((const char*)_datap + hdr_offs + offset, _dlen - hdr_offs - offset);
-    } else {
-        data.append((const char*)_datap + hdr_offs + offset, length);
+    bool found = !rc->external;
+    if (found) {
+        char* const msgp = static_cast<char*>(rc->datap) + msgPrefixSize;
+        u_int32_t hdr_offs = msgPrefixSize + qpid::framing::Buffer(msgp, sizeof(u_int32_t)).getLong() + sizeof(u_int32_t);
+        if (contentCacheMaxBytes)
+            cacheContent(rid, (const char*)rc->datap + hdr_offs, rc->dlen - hdr_offs);
+        if (hdr_offs + offset + length > rc->dlen) {
+            data.append((const char*)rc->datap + hdr_offs + offset, rc->dlen - hdr_offs - offset);
+        } else {
+            data.append((const char*)rc->datap + hdr_offs + offset, length);
+        }
     }
-    return true;
+    if (rc->pin.is_set()) {
+        // Do not hold the mapped file past this call, as a pinned file cannot be reset for writing. The msg is
+        // copied into the cursor buffer for the loads of its later chunks.
+        if (found)
+            rc->datap = std::memcpy(rc->buf.reserve(rc->dlen), rc->datap, rc->dlen);
+        else
+            rc->datap = 0;
+        rc->xidp = 0;
+        rc->pin.release();
+    }
+    releaseReadCursor(rc);
+    return found;
 }
 
 void
@@ -373,7 +410,7 @@ JournalImpl::enqueue_extern_data_record(const size_t tot_data_len, data_tok* dto
 
 void
 JournalImpl::enqueue_txn_data_record(const void* const data_buff, const size_t tot_data_len,
-        const size_t this_data_len, data_tok* dtokp, const std::string& xid, const bool transient)
+        const size_t this_data_len, data_tok* dtokp, const xid_handle& xid, const bool transient)
 {
     bool txn_incr = _mgmtObject != 0 ? _tmap.in_map(xid) : false;
 
@@ -391,7 +428,7 @@ JournalImpl::enqueue_txn_data_record(const void* const data_buff, const size_t t
 
 void
 JournalImpl::enqueue_extern_txn_data_record(const size_t tot_data_len, data_tok* dtokp,
-        const std::string& xid, const bool transient)
+        const xid_handle& xid, const bool transient)
 {
     bool txn_incr = _mgmtObject != 0 ? _tmap.in_map(xid) : false;
 
@@ -410,7 +447,21 @@ JournalImpl::enqueue_extern_txn_data_record(const size_t tot_data_len, data_tok*
 void
 JournalImpl::dequeue_data_record(data_tok* const dtokp, const bool txn_coml_commit)
 {
+    if (deqBatchSize > 1 && !txn_coml_commit && dtokp->external_rid())
+    {
+        qpid::sys::Mutex::ScopedLock sl(_deq_batch_lock);
+        if (batchable(dtokp->dequeue_rid()))
+        {
+            writeActivityFlag = true;
+            deqBatch.push_back(dtokp);
+            if (deqBatch.size() >= deqBatchSize)
+                writeDequeueBatch(dtokp);
+            return;
+        }
+    }
+
     handleIoResult(jcntl::dequeue_data_record(dtokp, txn_coml_commit));
+    dropCachedContent(dtokp->dequeue_rid());
 
     if (_mgmtObject != 0)
     {
@@ -421,11 +472,27 @@ JournalImpl::dequeue_data_record(data_tok* const dtokp, const bool txn_coml_comm
 }
 
 void
-JournalImpl::dequeue_txn_data_record(data_tok* const dtokp, const std::string& xid, const bool txn_coml_commit)
+JournalImpl::dequeue_data_records(const std::vector<data_tok*>& dtokl)
+{
+    handleIoResult(jcntl::dequeue_data_records(dtokl));
+    for (std::vector<data_tok*>::const_iterator i = dtokl.begin(); i != dtokl.end(); i++)
+        dropCachedContent((*i)->dequeue_rid());
+
+    if (_mgmtObject != 0)
+    {
+        _mgmtObject->inc_dequeues(dtokl.size());
+        _mgmtObject->inc_txnDequeues(dtokl.size());
+        _mgmtObject->dec_recordDepth(dtokl.size());
+    }
+}
+
+void
+JournalImpl::dequeue_txn_data_record(data_tok* const dtokp, const xid_handle& xid, const bool txn_coml_commit)
 {
     bool txn_incr = _mgmtObject != 0 ? _tmap.in_map(xid) : false;
 
     handleIoResult(jcntl::dequeue_txn_data_record(dtokp, xid, txn_coml_commit));
+    dropCachedContent(dtokp->dequeue_rid());
 
     if (_mgmtObject != 0)
     {
@@ -438,7 +505,7 @@ JournalImpl::dequeue_txn_data_record(data_tok* const dtokp, const std::string& x
 }
 
 void
-JournalImpl::txn_abort(data_tok* const dtokp, const std::string& xid)
+JournalImpl::txn_abort(data_tok* const dtokp, const xid_handle& xid)
 {
     handleIoResult(jcntl::txn_abort(dtokp, xid));
 
@@ -450,7 +517,7 @@ JournalImpl::txn_abort(data_tok* const dtokp, const std::string& xid)
 }
 
 void
-JournalImpl::txn_commit(data_tok* const dtokp, const std::string& xid)
+JournalImpl::txn_commit(data_tok* const dtokp, const xid_handle& xid)
 {
     handleIoResult(jcntl::txn_commit(dtokp, xid));
 
@@ -467,6 +534,11 @@ JournalImpl::stop(bool block_till_aio_cmpl)
     InactivityFireEvent* ifep = dynamic_cast<InactivityFireEvent*>(inactivityFireEventPtr.get());
     assert(ifep); // dynamic_cast can return null if the cast fails
     ifep->cancel();
+    {
+        qpid::sys::Mutex::ScopedLock sl(_deq_batch_lock);
+        try { writeDequeueBatch(); }
+        catch (const std::exception& e) { log(LOG_ERROR, e.what()); }
+    }
     jcntl::stop(block_till_aio_cmpl);
 
     if (_mgmtObject != 0) {
@@ -478,6 +550,10 @@ JournalImpl::stop(bool block_till_aio_cmpl)
 iores
 JournalImpl::flush(const bool block_till_aio_cmpl)
 {
+    {
+        qpid::sys::Mutex::ScopedLock sl(_deq_batch_lock);
+        writeDequeueBatch();
+    }
     const iores res = jcntl::flush(block_till_aio_cmpl);
     {
         qpid::sys::Mutex::ScopedLock sl(_getf_lock);
@@ -528,6 +604,17 @@ JournalImpl::flushFire()
             flushTriggeredFlag = true;
         }
     }
+    // Free the read cache of a journal which is no longer being read. Recovery reads are not serialised by
+    // _read_lock, so the cache is left alone until recovery is complete.
+    if (rcacheIdleSecs && _init_flag && !_stop_flag && !is_read_only() && _read_lock.trylock()) {
+        const bool released = release_idle_rcache(rcacheIdleSecs);
+        _read_lock.unlock();
+        if (released) log(LOG_DEBUG, "Idle read cache released");
+    }
+    if (rcacheIdleSecs && _init_flag && !_stop_flag)
+        releaseIdleReadCursors();
+    if (_init_flag && !_stop_flag && !is_read_only())
+        updateMemoryStats();
     inactivityFireEventPtr->setupNextFire();
     {
         timer.add(inactivityFireEventPtr);
@@ -565,16 +652,265 @@ void
 JournalImpl::rd_aio_cb(std::vector<u_int16_t>& /*pil*/)
 {}
 
+JournalImpl::ReadCursor::ReadCursor(mrg::journal::rcursor* const r) :
+        rcp(r),
+        busy(false),
+        lastUse(0),
+        lastReadRid(0),
+        xidp(0),
+        datap(0),
+        dlen(0),
+        dtok(),
+        external(false)
+{}
+
+bool
+JournalImpl::ReadCursor::oooRid(const u_int64_t rid) const
+{
+    return std::find(oooRidList.begin(), oooRidList.end(), rid) != oooRidList.end();
+}
+
+// The msg read is either in buf, which is kept for the next read, or in place in a mapped journal file
+void
+JournalImpl::ReadCursor::freeBuffers()
+{
+    pin.release();
+    xidp = 0;
+    datap = 0;
+}
+
+// Choose the cursor from which rid can be read with the least work. Consumers read forwards through the journal
+// and browsers restart from earlier positions, so a cursor which is already at rid, or which has not yet passed it,
+// is preferred; then a new cursor; then the least recently used. Blocks while all cursors are in use.
+JournalImpl::ReadCursor*
+JournalImpl::acquireReadCursor(const u_int64_t rid)
+{
+    qpid::sys::Monitor::ScopedLock sl(_rcursor_monitor);
+    while (true) {
+        ReadCursor* held = 0;   // Holds rid already (subsequent chunks of the same msg)
+        ReadCursor* behind = 0; // Closest position before rid
+        ReadCursor* lru = 0;
+        for (std::vector<ReadCursor*>::const_iterator i = rcursors.begin(); i != rcursors.end(); i++) {
+            ReadCursor* rc = *i;
+            if (rc->busy)
+                continue;
+            if (rc->dtok.rid() == rid)
+                held = rc;
+            else if (rc->lastReadRid < rid && !rc->oooRid(rid) && (!behind || rc->lastReadRid > behind->lastReadRid))
+                behind = rc;
+            if (!lru || rc->lastUse < lru->lastUse)
+                lru = rc;
+        }
+        ReadCursor* rc = held ? held : behind;
+        if (!rc && rcursors.size() < maxReadCursors) {
+            rc = new ReadCursor(open_rcursor(this));
+            rcursors.push_back(rc);
+        }
+        if (!rc)
+            rc = lru;
+        if (rc) {
+            rc->busy = true;
+            rc->lastUse = ++rcursorUseCnt;
+            return rc;
+        }
+        _rcursor_monitor.wait();
+    }
+}
+
+void
+JournalImpl::releaseReadCursor(ReadCursor* const rc)
+{
+    qpid::sys::Monitor::ScopedLock sl(_rcursor_monitor);
+    rc->busy = false;
+    _rcursor_monitor.notify();
+}
+
 void
-JournalImpl::free_read_buffers()
+JournalImpl::closeReadCursors()
 {
-    if (_xidp) {
-        ::free(_xidp);
-        _xidp = 0;
-        _datap = 0;
-    } else if (_datap) {
-        ::free(_datap);
-        _datap = 0;
+    qpid::sys::Monitor::ScopedLock sl(_rcursor_monitor);
+    for (std::vector<ReadCursor*>::iterator i = rcursors.begin(); i != rcursors.end(); i++) {
+        (*i)->freeBuffers();
+        close_rcursor((*i)->rcp);
+        delete *i;
+    }
+    rcursors.clear();
+}
+
+// Free the read caches of cursors not read for rcacheIdleSecs. All but one of the idle cursors are closed, as
+// they are only needed while there are concurrent readers.
+void
+JournalImpl::releaseIdleReadCursors()
+{
+    qpid::sys::Monitor::ScopedLock sl(_rcursor_monitor);
+    std::vector<ReadCursor*>::iterator i = rcursors.begin();
+    while (i != rcursors.end()) {
+        ReadCursor* rc = *i;
+        if (!rc->busy && rc->rcp->release_idle_pages(rcacheIdleSecs)) {
+            // The next read from this cursor starts again from the start of the journal
+            rc->lastReadRid = 0;
+            rc->oooRidList.clear();
+            // Drop the last msg read
+            rc->freeBuffers();
+            rc->buf.release();
+            rc->dtok.reset();
+            if (rcursors.size() > 1) {
+                close_rcursor(rc->rcp);
+                delete rc;
+                i = rcursors.erase(i);
+                log(LOG_DEBUG, "Idle read cursor closed");
+                continue;
+            }
+            log(LOG_DEBUG, "Idle read cache released");
+        }
+        i++;
+    }
+}
+
+// Memory of read cursors in use by a load is left out until the next update
+void
+JournalImpl::updateMemoryStats(const bool release)
+{
+    u_int64_t cacheBytes = 0;
+    u_int64_t indexBytes = 0;
+    if (!release) {
+        cacheBytes = cache_mem_bytes();
+        indexBytes = index_mem_bytes();
+        {
+            qpid::sys::Monitor::ScopedLock sl(_rcursor_monitor);
+            for (std::vector<ReadCursor*>::const_iterator i = rcursors.begin(); i != rcursors.end(); i++) {
+                cacheBytes += sizeof(ReadCursor);
+                if (!(*i)->busy)
+                    cacheBytes += (*i)->buf.mem_bytes() + (*i)->oooRidList.capacity() * sizeof(u_int64_t);
+            }
+        }
+        {
+            qpid::sys::Mutex::ScopedLock sl(_content_cache_lock);
+            cacheBytes += contentCacheBytes + contentCache.size() * (sizeof(ContentCache::value_type) +
+                    JRNL_MAP_NODE_OVERHEAD + sizeof(u_int64_t) + 2 * sizeof(void*));
+        }
+        {
+            qpid::sys::Mutex::ScopedLock sl(_deq_batch_lock);
+            cacheBytes += deqBatch.capacity() * sizeof(mrg::journal::data_tok*);
+        }
+    }
+    const int64_t cacheChg = int64_t(cacheBytes) - int64_t(cacheMemBytes);
+    const int64_t indexChg = int64_t(indexBytes) - int64_t(indexMemBytes);
+    cacheMemBytes = cacheBytes;
+    indexMemBytes = indexBytes;
+    if (_mgmtObject != 0) {
+        if (cacheChg > 0) _mgmtObject->inc_cacheBytes(cacheChg);
+        else if (cacheChg < 0) _mgmtObject->dec_cacheBytes(-cacheChg);
+        if (indexChg > 0) _mgmtObject->inc_indexBytes(indexChg);
+        else if (indexChg < 0) _mgmtObject->dec_indexBytes(-indexChg);
+    }
+    if (memoryCallback && (cacheChg || indexChg)) memoryCallback(cacheChg, indexChg);
+}
+
+void
+JournalImpl::set_content_cache_size(const size_t n)
+{
+    qpid::sys::Mutex::ScopedLock sl(_content_cache_lock);
+    contentCacheMaxBytes = n;
+    trimContentCache(n);
+}
+
+bool
+JournalImpl::loadCachedContent(const u_int64_t rid, std::string& data, const size_t length, const size_t offset)
+{
+    qpid::sys::Mutex::ScopedLock sl(_content_cache_lock);
+    ContentCacheItr i = contentCache.find(rid);
+    if (i == contentCache.end()) {
+        contentCacheMisses++;
+        return false;
+    }
+    contentCacheHits++;
+    contentCacheLru.splice(contentCacheLru.end(), contentCacheLru, i->second.lruItr);
+    const std::string& content = i->second.data;
+    if (offset + length > content.size()) {
+        data.append(content, offset, content.size() - offset);
+    } else {
+        data.append(content, offset, length);
+    }
+    return true;
+}
+
+// Content larger than the whole cache is not kept, as it would only displace everything else.
+void
+JournalImpl::cacheContent(const u_int64_t rid, const char* const data, const size_t size)
+{
+    qpid::sys::Mutex::ScopedLock sl(_content_cache_lock);
+    if (size > contentCacheMaxBytes || contentCache.find(rid) != contentCache.end())
+        return;
+    // A dequeue drops the entry only after removing rid from the enqueue map, so checking here under the lock
+    // keeps a load racing with the dequeue from caching the msg again. Locked (transactional) msgs are not cached.
+    if (!is_enqueued(rid))
+        return;
+    trimContentCache(contentCacheMaxBytes - size);
+    CachedContent& cc = contentCache[rid];
+    cc.data.assign(data, size);
+    cc.lruItr = contentCacheLru.insert(contentCacheLru.end(), rid);
+    contentCacheBytes += size;
+}
+
+void
+JournalImpl::dropCachedContent(const u_int64_t rid)
+{
+    if (!contentCacheMaxBytes)
+        return;
+    qpid::sys::Mutex::ScopedLock sl(_content_cache_lock);
+    ContentCacheItr i = contentCache.find(rid);
+    if (i == contentCache.end())
+        return;
+    contentCacheBytes -= i->second.data.size();
+    contentCacheLru.erase(i->second.lruItr);
+    contentCache.erase(i);
+}
+
+// Must be called with _content_cache_lock held
+void
+JournalImpl::trimContentCache(const size_t maxBytes)
+{
+    while (contentCacheBytes > maxBytes) {
+        ContentCacheItr i = contentCache.find(contentCacheLru.front());
+        contentCacheBytes -= i->second.data.size();
+        contentCache.erase(i);
+        contentCacheLru.pop_front();
+    }
+}
+
+// Must be called with _deq_batch_lock held
+bool
+JournalImpl::batchable(const u_int64_t drid)
+{
+    // Anything which would fail as a single dequeue is passed through so that the error is reported for that
+    // dequeue alone rather than for the whole batch when it is written.
+    if (!is_enqueued(drid))
+        return false;
+    for (std::vector<data_tok*>::const_iterator i = deqBatch.begin(); i != deqBatch.end(); i++)
+        if ((*i)->dequeue_rid() == drid)
+            return false;
+    return true;
+}
+
+// Must be called with _deq_batch_lock held. If the write fails, the tokens of the batch are released, except for
+// callerDtokp, which is released by the caller as for a failed single dequeue.
+void
+JournalImpl::writeDequeueBatch(const data_tok* const callerDtokp)
+{
+    if (deqBatch.empty())
+        return;
+    std::vector<data_tok*> dtokl;
+    dtokl.swap(deqBatch);
+    // The record takes the rid of its first token; use the most recently allocated one so rids stay increasing
+    dtokl.front()->set_rid(dtokl.back()->rid());
+    try {
+        dequeue_data_records(dtokl);
+    } catch (...) {
+        for (std::vector<data_tok*>::const_iterator i = dtokl.begin(); i != dtokl.end(); i++)
+            if (*i != callerDtokp && (*i)->wstate() == data_tok::ENQ)
+                static_cast<DataTokenImpl*>(*i)->release();
+        throw;
     }
 }
 
@@ -585,6 +921,11 @@ JournalImpl::handleIoResult(const iores r)
     switch (r)
     {
         case mrg::journal::RHM_IORES_SUCCESS:
+            {
+                // Writes do not wait for their AIO to complete, so make sure the completions are collected
+                qpid::sys::Mutex::ScopedLock sl(_getf_lock);
+                if (_wmgr.get_aio_evt_rem() && !getEventsTimerSetFlag) { setGetEventTimer(); }
+            }
             return;
         case mrg::journal::RHM_IORES_ENQCAPTHRESH:
             {
@@ -634,3 +975,13 @@ qpid::management::Manageable::status_t JournalImpl::ManagementMethod (uint32_t m
 
     return status;
 }
+
+void
+TplJournalImpl::groupFlush()
+{
+    // While an earlier TPL write is in flight, this txn's records are left in the current page, along with those
+    // of any other txns which arrive meanwhile. The page is flushed, as one write, by the first of them to find
+    // no write in flight once the earlier one has completed (see jcntl::wait_txn_synced()).
+    if (!get_wr_aio_evt_rem())
+        flush();
+}
@@ -24,12 +24,16 @@
 #ifndef _JournalImpl_
 #define _JournalImpl_
 
+#include <list>
+#include <map>
 #include <set>
 #include "jrnl/enums.hpp"
 #include "jrnl/jcntl.hpp"
+#include "jrnl/rcursor.hpp"
 #include "DataTokenImpl.h"
 #include "PreparedTransaction.h"
 #include <qpid/broker/PersistableQueue.h>
+#include <qpid/sys/Monitor.h>
 #include <qpid/sys/Timer.h>
 #include <qpid/sys/Time.h>
 #include <boost/ptr_container/ptr_list.hpp>
@@ -74,6 +78,8 @@ class JournalImpl : public qpid::broker::ExternalQueueStore, public mrg::journal
 {
   public:
     typedef boost::function<void (JournalImpl&)> DeleteCallback;
+    // Called with the change in the estimated cache and index memory of the journal each time it is updated
+    typedef boost::function<void (const int64_t cacheChg, const int64_t indexChg)> MemoryCallback;
     
   private:
 //    static qpid::sys::Mutex _static_lock;
@@ -83,21 +89,68 @@ class JournalImpl : public qpid::broker::ExternalQueueStore, public mrg::journal
     bool getEventsTimerSetFlag;
     boost::intrusive_ptr<qpid::sys::TimerTask> getEventsFireEventsPtr;
     qpid::sys::Mutex _getf_lock;
-    qpid::sys::Mutex _read_lock;
+    qpid::sys::Mutex _read_lock; // Serializes use of the journal's own read position (recovery, TPL reads)
 
-    u_int64_t lastReadRid; // rid of last read msg for loadMsgContent() - detects out-of-order read requests
-    std::vector<u_int64_t> oooRidList; // list of out-of-order rids (greater than current rid) encountered during read sequence
+    // A read position used by loadMsgContent(), with the last msg read from it
+    struct ReadCursor
+    {
+        mrg::journal::rcursor* rcp;
+        bool busy; // In use by a loadMsgContent() call
+        u_int64_t lastUse;
+        u_int64_t lastReadRid; // rid of last read msg - detects out-of-order read requests
+        std::vector<u_int64_t> oooRidList; // list of out-of-order rids (greater than current rid) encountered during read sequence
+        void* xidp;
+        void* datap;
+        size_t dlen;
+        mrg::journal::data_tok dtok;
+        bool external;
+        mrg::journal::rd_buf buf; // Holds the last msg read, reused for each read
+        mrg::journal::rd_pin pin; // Set while datap and xidp point into a mapped journal file instead (within a load only)
+
+        ReadCursor(mrg::journal::rcursor* const r);
+        bool oooRid(const u_int64_t rid) const;
+        void freeBuffers();
+    };
+    qpid::sys::Monitor _rcursor_monitor;
+    std::vector<ReadCursor*> rcursors;
+    u_int16_t maxReadCursors;
+    u_int64_t rcursorUseCnt;
 
     bool writeActivityFlag;
     bool flushTriggeredFlag;
     boost::intrusive_ptr<qpid::sys::TimerTask> inactivityFireEventPtr;
 
-    // temp local vars for loadMsgContent below
-    void* _xidp;
-    void* _datap;
-    size_t _dlen;
-    mrg::journal::data_tok _dtok;
-    bool _external;
+    // Non-transactional dequeues held back so that they are written as a single multi-rid dequeue record
+    qpid::sys::Mutex _deq_batch_lock;
+    std::vector<mrg::journal::data_tok*> deqBatch;
+    u_int32_t deqBatchSize;
+
+    // Read cache page memory is freed once the journal has not been read for this many seconds (0 = never)
+    u_int32_t rcacheIdleSecs;
+
+    // Content of recently loaded msgs, by rid, so that chunked loads of several msgs at once need not re-read them
+    struct CachedContent
+    {
+        std::string data;
+        std::list<u_int64_t>::iterator lruItr;
+    };
+    typedef std::map<u_int64_t, CachedContent> ContentCache;
+    typedef ContentCache::iterator ContentCacheItr;
+    qpid::sys::Mutex _content_cache_lock;
+    ContentCache contentCache;
+    std::list<u_int64_t> contentCacheLru; // Least recently used first
+    size_t contentCacheBytes;
+    size_t contentCacheMaxBytes;
+    u_int64_t contentCacheHits;
+    u_int64_t contentCacheMisses;
+
+    // Bytes preceding the encoded msg in each data record (see set_msg_prefix_size())
+    u_int32_t msgPrefixSize;
+
+    // Estimated cache and index memory last published (see updateMemoryStats())
+    u_int64_t cacheMemBytes;
+    u_int64_t indexMemBytes;
+    MemoryCallback memoryCallback;
 
     qpid::management::ManagementAgent* _agent;
     qmf::com::redhat::rhm::store::Journal* _mgmtObject;
@@ -176,22 +229,54 @@ class JournalImpl : public qpid::broker::ExternalQueueStore, public mrg::journal
                                     const bool transient = false);
 
     void enqueue_txn_data_record(const void* const data_buff, const size_t tot_data_len,
-                                 const size_t this_data_len, mrg::journal::data_tok* dtokp, const std::string& xid,
-                                 const bool transient = false);
+                                 const size_t this_data_len, mrg::journal::data_tok* dtokp,
+                                 const mrg::journal::xid_handle& xid, const bool transient = false);
 
     void enqueue_extern_txn_data_record(const size_t tot_data_len, mrg::journal::data_tok* dtokp,
-                                        const std::string& xid, const bool transient = false);
+                                        const mrg::journal::xid_handle& xid, const bool transient = false);
 
     void dequeue_data_record(mrg::journal::data_tok* const dtokp, const bool txn_coml_commit = false);
 
-    void dequeue_txn_data_record(mrg::journal::data_tok* const dtokp, const std::string& xid, const bool txn_coml_commit = false);
+    void dequeue_data_records(const std::vector<mrg::journal::data_tok*>& dtokl);
+
+    void dequeue_txn_data_record(mrg::journal::data_tok* const dtokp, const mrg::journal::xid_handle& xid,
+                                 const bool txn_coml_commit = false);
 
-    void txn_abort(mrg::journal::data_tok* const dtokp, const std::string& xid);
+    void txn_abort(mrg::journal::data_tok* const dtokp, const mrg::journal::xid_handle& xid);
 
-    void txn_commit(mrg::journal::data_tok* const dtokp, const std::string& xid);
+    void txn_commit(mrg::journal::data_tok* const dtokp, const mrg::journal::xid_handle& xid);
 
     void stop(bool block_till_aio_cmpl = false);
 
+    // Non-transactional dequeues are held back until n of them can be written as one record, or until the
+    // journal is flushed (which includes the inactivity flush). Values of 0 or 1 write each dequeue at once.
+    inline void set_dequeue_batch_size(const u_int32_t n) { deqBatchSize = n; }
+    inline u_int32_t get_dequeue_batch_size() const { return deqBatchSize; }
+
+    // The read cache is allocated on the first read from the journal (see loadMsgContent()) and freed again
+    // once it has not been read for secs seconds. 0 keeps the cache once allocated.
+    inline void set_rcache_idle_timeout(const u_int32_t secs) { rcacheIdleSecs = secs; }
+    inline u_int32_t get_rcache_idle_timeout() const { return rcacheIdleSecs; }
+
+    // loadMsgContent() reads through up to n read cursors, each with its own position and read cache, so that
+    // consumers and browsers reading different parts of the journal neither wait for nor disturb one another.
+    // Cursors are opened as needed and closed again once idle for the read cache idle timeout.
+    inline void set_read_cursors(const u_int16_t n) { maxReadCursors = n ? n : 1; }
+    inline u_int16_t get_read_cursors() const { return maxReadCursors; }
+
+    // The content of msgs read by loadMsgContent() is kept for later loads until it is dequeued or displaced by
+    // more recently loaded content, up to a total of n bytes. 0 disables the cache.
+    void set_content_cache_size(const size_t n);
+    inline size_t get_content_cache_size() const { return contentCacheMaxBytes; }
+    inline size_t get_content_cache_bytes() const { return contentCacheBytes; }
+    inline u_int64_t get_content_cache_hits() const { return contentCacheHits; }
+    inline u_int64_t get_content_cache_misses() const { return contentCacheMisses; }
+
+    // Each data record holds n bytes written by the store (eg the queue id in a shared journal) ahead of the
+    // encoded msg, which loadMsgContent() skips.
+    inline void set_msg_prefix_size(const u_int32_t n) { msgPrefixSize = n; }
+    inline u_int32_t get_msg_prefix_size() const { return msgPrefixSize; }
+
     // Logging
     void log(mrg::journal::log_level level, const std::string& log_stmt) const;
     void log(mrg::journal::log_level level, const char* const log_stmt) const;
@@ -216,8 +301,21 @@ class JournalImpl : public qpid::broker::ExternalQueueStore, public mrg::journal
 
     void resetDeleteCallback() { deleteCallback = DeleteCallback(); }
 
+    // The estimated memory of the journal is updated on each inactivity timer firing, and its changes passed to
+    // the callback. On destruction, the callback is passed the withdrawal of the last values reported.
+    inline void setMemoryCallback(const MemoryCallback& cb) { memoryCallback = cb; }
+    void resetMemoryCallback() { memoryCallback = MemoryCallback(); }
+
   private:
-    void free_read_buffers();
+    ReadCursor* acquireReadCursor(const u_int64_t rid);
+    void releaseReadCursor(ReadCursor* const rc);
+    void closeReadCursors();
+    void releaseIdleReadCursors();
+    void updateMemoryStats(const bool release = false);
+    bool loadCachedContent(const u_int64_t rid, std::string& data, const size_t length, const size_t offset);
+    void cacheContent(const u_int64_t rid, const char* const data, const size_t size);
+    void dropCachedContent(const u_int64_t rid);
+    void trimContentCache(const size_t maxBytes);
 
     inline void setGetEventTimer()
     {
@@ -226,6 +324,8 @@ class JournalImpl : public qpid::broker::ExternalQueueStore, public mrg::journal
         getEventsTimerSetFlag = true;
     }
     void handleIoResult(const mrg::journal::iores r);
+    bool batchable(const u_int64_t drid);
+    void writeDequeueBatch(const mrg::journal::data_tok* const callerDtokp = 0);
 
     // Management instrumentation callbacks overridden from jcntl
     inline void instr_incr_outstanding_aio_cnt() {
@@ -234,6 +334,9 @@ class JournalImpl : public qpid::broker::ExternalQueueStore, public mrg::journal
     inline void instr_decr_outstanding_aio_cnt() {
         if (_mgmtObject != 0) _mgmtObject->dec_outstandingAIOs();
     }
+    inline void instr_add_read_bytes(const u_int64_t bytes) {
+        if (_mgmtObject != 0) _mgmtObject->inc_readBytes(bytes);
+    }
 
 }; // class JournalImpl
 
@@ -252,11 +355,17 @@ class TplJournalImpl : public JournalImpl
 
     virtual ~TplJournalImpl() {}
 
+    // Flush the TPL on behalf of a txn which has written a record to it, combining the flush with those of
+    // other txns doing the same. If no TPL write is in flight the page is flushed at once; otherwise the flush
+    // is left until that write completes, so that it also carries the records of txns arriving meanwhile. In
+    // either case the caller then waits for its xid to be synced as usual.
+    void groupFlush();
+
     // Special version of read_data_record that ignores transactions - needed when reading the TPL
     inline mrg::journal::iores read_data_record(void** const datapp, std::size_t& dsize,
                                                 void** const xidpp, std::size_t& xidsize, bool& transient, bool& external,
-                                                mrg::journal::data_tok* const dtokp) {
-        return JournalImpl::read_data_record(datapp, dsize, xidpp, xidsize, transient, external, dtokp, true);
+                                                mrg::journal::data_tok* const dtokp, mrg::journal::rd_buf& buf) {
+        return JournalImpl::read_data_record(datapp, dsize, xidpp, xidsize, transient, external, dtokp, buf, 0, true);
     }
     inline void read_reset() { _rmgr.invalidate(); }
 }; // class TplJournalImpl
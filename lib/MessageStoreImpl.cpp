@@ -26,11 +26,16 @@
 #include "BindingDbt.h"
 #include "BufferValue.h"
 #include "IdDbt.h"
+#include "jrnl/lzf_codec.hpp"
+#include "jrnl/page_alloc.hpp"
 #include "jrnl/txn_map.hpp"
 #include "qpid/framing/FieldValue.h"
 #include "qpid/log/Statement.h"
 #include "qmf/com/redhat/rhm/store/Package.h"
 #include "StoreException.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
 #include <dirent.h>
 #include <db.h>
 
@@ -52,13 +57,29 @@ qpid::sys::Mutex TxnCtxt::globalSerialiser;
 MessageStoreImpl::TplRecoverStruct::TplRecoverStruct(const u_int64_t _rid,
                                                      const bool _deq_flag,
                                                      const bool _commit_flag,
-                                                     const bool _tpc_flag) :
+                                                     const bool _tpc_flag,
+                                                     const u_int16_t _shard) :
                                                      rid(_rid),
                                                      deq_flag(_deq_flag),
                                                      commit_flag(_commit_flag),
-                                                     tpc_flag(_tpc_flag)
+                                                     tpc_flag(_tpc_flag),
+                                                     shard(_shard)
 {}
 
+JournalReaperEvent::JournalReaperEvent(const std::string& dirName) :
+    qpid::sys::TimerTask(qpid::sys::Duration(0), "JournalReaper:" + dirName), _dirName(dirName) {}
+
+void JournalReaperEvent::fire()
+{
+    try {
+        journal::jdir::delete_dir(_dirName);
+        QPID_LOG(debug, "Journal reaper: deleted tombstone directory " << _dirName);
+    } catch (const journal::jexception& e) {
+        // Anything left behind is picked up again by reapTombstones() on the next store initialization
+        QPID_LOG(warning, "Journal reaper: failed to delete tombstone directory " << _dirName << ": " << e.what());
+    }
+}
+
 MessageStoreImpl::MessageStoreImpl(qpid::sys::Timer& timer_, const char* envpath) :
                                    numJrnlFiles(0),
                                    autoJrnlExpand(false),
@@ -67,11 +88,29 @@ MessageStoreImpl::MessageStoreImpl(qpid::sys::Timer& timer_, const char* envpath
                                    truncateFlag(false),
                                    wCachePgSizeSblks(0),
                                    wCacheNumPages(0),
+                                   wCacheMinPages(defWCacheMinPages),
+                                   wCacheMaxPages(defWCacheMaxPages),
+                                   rCachePgSizeSblks(defRCachePageSize * 1024 / JRNL_DBLK_SIZE / JRNL_SBLK_SIZE),
+                                   rCacheNumPages(defRCacheNumPages),
+                                   rCacheIdleSecs(defRCacheIdleTimeout),
+                                   hugePages(defHugePages),
+                                   numaLocalCaches(defNumaLocalCaches),
+                                   readCursors(defReadCursors),
+                                   contentCacheBytes(defContentCacheSize * 1024),
+                                   mmapReads(defMmapReads),
+                                   sharedNumJournals(defSharedJournals),
                                    tplNumJrnlFiles(0),
                                    tplJrnlFsizeSblks(0),
                                    tplWCachePgSizeSblks(0),
                                    tplWCacheNumPages(0),
+                                   tplNumShards(defTplNumShards),
                                    highestRid(0),
+                                   asyncQueueDestroy(defAsyncQueueDestroy),
+                                   compressThreshold(defCompressThreshold),
+                                   packRecords(defPackRecords),
+                                   dequeueBatchSize(defDequeueBatchSize),
+                                   writeCombining(defWriteCombining),
+                                   idLeaseSize(defIdLeaseSize),
                                    isInit(false),
                                    envPath(envpath),
                                    timer(timer_),
@@ -149,6 +188,36 @@ u_int32_t MessageStoreImpl::chkJrnlWrPageCacheSize(const u_int32_t param, const
     return p;
 }
 
+u_int32_t MessageStoreImpl::chkJrnlRdPageCacheSize(const u_int32_t param, const std::string paramName)
+{
+    // Read pages must divide the journal file size unit (JRNL_RMGR_PAGE_SIZE, 64 KiB)
+    u_int32_t p = param;
+    switch (p)
+    {
+      case 1:
+      case 2:
+      case 4:
+      case 8:
+      case 16:
+      case 32:
+      case 64:
+        break;
+      default:
+        if (p == 0) {
+            p = defRCachePageSize;
+            QPID_LOG(warning, "parameter " << paramName << " (" << param << ") must be a power of 2 between 1 and 64; changing this parameter to default value (" << p << ")");
+        } else {
+            if      (p <   6)   p =   4;
+            else if (p <  12)   p =   8;
+            else if (p <  24)   p =  16;
+            else if (p <  48)   p =  32;
+            else                p =  64;
+            QPID_LOG(warning, "parameter " << paramName << " (" << param << ") must be a power of 2 between 1 and 64; changing this parameter to closest allowable value (" << p << ")");
+        }
+    }
+    return p;
+}
+
 u_int16_t MessageStoreImpl::getJrnlWrNumPages(const u_int32_t wrPageSizeKib)
 {
     u_int32_t wrPageSizeSblks = wrPageSizeKib * 1024 / JRNL_DBLK_SIZE / JRNL_SBLK_SIZE; // convert from KiB to number sblks
@@ -237,9 +306,10 @@ void MessageStoreImpl::initManagement (qpid::broker::Broker* broker)
             mgmtObject->set_tplWritePages(tplWCacheNumPages);
             mgmtObject->set_tplInitialFileCount(tplNumJrnlFiles);
             mgmtObject->set_tplDataFileSize(tplJrnlFsizeSblks * JRNL_SBLK_SIZE * JRNL_DBLK_SIZE);
-            mgmtObject->set_tplCurrentFileCount(tplNumJrnlFiles);
+            mgmtObject->set_tplCurrentFileCount(tplNumJrnlFiles * tplStores.size()); // All shards
 
             agent->addObject(mgmtObject, 0, true);
+            journal::page_pool::set_listener(this);
 
             // Initialize all existing queues (ie those recovered before management was initialized)
             for (JournalListMapItr i=journalList.begin(); i!=journalList.end(); i++) {
@@ -249,6 +319,24 @@ void MessageStoreImpl::initManagement (qpid::broker::Broker* broker)
     }
 }
 
+void MessageStoreImpl::pool_pages_chg(const int32_t allocChg, const int32_t usedChg)
+{
+    if (mgmtObject == 0) return;
+    if (allocChg > 0) mgmtObject->inc_wcachePoolPages(allocChg);
+    else if (allocChg < 0) mgmtObject->dec_wcachePoolPages(-allocChg);
+    if (usedChg > 0) mgmtObject->inc_wcachePoolPagesInUse(usedChg);
+    else if (usedChg < 0) mgmtObject->dec_wcachePoolPagesInUse(-usedChg);
+}
+
+void MessageStoreImpl::journalMemoryChg(const int64_t cacheChg, const int64_t indexChg)
+{
+    if (mgmtObject == 0) return;
+    if (cacheChg > 0) mgmtObject->inc_journalCacheBytes(cacheChg);
+    else if (cacheChg < 0) mgmtObject->dec_journalCacheBytes(-cacheChg);
+    if (indexChg > 0) mgmtObject->inc_journalIndexBytes(indexChg);
+    else if (indexChg < 0) mgmtObject->dec_journalIndexBytes(-indexChg);
+}
+
 bool MessageStoreImpl::init(const qpid::Options* options)
 {
     // Extract and check options
@@ -263,6 +351,44 @@ bool MessageStoreImpl::init(const qpid::Options* options)
     u_int16_t autoJrnlExpandMaxFiles;
     chkJrnlAutoExpandOptions(opts, autoJrnlExpand, autoJrnlExpandMaxFiles, "auto-expand-max-jfiles", numJrnlFiles, "num-jfiles");
 
+    // Settings not passed to init(...) are set directly; until then they hold their defaults
+    if (!isInit) {
+        tplNumShards = opts->tplNumShards;
+        if (tplNumShards == 0) {
+            QPID_LOG(warning, "parameter tpl-shards (0) must be at least 1; changing this parameter to 1.");
+            tplNumShards = 1;
+        }
+        wCacheMinPages = opts->wCacheMinPages;
+        if (wCacheMinPages == 0) {
+            QPID_LOG(warning, "parameter wcache-min-pages (0) must be at least 1; changing this parameter to 1.");
+            wCacheMinPages = 1;
+        }
+        wCacheMaxPages = opts->wCacheMaxPages;
+        rCachePgSizeSblks = chkJrnlRdPageCacheSize(opts->rCachePageSizeKib, "rcache-page-size") * 1024 / JRNL_DBLK_SIZE / JRNL_SBLK_SIZE; // convert from KiB to number sblks
+        rCacheNumPages = opts->rCacheNumPages;
+        if (rCacheNumPages == 0) {
+            QPID_LOG(warning, "parameter rcache-pages (0) must be at least 1; changing this parameter to default value (" << defRCacheNumPages << ").");
+            rCacheNumPages = defRCacheNumPages;
+        }
+        rCacheIdleSecs = opts->rCacheIdleTimeout;
+        readCursors = opts->readCursors;
+        if (readCursors == 0) {
+            QPID_LOG(warning, "parameter read-cursors (0) must be at least 1; changing this parameter to 1.");
+            readCursors = 1;
+        }
+        hugePages = opts->hugePages;
+        numaLocalCaches = opts->numaLocalCaches;
+        contentCacheBytes = opts->contentCacheSizeKib * 1024;
+        mmapReads = opts->mmapReads;
+        sharedNumJournals = opts->sharedJournals;
+        asyncQueueDestroy = opts->asyncQueueDestroy;
+        compressThreshold = opts->compressThreshold;
+        packRecords = opts->packRecords;
+        dequeueBatchSize = opts->dequeueBatchSize;
+        writeCombining = opts->writeCombining;
+        idLeaseSize = opts->idLeaseSize;
+    }
+
     // Pass option values to init(...)
     return init(opts->storeDir, numJrnlFiles, jrnlFsizePgs, opts->truncateFlag, jrnlWrCachePageSizeKib, tplNumJrnlFiles, tplJrnlFSizePgs, tplJrnlWrCachePageSizeKib, autoJrnlExpand, autoJrnlExpandMaxFiles);
 }
@@ -285,13 +411,26 @@ bool MessageStoreImpl::init(const std::string& dir,
     numJrnlFiles = jfiles;
     jrnlFsizeSblks = jfileSizePgs * JRNL_RMGR_PAGE_SIZE;
     wCachePgSizeSblks = wCachePageSizeKib * 1024 / JRNL_DBLK_SIZE / JRNL_SBLK_SIZE; // convert from KiB to number sblks
-    wCacheNumPages = getJrnlWrNumPages(wCachePageSizeKib);
+    wCacheNumPages = wCacheMaxPages ? wCacheMaxPages : getJrnlWrNumPages(wCachePageSizeKib);
+    if (wCacheMinPages > wCacheNumPages) {
+        QPID_LOG(warning, "parameter wcache-min-pages (" << wCacheMinPages << ") may not exceed the number of write cache pages ("
+                 << wCacheNumPages << "); changing this parameter to " << wCacheNumPages << ".");
+        wCacheMinPages = wCacheNumPages;
+    }
     tplNumJrnlFiles = tplJfiles;
     tplJrnlFsizeSblks = tplJfileSizePgs * JRNL_RMGR_PAGE_SIZE;
     tplWCachePgSizeSblks = tplWCachePageSizeKib * 1024 / JRNL_DBLK_SIZE / JRNL_SBLK_SIZE; // convert from KiB to number sblks
     tplWCacheNumPages = getJrnlWrNumPages(tplWCachePageSizeKib);
     autoJrnlExpand = autoJExpand;
     autoJrnlExpandMaxFiles = autoJExpandMaxFiles;
+    messageIdSequence.setLeaseSize(idLeaseSize);
+    // Must be set before any journal allocates its page caches
+    if (!journal::page_alloc::set_policy((hugePages ? journal::page_alloc::PA_HUGE_PAGES : 0) |
+                                         (numaLocalCaches ? journal::page_alloc::PA_NUMA_LOCAL : 0))) {
+        QPID_LOG(warning, "Journal page cache memory already allocated; huge-pages and numa-local-caches settings ignored.");
+        hugePages = journal::page_alloc::huge_pages();
+        numaLocalCaches = journal::page_alloc::numa_local();
+    }
     if (dir.size()>0) storeDir = dir;
 
     if (truncateFlag)
@@ -307,10 +446,41 @@ bool MessageStoreImpl::init(const std::string& dir,
     QPID_LOG(info,   "> Default journal file size: " << jfileSizePgs << " (wpgs)");
     QPID_LOG(info,   "> Default write cache page size: " << wCachePageSizeKib << " (KiB)");
     QPID_LOG(info,   "> Default number of write cache pages: " << wCacheNumPages);
+    QPID_LOG(info,   "> Write cache pages kept by an idle journal: " << wCacheMinPages);
+    QPID_LOG(info,   "> Read cache page size: " << (rCachePgSizeSblks * JRNL_SBLK_SIZE * JRNL_DBLK_SIZE / 1024) << " (KiB)");
+    QPID_LOG(info,   "> Number of read cache pages: " << rCacheNumPages);
+    if (rCacheIdleSecs)
+        QPID_LOG(info,   "> Idle read caches released after: " << rCacheIdleSecs << " (s)");
+    QPID_LOG(info,   "> Huge page backed journal caches " << (hugePages ? "enabled" : "disabled"));
+    QPID_LOG(info,   "> NUMA local journal caches " << (numaLocalCaches ? "enabled" : "disabled"));
+    QPID_LOG(info,   "> Read cursors per journal: " << readCursors);
+    QPID_LOG(info,   "> Message content cache size per journal: " << (contentCacheBytes / 1024) << " (KiB)");
+    QPID_LOG(info,   "> Memory-mapped journal reads " << (mmapReads ? "enabled" : "disabled"));
+    if (sharedNumJournals)
+        QPID_LOG(info,   "> Shared journals: " << sharedNumJournals);
+    else
+        QPID_LOG(info,   "> Shared journals disabled");
     QPID_LOG(info,   "> TPL files per journal: " << tplNumJrnlFiles);
     QPID_LOG(info,   "> TPL journal file size: " << tplJfileSizePgs << " (wpgs)");
     QPID_LOG(info,   "> TPL write cache page size: " << tplWCachePageSizeKib << " (KiB)");
     QPID_LOG(info,   "> TPL number of write cache pages: " << tplWCacheNumPages);
+    if (tplNumShards > 1)
+        QPID_LOG(info,   "> TPL shards: " << tplNumShards);
+    if (tplStores.size() > tplNumShards)
+        QPID_LOG(notice, "Recovering " << (tplStores.size() - tplNumShards) << " additional TPL shard(s) found on disk");
+    QPID_LOG(info,   "> Asynchronous queue destroy " << (asyncQueueDestroy ? "enabled" : "disabled"));
+    if (compressThreshold)
+        QPID_LOG(info,   "> Message compression threshold: " << compressThreshold << " (bytes)");
+    else
+        QPID_LOG(info,   "> Message compression disabled");
+    QPID_LOG(info,   "> Small record packing " << (packRecords ? "enabled" : "disabled"));
+    if (dequeueBatchSize > 1)
+        QPID_LOG(info,   "> Dequeue batch size: " << dequeueBatchSize);
+    else
+        QPID_LOG(info,   "> Dequeue batching disabled");
+    QPID_LOG(info,   "> Write combining " << (writeCombining ? "enabled" : "disabled"));
+    if (idLeaseSize > 1)
+        QPID_LOG(info,   "> Persistence id lease size: " << idLeaseSize);
 
     return isInit;
 }
@@ -365,7 +535,16 @@ void MessageStoreImpl::init()
             // NOTE: during normal initialization, agent == 0 because the store is initialized before the management infrastructure.
             // However during a truncated initialization in a cluster, agent != 0. We always pass 0 as the agent for the
             // TplStore to keep things consistent in a cluster. See https://bugzilla.redhat.com/show_bug.cgi?id=681026
-            tplStorePtr.reset(new TplJournalImpl(timer, "TplStore", getTplBaseDir(), "tpl", defJournalGetEventsTimeout, defJournalFlushTimeout, 0));
+            // Shard 0 keeps the unsharded TPL name and directory; any further shards already on disk are also opened.
+            tplStores.clear();
+            for (u_int16_t i = 0; i < tplNumShards || journal::jdir::exists(getTplBaseDir(i) + "tpl.jinf"); i++) {
+                std::ostringstream id;
+                id << "TplStore";
+                if (i) id << "-" << i;
+                tplStores.push_back(tpl_ptr(new TplJournalImpl(timer, id.str(), getTplBaseDir(i), "tpl", defJournalGetEventsTimeout, defJournalFlushTimeout, 0)));
+                tplStores.back()->set_wcache_min_pages(wCacheMinPages);
+            }
+            reapTombstones(); // Finish deleting journals of queues destroyed (asynchronously) before the last shutdown
             isInit = true;
         } catch (const DbException& e) {
             if (e.get_errno() == DB_VERSION_MISMATCH)
@@ -392,17 +571,30 @@ void MessageStoreImpl::init()
 
 void MessageStoreImpl::finalize()
 {
-    if (tplStorePtr.get() && tplStorePtr->is_ready()) tplStorePtr->stop(true);
+    stopReaper();
+    for (std::vector<tpl_ptr>::iterator i = tplStores.begin(); i != tplStores.end(); i++)
+        if ((*i)->is_ready()) (*i)->stop(true);
+    {
+        qpid::sys::Mutex::ScopedLock sl(sharedJournalLock);
+        for (std::vector<journal_ptr>::iterator i = sharedJournals.begin(); i != sharedJournals.end(); i++)
+        {
+            if (!i->get()) continue;
+            (*i)->resetMemoryCallback();
+            if ((*i)->is_ready()) (*i)->stop(true);
+        }
+    }
     {
         qpid::sys::Mutex::ScopedLock sl(journalListLock);
         for (JournalListMapItr i = journalList.begin(); i != journalList.end(); i++)
         {
             JournalImpl* jQueue = i->second;
             jQueue->resetDeleteCallback();
+            jQueue->resetMemoryCallback();
             if (jQueue->is_ready()) jQueue->stop(true);
         }
     }
 
+    journal::page_pool::clear_listener(this);
     if (mgmtObject != 0) {
         mgmtObject->resourceDestroy();
         mgmtObject = 0;
@@ -422,7 +614,15 @@ void MessageStoreImpl::truncateInit(const bool saveStoreContent)
         }
         closeDbs();
         dbs.clear();
-        if (tplStorePtr->is_ready()) tplStorePtr->stop(true);
+        for (std::vector<tpl_ptr>::iterator i = tplStores.begin(); i != tplStores.end(); i++)
+            if ((*i)->is_ready()) (*i)->stop(true);
+        {
+            qpid::sys::Mutex::ScopedLock sl(sharedJournalLock);
+            for (std::vector<journal_ptr>::iterator i = sharedJournals.begin(); i != sharedJournals.end(); i++)
+                if (i->get() && (*i)->is_ready()) (*i)->stop(true);
+            sharedJournals.clear();
+        }
+        stopReaper();
         dbenv->close(0);
         isInit = false;
     }
@@ -442,10 +642,92 @@ void MessageStoreImpl::chkTplStoreInit()
 {
     // Prevent multiple threads from late-initializing the TPL
     qpid::sys::Mutex::ScopedLock sl(tplInitLock);
-    if (!tplStorePtr->is_ready()) {
-        journal::jdir::create_dir(getTplBaseDir());
-        tplStorePtr->initialize(tplNumJrnlFiles, false, 0, tplJrnlFsizeSblks, tplWCacheNumPages, tplWCachePgSizeSblks);
-        if (mgmtObject != 0) mgmtObject->set_tplIsInitialized(true);
+    bool initFlag = false;
+    for (u_int16_t i = 0; i < tplStores.size(); i++) {
+        if (!tplStores[i]->is_ready()) {
+            journal::jdir::create_dir(getTplBaseDir(i));
+            tplStores[i]->initialize(tplNumJrnlFiles, false, 0, tplJrnlFsizeSblks, tplWCacheNumPages, tplWCachePgSizeSblks);
+            initFlag = true;
+        }
+    }
+    if (initFlag && mgmtObject != 0) mgmtObject->set_tplIsInitialized(true);
+}
+
+void MessageStoreImpl::setJrnlOptions(JournalImpl* jQueue)
+{
+    // Only affects new enqueues; recovered records are expanded using the codec id they carry
+    if (compressThreshold)
+        jQueue->set_codec(mrg::journal::codec::get(mrg::journal::lzf_codec::LZF_CODEC_ID), compressThreshold);
+    jQueue->set_pack_records(packRecords);
+    jQueue->set_wcache_min_pages(wCacheMinPages);
+    jQueue->set_rcache_geometry(rCachePgSizeSblks, rCacheNumPages);
+    jQueue->set_rcache_idle_timeout(rCacheIdleSecs);
+    jQueue->set_read_cursors(readCursors);
+    jQueue->set_content_cache_size(contentCacheBytes);
+    jQueue->set_rd_mmap(mmapReads);
+    jQueue->setMemoryCallback(boost::bind(&MessageStoreImpl::journalMemoryChg, this, _1, _2));
+    jQueue->set_dequeue_batch_size(dequeueBatchSize);
+    jQueue->set_write_combining(writeCombining);
+}
+
+JournalImpl* MessageStoreImpl::sharedJournal(const u_int16_t shard)
+{
+    // Prevent multiple threads from late-initializing the same shared journal
+    qpid::sys::Mutex::ScopedLock sl(sharedJournalLock);
+    if (shard >= sharedJournals.size())
+        sharedJournals.resize(shard + 1);
+    if (!sharedJournals[shard].get())
+        sharedJournals[shard].reset(newSharedJournal(shard));
+    JournalImpl* jc = sharedJournals[shard].get();
+    if (!jc->is_ready()) {
+        // The directories of all lower shards are also created, so that recovery (which stops at the first missing
+        // directory beyond the number of shared journals) finds this one
+        for (u_int16_t i = 0; i <= shard; i++)
+            journal::jdir::create_dir(getSharedJrnlDir(i));
+        jc->initialize(numJrnlFiles, autoJrnlExpand, autoJrnlExpandMaxFiles, jrnlFsizeSblks, wCacheNumPages, wCachePgSizeSblks);
+    }
+    return jc;
+}
+
+JournalImpl* MessageStoreImpl::newSharedJournal(const u_int16_t shard)
+{
+    // Shard 0 has no suffix, as for the TPL
+    std::ostringstream id;
+    id << "SharedJournal";
+    if (shard) id << "-" << shard;
+    JournalImpl* jc = new JournalImpl(timer, id.str(), getSharedJrnlDir(shard), std::string("JournalData"),
+                                      defJournalGetEventsTimeout, defJournalFlushTimeout, agent);
+    setJrnlOptions(jc);
+    jc->set_msg_prefix_size(SharedQueueStore::prefixSize);
+    return jc;
+}
+
+// The journal to add to a txn for an operation on msg messageId on a queue: the queue's own journal, or for a
+// queue on the shared journals, the journal holding the msg's record
+qpid::broker::ExternalQueueStore* MessageStoreImpl::recordJournal(qpid::broker::ExternalQueueStore* eqs,
+                                                                  const u_int64_t messageId)
+{
+    SharedQueueStore* sqs = dynamic_cast<SharedQueueStore*>(eqs);
+    if (!sqs) return eqs;
+    SharedQueueStore::RecordRef ref;
+    return sqs->findRecord(messageId, ref) ? ref.journal : sqs->journal();
+}
+
+// Non-transactional dequeue of a record which has no msg in the broker (eg on a destroyed shared queue)
+void MessageStoreImpl::dequeueRecord(JournalImpl* jc, const u_int64_t rid)
+{
+    boost::intrusive_ptr<DataTokenImpl> ddtokp(new DataTokenImpl);
+    ddtokp->set_external_rid(true);
+    ddtokp->set_rid(messageIdSequence.next());
+    ddtokp->set_dequeue_rid(rid);
+    ddtokp->set_wstate(DataTokenImpl::ENQ);
+    // Manually increase the ref count, as raw pointers are used beyond this point
+    ddtokp->addRef();
+    try {
+        jc->dequeue_data_record(ddtokp.get());
+    } catch (...) {
+        ddtokp->release();
+        throw;
     }
 }
 
@@ -481,6 +763,7 @@ MessageStoreImpl::~MessageStoreImpl()
         QPID_LOG(error, "Unknown error in MessageStoreImpl::~MessageStoreImpl()");
     }
 
+    journal::page_pool::clear_listener(this);
     if (mgmtObject != 0) {
         mgmtObject->resourceDestroy();
         mgmtObject = 0;
@@ -516,9 +799,31 @@ void MessageStoreImpl::create(qpid::broker::PersistableQueue& queue,
         return;
     }
 
+    bool sharedFlag = sharedNumJournals > 0;
+    value = args.get("qpid.shared_journal");
+    if (value.get() != 0 && !value->empty() && value->convertsTo<int>())
+        sharedFlag = sharedNumJournals > 0 && value->get<int>() != 0;
+    if (sharedFlag) {
+        try {
+            JournalImpl* jc = sharedJournal(bHash(queue.getName()) % sharedNumJournals);
+            queue.setExternalQueueStore(new SharedQueueStore(jc));
+        } catch (const journal::jexception& e) {
+            THROW_STORE_EXCEPTION(std::string("Queue ") + queue.getName() + ": create() failed: " + e.what());
+        }
+        try {
+            if (!create(queueDb, queueIdSequence, queue)) {
+                THROW_STORE_EXCEPTION("Queue already exists: " + queue.getName());
+            }
+        } catch (const DbException& e) {
+            THROW_STORE_EXCEPTION_2("Error creating queue named  " + queue.getName(), e);
+        }
+        return;
+    }
+
     jQueue = new JournalImpl(timer, queue.getName(), getJrnlDir(queue),  std::string("JournalData"),
                              defJournalGetEventsTimeout, defJournalFlushTimeout, agent,
                              boost::bind(&MessageStoreImpl::journalDeleted, this, _1));
+    setJrnlOptions(jQueue);
     {
         qpid::sys::Mutex::ScopedLock sl(journalListLock);
         journalList[queue.getName()]=jQueue;
@@ -554,14 +859,40 @@ void MessageStoreImpl::destroy(qpid::broker::PersistableQueue& queue)
     destroy(queueDb, queue);
     deleteBindingsForQueue(queue);
     qpid::broker::ExternalQueueStore* eqs = queue.getExternalQueueStore();
-    if (eqs) {
+    SharedQueueStore* sqs = dynamic_cast<SharedQueueStore*>(eqs);
+    if (sqs) {
+        // The journals are shared, so dequeue the queue's remaining records rather than deleting any files.
+        // Records locked by a txn dequeue are left to it; if it is aborted, they are dequeued on recovery.
+        SharedQueueStore::RecordList records;
+        sqs->recordList(records);
+        try {
+            for (SharedQueueStore::RecordList::iterator i = records.begin(); i != records.end(); i++) {
+                JournalImpl* jc = i->second.journal;
+                if (jc->is_enqueued(i->second.rid)) // false if locked
+                    dequeueRecord(jc, i->second.rid);
+            }
+        } catch (const journal::jexception& e) {
+            THROW_STORE_EXCEPTION(std::string("Queue ") + queue.getName() + ": destroy() failed: " + e.what());
+        }
+        queue.setExternalQueueStore(0); // will delete the SharedQueueStore
+    } else if (eqs) {
         JournalImpl* jQueue = static_cast<JournalImpl*>(eqs);
-        jQueue->delete_jrnl_files();
-        queue.setExternalQueueStore(0); // will delete the journal if exists
         {
             qpid::sys::Mutex::ScopedLock sl(journalListLock);
             journalList.erase(queue.getName());
         }
+        jQueue->resetDeleteCallback();
+        if (asyncQueueDestroy) {
+            // The queue is already gone from the BDB, so after the rename its journal is invisible to both recovery
+            // and a new queue of the same name. The journal is stopped first, so that no AIO is outstanding on its
+            // files when they are moved; only the (potentially slow) file deletion is left to the reaper.
+            if (jQueue->is_ready())
+                jQueue->stop(true); // NOTE: This will *block* until all outstanding disk aio calls are complete!
+            reapJrnlDir(jQueue->dirname());
+        } else {
+            jQueue->delete_jrnl_files();
+        }
+        queue.setExternalQueueStore(0); // will delete the journal if exists
     }
 }
 
@@ -728,22 +1059,24 @@ void MessageStoreImpl::recover(qpid::broker::RecoveryManager& registry)
             TPCTxnCtxt* tpcc = new TPCTxnCtxt(xid, &messageIdSequence);
             std::auto_ptr<qpid::broker::TPCTransactionContext> txn(tpcc);
             tpcc->recoverDtok(citr->second.rid, xid);
-            tpcc->prepare(tplStorePtr.get());
+            tpcc->prepare(tplStores[citr->second.shard].get());
 
             qpid::broker::RecoverableTransaction::shared_ptr dtx;
             if (!incomplTplTxnFlag) dtx = registry.recoverTransaction(xid, txn);
             if (pt.enqueues.get()) {
                 for (LockedMappings::iterator j = pt.enqueues->begin(); j != pt.enqueues->end(); j++) {
-                    tpcc->addXidRecord(queues[j->first]->getExternalQueueStore());
+                    tpcc->addXidRecord(recordJournal(queues[j->first]->getExternalQueueStore(), j->second));
                     if (!incomplTplTxnFlag) dtx->enqueue(queues[j->first], messages[j->second]);
                 }
             }
             if (pt.dequeues.get()) {
                 for (LockedMappings::iterator j = pt.dequeues->begin(); j != pt.dequeues->end(); j++) {
-                    tpcc->addXidRecord(queues[j->first]->getExternalQueueStore());
+                    tpcc->addXidRecord(recordJournal(queues[j->first]->getExternalQueueStore(), j->second));
                     if (!incomplTplTxnFlag) dtx->dequeue(queues[j->first], messages[j->second]);
                 }
             }
+            for (std::set<qpid::broker::ExternalQueueStore*>::const_iterator j = pt.orphanJournals.begin(); j != pt.orphanJournals.end(); j++)
+                tpcc->addXidRecord(*j);
 
             if (incomplTplTxnFlag) {
                 tpcc->complete(citr->second.commit_flag);
@@ -752,18 +1085,20 @@ void MessageStoreImpl::recover(qpid::broker::RecoveryManager& registry)
             // Local (1PC) transaction
             boost::shared_ptr<TxnCtxt> opcc(new TxnCtxt(xid, &messageIdSequence));
             opcc->recoverDtok(citr->second.rid, xid);
-            opcc->prepare(tplStorePtr.get());
+            opcc->prepare(tplStores[citr->second.shard].get());
 
             if (pt.enqueues.get()) {
                 for (LockedMappings::iterator j = pt.enqueues->begin(); j != pt.enqueues->end(); j++) {
-                    opcc->addXidRecord(queues[j->first]->getExternalQueueStore());
+                    opcc->addXidRecord(recordJournal(queues[j->first]->getExternalQueueStore(), j->second));
                 }
             }
             if (pt.dequeues.get()) {
                 for (LockedMappings::iterator j = pt.dequeues->begin(); j != pt.dequeues->end(); j++) {
-                    opcc->addXidRecord(queues[j->first]->getExternalQueueStore());
+                    opcc->addXidRecord(recordJournal(queues[j->first]->getExternalQueueStore(), j->second));
                 }
             }
+            for (std::set<qpid::broker::ExternalQueueStore*>::const_iterator j = pt.orphanJournals.begin(); j != pt.orphanJournals.end(); j++)
+                opcc->addXidRecord(*j);
             if (incomplTplTxnFlag) {
                 opcc->complete(citr->second.commit_flag);
             } else {
@@ -785,6 +1120,12 @@ void MessageStoreImpl::recoverQueues(TxnCtxt& txn,
 
     u_int64_t maxQueueId(1);
 
+    // Queues on the shared journals, recovered once all queues are known
+    const bool sharedFlag = sharedNumJournals > 0 || journal::jdir::exists(getSharedJrnlDir());
+    MessageStoreImpl::queue_index sharedQueues; // queue_index is hidden by the parameter of the same name
+    std::set<std::string> queueDirs; // Journal directories of all recovered queues
+    bool allQueuesRecovered = true;
+
     IdDbt key;
     Dbt value;
     //read all queues
@@ -800,11 +1141,20 @@ void MessageStoreImpl::recoverQueues(TxnCtxt& txn,
         if (queueName.size() == 0)
         {
             QPID_LOG(error, "Cannot recover empty (null) queue name - ignoring and attempting to continue.");
+            allQueuesRecovered = false;
             break;
         }
+        queueDirs.insert(getJrnlHashDir(queueName));
+        if (sharedFlag && !journal::jdir::exists(getJrnlHashDir(queueName) + "JournalData.jinf")) {
+            sharedQueues[key.id] = queue;
+            queue_index[key.id] = queue;
+            maxQueueId = std::max(key.id, maxQueueId);
+            continue;
+        }
         jQueue = new JournalImpl(timer, queueName, getJrnlHashDir(queueName), std::string("JournalData"),
                                  defJournalGetEventsTimeout, defJournalFlushTimeout, agent,
                                  boost::bind(&MessageStoreImpl::journalDeleted, this, _1));
+        setJrnlOptions(jQueue);
         {
             qpid::sys::Mutex::ScopedLock sl(journalListLock);
             journalList[queueName] = jQueue;
@@ -833,15 +1183,188 @@ void MessageStoreImpl::recoverQueues(TxnCtxt& txn,
         maxQueueId = std::max(key.id, maxQueueId);
     }
 
+    SharedQueueStore::RecordList orphans;
+    if (sharedFlag)
+        recoverSharedJournals(registry, sharedQueues, prepared, messages, orphans);
+
     // NOTE: highestRid is set by both recoverQueues() and recoverTplStore() as
     // the messageIdSequence is used for both queue journals and the tpl journal.
     messageIdSequence.reset(highestRid + 1);
     QPID_LOG(info, "Most recent persistence id found: 0x" << std::hex << highestRid << std::dec);
 
+    // Records left on the shared journals by destroyed queues
+    try {
+        for (SharedQueueStore::RecordList::iterator i = orphans.begin(); i != orphans.end(); i++)
+            dequeueRecord(i->second.journal, i->second.rid);
+    } catch (const journal::jexception& e) {
+        THROW_STORE_EXCEPTION(std::string("Shared journal: recoverQueues() failed: ") + e.what());
+    }
+    if (orphans.size())
+        QPID_LOG(notice, "Dequeued " << orphans.size() << " shared journal records of queues which no longer exist");
+
     queueIdSequence.reset(maxQueueId + 1);
+    if (allQueuesRecovered) // Otherwise the journals of queues not recovered would look like orphans
+        reapOrphanJrnlDirs(queueDirs);
 }
 
 
+void MessageStoreImpl::recoverSharedJournals(qpid::broker::RecoveryManager& registry,
+                                            queue_index& sharedQueues,
+                                            txn_list& prepared,
+                                            message_index& messages,
+                                            SharedQueueStore::RecordList& orphans)
+{
+    // Shards beyond sharedNumJournals were left by a previous run with a larger value
+    u_int16_t numShards = 0;
+    while (numShards < sharedNumJournals || journal::jdir::exists(getSharedJrnlDir(numShards)))
+        numShards++;
+    {
+        qpid::sys::Mutex::ScopedLock sl(sharedJournalLock);
+        sharedJournals.clear();
+        for (u_int16_t i = 0; i < numShards; i++)
+            sharedJournals.push_back(journal_ptr(newSharedJournal(i)));
+    }
+
+    // New msgs are written to each queue's home journal, selected as in create()
+    const u_int16_t homeShards = sharedNumJournals ? sharedNumJournals : numShards;
+    for (queue_index::iterator i = sharedQueues.begin(); i != sharedQueues.end(); i++) {
+        JournalImpl* jc = sharedJournals[bHash(i->second->getName()) % homeShards].get();
+        i->second->setExternalQueueStore(new SharedQueueStore(jc));
+    }
+
+    queue_count_map counts;
+    for (u_int16_t i = 0; i < numShards; i++)
+        recoverSharedJournal(i, registry, sharedQueues, prepared, messages, counts, orphans);
+
+    for (queue_index::iterator i = sharedQueues.begin(); i != sharedQueues.end(); i++) {
+        const std::pair<long, long>& cnt = counts[i->first];
+        QPID_LOG(info, "Recovered queue \"" << i->second->getName() << "\" (shared journal): " << cnt.first
+                 << " messages recovered; " << cnt.second << " messages in-doubt.");
+        // Initialize the home journal if it held no records
+        try {
+            sharedJournal(bHash(i->second->getName()) % homeShards);
+        } catch (const journal::jexception& e) {
+            THROW_STORE_EXCEPTION(std::string("Queue ") + i->second->getName() + ": recoverQueues() failed: " + e.what());
+        }
+    }
+}
+
+void MessageStoreImpl::recoverSharedJournal(const u_int16_t shard,
+                                           qpid::broker::RecoveryManager& recovery,
+                                           queue_index& sharedQueues,
+                                           txn_list& prepared,
+                                           message_index& messages,
+                                           queue_count_map& counts,
+                                           SharedQueueStore::RecordList& orphans)
+{
+    JournalImpl* jc = sharedJournals[shard].get();
+    if (!journal::jdir::exists(jc->jrnl_dir() + jc->base_filename() + ".jinf"))
+        return;
+
+    DataTokenImpl dtok;
+    journal::rd_buf rbuf;
+    void* dbuff = NULL; size_t dbuffSize = 0;
+    void* xidbuff = NULL; size_t xidbuffSize = 0;
+    bool transientFlag = false;
+    bool externalFlag = false;
+    bool read = true;
+    try {
+        // A queue id of 0 leaves the PreparedTransaction lists to be filled below, as each record is read
+        u_int64_t thisHighestRid = 0ULL;
+        jc->recover(numJrnlFiles, autoJrnlExpand, autoJrnlExpandMaxFiles, jrnlFsizeSblks, wCacheNumPages, wCachePgSizeSblks, &prepared, thisHighestRid, 0);
+        if (highestRid == 0ULL)
+            highestRid = thisHighestRid;
+        else if (thisHighestRid - highestRid < 0x8000000000000000ULL) // RFC 1982 comparison for unsigned 64-bit
+            highestRid = thisHighestRid;
+
+        // Records of prepared txns, by rid
+        std::map<u_int64_t, PreparedTransaction*> prepEnqs;
+        std::map<u_int64_t, PreparedTransaction*> prepDeqs;
+        journal::txn_map& tmap = jc->get_txn_map();
+        for (txn_list::iterator i = prepared.begin(); i != prepared.end(); i++) {
+            journal::txn_data_list txnList = tmap.get_tdata_list(i->xid); // txnList will be empty if xid not found
+            for (journal::tdl_itr j = txnList.begin(); j < txnList.end(); j++) {
+                if (j->_enq_flag)
+                    prepEnqs[j->_rid] = &*i;
+                else
+                    prepDeqs[j->_drid] = &*i;
+            }
+        }
+
+        dtok.set_wstate(DataTokenImpl::ENQ);
+        unsigned aio_sleep_cnt = 0;
+        while (read) {
+            mrg::journal::iores res = jc->read_data_record(&dbuff, dbuffSize, &xidbuff, xidbuffSize, transientFlag, externalFlag, &dtok, rbuf);
+            switch (res)
+            {
+              case mrg::journal::RHM_IORES_SUCCESS: {
+                const u_int64_t rid = dtok.rid();
+                if (externalFlag) {
+                    unsigned headerSize;
+                    getExternMessage(recovery, rid, headerSize); // large message external to jrnl
+                }
+                if (dtok.dsize() < SharedQueueStore::prefixSize) {
+                    std::ostringstream oss;
+                    oss << "Record 0x" << std::hex << rid << std::dec << " too short for shared journal record prefix";
+                    THROW_STORE_EXCEPTION(oss.str());
+                }
+                u_int64_t queueId;
+                u_int64_t messageId;
+                SharedQueueStore::decodePrefix(static_cast<char*>(dbuff), queueId, messageId);
+
+                queue_index::iterator qi = sharedQueues.find(queueId);
+                if (qi == sharedQueues.end()) {
+                    // Queue destroyed before all its records were dequeued. The record is dequeued once recovery is
+                    // complete, unless it is part of a txn, which is left to end as it would have. A prepared txn
+                    // must then still be completed on this journal, though the record is in neither of its lists.
+                    if (jc->is_enqueued(rid)) { // false if locked
+                        orphans.push_back(SharedQueueStore::RecordListEntry(messageId, SharedQueueStore::RecordRef(jc, rid)));
+                    } else {
+                        std::map<u_int64_t, PreparedTransaction*>::iterator pi = prepEnqs.find(rid);
+                        if (pi != prepEnqs.end()) pi->second->orphanJournals.insert(jc);
+                        pi = prepDeqs.find(rid);
+                        if (pi != prepDeqs.end()) pi->second->orphanJournals.insert(jc);
+                    }
+                } else {
+                    std::map<u_int64_t, PreparedTransaction*>::iterator pi = prepEnqs.find(rid);
+                    if (pi != prepEnqs.end()) pi->second->enqueues->add(queueId, messageId);
+                    pi = prepDeqs.find(rid);
+                    if (pi != prepDeqs.end()) pi->second->dequeues->add(queueId, messageId);
+
+                    SharedQueueStore* sqs = static_cast<SharedQueueStore*>(qi->second->getExternalQueueStore());
+                    sqs->addRecord(messageId, jc, rid);
+                    qpid::broker::RecoverableMessage::shared_ptr msg = decodeMessage(recovery,
+                            static_cast<char*>(dbuff) + SharedQueueStore::prefixSize,
+                            dtok.dsize() - SharedQueueStore::prefixSize, false, messageId);
+                    std::pair<long, long>& cnt = counts[queueId];
+                    recoverMessage(qi->second, msg, messageId, jc, rid, prepared, messages, cnt.first, cnt.second);
+                }
+
+                dtok.reset();
+                dtok.set_wstate(DataTokenImpl::ENQ);
+                aio_sleep_cnt = 0;
+                break;
+              }
+              case mrg::journal::RHM_IORES_PAGE_AIOWAIT:
+                if (++aio_sleep_cnt > MAX_AIO_SLEEPS)
+                    THROW_STORE_EXCEPTION("Timeout waiting for AIO in MessageStoreImpl::recoverSharedJournal()");
+                ::usleep(AIO_SLEEP_TIME_US);
+                break;
+              case mrg::journal::RHM_IORES_EMPTY:
+                read = false;
+                break;
+              default:
+                std::ostringstream oss;
+                oss << "recoverSharedJournal(): Journal " << jc->id() << ": Unexpected return from journal read: " << mrg::journal::iores_str(res);
+                THROW_STORE_EXCEPTION(oss.str());
+            } // switch
+        } // while
+        jc->recover_complete(); // start journal.
+    } catch (const journal::jexception& e) {
+        THROW_STORE_EXCEPTION(std::string("Journal ") + jc->id() + ": recoverSharedJournal() failed: " + e.what());
+    }
+}
+
 void MessageStoreImpl::recoverExchanges(TxnCtxt& txn,
                                        qpid::broker::RecoveryManager& registry,
                                        exchange_index& index)
@@ -932,8 +1455,6 @@ void MessageStoreImpl::recoverMessages(TxnCtxt& /*txn*/,
                                       long& rcnt,
                                       long& idcnt)
 {
-    size_t preambleLength = sizeof(u_int32_t)/*header size*/;
-
     JournalImpl* jc = static_cast<JournalImpl*>(queue->getExternalQueueStore());
     DataTokenImpl dtok;
     size_t readSize = 0;
@@ -945,6 +1466,8 @@ void MessageStoreImpl::recoverMessages(TxnCtxt& /*txn*/,
     //bool read = jc->get_enq_cnt() > 0;
     bool read = true;
 
+    // Records are read into rbuf, which is reused for each record rather than allocated and freed each time
+    journal::rd_buf rbuf;
     void* dbuff = NULL; size_t dbuffSize = 0;
     void* xidbuff = NULL; size_t xidbuffSize = 0;
     bool transientFlag = false;
@@ -956,85 +1479,19 @@ void MessageStoreImpl::recoverMessages(TxnCtxt& /*txn*/,
     try {
         unsigned aio_sleep_cnt = 0;
         while (read) {
-            mrg::journal::iores res = jc->read_data_record(&dbuff, dbuffSize, &xidbuff, xidbuffSize, transientFlag, externalFlag, &dtok);
+            mrg::journal::iores res = jc->read_data_record(&dbuff, dbuffSize, &xidbuff, xidbuffSize, transientFlag, externalFlag, &dtok, rbuf);
             readSize = dtok.dsize();
 
             switch (res)
             {
               case mrg::journal::RHM_IORES_SUCCESS: {
                 msg_count++;
-                qpid::broker::RecoverableMessage::shared_ptr msg;
-                char* data = (char*)dbuff;
-
-                unsigned headerSize;
-                if (externalFlag) {
-                    msg = getExternMessage(recovery, dtok.rid(), headerSize); // large message external to jrnl
-                } else {
-                    headerSize = qpid::framing::Buffer(data, preambleLength).getLong();
-                    qpid::framing::Buffer headerBuff(data+ preambleLength, headerSize); /// do we want read size or header size ????
-                    msg = recovery.recoverMessage(headerBuff);
-                }
-                msg->setPersistenceId(dtok.rid());
-                // At some future point if delivery attempts are stored, then this call would
-                // become optional depending on that information.
-                msg->setRedelivered();
-
-                u_int32_t contentOffset = headerSize + preambleLength;
-                u_int64_t contentSize = readSize - contentOffset;
-                if (msg->loadContent(contentSize) && !externalFlag) {
-                    //now read the content
-                    qpid::framing::Buffer contentBuff(data + contentOffset, contentSize);
-                    msg->decodeContent(contentBuff);
-                }
-
-                PreparedTransaction::list::iterator i = PreparedTransaction::getLockedPreparedTransaction(prepared, queue->getPersistenceId(), dtok.rid());
-                if (i == prepared.end()) { // not in prepared list
-                    rcnt++;
-                    queue->recover(msg);
-                } else {
-                    u_int64_t rid = dtok.rid();
-                    std::string xid(i->xid);
-                    TplRecoverMapCitr citr = tplRecoverMap.find(xid);
-                    if (citr == tplRecoverMap.end()) THROW_STORE_EXCEPTION("XID not found in tplRecoverMap");
-
-                    // deq present in prepared list: this xid is part of incomplete txn commit/abort
-                    // or this is a 1PC txn that must be rolled forward
-                    if (citr->second.deq_flag || !citr->second.tpc_flag) {
-                        if (jc->is_enqueued(rid, true)) {
-                            // Enqueue is non-tx, dequeue tx
-                            assert(jc->is_locked(rid)); // This record MUST be locked by a txn dequeue
-                            if (!citr->second.commit_flag) {
-                                rcnt++;
-                                queue->recover(msg); // recover message in abort case only
-                            }
-                        } else {
-                            // Enqueue and/or dequeue tx
-                            journal::txn_map& tmap = jc->get_txn_map();
-                            journal::txn_data_list txnList = tmap.get_tdata_list(xid); // txnList will be empty if xid not found
-                            bool enq = false;
-                            bool deq = false;
-                            for (journal::tdl_itr j = txnList.begin(); j<txnList.end(); j++) {
-                                if (j->_enq_flag && j->_rid == rid) enq = true;
-                                else if (!j->_enq_flag && j->_drid == rid) deq = true;
-                            }
-                            if (enq && !deq && citr->second.commit_flag) {
-                                rcnt++;
-                                queue->recover(msg); // recover txn message in commit case only
-                            }
-                        }
-                    } else {
-                        idcnt++;
-                        messages[rid] = msg;
-                    }
-                }
+                qpid::broker::RecoverableMessage::shared_ptr msg = decodeMessage(recovery, (char*)dbuff, readSize,
+                                                                                 externalFlag, dtok.rid());
+                recoverMessage(queue, msg, dtok.rid(), jc, dtok.rid(), prepared, messages, rcnt, idcnt);
 
                 dtok.reset();
                 dtok.set_wstate(DataTokenImpl::ENQ);
-
-                if (xidbuff)
-                    ::free(xidbuff);
-                else if (dbuff)
-                    ::free(dbuff);
                 aio_sleep_cnt = 0;
                 break;
               }
@@ -1057,6 +1514,91 @@ void MessageStoreImpl::recoverMessages(TxnCtxt& /*txn*/,
     }
 }
 
+qpid::broker::RecoverableMessage::shared_ptr MessageStoreImpl::decodeMessage(qpid::broker::RecoveryManager& recovery,
+                                                                             char* data,
+                                                                             size_t readSize,
+                                                                             bool externalFlag,
+                                                                             u_int64_t messageId)
+{
+    size_t preambleLength = sizeof(u_int32_t)/*header size*/;
+    qpid::broker::RecoverableMessage::shared_ptr msg;
+
+    unsigned headerSize;
+    if (externalFlag) {
+        msg = getExternMessage(recovery, messageId, headerSize); // large message external to jrnl
+    } else {
+        headerSize = qpid::framing::Buffer(data, preambleLength).getLong();
+        qpid::framing::Buffer headerBuff(data+ preambleLength, headerSize); /// do we want read size or header size ????
+        msg = recovery.recoverMessage(headerBuff);
+    }
+    msg->setPersistenceId(messageId);
+    // At some future point if delivery attempts are stored, then this call would
+    // become optional depending on that information.
+    msg->setRedelivered();
+
+    u_int32_t contentOffset = headerSize + preambleLength;
+    u_int64_t contentSize = readSize - contentOffset;
+    if (msg->loadContent(contentSize) && !externalFlag) {
+        //now read the content
+        qpid::framing::Buffer contentBuff(data + contentOffset, contentSize);
+        msg->decodeContent(contentBuff);
+    }
+    return msg;
+}
+
+// Recover msg messageId, read from record rid of journal jc, onto queue, or hold it for its prepared txn. The rid
+// is the messageId, except on a shared journal.
+void MessageStoreImpl::recoverMessage(qpid::broker::RecoverableQueue::shared_ptr& queue,
+                                      qpid::broker::RecoverableMessage::shared_ptr& msg,
+                                      u_int64_t messageId,
+                                      JournalImpl* jc,
+                                      u_int64_t rid,
+                                      txn_list& prepared,
+                                      message_index& messages,
+                                      long& rcnt,
+                                      long& idcnt)
+{
+    PreparedTransaction::list::iterator i = PreparedTransaction::getLockedPreparedTransaction(prepared, queue->getPersistenceId(), messageId);
+    if (i == prepared.end()) { // not in prepared list
+        rcnt++;
+        queue->recover(msg);
+    } else {
+        std::string xid(i->xid);
+        TplRecoverMapCitr citr = tplRecoverMap.find(xid);
+        if (citr == tplRecoverMap.end()) THROW_STORE_EXCEPTION("XID not found in tplRecoverMap");
+
+        // deq present in prepared list: this xid is part of incomplete txn commit/abort
+        // or this is a 1PC txn that must be rolled forward
+        if (citr->second.deq_flag || !citr->second.tpc_flag) {
+            if (jc->is_enqueued(rid, true)) {
+                // Enqueue is non-tx, dequeue tx
+                assert(jc->is_locked(rid)); // This record MUST be locked by a txn dequeue
+                if (!citr->second.commit_flag) {
+                    rcnt++;
+                    queue->recover(msg); // recover message in abort case only
+                }
+            } else {
+                // Enqueue and/or dequeue tx
+                journal::txn_map& tmap = jc->get_txn_map();
+                journal::txn_data_list txnList = tmap.get_tdata_list(xid); // txnList will be empty if xid not found
+                bool enq = false;
+                bool deq = false;
+                for (journal::tdl_itr j = txnList.begin(); j<txnList.end(); j++) {
+                    if (j->_enq_flag && j->_rid == rid) enq = true;
+                    else if (!j->_enq_flag && j->_drid == rid) deq = true;
+                }
+                if (enq && !deq && citr->second.commit_flag) {
+                    rcnt++;
+                    queue->recover(msg); // recover txn message in commit case only
+                }
+            }
+        } else {
+            idcnt++;
+            messages[messageId] = msg;
+        }
+    }
+}
+
 qpid::broker::RecoverableMessage::shared_ptr MessageStoreImpl::getExternMessage(qpid::broker::RecoveryManager& /*recovery*/,
                                                                  uint64_t /*messageId*/,
                                                                  unsigned& /*headerSize*/)
@@ -1097,9 +1639,24 @@ int MessageStoreImpl::enqueueMessage(TxnCtxt& txn,
 
 void MessageStoreImpl::readTplStore()
 {
+    // Re-read all shards, recovering any which have not yet been recovered
     tplRecoverMap.clear();
-    journal::txn_map& tmap = tplStorePtr->get_txn_map();
+    for (u_int16_t i = 0; i < tplStores.size(); i++) {
+        if (tplStores[i]->is_ready()) {
+            tplStores[i]->read_reset();
+            readTplShard(i);
+        } else {
+            recoverTplShard(i);
+        }
+    }
+}
+
+void MessageStoreImpl::readTplShard(const u_int16_t shard)
+{
+    TplJournalImpl* tpl = tplStores[shard].get();
+    journal::txn_map& tmap = tpl->get_txn_map();
     DataTokenImpl dtok;
+    journal::rd_buf rbuf;
     void* dbuff = NULL; size_t dbuffSize = 0;
     void* xidbuff = NULL; size_t xidbuffSize = 0;
     bool transientFlag = false;
@@ -1110,7 +1667,7 @@ void MessageStoreImpl::readTplStore()
         while (!done) {
             dtok.reset();
             dtok.set_wstate(DataTokenImpl::ENQ);
-            mrg::journal::iores res = tplStorePtr->read_data_record(&dbuff, dbuffSize, &xidbuff, xidbuffSize, transientFlag, externalFlag, &dtok);
+            mrg::journal::iores res = tpl->read_data_record(&dbuff, dbuffSize, &xidbuff, xidbuffSize, transientFlag, externalFlag, &dtok, rbuf);
             switch (res) {
               case mrg::journal::RHM_IORES_SUCCESS: {
                 // Every TPL record contains both data and an XID
@@ -1141,10 +1698,8 @@ void MessageStoreImpl::readTplStore()
                     }
                     assert(enqCnt == 1);
                     assert(deqCnt <= 1);
-                    tplRecoverMap.insert(TplRecoverMapPair(xid, TplRecoverStruct(rid, deqCnt == 1, commitFlag, is2PC)));
+                    tplRecoverMap.insert(TplRecoverMapPair(xid, TplRecoverStruct(rid, deqCnt == 1, commitFlag, is2PC, shard)));
                 }
-
-                ::free(xidbuff);
                 aio_sleep_cnt = 0;
                 break;
                 }
@@ -1169,25 +1724,33 @@ void MessageStoreImpl::readTplStore()
 
 void MessageStoreImpl::recoverTplStore()
 {
-    if (journal::jdir::exists(tplStorePtr->jrnl_dir() + tplStorePtr->base_filename() + ".jinf")) {
+    for (u_int16_t i = 0; i < tplStores.size(); i++) {
+        if (!tplStores[i]->is_ready())
+            recoverTplShard(i);
+    }
+}
+
+void MessageStoreImpl::recoverTplShard(const u_int16_t shard)
+{
+    TplJournalImpl* tpl = tplStores[shard].get();
+    if (journal::jdir::exists(tpl->jrnl_dir() + tpl->base_filename() + ".jinf")) {
         u_int64_t thisHighestRid = 0ULL;
-        tplStorePtr->recover(tplNumJrnlFiles, false, 0, tplJrnlFsizeSblks, tplWCachePgSizeSblks, tplWCacheNumPages, 0, thisHighestRid, 0);
+        tpl->recover(tplNumJrnlFiles, false, 0, tplJrnlFsizeSblks, tplWCachePgSizeSblks, tplWCacheNumPages, 0, thisHighestRid, 0);
         if (highestRid == 0ULL)
             highestRid = thisHighestRid;
         else if (thisHighestRid - highestRid  < 0x8000000000000000ULL) // RFC 1982 comparison for unsigned 64-bit
             highestRid = thisHighestRid;
 
         // Load tplRecoverMap by reading the TPL store
-        readTplStore();
+        readTplShard(shard);
 
-        tplStorePtr->recover_complete(); // start journal.
+        tpl->recover_complete(); // start journal.
     }
 }
 
 void MessageStoreImpl::recoverLockedMappings(txn_list& txns)
 {
-    if (!tplStorePtr->is_ready())
-        recoverTplStore();
+    recoverTplStore();
 
     // Abort unprepared xids and populate the locked maps
     for (TplRecoverMapCitr i = tplRecoverMap.begin(); i != tplRecoverMap.end(); i++) {
@@ -1201,12 +1764,7 @@ void MessageStoreImpl::recoverLockedMappings(txn_list& txns)
 
 void MessageStoreImpl::collectPreparedXids(std::set<std::string>& xids)
 {
-    if (tplStorePtr->is_ready()) {
-        tplStorePtr->read_reset();
-        readTplStore();
-    } else {
-        recoverTplStore();
-    }
+    readTplStore();
     for (TplRecoverMapCitr i = tplRecoverMap.begin(); i != tplRecoverMap.end(); i++) {
         // Discard all txns that are to be rolled forward/back and 1PC transactions
         if (!i->second.deq_flag && i->second.tpc_flag)
@@ -1242,8 +1800,15 @@ void MessageStoreImpl::loadContent(const qpid::broker::PersistableQueue& queue,
     if (messageId != 0) {
         try {
             JournalImpl* jc = static_cast<JournalImpl*>(queue.getExternalQueueStore());
-            if (jc && jc->is_enqueued(messageId) ) {
-                if (!jc->loadMsgContent(messageId, data, length, offset)) {
+            u_int64_t rid = messageId;
+            SharedQueueStore* sqs = dynamic_cast<SharedQueueStore*>(queue.getExternalQueueStore());
+            if (sqs) {
+                SharedQueueStore::RecordRef ref;
+                jc = sqs->findRecord(messageId, ref) ? ref.journal : 0;
+                rid = ref.rid;
+            }
+            if (jc && jc->is_enqueued(rid) ) {
+                if (!jc->loadMsgContent(rid, data, length, offset)) {
                     std::ostringstream oss;
                     oss << "Queue " << queue.getName() << ": loadContent() failed: Message " << messageId << " is extern";
                     THROW_STORE_EXCEPTION(oss.str());
@@ -1267,8 +1832,15 @@ void MessageStoreImpl::flush(const qpid::broker::PersistableQueue& queue)
     checkInit();
     std::string qn = queue.getName();
     try {
-        JournalImpl* jc = static_cast<JournalImpl*>(queue.getExternalQueueStore());
-        if (jc) {
+        SharedQueueStore* sqs = dynamic_cast<SharedQueueStore*>(queue.getExternalQueueStore());
+        if (sqs) {
+            // Records of the queue may be in any of the shared journals
+            std::set<JournalImpl*> journals;
+            sqs->journalList(journals);
+            for (std::set<JournalImpl*>::iterator i = journals.begin(); i != journals.end(); i++)
+                (*i)->flush();
+        } else {
+            JournalImpl* jc = static_cast<JournalImpl*>(queue.getExternalQueueStore());
             // TODO: check if this result should be used...
             /*mrg::journal::iores res =*/ jc->flush();
         }
@@ -1305,20 +1877,23 @@ void MessageStoreImpl::enqueue(qpid::broker::TransactionContext* ctxt,
     store(&queue, txn, msg, newId);
 
     // add queue* to the txn map..
-    if (ctxt) txn->addXidRecord(queue.getExternalQueueStore());
+    if (ctxt) txn->addXidRecord(recordJournal(queue.getExternalQueueStore(), messageId));
 }
 
-u_int64_t MessageStoreImpl::msgEncode(std::vector<char>& buff, const boost::intrusive_ptr<qpid::broker::PersistableMessage>& message)
+// The message is encoded after prefixSize bytes, which are left for the caller to fill
+u_int64_t MessageStoreImpl::msgEncode(std::vector<char>& buff,
+                                      const boost::intrusive_ptr<qpid::broker::PersistableMessage>& message,
+                                      const std::size_t prefixSize)
 {
     u_int32_t headerSize = message->encodedHeaderSize();
-    u_int64_t size = message->encodedSize() + sizeof(u_int32_t);
+    u_int64_t size = prefixSize + message->encodedSize() + sizeof(u_int32_t);
     try { buff = std::vector<char>(size); } // long + headers + content
     catch (const std::exception& e) {
         std::ostringstream oss;
         oss << "Unable to allocate memory for encoding message; requested size: " << size << "; error: " << e.what();
         THROW_STORE_EXCEPTION(oss.str());
     }
-    qpid::framing::Buffer buffer(&buff[0],size);
+    qpid::framing::Buffer buffer(&buff[prefixSize], size - prefixSize);
     buffer.putLong(headerSize);
     message->encode(buffer);
     return size;
@@ -1330,7 +1905,8 @@ void MessageStoreImpl::store(const qpid::broker::PersistableQueue* queue,
                             bool /*newId*/)
 {
     std::vector<char> buff;
-    u_int64_t size = msgEncode(buff, message);
+    SharedQueueStore* sqs = queue ? dynamic_cast<SharedQueueStore*>(queue->getExternalQueueStore()) : 0;
+    u_int64_t size = msgEncode(buff, message, sqs ? SharedQueueStore::prefixSize : 0);
 
     try {
         if (queue) {
@@ -1338,9 +1914,20 @@ void MessageStoreImpl::store(const qpid::broker::PersistableQueue* queue,
             dtokp->addRef();
             dtokp->setSourceMessage(message);
             dtokp->set_external_rid(true);
-            dtokp->set_rid(message->getPersistenceId()); // set the messageID into the Journal header (record-id)
 
-            JournalImpl* jc = static_cast<JournalImpl*>(queue->getExternalQueueStore());
+            JournalImpl* jc;
+            u_int64_t rid;
+            if (sqs) {
+                // A msg may be on several queues sharing a journal, so each record has its own rid, and carries the
+                // queue and msg ids ahead of the encoded msg
+                jc = sqs->journal();
+                rid = messageIdSequence.next();
+                SharedQueueStore::encodePrefix(&buff[0], queue->getPersistenceId(), message->getPersistenceId());
+            } else {
+                jc = static_cast<JournalImpl*>(queue->getExternalQueueStore());
+                rid = message->getPersistenceId();
+            }
+            dtokp->set_rid(rid); // set the messageID into the Journal header (record-id)
             if (txn->getXid().empty()) {
                 if (message->isContentReleased()) {
                     jc->enqueue_extern_data_record(size, dtokp.get(), !message->isPersistent());
@@ -1349,11 +1936,12 @@ void MessageStoreImpl::store(const qpid::broker::PersistableQueue* queue,
                 }
             } else {
                 if (message->isContentReleased()) {
-                    jc->enqueue_extern_txn_data_record(size, dtokp.get(), txn->getXid(), !message->isPersistent());
+                    jc->enqueue_extern_txn_data_record(size, dtokp.get(), txn->getXidHandle(), !message->isPersistent());
                 } else {
-                    jc->enqueue_txn_data_record(&buff[0], size, size, dtokp.get(), txn->getXid(), !message->isPersistent());
+                    jc->enqueue_txn_data_record(&buff[0], size, size, dtokp.get(), txn->getXidHandle(), !message->isPersistent());
                 }
             }
+            if (sqs) sqs->addRecord(message->getPersistenceId(), jc, rid);
         } else {
             THROW_STORE_EXCEPTION(std::string("MessageStoreImpl::store() failed: queue NULL."));
        }
@@ -1386,7 +1974,7 @@ void MessageStoreImpl::dequeue(qpid::broker::TransactionContext* ctxt,
     }
 
     // add queue* to the txn map..
-    if (ctxt) txn->addXidRecord(queue.getExternalQueueStore());
+    if (ctxt) txn->addXidRecord(recordJournal(queue.getExternalQueueStore(), messageId));
     async_dequeue(ctxt, msg, queue);
 
     msg->dequeueComplete();
@@ -1396,23 +1984,37 @@ void MessageStoreImpl::async_dequeue(qpid::broker::TransactionContext* ctxt,
                                     const boost::intrusive_ptr<qpid::broker::PersistableMessage>& msg,
                                     const qpid::broker::PersistableQueue& queue)
 {
+    JournalImpl* jc = static_cast<JournalImpl*>(queue.getExternalQueueStore());
+    u_int64_t drid = msg->getPersistenceId();
+    SharedQueueStore* sqs = dynamic_cast<SharedQueueStore*>(queue.getExternalQueueStore());
+    if (sqs) {
+        SharedQueueStore::RecordRef ref;
+        if (!sqs->findRecord(drid, ref)) {
+            std::ostringstream oss;
+            oss << "Queue " << queue.getName() << ": async_dequeue() failed: Message " << drid << " not enqueued";
+            THROW_STORE_EXCEPTION(oss.str());
+        }
+        jc = ref.journal;
+        drid = ref.rid;
+    }
+
     boost::intrusive_ptr<DataTokenImpl> ddtokp(new DataTokenImpl);
     ddtokp->setSourceMessage(msg);
     ddtokp->set_external_rid(true);
     ddtokp->set_rid(messageIdSequence.next());
-    ddtokp->set_dequeue_rid(msg->getPersistenceId());
+    ddtokp->set_dequeue_rid(drid);
     ddtokp->set_wstate(DataTokenImpl::ENQ);
-    std::string tid;
+    journal::xid_handle tid;
     if (ctxt) {
         TxnCtxt* txn = check(ctxt);
-        tid = txn->getXid();
+        tid = txn->getXidHandle();
     }
     // Manually increase the ref count, as raw pointers are used beyond this point
     ddtokp->addRef();
     try {
-        JournalImpl* jc = static_cast<JournalImpl*>(queue.getExternalQueueStore());
         if (tid.empty()) {
             jc->dequeue_data_record(ddtokp.get());
+            if (sqs) sqs->removeRecord(msg->getPersistenceId());
         } else {
             jc->dequeue_txn_data_record(ddtokp.get(), tid);
         }
@@ -1440,7 +2042,10 @@ void MessageStoreImpl::completed(TxnCtxt& txn,
             DataTokenImpl* dtokp = txn.getDtok();
             dtokp->set_dequeue_rid(dtokp->rid());
             dtokp->set_rid(messageIdSequence.next());
-            tplStorePtr->dequeue_txn_data_record(txn.getDtok(), txn.getXid(), commit);
+            // Complete on the shard on which the txn was prepared (or recovered)
+            TplJournalImpl* tpl = txn.getPreparedXidStore();
+            if (!tpl) tpl = tplStore(txn.getXid());
+            tpl->dequeue_txn_data_record(txn.getDtok(), txn.getXidHandle(), commit);
         }
         txn.complete(commit);
         if (mgmtObject != 0) {
@@ -1493,8 +2098,9 @@ void MessageStoreImpl::localPrepare(TxnCtxt* ctxt)
         dtokp->set_external_rid(true);
         dtokp->set_rid(messageIdSequence.next());
         char tpcFlag = static_cast<char>(ctxt->isTPC());
-        tplStorePtr->enqueue_txn_data_record(&tpcFlag, sizeof(char), sizeof(char), dtokp, ctxt->getXid(), false);
-        ctxt->prepare(tplStorePtr.get());
+        TplJournalImpl* tpl = tplStore(ctxt->getXid());
+        tpl->enqueue_txn_data_record(&tpcFlag, sizeof(char), sizeof(char), dtokp, ctxt->getXidHandle(), false);
+        ctxt->prepare(tpl);
         // make sure all the data is written to disk before returning
         ctxt->sync();
         if (mgmtObject != 0) {
@@ -1513,6 +2119,11 @@ void MessageStoreImpl::commit(qpid::broker::TransactionContext& ctxt)
     TxnCtxt* txn(check(&ctxt));
     if (!txn->isTPC()) {
         if (txn->impactedQueuesEmpty()) return;
+        if (txn->impactedQueuesSingle()) {
+            // The journal's own commit record makes a single-queue txn atomic; the TPL is not needed
+            txn->complete(true);
+            return;
+        }
         localPrepare(dynamic_cast<TxnCtxt*>(txn));
     }
     completed(*dynamic_cast<TxnCtxt*>(txn), true);
@@ -1524,6 +2135,10 @@ void MessageStoreImpl::abort(qpid::broker::TransactionContext& ctxt)
     TxnCtxt* txn(check(&ctxt));
     if (!txn->isTPC()) {
         if (txn->impactedQueuesEmpty()) return;
+        if (txn->impactedQueuesSingle()) {
+            txn->complete(false);
+            return;
+        }
         localPrepare(dynamic_cast<TxnCtxt*>(txn));
     }
     completed(*dynamic_cast<TxnCtxt*>(txn), false);
@@ -1643,13 +2258,129 @@ std::string MessageStoreImpl::getBdbBaseDir()
     return dir.str();
 }
 
-std::string MessageStoreImpl::getTplBaseDir()
+std::string MessageStoreImpl::getTplBaseDir(const u_int16_t shard)
+{
+    std::ostringstream dir;
+    dir << storeDir << "/" << storeTopLevelDir << "/tpl";
+    if (shard) dir << "-" << shard;
+    dir << "/";
+    return dir.str();
+}
+
+std::string MessageStoreImpl::getSharedJrnlDir(const u_int16_t shard)
 {
     std::ostringstream dir;
-    dir << storeDir << "/" << storeTopLevelDir << "/tpl/" ;
+    dir << storeDir << "/" << storeTopLevelDir << "/shared";
+    if (shard) dir << "-" << shard;
+    dir << "/";
     return dir.str();
 }
 
+std::string MessageStoreImpl::getDelBaseDir()
+{
+    std::ostringstream dir;
+    dir << storeDir << "/" << storeTopLevelDir << "/del/" ;
+    return dir.str();
+}
+
+void MessageStoreImpl::reapJrnlDir(const std::string& jrnlDir)
+{
+    qpid::sys::Mutex::ScopedLock sl(reaperLock);
+    std::string tombstone;
+    try {
+        journal::jdir::create_dir(getDelBaseDir());
+        tombstone = journal::jdir::create_bak_dir(getDelBaseDir(), "jrnl");
+        std::string tombstoneJrnlDir(tombstone + "/jrnl");
+        if (::rename(jrnlDir.c_str(), tombstoneJrnlDir.c_str())) {
+            if (errno != ENOENT) { // ENOENT: journal was never initialized, nothing to reap
+                std::ostringstream oss;
+                oss << "Unable to move journal directory \"" << jrnlDir << "\" to \"" << tombstoneJrnlDir << "\"" << FORMAT_SYSERR(errno);
+                THROW_STORE_EXCEPTION(oss.str());
+            }
+        }
+    } catch (const journal::jexception& e) {
+        THROW_STORE_EXCEPTION(std::string("Unable to tombstone journal directory ") + jrnlDir + ": " + e.what());
+    }
+    if (!reaperTimerPtr.get()) {
+        reaperTimerPtr.reset(new qpid::sys::Timer);
+        reaperTimerPtr->start();
+    }
+    reaperTimerPtr->add(new JournalReaperEvent(tombstone));
+}
+
+void MessageStoreImpl::reapTombstones()
+{
+    const std::string delBaseDir(getDelBaseDir());
+    DIR* dir = ::opendir(delBaseDir.c_str());
+    if (!dir) return; // No tombstones
+    std::vector<std::string> tombstones;
+    struct dirent* entry;
+    while ((entry = ::readdir(dir)) != 0) {
+        if (std::strcmp(entry->d_name, ".") != 0 && std::strcmp(entry->d_name, "..") != 0)
+            tombstones.push_back(delBaseDir + entry->d_name);
+    }
+    ::closedir(dir);
+    if (tombstones.empty()) return;
+
+    QPID_LOG(notice, "Found " << tombstones.size() << " journal tombstone(s) in " << delBaseDir << "; deleting in background.");
+    qpid::sys::Mutex::ScopedLock sl(reaperLock);
+    if (!reaperTimerPtr.get()) {
+        reaperTimerPtr.reset(new qpid::sys::Timer);
+        reaperTimerPtr->start();
+    }
+    for (std::vector<std::string>::const_iterator i = tombstones.begin(); i != tombstones.end(); i++)
+        reaperTimerPtr->add(new JournalReaperEvent(*i));
+}
+
+void MessageStoreImpl::reapOrphanJrnlDirs(const std::set<std::string>& queueDirs)
+{
+    // A crash after a queue was deleted from the BDB, but before its journal directory was moved or deleted, leaves
+    // a journal directory which belongs to no queue
+    const std::string jrnlBaseDir(getJrnlBaseDir());
+    DIR* baseDir = ::opendir(jrnlBaseDir.c_str());
+    if (!baseDir) return; // No journals
+    std::vector<std::string> orphans;
+    struct dirent* hashEntry;
+    while ((hashEntry = ::readdir(baseDir)) != 0) {
+        if (std::strcmp(hashEntry->d_name, ".") == 0 || std::strcmp(hashEntry->d_name, "..") == 0)
+            continue;
+        const std::string hashDir(jrnlBaseDir + hashEntry->d_name + "/");
+        DIR* dir = ::opendir(hashDir.c_str());
+        if (!dir) continue;
+        struct dirent* entry;
+        while ((entry = ::readdir(dir)) != 0) {
+            if (std::strcmp(entry->d_name, ".") == 0 || std::strcmp(entry->d_name, "..") == 0)
+                continue;
+            // A queue name may contain '/', so a directory is only an orphan if no queue's directory lies within it
+            const std::string jrnlDir(hashDir + entry->d_name + "/");
+            std::set<std::string>::const_iterator i = queueDirs.lower_bound(jrnlDir);
+            if (i == queueDirs.end() || i->compare(0, jrnlDir.size(), jrnlDir) != 0)
+                orphans.push_back(jrnlDir);
+        }
+        ::closedir(dir);
+    }
+    ::closedir(baseDir);
+
+    for (std::vector<std::string>::const_iterator i = orphans.begin(); i != orphans.end(); i++) {
+        QPID_LOG(notice, "Journal directory " << *i << " belongs to no queue; deleting in background.");
+        try {
+            reapJrnlDir(*i);
+        } catch (const StoreException& e) {
+            QPID_LOG(warning, e.what());
+        }
+    }
+}
+
+void MessageStoreImpl::stopReaper()
+{
+    // Outstanding tombstones are left on disk and are reaped at the next store initialization
+    qpid::sys::Mutex::ScopedLock sl(reaperLock);
+    if (reaperTimerPtr.get()) {
+        reaperTimerPtr->stop();
+        reaperTimerPtr.reset();
+    }
+}
+
 std::string MessageStoreImpl::getJrnlDir(const qpid::broker::PersistableQueue& queue) //for exmaple /var/rhm/ + queueDir/
 {
     return getJrnlHashDir(queue.getName().c_str());
@@ -1690,7 +2421,25 @@ MessageStoreImpl::StoreOptions::StoreOptions(const std::string& name) :
                                              wCachePageSizeKib(defWCachePageSize),
                                              tplNumJrnlFiles(defTplNumJrnlFiles),
                                              tplJrnlFsizePgs(defTplJrnlFileSizePgs),
-                                             tplWCachePageSizeKib(defTplWCachePageSize)
+                                             tplWCachePageSizeKib(defTplWCachePageSize),
+                                             asyncQueueDestroy(defAsyncQueueDestroy),
+                                             compressThreshold(defCompressThreshold),
+                                             packRecords(defPackRecords),
+                                             dequeueBatchSize(defDequeueBatchSize),
+                                             writeCombining(defWriteCombining),
+                                             idLeaseSize(defIdLeaseSize),
+                                             tplNumShards(defTplNumShards),
+                                             wCacheMinPages(defWCacheMinPages),
+                                             wCacheMaxPages(defWCacheMaxPages),
+                                             rCachePageSizeKib(defRCachePageSize),
+                                             rCacheNumPages(defRCacheNumPages),
+                                             rCacheIdleTimeout(defRCacheIdleTimeout),
+                                             hugePages(defHugePages),
+                                             numaLocalCaches(defNumaLocalCaches),
+                                             readCursors(defReadCursors),
+                                             contentCacheSizeKib(defContentCacheSize),
+                                             mmapReads(defMmapReads),
+                                             sharedJournals(defSharedJournals)
 {
     std::ostringstream oss1;
     oss1 << "Default number of files for each journal instance (queue). [Allowable values: " <<
@@ -1729,6 +2478,77 @@ MessageStoreImpl::StoreOptions::StoreOptions(const std::string& name) :
                 "Size of the pages in the transaction prepared list write page cache in KiB. "
                 "Allowable values - powers of 2: 1, 2, 4, ... , 128. "
                 "Lower values decrease latency at the expense of throughput.")
+        ("async-queue-destroy", qpid::optValue(asyncQueueDestroy, "yes|no"),
+                "If yes|true|1, a destroyed queue's journal directory is renamed and its files are deleted in the "
+                "background. If no|false|0, journal files are deleted before the queue destroy returns.")
+        ("compress-threshold", qpid::optValue(compressThreshold, "N"),
+                "Compress (LZF) message content of N bytes or more when writing it to the journal, provided this "
+                "saves journal space. 0 disables compression. Compressed messages remain readable if this is later "
+                "changed or disabled.")
+        ("pack-records", qpid::optValue(packRecords, "yes|no"),
+                "If yes|true|1, small non-transactional records (dequeues and small messages) are packed several to "
+                "a journal data block, reducing the number of bytes written for small messages. Journals written "
+                "this way can be recovered regardless of this setting.")
+        ("dequeue-batch-size", qpid::optValue(dequeueBatchSize, "N"),
+                "Write up to N non-transactional dequeues from the same queue as a single journal record. Pending "
+                "dequeues are written when N is reached or when the journal is flushed. Dequeues of the oldest "
+                "messages on a queue (in-order consumption, purge) are written as a single range record. 0 or 1 "
+                "writes each dequeue as it occurs.")
+        ("write-combining", qpid::optValue(writeCombining, "yes|no"),
+                "If yes|true|1, concurrent writes to the same queue's journal are queued in a lock-free ring and "
+                "written in a single pass by whichever thread holds the journal write lock, rather than each "
+                "thread taking the lock in turn. Improves throughput of busy queues with many producers.")
+        ("id-lease-size", qpid::optValue(idLeaseSize, "N"),
+                "Each broker thread reserves message persistence ids in blocks of N, rather than allocating every "
+                "id from the shared counter. Reduces contention on many-core brokers; ids remain unique but are "
+                "only increasing per thread. 0 or 1 allocates each id from the shared counter.")
+        ("tpl-shards", qpid::optValue(tplNumShards, "N"),
+                "Number of transaction prepared list journals. Each transaction is prepared on one of these, "
+                "selected by its xid, so that transactional throughput is not limited by a single journal. "
+                "Additional shards left by a previous run with a larger value are recovered.")
+        ("wcache-min-pages", qpid::optValue(wCacheMinPages, "N"),
+                "Number of write cache pages each journal keeps while idle. Pages beyond this are returned to a "
+                "write page pool shared by all journals once their writes complete, and are borrowed again as "
+                "needed, so that idle queues hold little memory.")
+        ("wcache-max-pages", qpid::optValue(wCacheMaxPages, "N"),
+                "Maximum number of write cache pages each journal may borrow from the shared write page pool. "
+                "0 selects a value based on wcache-page-size (1 MiB in total for page sizes of 32 KiB and over).")
+        ("rcache-page-size", qpid::optValue(rCachePageSizeKib, "N"),
+                "Size of the pages in each journal's read page cache in KiB. "
+                "Allowable values - powers of 2: 1, 2, 4, ... , 64.")
+        ("rcache-pages", qpid::optValue(rCacheNumPages, "N"),
+                "Number of pages in each journal's read page cache. The read cache is only allocated when a "
+                "journal is first read after recovery (eg to load the content of a message released from memory).")
+        ("rcache-idle-timeout", qpid::optValue(rCacheIdleTimeout, "SECONDS"),
+                "Free the read page cache of a journal which has not been read for this many seconds. It is "
+                "allocated again by the next read. 0 keeps read caches once allocated.")
+        ("huge-pages", qpid::optValue(hugePages, "yes|no"),
+                "If yes|true|1, journal write and read page caches are backed by 2 MiB huge pages, using reserved "
+                "huge pages where these are configured and transparent huge pages otherwise. Reduces TLB misses "
+                "when many journals are active. Falls back to normal pages if huge pages are unavailable.")
+        ("numa-local-caches", qpid::optValue(numaLocalCaches, "yes|no"),
+                "If yes|true|1, journal page cache memory is placed on the NUMA node of the thread which first "
+                "writes to or reads from the journal, and pooled write cache pages are only reused on the node "
+                "they were allocated on.")
+        ("read-cursors", qpid::optValue(readCursors, "N"),
+                "Maximum number of independent read positions kept by each journal for loading the content of "
+                "messages released from memory, so that consumers and browsers reading different parts of a "
+                "queue do not restart each other's reads. Each cursor has its own read page cache.")
+        ("content-cache-size", qpid::optValue(contentCacheSizeKib, "N"),
+                "Size in KiB of each journal's cache of recently loaded message content, which allows the content "
+                "of several messages released from memory to be loaded in chunks at the same time without reading "
+                "them again from disk for each chunk. The cache is per journal, so up to N KiB is used for each "
+                "durable queue. 0 disables the cache.")
+        ("mmap-reads", qpid::optValue(mmapReads, "yes|no"),
+                "If yes|true|1, journals are read through read-only memory mappings of their files instead of "
+                "through read page caches, and message content is loaded directly from the mapping without "
+                "being copied first. Only data whose writes have completed is read.")
+        ("shared-journals", qpid::optValue(sharedJournals, "N"),
+                "Number of journals shared by queues, for brokers with large numbers of queues each with a low "
+                "message rate. If greater than 0, new queues write their messages to one of N shared journals, "
+                "selected by queue name, instead of each creating its own journal files. A queue may keep its own "
+                "journal by setting the qpid.shared_journal queue argument to 0. Messages on shared journals "
+                "are recovered regardless of this setting. 0 gives each queue its own journal.")
         ;
 }
 
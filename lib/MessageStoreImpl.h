@@ -24,7 +24,9 @@
 #ifndef _MessageStoreImpl_
 #define _MessageStoreImpl_
 
+#include <set>
 #include <string>
+#include <vector>
 
 #include "db-inc.h"
 #include "Cursor.h"
@@ -32,7 +34,9 @@
 #include "IdSequence.h"
 #include "JournalImpl.h"
 #include "jrnl/jcfg.hpp"
+#include "jrnl/page_pool.hpp"
 #include "PreparedTransaction.h"
+#include "SharedQueueStore.h"
 #include "qpid/broker/Broker.h"
 #include "qpid/broker/MessageStore.h"
 #include "qpid/management/Manageable.h"
@@ -52,10 +56,24 @@ class Timer;
 namespace mrg {
 namespace msgstore {
 
+/**
+ * Timer task which deletes a tombstoned journal directory. It is run on the store's own reaper timer so that
+ * unlinking large journal files does not hold up the broker thread that destroyed the queue.
+ */
+class JournalReaperEvent : public qpid::sys::TimerTask
+{
+    const std::string _dirName;
+
+  public:
+    JournalReaperEvent(const std::string& dirName);
+    void fire();
+};
+
 /**
  * An implementation of the MessageStore interface based on Berkeley DB
  */
-class MessageStoreImpl : public qpid::broker::MessageStore, public qpid::management::Manageable
+class MessageStoreImpl : public qpid::broker::MessageStore, public qpid::management::Manageable,
+                         public mrg::journal::page_pool_listener
 {
   public:
     typedef boost::shared_ptr<Db> db_ptr;
@@ -74,12 +92,31 @@ class MessageStoreImpl : public qpid::broker::MessageStore, public qpid::managem
         u_int16_t tplNumJrnlFiles;
         u_int32_t tplJrnlFsizePgs;
         u_int32_t tplWCachePageSizeKib;
+        bool      asyncQueueDestroy;
+        u_int32_t compressThreshold;
+        bool      packRecords;
+        u_int32_t dequeueBatchSize;
+        bool      writeCombining;
+        u_int32_t idLeaseSize;
+        u_int16_t tplNumShards;
+        u_int16_t wCacheMinPages;
+        u_int16_t wCacheMaxPages;
+        u_int32_t rCachePageSizeKib;
+        u_int16_t rCacheNumPages;
+        u_int32_t rCacheIdleTimeout;
+        bool      hugePages;
+        bool      numaLocalCaches;
+        u_int16_t readCursors;
+        u_int32_t contentCacheSizeKib;
+        bool      mmapReads;
+        u_int16_t sharedJournals;
     };
 
   protected:
     typedef std::map<u_int64_t, qpid::broker::RecoverableQueue::shared_ptr> queue_index;
     typedef std::map<u_int64_t, qpid::broker::RecoverableExchange::shared_ptr> exchange_index;
     typedef std::map<u_int64_t, qpid::broker::RecoverableMessage::shared_ptr> message_index;
+    typedef std::map<u_int64_t, std::pair<long, long> > queue_count_map; // queue id -> recovered, in-doubt msgs
 
     typedef LockedMappings::map txn_lock_map;
     typedef boost::ptr_list<PreparedTransaction> txn_list;
@@ -90,7 +127,9 @@ class MessageStoreImpl : public qpid::broker::MessageStore, public qpid::managem
         bool deq_flag;
         bool commit_flag;
         bool tpc_flag;
-        TplRecoverStruct(const u_int64_t _rid, const bool _deq_flag, const bool _commit_flag, const bool _tpc_flag);
+        u_int16_t shard; // TPL shard containing the record
+        TplRecoverStruct(const u_int64_t _rid, const bool _deq_flag, const bool _commit_flag, const bool _tpc_flag,
+                         const u_int16_t _shard);
     };
     typedef TplRecoverStruct TplRecover;
     typedef std::pair<std::string, TplRecover> TplRecoverMapPair;
@@ -108,9 +147,27 @@ class MessageStoreImpl : public qpid::broker::MessageStore, public qpid::managem
     static const u_int16_t defTplNumJrnlFiles = 8;
     static const u_int32_t defTplJrnlFileSizePgs = 24;
     static const u_int32_t defTplWCachePageSize = defWCachePageSize / 8;
+    static const u_int16_t defTplNumShards = 1;
     // TODO: set defAutoJrnlExpand to true and defAutoJrnlExpandMaxFiles to 16 when auto-expand comes on-line
     static const bool      defAutoJrnlExpand = false;
     static const u_int16_t defAutoJrnlExpandMaxFiles = 0;
+    static const bool      defAsyncQueueDestroy = false;
+    static const u_int32_t defCompressThreshold = 0;
+    static const bool      defPackRecords = false;
+    static const u_int32_t defDequeueBatchSize = 0;
+    static const bool      defWriteCombining = false;
+    static const u_int32_t defIdLeaseSize = 0;
+    static const u_int16_t defWCacheMinPages = JRNL_WMGR_MIN_PAGES;
+    static const u_int16_t defWCacheMaxPages = 0; // 0 = derive from the write page size
+    static const u_int32_t defRCachePageSize = JRNL_RMGR_PAGE_SIZE * JRNL_DBLK_SIZE * JRNL_SBLK_SIZE / 1024;
+    static const u_int16_t defRCacheNumPages = JRNL_RMGR_PAGES;
+    static const u_int32_t defRCacheIdleTimeout = 60; // seconds
+    static const bool      defHugePages = false;
+    static const bool      defNumaLocalCaches = false;
+    static const u_int16_t defReadCursors = 4;
+    static const u_int32_t defContentCacheSize = 0; // KiB, 0 = disabled
+    static const bool      defMmapReads = false;
+    static const u_int16_t defSharedJournals = 0; // 0 = each queue has its own journal
 
     static const std::string storeTopLevelDir;
     static qpid::sys::Duration defJournalGetEventsTimeout;
@@ -125,12 +182,22 @@ class MessageStoreImpl : public qpid::broker::MessageStore, public qpid::managem
     db_ptr bindingDb;
     db_ptr generalDb;
 
-    // Pointer to Transaction Prepared List (TPL) journal instance
-    boost::shared_ptr<TplJournalImpl> tplStorePtr;
+    // Transaction Prepared List (TPL) journal instances. Each transaction is prepared on the shard selected by
+    // its xid hash. Shards found on disk beyond tplNumShards (ie from a previous run with more shards) are
+    // recovered and completed, but receive no new transactions.
+    typedef boost::shared_ptr<TplJournalImpl> tpl_ptr;
+    std::vector<tpl_ptr> tplStores;
     TplRecoverMap tplRecoverMap;
     qpid::sys::Mutex tplInitLock;
     JournalListMap journalList;
     qpid::sys::Mutex journalListLock;
+
+    // Journals shared by queues which do not have their own journal (see SharedQueueStore). A queue is given
+    // one of the first sharedNumJournals by the hash of its name. Shared journals found on disk beyond these are
+    // recovered, but receive no new messages. Journals are created as needed, and are never in journalList.
+    typedef boost::shared_ptr<JournalImpl> journal_ptr;
+    std::vector<journal_ptr> sharedJournals;
+    qpid::sys::Mutex sharedJournalLock;
     qpid::sys::Mutex bdbLock;
 
     IdSequence queueIdSequence;
@@ -145,15 +212,37 @@ class MessageStoreImpl : public qpid::broker::MessageStore, public qpid::managem
     bool      truncateFlag;
     u_int32_t wCachePgSizeSblks;
     u_int16_t wCacheNumPages;
+    u_int16_t wCacheMinPages;
+    u_int16_t wCacheMaxPages;
+    u_int32_t rCachePgSizeSblks;
+    u_int16_t rCacheNumPages;
+    u_int32_t rCacheIdleSecs;
+    bool      hugePages;
+    bool      numaLocalCaches;
+    u_int16_t readCursors;
+    u_int32_t contentCacheBytes;
+    bool      mmapReads;
+    u_int16_t sharedNumJournals;
     u_int16_t tplNumJrnlFiles;
     u_int32_t tplJrnlFsizeSblks;
     u_int32_t tplWCachePgSizeSblks;
     u_int16_t tplWCacheNumPages;
+    u_int16_t tplNumShards;
     u_int64_t highestRid;
+    bool      asyncQueueDestroy;
+    u_int32_t compressThreshold;
+    bool      packRecords;
+    u_int32_t dequeueBatchSize;
+    bool      writeCombining;
+    u_int32_t idLeaseSize;
     bool isInit;
     const char* envPath;
     qpid::sys::Timer& timer;
 
+    // Reaper for tombstoned journal directories, started on first use
+    boost::shared_ptr<qpid::sys::Timer> reaperTimerPtr;
+    qpid::sys::Mutex reaperLock;
+
     qmf::com::redhat::rhm::store::Store* mgmtObject;
     qpid::management::ManagementAgent* agent;
     
@@ -168,6 +257,8 @@ class MessageStoreImpl : public qpid::broker::MessageStore, public qpid::managem
                                             const std::string paramName,
                                             const u_int16_t jrnlFsizePgs);
     static u_int16_t getJrnlWrNumPages(const u_int32_t wrPageSizeKib);
+    static u_int32_t chkJrnlRdPageCacheSize(const u_int32_t param,
+                                            const std::string paramName);
     void chkJrnlAutoExpandOptions(const MessageStoreImpl::StoreOptions* opts,
                                   bool& autoJrnlExpand,
                                   u_int16_t& autoJrnlExpandMaxFiles,
@@ -194,6 +285,32 @@ class MessageStoreImpl : public qpid::broker::MessageStore, public qpid::managem
                          message_index& prepared,
                          long& rcnt,
                          long& idcnt);
+    qpid::broker::RecoverableMessage::shared_ptr decodeMessage(qpid::broker::RecoveryManager& recovery,
+                                                               char* data,
+                                                               size_t readSize,
+                                                               bool externalFlag,
+                                                               u_int64_t messageId);
+    void recoverMessage(qpid::broker::RecoverableQueue::shared_ptr& queue,
+                        qpid::broker::RecoverableMessage::shared_ptr& msg,
+                        u_int64_t messageId,
+                        JournalImpl* jc,
+                        u_int64_t rid,
+                        txn_list& locked,
+                        message_index& prepared,
+                        long& rcnt,
+                        long& idcnt);
+    void recoverSharedJournals(qpid::broker::RecoveryManager& recovery,
+                               queue_index& sharedQueues,
+                               txn_list& locked,
+                               message_index& prepared,
+                               SharedQueueStore::RecordList& orphans);
+    void recoverSharedJournal(const u_int16_t shard,
+                              qpid::broker::RecoveryManager& recovery,
+                              queue_index& sharedQueues,
+                              txn_list& locked,
+                              message_index& prepared,
+                              queue_count_map& counts,
+                              SharedQueueStore::RecordList& orphans);
     qpid::broker::RecoverableMessage::shared_ptr getExternMessage(qpid::broker::RecoveryManager& recovery,
                                                                   uint64_t mId,
                                                                   unsigned& headerSize);
@@ -212,10 +329,14 @@ class MessageStoreImpl : public qpid::broker::MessageStore, public qpid::managem
                        txn_list& locked,
                        message_index& prepared);
     void readTplStore();
+    void readTplShard(const u_int16_t shard);
     void recoverTplStore();
+    void recoverTplShard(const u_int16_t shard);
     void recoverLockedMappings(txn_list& txns);
     TxnCtxt* check(qpid::broker::TransactionContext* ctxt);
-    u_int64_t msgEncode(std::vector<char>& buff, const boost::intrusive_ptr<qpid::broker::PersistableMessage>& message);
+    u_int64_t msgEncode(std::vector<char>& buff,
+                        const boost::intrusive_ptr<qpid::broker::PersistableMessage>& message,
+                        const std::size_t prefixSize = 0);
     void store(const qpid::broker::PersistableQueue* queue,
                TxnCtxt* txn,
                const boost::intrusive_ptr<qpid::broker::PersistableMessage>& message,
@@ -247,17 +368,29 @@ class MessageStoreImpl : public qpid::broker::MessageStore, public qpid::managem
 
     // journal functions
     void createJrnlQueue(const qpid::broker::PersistableQueue& queue);
+    void setJrnlOptions(JournalImpl* jQueue);
+    JournalImpl* sharedJournal(const u_int16_t shard);
+    JournalImpl* newSharedJournal(const u_int16_t shard);
+    qpid::broker::ExternalQueueStore* recordJournal(qpid::broker::ExternalQueueStore* eqs, const u_int64_t messageId);
+    void dequeueRecord(JournalImpl* jc, const u_int64_t rid);
     u_int32_t bHash(const std::string str);
     std::string getJrnlDir(const qpid::broker::PersistableQueue& queue); //for exmaple /var/rhm/ + queueDir/
     std::string getJrnlHashDir(const std::string& queueName);
     std::string getJrnlBaseDir();
     std::string getBdbBaseDir();
-    std::string getTplBaseDir();
+    std::string getTplBaseDir(const u_int16_t shard = 0);
+    std::string getSharedJrnlDir(const u_int16_t shard = 0);
+    std::string getDelBaseDir();
+    void reapJrnlDir(const std::string& jrnlDir);
+    void reapTombstones();
+    void reapOrphanJrnlDirs(const std::set<std::string>& queueDirs);
+    void stopReaper();
     inline void checkInit() {
         // TODO: change the default dir to ~/.qpidd
         if (!isInit) { init("/tmp"); isInit = true; }
     }
     void chkTplStoreInit();
+    inline TplJournalImpl* tplStore(const std::string& xid) { return tplStores[bHash(xid) % tplNumShards].get(); }
 
     // debug aid for printing XIDs that may contain non-printable chars
     static std::string xid2str(const std::string xid) {
@@ -369,10 +502,15 @@ class MessageStoreImpl : public qpid::broker::MessageStore, public qpid::managem
     inline qpid::management::Manageable::status_t ManagementMethod (u_int32_t, qpid::management::Args&)
         { return qpid::management::Manageable::STATUS_OK; }
 
+    // mrg::journal::page_pool_listener: keeps the Store write page pool statistics current
+    void pool_pages_chg(const int32_t allocChg, const int32_t usedChg);
+
     std::string getStoreDir() const;
 
   private:
     void journalDeleted(JournalImpl&);
+    // Keeps the Store journal memory statistics current, see JournalImpl::setMemoryCallback()
+    void journalMemoryChg(const int64_t cacheChg, const int64_t indexChg);
 
 }; // class MessageStoreImpl
 
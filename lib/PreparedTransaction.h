@@ -31,6 +31,11 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/ptr_container/ptr_list.hpp>
 
+namespace qpid{
+namespace broker{
+class ExternalQueueStore;
+}}
+
 namespace mrg{
 namespace msgstore{
 
@@ -64,6 +69,8 @@ struct PreparedTransaction
     const std::string xid;
     const LockedMappings::shared_ptr enqueues;
     const LockedMappings::shared_ptr dequeues;
+    // Shared journals holding records of the txn whose queue has been destroyed, which are in neither list
+    std::set<qpid::broker::ExternalQueueStore*> orphanJournals;
 
     PreparedTransaction(const std::string& xid, LockedMappings::shared_ptr enqueues, LockedMappings::shared_ptr dequeues);
     bool isLocked(queue_id queue, message_id message);
@@ -0,0 +1,106 @@
+/*
+ Copyright (c) 2007, 2008, 2009 Red Hat, Inc.
+
+ This file is part of the Qpid async store library msgstore.so.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ USA
+
+ The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#include "SharedQueueStore.h"
+
+#include "JournalImpl.h"
+#include <qpid/framing/Buffer.h>
+
+using namespace mrg::msgstore;
+
+// Least number of entries before stale entries are first pruned
+#define SHARED_QUEUE_PRUNE_MIN 64
+
+SharedQueueStore::SharedQueueStore(JournalImpl* home) : homeJournal(home), pruneSize(SHARED_QUEUE_PRUNE_MIN)
+{}
+
+void SharedQueueStore::addRecord(const u_int64_t messageId, JournalImpl* jc, const u_int64_t rid)
+{
+    qpid::sys::Mutex::ScopedLock sl(recordLock);
+    records[messageId] = RecordRef(jc, rid);
+    if (records.size() >= pruneSize) {
+        prune();
+        // Prune again only once the live entries have doubled, so that pruning costs O(1) per record
+        pruneSize = records.size() * 2 > SHARED_QUEUE_PRUNE_MIN ? records.size() * 2 : SHARED_QUEUE_PRUNE_MIN;
+    }
+}
+
+bool SharedQueueStore::findRecord(const u_int64_t messageId, RecordRef& ref)
+{
+    qpid::sys::Mutex::ScopedLock sl(recordLock);
+    RecordMapItr i = records.find(messageId);
+    if (i == records.end()) return false;
+    ref = i->second;
+    return true;
+}
+
+void SharedQueueStore::removeRecord(const u_int64_t messageId)
+{
+    qpid::sys::Mutex::ScopedLock sl(recordLock);
+    records.erase(messageId);
+}
+
+void SharedQueueStore::recordList(RecordList& list)
+{
+    qpid::sys::Mutex::ScopedLock sl(recordLock);
+    list.reserve(list.size() + records.size());
+    for (RecordMapItr i = records.begin(); i != records.end(); i++)
+        list.push_back(*i);
+}
+
+void SharedQueueStore::encodePrefix(char* buff, const u_int64_t queueId, const u_int64_t messageId)
+{
+    qpid::framing::Buffer buffer(buff, prefixSize);
+    buffer.putLongLong(queueId);
+    buffer.putLongLong(messageId);
+}
+
+void SharedQueueStore::decodePrefix(char* buff, u_int64_t& queueId, u_int64_t& messageId)
+{
+    qpid::framing::Buffer buffer(buff, prefixSize);
+    queueId = buffer.getLongLong();
+    messageId = buffer.getLongLong();
+}
+
+void SharedQueueStore::journalList(std::set<JournalImpl*>& list)
+{
+    qpid::sys::Mutex::ScopedLock sl(recordLock);
+    list.insert(homeJournal);
+    for (RecordMapItr i = records.begin(); i != records.end(); i++)
+        list.insert(i->second.journal);
+}
+
+// Private functions
+
+void SharedQueueStore::prune()
+{
+    // Drop entries whose record has been dequeued, or whose transactional enqueue was aborted. A record
+    // which is enqueued or still part of an open transaction is kept.
+    for (RecordMapItr i = records.begin(); i != records.end();) {
+        JournalImpl* jc = i->second.journal;
+        if (jc->is_enqueued(i->second.rid, true) || jc->get_txn_map().is_enq(i->second.rid))
+            i++;
+        else
+            records.erase(i++);
+    }
+}
@@ -0,0 +1,101 @@
+/*
+ Copyright (c) 2007, 2008, 2009 Red Hat, Inc.
+
+ This file is part of the Qpid async store library msgstore.so.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ USA
+
+ The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#ifndef _SharedQueueStore_
+#define _SharedQueueStore_
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+#include <qpid/broker/PersistableQueue.h>
+#include <qpid/sys/Mutex.h>
+#include <sys/types.h>
+
+namespace mrg{
+namespace msgstore{
+
+class JournalImpl;
+
+/**
+ * Store of a queue whose messages are written to a journal shared with other queues, rather than to a
+ * journal of its own.
+ *
+ * Each record in a shared journal starts with a prefix holding the id of the queue and the persistence
+ * id of the message, and has its own record id, as a message enqueued on several queues may be written
+ * to the same shared journal more than once. The store keeps the index of the queue's records: for each
+ * message on the queue, the journal holding its record and the record id. New messages are written to
+ * the queue's home journal; records recovered from other shared journals (eg after the number of shared
+ * journals is changed) stay where they are until dequeued.
+ *
+ * Entries are removed when a message is dequeued outside a transaction. Entries of records dequeued
+ * or aborted in a transaction are pruned from time to time as records are added.
+ */
+class SharedQueueStore : public qpid::broker::ExternalQueueStore
+{
+  public:
+    struct RecordRef
+    {
+        JournalImpl* journal;
+        u_int64_t rid;
+        RecordRef() : journal(0), rid(0) {}
+        RecordRef(JournalImpl* j, const u_int64_t r) : journal(j), rid(r) {}
+    };
+    typedef std::pair<u_int64_t, RecordRef> RecordListEntry;
+    typedef std::vector<RecordListEntry> RecordList;
+
+    // Size of the prefix (queue id, message persistence id) written ahead of the encoded message
+    static const std::size_t prefixSize = 2 * sizeof(u_int64_t);
+
+  private:
+    typedef std::map<u_int64_t, RecordRef> RecordMap;
+    typedef RecordMap::iterator RecordMapItr;
+
+    JournalImpl* homeJournal;
+    qpid::sys::Mutex recordLock;
+    RecordMap records; // message persistence id -> record
+    std::size_t pruneSize; // records.size() at which stale entries are next pruned
+
+    void prune();
+
+  public:
+    SharedQueueStore(JournalImpl* home);
+    virtual ~SharedQueueStore() {}
+
+    inline JournalImpl* journal() const { return homeJournal; }
+
+    void addRecord(const u_int64_t messageId, JournalImpl* jc, const u_int64_t rid);
+    bool findRecord(const u_int64_t messageId, RecordRef& ref);
+    void removeRecord(const u_int64_t messageId);
+    void recordList(RecordList& list);
+    void journalList(std::set<JournalImpl*>& list); // Home journal and journals holding records of the queue
+
+    static void encodePrefix(char* buff, const u_int64_t queueId, const u_int64_t messageId);
+    static void decodePrefix(char* buff, u_int64_t& queueId, u_int64_t& messageId);
+
+    qpid::management::ManagementObject* GetManagementObject(void) const { return 0; }
+};
+
+}}
+
+#endif
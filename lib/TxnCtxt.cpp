@@ -9,7 +9,10 @@ namespace mrg {
 namespace msgstore {
 
 void TxnCtxt::completeTxn(bool commit) {
-    sync();
+    // Data on several journals must be on disk before any commit record is written; a single unprepared
+    // journal's commit record is atomic by itself, and is synced by commitTxn().
+    if (preparedXidStorePtr || impactedQueues.size() > 1)
+        sync();
     for (ipqItr i = impactedQueues.begin(); i != impactedQueues.end(); i++) {
         commitTxn(static_cast<JournalImpl*>(*i), commit);
     }
@@ -26,10 +29,10 @@ void TxnCtxt::commitTxn(JournalImpl* jc, bool commit) {
         dtokp->set_rid(loggedtx->next());
         try {
             if (commit) {
-                jc->txn_commit(dtokp.get(), getXid());
+                jc->txn_commit(dtokp.get(), getXidHandle());
                 sync();
             } else {
-                jc->txn_abort(dtokp.get(), getXid());
+                jc->txn_abort(dtokp.get(), getXidHandle());
             }
         } catch (const journal::jexception& e) {
             THROW_STORE_EXCEPTION(std::string("Error commit") + e.what());
@@ -78,30 +81,32 @@ TxnCtxt::~TxnCtxt() { abort(); }
 void TxnCtxt::sync() {
     if (loggedtx) {
         try {
+            std::vector<JournalImpl*> pending;
             for (ipqItr i = impactedQueues.begin(); i != impactedQueues.end(); i++)
-                jrnl_flush(static_cast<JournalImpl*>(*i));
-            if (preparedXidStorePtr)
-                jrnl_flush(preparedXidStorePtr);
-            for (ipqItr i = impactedQueues.begin(); i != impactedQueues.end(); i++)
-                jrnl_sync(static_cast<JournalImpl*>(*i), &journal::jcntl::_aio_cmpl_timeout);
-            if (preparedXidStorePtr)
-                jrnl_sync(preparedXidStorePtr, &journal::jcntl::_aio_cmpl_timeout);
+                jrnl_flush(static_cast<JournalImpl*>(*i), pending);
+            if (preparedXidStorePtr && !preparedXidStorePtr->is_txn_synced(getXidHandle())) {
+                preparedXidStorePtr->groupFlush();
+                pending.push_back(preparedXidStorePtr);
+            }
+            jrnl_sync(pending, &journal::jcntl::_aio_cmpl_timeout);
         } catch (const journal::jexception& e) {
             THROW_STORE_EXCEPTION(std::string("Error during txn sync: ") + e.what());
         }
     }
 }
 
-void TxnCtxt::jrnl_flush(JournalImpl* jc) {
-    if (jc && !(jc->is_txn_synced(getXid())))
+void TxnCtxt::jrnl_flush(JournalImpl* jc, std::vector<JournalImpl*>& pending) {
+    if (jc && !(jc->is_txn_synced(getXidHandle()))) {
         jc->flush();
+        pending.push_back(jc);
+    }
 }
 
-void TxnCtxt::jrnl_sync(JournalImpl* jc, timespec* timeout) {
-    if (!jc || jc->is_txn_synced(getXid()))
-        return;
-    while (jc->get_wr_aio_evt_rem()) {
-        if (jc->get_wr_events(timeout) == journal::jerrno::AIO_TIMEOUT && timeout)
+// Waits until this txn is synced on every journal in pending. The writes to all of them are already in flight
+// (see sync()), so waiting on each journal in turn lasts about as long as the slowest one, not the sum of them.
+void TxnCtxt::jrnl_sync(std::vector<JournalImpl*>& pending, timespec* timeout) {
+    for (std::vector<JournalImpl*>::iterator i = pending.begin(); i != pending.end(); i++) {
+        if ((*i)->wait_txn_synced(getXidHandle(), timeout) == journal::jerrno::AIO_TIMEOUT)
             THROW_STORE_EXCEPTION(std::string("Error: timeout waiting for TxnCtxt::jrnl_sync()"));
     }
 }
@@ -141,12 +146,20 @@ bool TxnCtxt::isTPC() { return false; }
 
 const std::string& TxnCtxt::getXid() { return tid; }
 
+const journal::xid_handle& TxnCtxt::getXidHandle() {
+    if (xidHandle.empty())
+        xidHandle = journal::xid_handle(getXid());
+    return xidHandle;
+}
+
 void TxnCtxt::addXidRecord(qpid::broker::ExternalQueueStore* queue) { impactedQueues.insert(queue); }
 
 void TxnCtxt::complete(bool commit) { completeTxn(commit); }
 
 bool TxnCtxt::impactedQueuesEmpty() { return impactedQueues.empty(); }
 
+bool TxnCtxt::impactedQueuesSingle() { return impactedQueues.size() == 1; }
+
 DataTokenImpl* TxnCtxt::getDtok() { return dtokp.get(); }
 
 void TxnCtxt::incrDtokRef() { dtokp->addRef(); }
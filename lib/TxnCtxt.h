@@ -28,10 +28,12 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "DataTokenImpl.h"
 #include "IdSequence.h"
 #include "JournalImpl.h"
+#include "jrnl/xid_handle.hpp"
 #include "qpid/broker/PersistableQueue.h"
 #include "qpid/broker/TransactionalStore.h"
 #include "qpid/sys/Mutex.h"
@@ -60,18 +62,23 @@ class TxnCtxt : public qpid::broker::TransactionContext
     IdSequence* loggedtx;
     boost::intrusive_ptr<DataTokenImpl> dtokp;
     AutoScopedLock globalHolder;
-    JournalImpl* preparedXidStorePtr;
+    TplJournalImpl* preparedXidStorePtr;
 
     /**
      * local txn id, if non XA.
      */
     std::string tid;
+    /**
+     * Interned handle for getXid(), passed to the journals so that they need not copy or rehash the xid.
+     * Set on first use, so that txns which write no journal records do not intern their xid.
+     */
+    journal::xid_handle xidHandle;
     DbTxn* txn;
 
     virtual void completeTxn(bool commit);
     void commitTxn(JournalImpl* jc, bool commit);
-    void jrnl_flush(JournalImpl* jc);
-    void jrnl_sync(JournalImpl* jc, timespec* timeout);
+    void jrnl_flush(JournalImpl* jc, std::vector<JournalImpl*>& pending);
+    void jrnl_sync(std::vector<JournalImpl*>& pending, timespec* timeout);
 
   public:
     TxnCtxt(IdSequence* _loggedtx=NULL);
@@ -90,11 +97,14 @@ class TxnCtxt : public qpid::broker::TransactionContext
     DbTxn* get();
     virtual bool isTPC();
     virtual const std::string& getXid();
+    const journal::xid_handle& getXidHandle();
 
     void addXidRecord(qpid::broker::ExternalQueueStore* queue);
-    inline void prepare(JournalImpl* _preparedXidStorePtr) { preparedXidStorePtr = _preparedXidStorePtr; }
+    inline void prepare(TplJournalImpl* _preparedXidStorePtr) { preparedXidStorePtr = _preparedXidStorePtr; }
+    inline TplJournalImpl* getPreparedXidStore() const { return preparedXidStorePtr; }
     void complete(bool commit);
     bool impactedQueuesEmpty();
+    bool impactedQueuesSingle();
     DataTokenImpl* getDtok();
     void incrDtokRef();
     void recoverDtok(const u_int64_t rid, const std::string xid);
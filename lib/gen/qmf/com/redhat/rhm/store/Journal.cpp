@@ -43,7 +43,7 @@ using           std::string;
 string  Journal::packageName  = string ("com.redhat.rhm.store");
 string  Journal::className    = string ("journal");
 uint8_t Journal::md5Sum[MD5_LEN]   =
-    {0x9,0xc2,0xe2,0xfc,0xcc,0x2e,0x72,0xaa,0x3f,0xce,0x36,0x28,0xce,0x81,0xc,0xd4};
+    {0x6d,0x5e,0xc0,0x6f,0xcd,0x8a,0xd9,0xd6,0xb9,0x61,0x16,0x73,0x2,0x4c,0x65,0xb4};
 
 Journal::Journal (ManagementAgent*, Manageable* _core) :
     ManagementObject(_core)
@@ -68,6 +68,12 @@ Journal::Journal (ManagementAgent*, Manageable* _core) :
     outstandingAIOs = 0;
     outstandingAIOsHigh = 0;
     outstandingAIOsLow  = 0;
+    cacheBytes = 0;
+    cacheBytesHigh = 0;
+    cacheBytesLow  = 0;
+    indexBytes = 0;
+    indexBytesHigh = 0;
+    indexBytesLow  = 0;
     freeFileCount = 0;
     freeFileCountHigh = 0;
     freeFileCountLow  = 0;
@@ -134,7 +140,7 @@ void Journal::writeSchema (std::string& schema)
     buf.putShortString (className);   // Class Name
     buf.putBin128      (md5Sum);      // Schema Hash
     buf.putShort       (13); // Config Element Count
-    buf.putShort       (29); // Inst Element Count
+    buf.putShort       (38); // Inst Element Count
     buf.putShort       (1); // Method Count
 
     // Properties
@@ -354,6 +360,69 @@ void Journal::writeSchema (std::string& schema)
     ft[DESC] = "Number of currently outstanding AIO requests in Async IO system (Low)";
     buf.putMap(ft);
 
+    ft.clear();
+    ft[NAME] = "cacheBytes";
+    ft[TYPE] = TYPE_U64;
+    ft[UNIT] = "byte";
+    ft[DESC] = "Estimated memory used by the caches and buffers of this journal";
+    buf.putMap(ft);
+
+    ft.clear();
+    ft[NAME] = "cacheBytesHigh";
+    ft[TYPE] = TYPE_U64;
+    ft[UNIT] = "byte";
+    ft[DESC] = "Estimated memory used by the caches and buffers of this journal (High)";
+    buf.putMap(ft);
+
+    ft.clear();
+    ft[NAME] = "cacheBytesLow";
+    ft[TYPE] = TYPE_U64;
+    ft[UNIT] = "byte";
+    ft[DESC] = "Estimated memory used by the caches and buffers of this journal (Low)";
+    buf.putMap(ft);
+
+    ft.clear();
+    ft[NAME] = "contentCacheHits";
+    ft[TYPE] = TYPE_U64;
+    ft[UNIT] = "record";
+    ft[DESC] = "Message content loads satisfied from the content cache";
+    buf.putMap(ft);
+
+    ft.clear();
+    ft[NAME] = "contentCacheMisses";
+    ft[TYPE] = TYPE_U64;
+    ft[UNIT] = "record";
+    ft[DESC] = "Message content loads not satisfied from the content cache";
+    buf.putMap(ft);
+
+    ft.clear();
+    ft[NAME] = "indexBytes";
+    ft[TYPE] = TYPE_U64;
+    ft[UNIT] = "byte";
+    ft[DESC] = "Estimated memory used by the enqueue and transaction indexes of this journal";
+    buf.putMap(ft);
+
+    ft.clear();
+    ft[NAME] = "indexBytesHigh";
+    ft[TYPE] = TYPE_U64;
+    ft[UNIT] = "byte";
+    ft[DESC] = "Estimated memory used by the enqueue and transaction indexes of this journal (High)";
+    buf.putMap(ft);
+
+    ft.clear();
+    ft[NAME] = "indexBytesLow";
+    ft[TYPE] = TYPE_U64;
+    ft[UNIT] = "byte";
+    ft[DESC] = "Estimated memory used by the enqueue and transaction indexes of this journal (Low)";
+    buf.putMap(ft);
+
+    ft.clear();
+    ft[NAME] = "readBytes";
+    ft[TYPE] = TYPE_U64;
+    ft[UNIT] = "byte";
+    ft[DESC] = "Bytes read from the journal files";
+    buf.putMap(ft);
+
     ft.clear();
     ft[NAME] = "freeFileCount";
     ft[TYPE] = TYPE_U32;
@@ -499,6 +568,9 @@ void Journal::aggregatePerThreadStats(struct PerThreadStats* totals) const
     totals->txnDequeues = 0;
     totals->txnCommits = 0;
     totals->txnAborts = 0;
+    totals->contentCacheHits = 0;
+    totals->contentCacheMisses = 0;
+    totals->readBytes = 0;
     totals->writeWaitFailures = 0;
     totals->writeBusyFailures = 0;
     totals->readRecordCount = 0;
@@ -514,6 +586,9 @@ void Journal::aggregatePerThreadStats(struct PerThreadStats* totals) const
             totals->txnDequeues += threadStats->txnDequeues;
             totals->txnCommits += threadStats->txnCommits;
             totals->txnAborts += threadStats->txnAborts;
+            totals->contentCacheHits += threadStats->contentCacheHits;
+            totals->contentCacheMisses += threadStats->contentCacheMisses;
+            totals->readBytes += threadStats->readBytes;
             totals->writeWaitFailures += threadStats->writeWaitFailures;
             totals->writeBusyFailures += threadStats->writeBusyFailures;
             totals->readRecordCount += threadStats->readRecordCount;
@@ -649,6 +724,15 @@ void Journal::writeStatistics (std::string& _sBuf, bool skipHeaders)
     buf.putLong(outstandingAIOs);
     buf.putLong(outstandingAIOsHigh);
     buf.putLong(outstandingAIOsLow);
+    buf.putLongLong(cacheBytes);
+    buf.putLongLong(cacheBytesHigh);
+    buf.putLongLong(cacheBytesLow);
+    buf.putLongLong(totals.contentCacheHits);
+    buf.putLongLong(totals.contentCacheMisses);
+    buf.putLongLong(indexBytes);
+    buf.putLongLong(indexBytesHigh);
+    buf.putLongLong(indexBytesLow);
+    buf.putLongLong(totals.readBytes);
     buf.putLong(freeFileCount);
     buf.putLong(freeFileCountHigh);
     buf.putLong(freeFileCountLow);
@@ -672,6 +756,10 @@ void Journal::writeStatistics (std::string& _sBuf, bool skipHeaders)
     recordDepthLow  = recordDepth;
     outstandingAIOsHigh = outstandingAIOs;
     outstandingAIOsLow  = outstandingAIOs;
+    cacheBytesHigh = cacheBytes;
+    cacheBytesLow  = cacheBytes;
+    indexBytesHigh = indexBytes;
+    indexBytesLow  = indexBytes;
     freeFileCountHigh = freeFileCount;
     freeFileCountLow  = freeFileCount;
     availableFileCountHigh = availableFileCount;
@@ -789,6 +877,15 @@ void Journal::mapEncodeValues (::qpid::types::Variant::Map& _map,
     _map["outstandingAIOs"] = ::qpid::types::Variant(outstandingAIOs);
     _map["outstandingAIOsHigh"] = ::qpid::types::Variant(outstandingAIOsHigh);
     _map["outstandingAIOsLow"] = ::qpid::types::Variant(outstandingAIOsLow);
+    _map["cacheBytes"] = ::qpid::types::Variant(cacheBytes);
+    _map["cacheBytesHigh"] = ::qpid::types::Variant(cacheBytesHigh);
+    _map["cacheBytesLow"] = ::qpid::types::Variant(cacheBytesLow);
+    _map["contentCacheHits"] = ::qpid::types::Variant(totals.contentCacheHits);
+    _map["contentCacheMisses"] = ::qpid::types::Variant(totals.contentCacheMisses);
+    _map["indexBytes"] = ::qpid::types::Variant(indexBytes);
+    _map["indexBytesHigh"] = ::qpid::types::Variant(indexBytesHigh);
+    _map["indexBytesLow"] = ::qpid::types::Variant(indexBytesLow);
+    _map["readBytes"] = ::qpid::types::Variant(totals.readBytes);
     _map["freeFileCount"] = ::qpid::types::Variant(freeFileCount);
     _map["freeFileCountHigh"] = ::qpid::types::Variant(freeFileCountHigh);
     _map["freeFileCountLow"] = ::qpid::types::Variant(freeFileCountLow);
@@ -812,6 +909,10 @@ void Journal::mapEncodeValues (::qpid::types::Variant::Map& _map,
     recordDepthLow  = recordDepth;
     outstandingAIOsHigh = outstandingAIOs;
     outstandingAIOsLow  = outstandingAIOs;
+    cacheBytesHigh = cacheBytes;
+    cacheBytesLow  = cacheBytes;
+    indexBytesHigh = indexBytes;
+    indexBytesLow  = indexBytes;
     freeFileCountHigh = freeFileCount;
     freeFileCountLow  = freeFileCount;
     availableFileCountHigh = availableFileCount;
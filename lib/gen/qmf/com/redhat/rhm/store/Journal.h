@@ -70,6 +70,12 @@ class Journal : public ::qpid::management::ManagementObject
     uint32_t  outstandingAIOs;
     uint32_t  outstandingAIOsHigh;
     uint32_t  outstandingAIOsLow;
+    uint64_t  cacheBytes;
+    uint64_t  cacheBytesHigh;
+    uint64_t  cacheBytesLow;
+    uint64_t  indexBytes;
+    uint64_t  indexBytesHigh;
+    uint64_t  indexBytesLow;
     uint32_t  freeFileCount;
     uint32_t  freeFileCountHigh;
     uint32_t  freeFileCountLow;
@@ -93,6 +99,9 @@ class Journal : public ::qpid::management::ManagementObject
         uint64_t  txnDequeues;
         uint64_t  txnCommits;
         uint64_t  txnAborts;
+        uint64_t  contentCacheHits;
+        uint64_t  contentCacheMisses;
+        uint64_t  readBytes;
         uint64_t  writeWaitFailures;
         uint64_t  writeBusyFailures;
         uint64_t  readRecordCount;
@@ -115,6 +124,9 @@ class Journal : public ::qpid::management::ManagementObject
             threadStats->txnDequeues = 0;
             threadStats->txnCommits = 0;
             threadStats->txnAborts = 0;
+            threadStats->contentCacheHits = 0;
+            threadStats->contentCacheMisses = 0;
+            threadStats->readBytes = 0;
             threadStats->writeWaitFailures = 0;
             threadStats->writeBusyFailures = 0;
             threadStats->readRecordCount = 0;
@@ -368,6 +380,58 @@ class Journal : public ::qpid::management::ManagementObject
             outstandingAIOsLow = outstandingAIOs;
         instChanged = true;
     }
+    inline void inc_cacheBytes (uint64_t by = 1) {
+        ::qpid::management::Mutex::ScopedLock mutex(accessLock);
+        cacheBytes += by;
+        if (cacheBytesHigh < cacheBytes)
+            cacheBytesHigh = cacheBytes;
+        instChanged = true;
+    }
+    inline void dec_cacheBytes (uint64_t by = 1) {
+        ::qpid::management::Mutex::ScopedLock mutex(accessLock);
+        cacheBytes -= by;
+        if (cacheBytesLow > cacheBytes)
+            cacheBytesLow = cacheBytes;
+        instChanged = true;
+    }
+    inline void inc_contentCacheHits (uint64_t by = 1) {
+        getThreadStats()->contentCacheHits += by;
+        instChanged = true;
+    }
+    inline void dec_contentCacheHits (uint64_t by = 1) {
+        getThreadStats()->contentCacheHits -= by;
+        instChanged = true;
+    }
+    inline void inc_contentCacheMisses (uint64_t by = 1) {
+        getThreadStats()->contentCacheMisses += by;
+        instChanged = true;
+    }
+    inline void dec_contentCacheMisses (uint64_t by = 1) {
+        getThreadStats()->contentCacheMisses -= by;
+        instChanged = true;
+    }
+    inline void inc_indexBytes (uint64_t by = 1) {
+        ::qpid::management::Mutex::ScopedLock mutex(accessLock);
+        indexBytes += by;
+        if (indexBytesHigh < indexBytes)
+            indexBytesHigh = indexBytes;
+        instChanged = true;
+    }
+    inline void dec_indexBytes (uint64_t by = 1) {
+        ::qpid::management::Mutex::ScopedLock mutex(accessLock);
+        indexBytes -= by;
+        if (indexBytesLow > indexBytes)
+            indexBytesLow = indexBytes;
+        instChanged = true;
+    }
+    inline void inc_readBytes (uint64_t by = 1) {
+        getThreadStats()->readBytes += by;
+        instChanged = true;
+    }
+    inline void dec_readBytes (uint64_t by = 1) {
+        getThreadStats()->readBytes -= by;
+        instChanged = true;
+    }
     inline void inc_freeFileCount (uint32_t by = 1) {
         ::qpid::management::Mutex::ScopedLock mutex(accessLock);
         freeFileCount += by;
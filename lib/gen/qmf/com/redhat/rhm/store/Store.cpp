@@ -42,7 +42,7 @@ using           std::string;
 string  Store::packageName  = string ("com.redhat.rhm.store");
 string  Store::className    = string ("store");
 uint8_t Store::md5Sum[MD5_LEN]   =
-    {0x18,0xd,0xd4,0x15,0xd3,0x9a,0xf,0xbe,0x3a,0x40,0xe1,0x1b,0x9e,0x5b,0x7e,0x86};
+    {0x1e,0xea,0xde,0x3b,0x8,0xc5,0x75,0x98,0x52,0x25,0x5f,0x63,0x0,0x20,0xc6,0x8c};
 
 Store::Store (ManagementAgent*, Manageable* _core, ::qpid::management::Manageable* _parent) :
     ManagementObject(_core)
@@ -64,6 +64,18 @@ Store::Store (ManagementAgent*, Manageable* _core, ::qpid::management::Manageabl
     tplOutstandingAIOs = 0;
     tplOutstandingAIOsHigh = 0;
     tplOutstandingAIOsLow  = 0;
+    wcachePoolPages = 0;
+    wcachePoolPagesHigh = 0;
+    wcachePoolPagesLow  = 0;
+    wcachePoolPagesInUse = 0;
+    wcachePoolPagesInUseHigh = 0;
+    wcachePoolPagesInUseLow  = 0;
+    journalCacheBytes = 0;
+    journalCacheBytesHigh = 0;
+    journalCacheBytesLow  = 0;
+    journalIndexBytes = 0;
+    journalIndexBytesHigh = 0;
+    journalIndexBytesLow  = 0;
 
 
 
@@ -118,7 +130,7 @@ void Store::writeSchema (std::string& schema)
     buf.putShortString (className);   // Class Name
     buf.putBin128      (md5Sum);      // Schema Hash
     buf.putShort       (11); // Config Element Count
-    buf.putShort       (9); // Inst Element Count
+    buf.putShort       (21); // Inst Element Count
     buf.putShort       (0); // Method Count
 
     // Properties
@@ -292,6 +304,90 @@ void Store::writeSchema (std::string& schema)
     ft[DESC] = "Number of currently outstanding AIO requests in Async IO system (Low)";
     buf.putMap(ft);
 
+    ft.clear();
+    ft[NAME] = "wcachePoolPages";
+    ft[TYPE] = TYPE_U32;
+    ft[UNIT] = "wpage";
+    ft[DESC] = "Number of write cache pages allocated by the shared write page pool";
+    buf.putMap(ft);
+
+    ft.clear();
+    ft[NAME] = "wcachePoolPagesHigh";
+    ft[TYPE] = TYPE_U32;
+    ft[UNIT] = "wpage";
+    ft[DESC] = "Number of write cache pages allocated by the shared write page pool (High)";
+    buf.putMap(ft);
+
+    ft.clear();
+    ft[NAME] = "wcachePoolPagesLow";
+    ft[TYPE] = TYPE_U32;
+    ft[UNIT] = "wpage";
+    ft[DESC] = "Number of write cache pages allocated by the shared write page pool (Low)";
+    buf.putMap(ft);
+
+    ft.clear();
+    ft[NAME] = "wcachePoolPagesInUse";
+    ft[TYPE] = TYPE_U32;
+    ft[UNIT] = "wpage";
+    ft[DESC] = "Number of shared write page pool pages in use by journals";
+    buf.putMap(ft);
+
+    ft.clear();
+    ft[NAME] = "wcachePoolPagesInUseHigh";
+    ft[TYPE] = TYPE_U32;
+    ft[UNIT] = "wpage";
+    ft[DESC] = "Number of shared write page pool pages in use by journals (High)";
+    buf.putMap(ft);
+
+    ft.clear();
+    ft[NAME] = "wcachePoolPagesInUseLow";
+    ft[TYPE] = TYPE_U32;
+    ft[UNIT] = "wpage";
+    ft[DESC] = "Number of shared write page pool pages in use by journals (Low)";
+    buf.putMap(ft);
+
+    ft.clear();
+    ft[NAME] = "journalCacheBytes";
+    ft[TYPE] = TYPE_U64;
+    ft[UNIT] = "byte";
+    ft[DESC] = "Estimated memory used by the caches and buffers of all journals";
+    buf.putMap(ft);
+
+    ft.clear();
+    ft[NAME] = "journalCacheBytesHigh";
+    ft[TYPE] = TYPE_U64;
+    ft[UNIT] = "byte";
+    ft[DESC] = "Estimated memory used by the caches and buffers of all journals (High)";
+    buf.putMap(ft);
+
+    ft.clear();
+    ft[NAME] = "journalCacheBytesLow";
+    ft[TYPE] = TYPE_U64;
+    ft[UNIT] = "byte";
+    ft[DESC] = "Estimated memory used by the caches and buffers of all journals (Low)";
+    buf.putMap(ft);
+
+    ft.clear();
+    ft[NAME] = "journalIndexBytes";
+    ft[TYPE] = TYPE_U64;
+    ft[UNIT] = "byte";
+    ft[DESC] = "Estimated memory used by the enqueue and transaction indexes of all journals";
+    buf.putMap(ft);
+
+    ft.clear();
+    ft[NAME] = "journalIndexBytesHigh";
+    ft[TYPE] = TYPE_U64;
+    ft[UNIT] = "byte";
+    ft[DESC] = "Estimated memory used by the enqueue and transaction indexes of all journals (High)";
+    buf.putMap(ft);
+
+    ft.clear();
+    ft[NAME] = "journalIndexBytesLow";
+    ft[TYPE] = TYPE_U64;
+    ft[UNIT] = "byte";
+    ft[DESC] = "Estimated memory used by the enqueue and transaction indexes of all journals (Low)";
+    buf.putMap(ft);
+
 
     // Methods
 
@@ -436,6 +532,18 @@ void Store::writeStatistics (std::string& _sBuf, bool skipHeaders)
     buf.putLong(tplOutstandingAIOs);
     buf.putLong(tplOutstandingAIOsHigh);
     buf.putLong(tplOutstandingAIOsLow);
+    buf.putLong(wcachePoolPages);
+    buf.putLong(wcachePoolPagesHigh);
+    buf.putLong(wcachePoolPagesLow);
+    buf.putLong(wcachePoolPagesInUse);
+    buf.putLong(wcachePoolPagesInUseHigh);
+    buf.putLong(wcachePoolPagesInUseLow);
+    buf.putLongLong(journalCacheBytes);
+    buf.putLongLong(journalCacheBytesHigh);
+    buf.putLongLong(journalCacheBytesLow);
+    buf.putLongLong(journalIndexBytes);
+    buf.putLongLong(journalIndexBytesHigh);
+    buf.putLongLong(journalIndexBytesLow);
 
 
     // Maintenance of hi-lo statistics
@@ -443,6 +551,14 @@ void Store::writeStatistics (std::string& _sBuf, bool skipHeaders)
     tplTransactionDepthLow  = tplTransactionDepth;
     tplOutstandingAIOsHigh = tplOutstandingAIOs;
     tplOutstandingAIOsLow  = tplOutstandingAIOs;
+    wcachePoolPagesHigh = wcachePoolPages;
+    wcachePoolPagesLow  = wcachePoolPages;
+    wcachePoolPagesInUseHigh = wcachePoolPagesInUse;
+    wcachePoolPagesInUseLow  = wcachePoolPagesInUse;
+    journalCacheBytesHigh = journalCacheBytes;
+    journalCacheBytesLow  = journalCacheBytes;
+    journalIndexBytesHigh = journalIndexBytes;
+    journalIndexBytesLow  = journalIndexBytes;
 
 
 
@@ -527,6 +643,18 @@ void Store::mapEncodeValues (::qpid::types::Variant::Map& _map,
     _map["tplOutstandingAIOs"] = ::qpid::types::Variant(tplOutstandingAIOs);
     _map["tplOutstandingAIOsHigh"] = ::qpid::types::Variant(tplOutstandingAIOsHigh);
     _map["tplOutstandingAIOsLow"] = ::qpid::types::Variant(tplOutstandingAIOsLow);
+    _map["wcachePoolPages"] = ::qpid::types::Variant(wcachePoolPages);
+    _map["wcachePoolPagesHigh"] = ::qpid::types::Variant(wcachePoolPagesHigh);
+    _map["wcachePoolPagesLow"] = ::qpid::types::Variant(wcachePoolPagesLow);
+    _map["wcachePoolPagesInUse"] = ::qpid::types::Variant(wcachePoolPagesInUse);
+    _map["wcachePoolPagesInUseHigh"] = ::qpid::types::Variant(wcachePoolPagesInUseHigh);
+    _map["wcachePoolPagesInUseLow"] = ::qpid::types::Variant(wcachePoolPagesInUseLow);
+    _map["journalCacheBytes"] = ::qpid::types::Variant(journalCacheBytes);
+    _map["journalCacheBytesHigh"] = ::qpid::types::Variant(journalCacheBytesHigh);
+    _map["journalCacheBytesLow"] = ::qpid::types::Variant(journalCacheBytesLow);
+    _map["journalIndexBytes"] = ::qpid::types::Variant(journalIndexBytes);
+    _map["journalIndexBytesHigh"] = ::qpid::types::Variant(journalIndexBytesHigh);
+    _map["journalIndexBytesLow"] = ::qpid::types::Variant(journalIndexBytesLow);
 
 
     // Maintenance of hi-lo statistics
@@ -534,6 +662,14 @@ void Store::mapEncodeValues (::qpid::types::Variant::Map& _map,
     tplTransactionDepthLow  = tplTransactionDepth;
     tplOutstandingAIOsHigh = tplOutstandingAIOs;
     tplOutstandingAIOsLow  = tplOutstandingAIOs;
+    wcachePoolPagesHigh = wcachePoolPages;
+    wcachePoolPagesLow  = wcachePoolPages;
+    wcachePoolPagesInUseHigh = wcachePoolPagesInUse;
+    wcachePoolPagesInUseLow  = wcachePoolPagesInUse;
+    journalCacheBytesHigh = journalCacheBytes;
+    journalCacheBytesLow  = journalCacheBytes;
+    journalIndexBytesHigh = journalIndexBytes;
+    journalIndexBytesLow  = journalIndexBytes;
 
 
     }
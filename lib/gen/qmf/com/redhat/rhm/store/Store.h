@@ -68,6 +68,18 @@ class Store : public ::qpid::management::ManagementObject
     uint32_t  tplOutstandingAIOs;
     uint32_t  tplOutstandingAIOsHigh;
     uint32_t  tplOutstandingAIOsLow;
+    uint32_t  wcachePoolPages;
+    uint32_t  wcachePoolPagesHigh;
+    uint32_t  wcachePoolPagesLow;
+    uint32_t  wcachePoolPagesInUse;
+    uint32_t  wcachePoolPagesInUseHigh;
+    uint32_t  wcachePoolPagesInUseLow;
+    uint64_t  journalCacheBytes;
+    uint64_t  journalCacheBytesHigh;
+    uint64_t  journalCacheBytesLow;
+    uint64_t  journalIndexBytes;
+    uint64_t  journalIndexBytesHigh;
+    uint64_t  journalIndexBytesLow;
 
 
     // Per-Thread Statistics
@@ -286,6 +298,62 @@ class Store : public ::qpid::management::ManagementObject
             tplOutstandingAIOsLow = tplOutstandingAIOs;
         instChanged = true;
     }
+    inline void inc_wcachePoolPages (uint32_t by = 1) {
+        ::qpid::management::Mutex::ScopedLock mutex(accessLock);
+        wcachePoolPages += by;
+        if (wcachePoolPagesHigh < wcachePoolPages)
+            wcachePoolPagesHigh = wcachePoolPages;
+        instChanged = true;
+    }
+    inline void dec_wcachePoolPages (uint32_t by = 1) {
+        ::qpid::management::Mutex::ScopedLock mutex(accessLock);
+        wcachePoolPages -= by;
+        if (wcachePoolPagesLow > wcachePoolPages)
+            wcachePoolPagesLow = wcachePoolPages;
+        instChanged = true;
+    }
+    inline void inc_wcachePoolPagesInUse (uint32_t by = 1) {
+        ::qpid::management::Mutex::ScopedLock mutex(accessLock);
+        wcachePoolPagesInUse += by;
+        if (wcachePoolPagesInUseHigh < wcachePoolPagesInUse)
+            wcachePoolPagesInUseHigh = wcachePoolPagesInUse;
+        instChanged = true;
+    }
+    inline void dec_wcachePoolPagesInUse (uint32_t by = 1) {
+        ::qpid::management::Mutex::ScopedLock mutex(accessLock);
+        wcachePoolPagesInUse -= by;
+        if (wcachePoolPagesInUseLow > wcachePoolPagesInUse)
+            wcachePoolPagesInUseLow = wcachePoolPagesInUse;
+        instChanged = true;
+    }
+    inline void inc_journalCacheBytes (uint64_t by = 1) {
+        ::qpid::management::Mutex::ScopedLock mutex(accessLock);
+        journalCacheBytes += by;
+        if (journalCacheBytesHigh < journalCacheBytes)
+            journalCacheBytesHigh = journalCacheBytes;
+        instChanged = true;
+    }
+    inline void dec_journalCacheBytes (uint64_t by = 1) {
+        ::qpid::management::Mutex::ScopedLock mutex(accessLock);
+        journalCacheBytes -= by;
+        if (journalCacheBytesLow > journalCacheBytes)
+            journalCacheBytesLow = journalCacheBytes;
+        instChanged = true;
+    }
+    inline void inc_journalIndexBytes (uint64_t by = 1) {
+        ::qpid::management::Mutex::ScopedLock mutex(accessLock);
+        journalIndexBytes += by;
+        if (journalIndexBytesHigh < journalIndexBytes)
+            journalIndexBytesHigh = journalIndexBytes;
+        instChanged = true;
+    }
+    inline void dec_journalIndexBytes (uint64_t by = 1) {
+        ::qpid::management::Mutex::ScopedLock mutex(accessLock);
+        journalIndexBytes -= by;
+        if (journalIndexBytesLow > journalIndexBytes)
+            journalIndexBytesLow = journalIndexBytes;
+        instChanged = true;
+    }
 
 };
 
@@ -0,0 +1,142 @@
+/**
+ * \file codec.cpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * File containing code for class mrg::journal::codec (record data compression
+ * codec). See comments in file codec.hpp for details.
+ *
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#include "jrnl/codec.hpp"
+
+#include <cstring>
+#include <iomanip>
+#include "jrnl/jerrno.hpp"
+#include "jrnl/jexception.hpp"
+#include "jrnl/lzf_codec.hpp"
+#include <sstream>
+
+namespace mrg
+{
+namespace journal
+{
+
+static const lzf_codec _lzf_codec;
+
+const codec* codec::_registry[256];
+bool codec::_initialized = codec::__init();
+
+codec::~codec() {}
+
+void
+codec::register_codec(const codec* const cp)
+{
+    const u_int8_t cid = cp->id();
+    if (cid == 0 || (_registry[cid] && _registry[cid] != cp))
+    {
+        std::ostringstream oss;
+        oss << "codec=\"" << cp->name() << "\" id=" << (int)cid;
+        if (cid)
+            oss << " registered_codec=\"" << _registry[cid]->name() << "\"";
+        throw jexception(jerrno::JERR_CODEC_DUPLICATE, oss.str(), "codec", "register_codec");
+    }
+    _registry[cid] = cp;
+}
+
+const codec*
+codec::get(const u_int8_t codec_id)
+{
+    const codec* cp = _registry[codec_id];
+    if (cp == 0)
+    {
+        std::ostringstream oss;
+        oss << "id=" << (int)codec_id;
+        throw jexception(jerrno::JERR_CODEC_UNKNOWN, oss.str(), "codec", "get");
+    }
+    return cp;
+}
+
+std::size_t
+codec::pack(const codec* const cp, const void* const src, const std::size_t src_len, void* const dest,
+        const std::size_t dest_len)
+{
+    if (dest_len <= codec_hdr::size())
+        return 0;
+    const std::size_t clen = cp->compress(src, src_len, (char*)dest + codec_hdr::size(),
+            dest_len - codec_hdr::size());
+    if (clen == 0)
+        return 0;
+    codec_hdr ch(cp->id(), src_len);
+    std::memcpy(dest, &ch, codec_hdr::size());
+    return codec_hdr::size() + clen;
+}
+
+std::size_t
+codec::unpacked_size(const void* const src, const std::size_t src_len)
+{
+    if (src_len < codec_hdr::size())
+    {
+        std::ostringstream oss;
+        oss << "packed_size=" << src_len << " codec_hdr_size=" << codec_hdr::size();
+        throw jexception(jerrno::JERR_CODEC_BADHDR, oss.str(), "codec", "unpacked_size");
+    }
+    codec_hdr ch;
+    std::memcpy(&ch, src, codec_hdr::size());
+    return ch._usize;
+}
+
+void
+codec::unpack(const void* const src, const std::size_t src_len, void* const dest,
+        const std::size_t dest_len)
+{
+    codec_hdr ch;
+    if (src_len >= codec_hdr::size())
+        std::memcpy(&ch, src, codec_hdr::size());
+    if (src_len < codec_hdr::size() || ch._usize != dest_len)
+    {
+        std::ostringstream oss;
+        oss << "packed_size=" << src_len << " usize=" << ch._usize << " dest_len=" << dest_len;
+        throw jexception(jerrno::JERR_CODEC_BADHDR, oss.str(), "codec", "unpack");
+    }
+    const codec* cp = get(ch._codec_id);
+    if (!cp->decompress((const char*)src + codec_hdr::size(), src_len - codec_hdr::size(), dest,
+            dest_len))
+    {
+        std::ostringstream oss;
+        oss << "codec=\"" << cp->name() << "\" packed_size=" << src_len << " usize=" << dest_len;
+        throw jexception(jerrno::JERR_CODEC_DECOMPFAIL, oss.str(), "codec", "unpack");
+    }
+}
+
+// static initialization fn
+
+bool
+codec::__init()
+{
+    _registry[_lzf_codec.id()] = &_lzf_codec;
+    return true;
+}
+
+} // namespace journal
+} // namespace mrg
@@ -0,0 +1,161 @@
+/**
+ * \file codec.hpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * File containing code for class mrg::journal::codec (record data compression
+ * codec). See class documentation for details.
+ *
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#ifndef mrg_journal_codec_hpp
+#define mrg_journal_codec_hpp
+
+namespace mrg
+{
+namespace journal
+{
+class codec;
+}
+}
+
+#include <cstddef>
+#include <sys/types.h>
+
+namespace mrg
+{
+namespace journal
+{
+
+#pragma pack(1)
+
+    /**
+    * \brief Struct prefixed to the data portion of a compressed enqueue record. It identifies the
+    * codec used to compress the data and the size of the data once uncompressed. The size of the
+    * compressed data itself is the enqueue header dsize less the size of this struct.
+    *
+    * Compressed data header in binary format (16 bytes):
+    * <pre>
+    *   0                           7
+    * +---+---+---+---+---+---+---+---+
+    * | c |         filler            |
+    * +---+---+---+---+---+---+---+---+
+    * |          usize                |
+    * +---+---+---+---+---+---+---+---+
+    * </pre>
+    * c = codec id
+    */
+    struct codec_hdr
+    {
+        u_int8_t _codec_id;         ///< Id of codec used to compress the data
+        u_int8_t _filler[7];        ///< Little-endian filler to 64-bit boundary
+        u_int64_t _usize;           ///< Size of data once uncompressed
+
+        inline codec_hdr(): _codec_id(0), _usize(0) { for (int i=0; i<7; i++) _filler[i] = 0; }
+        inline codec_hdr(const u_int8_t codec_id, const u_int64_t usize):
+                _codec_id(codec_id), _usize(usize) { for (int i=0; i<7; i++) _filler[i] = 0; }
+        inline static std::size_t size() { return sizeof(codec_hdr); }
+    };
+
+#pragma pack()
+
+    /**
+    * \class codec
+    * \brief Abstract base for codecs used to compress enqueue record data.
+    *
+    * Each codec is identified by a one-byte id which is written into the codec_hdr of every record
+    * it compresses, so that the record can be decompressed on read or recovery regardless of the
+    * codec currently set on the journal. Codecs are stateless and are shared by all journals; they
+    * are held in a static registry which contains the built-in LZF codec (lzf_codec) at startup.
+    * Additional codecs may be added with register_codec() before any journal which uses them is
+    * recovered. Codec id 0 is reserved.
+    */
+    class codec
+    {
+    private:
+        static const codec* _registry[256];
+        static bool _initialized;
+        static bool __init();
+
+    public:
+        virtual ~codec();
+
+        virtual u_int8_t id() const = 0;
+        virtual const char* name() const = 0;
+
+        /**
+        * \brief Compress src_len bytes at src into dest.
+        *
+        * \return Number of bytes written to dest, or 0 if the compressed data will not fit into
+        *     dest_len bytes (in which case the data should be stored uncompressed).
+        */
+        virtual std::size_t compress(const void* const src, const std::size_t src_len, void* const dest,
+                const std::size_t dest_len) const = 0;
+
+        /**
+        * \brief Decompress src_len bytes at src into dest, which must be exactly dest_len bytes.
+        *
+        * \return <b><i>true</i></b> if the data decompressed to exactly dest_len bytes;
+        *     <b><i>false</i></b> if the data is corrupt.
+        */
+        virtual bool decompress(const void* const src, const std::size_t src_len, void* const dest,
+                const std::size_t dest_len) const = 0;
+
+        /**
+        * \brief Add a codec to the registry. The codec must remain valid for the life of the
+        *     process. Throws JERR_CODEC_DUPLICATE if the id is already in use.
+        */
+        static void register_codec(const codec* const cp);
+
+        /**
+        * \brief Find a codec by id. Throws JERR_CODEC_UNKNOWN if no such codec is registered.
+        */
+        static const codec* get(const u_int8_t codec_id);
+
+        /**
+        * \brief Compress src into dest, prefixing the result with a codec_hdr.
+        *
+        * \return Total number of bytes written to dest (including the codec_hdr), or 0 if the
+        *     result will not fit into dest_len bytes.
+        */
+        static std::size_t pack(const codec* const cp, const void* const src, const std::size_t src_len,
+                void* const dest, const std::size_t dest_len);
+
+        /**
+        * \brief Return the uncompressed size of packed data src. Throws JERR_CODEC_BADHDR if
+        *     src_len is too small to contain a codec_hdr.
+        */
+        static std::size_t unpacked_size(const void* const src, const std::size_t src_len);
+
+        /**
+        * \brief Decompress packed data src into dest, which must be unpacked_size() bytes long.
+        *     Throws JERR_CODEC_UNKNOWN or JERR_CODEC_DECOMPFAIL on failure.
+        */
+        static void unpack(const void* const src, const std::size_t src_len, void* const dest,
+                const std::size_t dest_len);
+    }; // class codec
+
+} // namespace journal
+} // namespace mrg
+
+#endif // ifndef mrg_journal_codec_hpp
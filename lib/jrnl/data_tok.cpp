@@ -177,12 +177,13 @@ data_tok::status_str() const
     oss << std::hex << std::setfill('0');
     oss << "dtok id=0x" << _icnt << "; ws=" << wstate_str() << "; rs=" << rstate_str();
     oss << "; fid=0x" << _fid << "; rid=0x" << _rid << "; xid=";
-    for (unsigned i=0; i<_xid.size(); i++)
+    const std::string& xid = _xid.str();
+    for (unsigned i=0; i<xid.size(); i++)
     {
-        if (isprint(_xid[i]))
-            oss << _xid[i];
+        if (isprint(xid[i]))
+            oss << xid[i];
         else
-            oss << "/" << std::setw(2) << (int)((char)_xid[i]);
+            oss << "/" << std::setw(2) << (int)((char)xid[i]);
     }
     oss << "; drid=0x" << _dequeue_rid << " extrid=" << (_external_rid?"T":"F");
     oss << "; ds=0x" << _dsize << "; dw=0x" << _dblks_written << "; dr=0x" << _dblks_read;
@@ -44,6 +44,7 @@ class data_tok;
 #include <cassert>
 #include <cstddef>
 #include "jrnl/smutex.hpp"
+#include "jrnl/xid_handle.hpp"
 #include <pthread.h>
 #include <string>
 #include <sys/types.h>
@@ -106,7 +107,7 @@ namespace journal
         u_int32_t   _pg_cnt;        ///< Page counter - incr for each page containing part of data
         u_int16_t   _fid;           ///< FID containing header of enqueue record
         u_int64_t   _rid;           ///< RID of data set by enqueue operation
-        std::string _xid;           ///< XID set by enqueue operation
+        xid_handle _xid;            ///< XID set by enqueue operation
         u_int64_t   _dequeue_rid;   ///< RID of data set by dequeue operation
         bool        _external_rid;  ///< Flag to indicate external setting of rid
 
@@ -154,11 +155,12 @@ namespace journal
         inline void set_external_rid(const bool external_rid) { _external_rid = external_rid; }
 
         inline bool has_xid() const { return !_xid.empty(); }
-        inline const std::string& xid() const { return _xid; }
+        inline const xid_handle& xid() const { return _xid; }
         inline void clear_xid() { _xid.clear(); }
-        inline void set_xid(const std::string& xid) { _xid.assign(xid); }
+        inline void set_xid(const xid_handle& xid) { _xid = xid; }
+        inline void set_xid(const std::string& xid) { _xid = xid_handle(xid); }
         inline void set_xid(const void* xidp, const std::size_t xid_len)
-                { _xid.assign((const char*)xidp, xid_len); }
+                { _xid = xid_handle(xidp, xid_len); }
 
         void reset();
 
@@ -91,6 +91,7 @@ namespace journal
 #endif
         static const u_int16_t ENQ_HDR_TRANSIENT_MASK = 0x10;
         static const u_int16_t ENQ_HDR_EXTERNAL_MASK = 0x20;
+        static const u_int16_t ENQ_HDR_COMPRESSED_MASK = 0x40;
 
         /**
         * \brief Default constructor, which sets all values to 0.
@@ -151,6 +152,17 @@ namespace journal
                     _uflag & (~ENQ_HDR_EXTERNAL_MASK);
         }
 
+        /**
+        * \brief Data is prefixed with a codec_hdr and compressed; dsize is the compressed size.
+        */
+        inline bool is_compressed() const { return _uflag & ENQ_HDR_COMPRESSED_MASK; }
+
+        inline void set_compressed(const bool compressed)
+        {
+            _uflag = compressed ? _uflag | ENQ_HDR_COMPRESSED_MASK :
+                    _uflag & (~ENQ_HDR_COMPRESSED_MASK);
+        }
+
         /**
         * \brief Returns the size of the header in bytes.
         */
@@ -32,6 +32,7 @@
 
 #include "jrnl/enq_map.hpp"
 
+#include <algorithm>
 #include <iomanip>
 #include "jrnl/jerrno.hpp"
 #include "jrnl/slock.hpp"
@@ -52,7 +53,6 @@ int16_t enq_map::EMAP_FALSE = 0;
 int16_t enq_map::EMAP_TRUE = 1;
 
 enq_map::enq_map():
-        _map(),
         _pfid_enq_cnt()
 {}
 
@@ -76,22 +76,24 @@ enq_map::insert_pfid(const u_int64_t rid, const u_int16_t pfid, const bool locke
 {
     std::pair<emap_itr, bool> ret;
     emap_data_struct rec(pfid, locked);
+    emap_stripe& st = stripe(rid);
     {
-        slock s(_mutex);
-        ret = _map.insert(emap_param(rid, rec));
+        slock s(st._mutex);
+        ret = st._map.insert(emap_param(rid, rec));
     }
     if (ret.second == false)
         return EMAP_DUP_RID;
-    _pfid_enq_cnt.at(pfid)++;
+    __sync_add_and_fetch(&_pfid_enq_cnt.at(pfid), 1);
     return EMAP_OK;
 }
 
 int16_t
 enq_map::get_pfid(const u_int64_t rid)
 {
-    slock s(_mutex);
-    emap_itr itr = _map.find(rid);
-    if (itr == _map.end()) // not found in map
+    emap_stripe& st = stripe(rid);
+    slock s(st._mutex);
+    emap_itr itr = st._map.find(rid);
+    if (itr == st._map.end()) // not found in map
         return EMAP_RID_NOT_FOUND;
     if (itr->second._lock)
         return EMAP_LOCKED;
@@ -101,24 +103,29 @@ enq_map::get_pfid(const u_int64_t rid)
 int16_t
 enq_map::get_remove_pfid(const u_int64_t rid, const bool txn_flag)
 {
-    slock s(_mutex);
-    emap_itr itr = _map.find(rid);
-    if (itr == _map.end()) // not found in map
-        return EMAP_RID_NOT_FOUND;
-    if (itr->second._lock && !txn_flag) // locked, but not a commit/abort
-        return EMAP_LOCKED;
-    u_int16_t pfid = itr->second._pfid;
-    _map.erase(itr);
-    _pfid_enq_cnt.at(pfid)--;
+    u_int16_t pfid;
+    emap_stripe& st = stripe(rid);
+    {
+        slock s(st._mutex);
+        emap_itr itr = st._map.find(rid);
+        if (itr == st._map.end()) // not found in map
+            return EMAP_RID_NOT_FOUND;
+        if (itr->second._lock && !txn_flag) // locked, but not a commit/abort
+            return EMAP_LOCKED;
+        pfid = itr->second._pfid;
+        st._map.erase(itr);
+    }
+    __sync_sub_and_fetch(&_pfid_enq_cnt.at(pfid), 1);
     return pfid;
 }
 
 bool
 enq_map::is_enqueued(const u_int64_t rid, bool ignore_lock)
 {
-    slock s(_mutex);
-    emap_itr itr = _map.find(rid);
-    if (itr == _map.end()) // not found in map
+    emap_stripe& st = stripe(rid);
+    slock s(st._mutex);
+    emap_itr itr = st._map.find(rid);
+    if (itr == st._map.end()) // not found in map
         return false;
     if (!ignore_lock && itr->second._lock) // locked
         return false;
@@ -128,9 +135,10 @@ enq_map::is_enqueued(const u_int64_t rid, bool ignore_lock)
 int16_t
 enq_map::lock(const u_int64_t rid)
 {
-    slock s(_mutex);
-    emap_itr itr = _map.find(rid);
-    if (itr == _map.end()) // not found in map
+    emap_stripe& st = stripe(rid);
+    slock s(st._mutex);
+    emap_itr itr = st._map.find(rid);
+    if (itr == st._map.end()) // not found in map
         return EMAP_RID_NOT_FOUND;
     itr->second._lock = true;
     return EMAP_OK;
@@ -139,9 +147,10 @@ enq_map::lock(const u_int64_t rid)
 int16_t
 enq_map::unlock(const u_int64_t rid)
 {
-    slock s(_mutex);
-    emap_itr itr = _map.find(rid);
-    if (itr == _map.end()) // not found in map
+    emap_stripe& st = stripe(rid);
+    slock s(st._mutex);
+    emap_itr itr = st._map.find(rid);
+    if (itr == st._map.end()) // not found in map
         return EMAP_RID_NOT_FOUND;
     itr->second._lock = false;
     return EMAP_OK;
@@ -150,33 +159,142 @@ enq_map::unlock(const u_int64_t rid)
 int16_t
 enq_map::is_locked(const u_int64_t rid)
 {
-    slock s(_mutex);
-    emap_itr itr = _map.find(rid);
-    if (itr == _map.end()) // not found in map
+    emap_stripe& st = stripe(rid);
+    slock s(st._mutex);
+    emap_itr itr = st._map.find(rid);
+    if (itr == st._map.end()) // not found in map
         return EMAP_RID_NOT_FOUND;
     return itr->second._lock ? EMAP_TRUE : EMAP_FALSE;
 }
 
+// Returns the number of records in the map with a rid in the range first_rid to last_rid
+// (inclusive); locked is set true if any of them is locked.
+u_int32_t
+enq_map::range_cnt(const u_int64_t first_rid, const u_int64_t last_rid, bool& locked)
+{
+    u_int32_t cnt = 0;
+    locked = false;
+    for (int i = 0; i < JRNL_MAP_STRIPES; i++)
+    {
+        emap_stripe& st = _stripes[i];
+        slock s(st._mutex);
+        for (emap_itr itr = st._map.lower_bound(first_rid); itr != st._map.end() && itr->first <= last_rid; itr++)
+        {
+            if (itr->second._lock)
+                locked = true;
+            cnt++;
+        }
+    }
+    return cnt;
+}
+
+// Removes all unlocked records with a rid in the range first_rid to last_rid (inclusive) from the
+// map. The number of records removed from each pfid is added to pfid_cnt (indexed by pfid), and
+// the total number of records removed is returned.
+u_int32_t
+enq_map::remove_range(const u_int64_t first_rid, const u_int64_t last_rid, std::vector<u_int32_t>& pfid_cnt)
+{
+    u_int32_t cnt = 0;
+    pfid_cnt.resize(_pfid_enq_cnt.size(), 0);
+    for (int i = 0; i < JRNL_MAP_STRIPES; i++)
+    {
+        emap_stripe& st = _stripes[i];
+        slock s(st._mutex);
+        emap_itr itr = st._map.lower_bound(first_rid);
+        while (itr != st._map.end() && itr->first <= last_rid)
+        {
+            if (itr->second._lock)
+            {
+                itr++;
+                continue;
+            }
+            const u_int16_t pfid = itr->second._pfid;
+            __sync_sub_and_fetch(&_pfid_enq_cnt.at(pfid), 1);
+            pfid_cnt.at(pfid)++;
+            st._map.erase(itr++);
+            cnt++;
+        }
+    }
+    return cnt;
+}
+
 void
-enq_map::rid_list(std::vector<u_int64_t>& rv)
+enq_map::clear()
 {
-    rv.clear();
+    for (int i = 0; i < JRNL_MAP_STRIPES; i++)
     {
-        slock s(_mutex);
-        for (emap_itr itr = _map.begin(); itr != _map.end(); itr++)
-            rv.push_back(itr->first);
+        slock s(_stripes[i]._mutex);
+        _stripes[i]._map.clear();
     }
 }
 
+bool
+enq_map::empty() const
+{
+    for (int i = 0; i < JRNL_MAP_STRIPES; i++)
+    {
+        slock s(_stripes[i]._mutex);
+        if (!_stripes[i]._map.empty())
+            return false;
+    }
+    return true;
+}
+
+u_int32_t
+enq_map::size() const
+{
+    u_int32_t cnt = 0;
+    for (int i = 0; i < JRNL_MAP_STRIPES; i++)
+    {
+        slock s(_stripes[i]._mutex);
+        cnt += u_int32_t(_stripes[i]._map.size());
+    }
+    return cnt;
+}
+
+std::size_t
+enq_map::mem_bytes() const
+{
+    return size() * (sizeof(emap::value_type) + JRNL_MAP_NODE_OVERHEAD) +
+            _pfid_enq_cnt.capacity() * sizeof(u_int32_t);
+}
+
+void
+enq_map::rid_list(std::vector<u_int64_t>& rv)
+{
+    std::vector<std::pair<u_int64_t, u_int16_t> > lv;
+    sorted_list(lv);
+    rv.clear();
+    rv.reserve(lv.size());
+    for (std::vector<std::pair<u_int64_t, u_int16_t> >::const_iterator itr = lv.begin(); itr != lv.end(); itr++)
+        rv.push_back(itr->first);
+}
+
 void
 enq_map::pfid_list(std::vector<u_int16_t>& fv)
 {
+    std::vector<std::pair<u_int64_t, u_int16_t> > lv;
+    sorted_list(lv);
     fv.clear();
+    fv.reserve(lv.size());
+    for (std::vector<std::pair<u_int64_t, u_int16_t> >::const_iterator itr = lv.begin(); itr != lv.end(); itr++)
+        fv.push_back(itr->second);
+}
+
+// Collects (rid, pfid) pairs from all stripes in rid order, so that the rid and pfid lists keep
+// the ordering of a single map.
+void
+enq_map::sorted_list(std::vector<std::pair<u_int64_t, u_int16_t> >& lv)
+{
+    lv.clear();
+    for (int i = 0; i < JRNL_MAP_STRIPES; i++)
     {
-        slock s(_mutex);
-        for (emap_itr itr = _map.begin(); itr != _map.end(); itr++)
-            fv.push_back(itr->second._pfid);
+        emap_stripe& st = _stripes[i];
+        slock s(st._mutex);
+        for (emap_citr itr = st._map.begin(); itr != st._map.end(); itr++)
+            lv.push_back(std::make_pair(itr->first, itr->second._pfid));
     }
+    std::sort(lv.begin(), lv.end());
 }
 
 } // namespace journal
@@ -41,6 +41,7 @@ class enq_map;
 }
 }
 
+#include "jrnl/jcfg.hpp"
 #include "jrnl/jexception.hpp"
 #include "jrnl/smutex.hpp"
 #include <map>
@@ -71,6 +72,11 @@ namespace journal
     *   rid3 --- [ pfid, txn_lock ]
     *   ...
     * </pre>
+    *
+    * The map is split into JRNL_MAP_STRIPES stripes selected by a hash of the rid, each with its
+    * own mutex, so that AIO completion processing and lookups do not contend with enqueues on
+    * other rids. Operations on a single rid lock only one stripe; whole-map operations (ranges
+    * and lists) visit each stripe in turn.
     */
     class enq_map
     {
@@ -94,9 +100,15 @@ namespace journal
         typedef std::pair<u_int64_t, emap_data_struct> emap_param;
         typedef std::map<u_int64_t, emap_data_struct> emap;
         typedef emap::iterator emap_itr;
+        typedef emap::const_iterator emap_citr;
+
+        struct emap_stripe
+        {
+            emap _map;
+            smutex _mutex;
+        };
 
-        emap _map;
-        smutex _mutex;
+        emap_stripe _stripes[JRNL_MAP_STRIPES];
         std::vector<u_int32_t> _pfid_enq_cnt;
 
     public:
@@ -114,11 +126,21 @@ namespace journal
         int16_t lock(const u_int64_t rid); // 0=ok; -1=rid not found
         int16_t unlock(const u_int64_t rid); // 0=ok; -1=rid not found
         int16_t is_locked(const u_int64_t rid); // 1=true; 0=false; -1=rid not found
-        inline void clear() { _map.clear(); }
-        inline bool empty() const { return _map.empty(); }
-        inline u_int32_t size() const { return u_int32_t(_map.size()); }
+        u_int32_t range_cnt(const u_int64_t first_rid, const u_int64_t last_rid, bool& locked);
+        u_int32_t remove_range(const u_int64_t first_rid, const u_int64_t last_rid,
+                std::vector<u_int32_t>& pfid_cnt);
+        void clear();
+        bool empty() const;
+        u_int32_t size() const;
+        std::size_t mem_bytes() const; // Estimated heap memory held by the map
         void rid_list(std::vector<u_int64_t>& rv);
         void pfid_list(std::vector<u_int16_t>& fv);
+
+    private:
+        // Rids are usually allocated sequentially, so mix the bits before selecting a stripe
+        inline emap_stripe& stripe(const u_int64_t rid)
+        { return _stripes[((rid * 0x9e3779b97f4a7c15ULL) >> 32) & (JRNL_MAP_STRIPES - 1)]; }
+        void sorted_list(std::vector<std::pair<u_int64_t, u_int16_t> >& lv);
     };
 
 } // namespace journal
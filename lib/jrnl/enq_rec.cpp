@@ -37,6 +37,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <iomanip>
+#include "jrnl/codec.hpp"
 #include "jrnl/jerrno.hpp"
 #include "jrnl/jexception.hpp"
 #include <sstream>
@@ -53,6 +54,7 @@ enq_rec::enq_rec():
         _xidp(0),
         _data(0),
         _buff(0),
+        _rbufp(0),
         _enq_tail(_enq_hdr)
 {}
 
@@ -64,6 +66,7 @@ enq_rec::enq_rec(const u_int64_t rid, const void* const dbuf, const std::size_t
         _xidp(xidp),
         _data(dbuf),
         _buff(0),
+        _rbufp(0),
         _enq_tail(_enq_hdr)
 {}
 
@@ -75,16 +78,18 @@ enq_rec::~enq_rec()
 // Prepare instance for use in reading data from journal, where buf contains preallocated space
 // to receive data.
 void
-enq_rec::reset()
+enq_rec::reset(rd_buf* const rbp)
 {
     _enq_hdr._rid = 0;
     _enq_hdr.set_owi(false);
     _enq_hdr.set_transient(false);
+    _enq_hdr.set_compressed(false);
     _enq_hdr._xidsize = 0;
     _enq_hdr._dsize = 0;
     _xidp = 0;
     _data = 0;
     _buff = 0;
+    _rbufp = rbp;
     _enq_tail._rid = 0;
 }
 
@@ -93,17 +98,19 @@ enq_rec::reset()
 void
 enq_rec::reset(const u_int64_t rid, const void* const dbuf, const std::size_t dlen,
         const void* const xidp, const std::size_t xidlen, const bool owi, const bool transient,
-        const bool external)
+        const bool external, const bool compressed)
 {
     _enq_hdr._rid = rid;
     _enq_hdr.set_owi(owi);
     _enq_hdr.set_transient(transient);
     _enq_hdr.set_external(external);
+    _enq_hdr.set_compressed(compressed);
     _enq_hdr._xidsize = xidlen;
     _enq_hdr._dsize = dlen;
     _xidp = xidp;
     _data = dbuf;
     _buff = 0;
+    _rbufp = 0;
     _enq_tail._rid = rid;
 }
 
@@ -373,7 +380,8 @@ enq_rec::decode(rec_hdr& h, void* rptr, u_int32_t rec_offs_dblks, u_int32_t max_
         chk_hdr();
         if (_enq_hdr._xidsize + (_enq_hdr.is_external() ? 0 : _enq_hdr._dsize))
         {
-            _buff = std::malloc(_enq_hdr._xidsize + (_enq_hdr.is_external() ? 0 : _enq_hdr._dsize));
+            const std::size_t buff_size = _enq_hdr._xidsize + (_enq_hdr.is_external() ? 0 : _enq_hdr._dsize);
+            _buff = _rbufp ? _rbufp->reserve(buff_size) : std::malloc(buff_size);
             MALLOC_CHK(_buff, "_buff", "enq_rec", "decode");
 
             const u_int32_t hdr_xid_size = enq_hdr::size() + _enq_hdr._xidsize;
@@ -450,6 +458,36 @@ enq_rec::decode(rec_hdr& h, void* rptr, u_int32_t rec_offs_dblks, u_int32_t max_
     return size_dblks(rd_cnt);
 }
 
+u_int32_t
+enq_rec::decode_in_place(rec_hdr& h, void* rptr)
+{
+    assert(rptr != 0);
+
+    _enq_hdr.hdr_copy(h);
+    std::size_t rd_cnt = sizeof(rec_hdr);
+#if defined(JRNL_BIG_ENDIAN) && defined(JRNL_32_BIT)
+    rd_cnt += sizeof(u_int32_t); // Filler 0
+#endif
+    _enq_hdr._xidsize = *(std::size_t*)((char*)rptr + rd_cnt);
+    rd_cnt += sizeof(std::size_t);
+#if defined(JRNL_LITTLE_ENDIAN) && defined(JRNL_32_BIT)
+    rd_cnt += sizeof(u_int32_t); // Filler 0
+#endif
+#if defined(JRNL_BIG_ENDIAN) && defined(JRNL_32_BIT)
+    rd_cnt += sizeof(u_int32_t); // Filler 1
+#endif
+    _enq_hdr._dsize = *(std::size_t*)((char*)rptr + rd_cnt);
+    rd_cnt = _enq_hdr.size();
+    chk_hdr();
+    const std::size_t xid_data_size = _enq_hdr._xidsize + (_enq_hdr.is_external() ? 0 : _enq_hdr._dsize);
+    _buff = xid_data_size ? (char*)rptr + rd_cnt : 0;
+    rd_cnt += xid_data_size;
+    std::memcpy((void*)&_enq_tail, (char*)rptr + rd_cnt, sizeof(_enq_tail));
+    chk_tail();
+    rd_cnt += sizeof(_enq_tail);
+    return size_dblks(rd_cnt);
+}
+
 bool
 enq_rec::rcv_decode(rec_hdr h, std::ifstream* ifsp, std::size_t& rec_offs)
 {
@@ -565,6 +603,45 @@ enq_rec::get_data(void** const datapp)
     return _enq_hdr._dsize;
 }
 
+void
+enq_rec::decompress()
+{
+    if (!_enq_hdr.is_compressed() || _enq_hdr.is_external() || !_buff)
+        return;
+    const void* const cdata = (char*)_buff + _enq_hdr._xidsize;
+    std::size_t usize = 0;
+    void* ubuff = 0;
+    try
+    {
+        usize = codec::unpacked_size(cdata, _enq_hdr._dsize);
+        const std::size_t ubuff_size = _enq_hdr._xidsize + (usize ? usize : 1);
+        ubuff = _rbufp ? _rbufp->reserve_spare(ubuff_size) : std::malloc(ubuff_size);
+        MALLOC_CHK(ubuff, "ubuff", "enq_rec", "decompress");
+        if (_enq_hdr._xidsize)
+            std::memcpy(ubuff, _buff, _enq_hdr._xidsize);
+        codec::unpack(cdata, _enq_hdr._dsize, (char*)ubuff + _enq_hdr._xidsize, usize);
+    }
+    catch (const jexception&)
+    {
+        // The caller never receives _buff if the read throws, so release it here (a caller's buffer
+        // is kept for the next read)
+        if (!_rbufp)
+        {
+            std::free(ubuff);
+            std::free(_buff);
+        }
+        _buff = 0;
+        throw;
+    }
+    if (_rbufp)
+        _rbufp->swap();
+    else
+        std::free(_buff);
+    _buff = ubuff;
+    _enq_hdr._dsize = usize;
+    _enq_hdr.set_compressed(false);
+}
+
 std::string&
 enq_rec::str(std::string& str) const
 {
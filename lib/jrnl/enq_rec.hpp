@@ -42,6 +42,7 @@ class enq_rec;
 #include <cstddef>
 #include "jrnl/enq_hdr.hpp"
 #include "jrnl/jrec.hpp"
+#include "jrnl/rd_buf.hpp"
 
 namespace mrg
 {
@@ -59,6 +60,7 @@ namespace journal
         const void* _xidp;          ///< xid pointer for encoding (for writing to disk)
         const void* _data;          ///< Pointer to data to be written to disk
         void* _buff;                ///< Pointer to buffer to receive data read from disk
+        rd_buf* _rbufp;             ///< Caller's buffer in which _buff is placed, 0 to allocate _buff
         rec_tail _enq_tail;
 
     public:
@@ -78,16 +80,21 @@ namespace journal
         */
         virtual ~enq_rec();
 
-        // Prepare instance for use in reading data from journal, xid and data will be allocated
-        void reset();
-        // Prepare instance for use in writing data to journal
+        // Prepare instance for use in reading data from journal, xid and data will be placed in rbp
+        // if supplied, otherwise allocated
+        void reset(rd_buf* const rbp = 0);
+        // Prepare instance for use in writing data to journal; if compressed, dbuf/dlen is packed
+        // data (see codec::pack())
         void reset(const u_int64_t rid, const void* const dbuf, const std::size_t dlen,
                 const void* const xidp, const std::size_t xidlen, const bool owi, const bool transient,
-                const bool external);
+                const bool external, const bool compressed = false);
 
         u_int32_t encode(void* wptr, u_int32_t rec_offs_dblks, u_int32_t max_size_dblks);
         u_int32_t decode(rec_hdr& h, void* rptr, u_int32_t rec_offs_dblks,
                 u_int32_t max_size_dblks);
+        // Decode a complete record at rptr without copying it; get_xid() and get_data() then return
+        // pointers into rptr, which must not be freed
+        u_int32_t decode_in_place(rec_hdr& h, void* rptr);
         // Decode used for recover
         bool rcv_decode(rec_hdr h, std::ifstream* ifsp, std::size_t& rec_offs);
 
@@ -95,6 +102,9 @@ namespace journal
         std::size_t get_data(void** const datapp);
         inline bool is_transient() const { return _enq_hdr.is_transient(); }
         inline bool is_external() const { return _enq_hdr.is_external(); }
+        inline bool is_compressed() const { return _enq_hdr.is_compressed(); }
+        // Replace compressed data read from journal with uncompressed data
+        void decompress();
         std::string& str(std::string& str) const;
         inline std::size_t data_size() const { return _enq_hdr._dsize; }
         inline std::size_t xid_size() const { return _enq_hdr._xidsize; }
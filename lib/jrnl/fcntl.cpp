@@ -38,7 +38,9 @@
 #include <iomanip>
 #include "jrnl/jerrno.hpp"
 #include "jrnl/jexception.hpp"
+#include "jrnl/slock.hpp"
 #include <sstream>
+#include <sys/mman.h>
 #include <unistd.h>
 
 namespace mrg
@@ -53,9 +55,11 @@ fcntl::fcntl(const std::string& fbasename, const u_int16_t pfid, const u_int16_t
         _lfid(lfid),
         _ffull_dblks(JRNL_SBLK_SIZE * (jfsize_sblks + 1)),
         _wr_fh(-1),
+        _rd_fh(-1),
+        _reset_cnt(0),
+        _rd_map(0),
+        _rd_pin_cnt(0),
         _rec_enqcnt(0),
-        _rd_subm_cnt_dblks(0),
-        _rd_cmpl_cnt_dblks(0),
         _wr_subm_cnt_dblks(0),
         _wr_cmpl_cnt_dblks(0),
         _aio_cnt(0),
@@ -67,23 +71,17 @@ fcntl::fcntl(const std::string& fbasename, const u_int16_t pfid, const u_int16_t
 
 fcntl::~fcntl()
 {
+    close_rd_fh();
     close_wr_fh();
 }
 
 bool
 fcntl::reset(const rcvdat* const ro)
 {
-    rd_reset();
+    _reset_cnt++; // Invalidates the position of any reader of this file
     return wr_reset(ro);
 }
 
-void
-fcntl::rd_reset()
-{
-    _rd_subm_cnt_dblks = 0;
-    _rd_cmpl_cnt_dblks = 0;
-}
-
 bool
 fcntl::wr_reset(const rcvdat* const ro)
 {
@@ -105,9 +103,9 @@ fcntl::wr_reset(const rcvdat* const ro)
             return true;
         }
     }
-    // Journal overflow test - checks if the file to be reset still contains enqueued records
-    // or outstanding aios
-    if (_rec_enqcnt || _aio_cnt)
+    // Journal overflow test - checks if the file to be reset still contains enqueued records,
+    // outstanding aios or data pinned by readers
+    if (_rec_enqcnt || _aio_cnt || _rd_pin_cnt)
         return false;
     _wr_subm_cnt_dblks = 0;
     _wr_cmpl_cnt_dblks = 0;
@@ -140,6 +138,61 @@ fcntl::close_wr_fh()
     }
 }
 
+int
+fcntl::open_rd_fh()
+{
+    slock s(_rd_fh_mutex);
+    if (_rd_fh < 0)
+    {
+        _rd_fh = ::open(_fname.c_str(), O_RDONLY | O_DIRECT);
+        if (_rd_fh < 0)
+        {
+            std::ostringstream oss;
+            oss << "pfid=" << _pfid << " lfid=" << _lfid << " file=\"" << _fname << "\"" << FORMAT_SYSERR(errno);
+            throw jexception(jerrno::JERR_FCNTL_OPENRD, oss.str(), "fcntl", "open_rd_fh");
+        }
+    }
+    return _rd_fh;
+}
+
+// The whole file is mapped, as its size is fixed. Data in the mapping is only coherent with data written through
+// _wr_fh (which uses O_DIRECT) once the write AIO has completed, as the kernel invalidates cached pages of the
+// written range on completion; readers must therefore never read past wr_cmpl_cnt_dblks().
+const char*
+fcntl::map_rd()
+{
+    open_rd_fh();
+    slock s(_rd_fh_mutex);
+    if (!_rd_map)
+    {
+        void* const mp = ::mmap(0, _ffull_dblks * JRNL_DBLK_SIZE, PROT_READ, MAP_SHARED, _rd_fh, 0);
+        if (mp == MAP_FAILED)
+        {
+            std::ostringstream oss;
+            oss << "pfid=" << _pfid << " lfid=" << _lfid << " file=\"" << _fname << "\"" << FORMAT_SYSERR(errno);
+            throw jexception(jerrno::JERR_FCNTL_MMAP, oss.str(), "fcntl", "map_rd");
+        }
+        _rd_map = mp;
+    }
+    return (const char*)_rd_map;
+}
+
+void
+fcntl::close_rd_fh()
+{
+    slock s(_rd_fh_mutex);
+    if (_rd_map)
+    {
+        ::munmap(_rd_map, _ffull_dblks * JRNL_DBLK_SIZE);
+        _rd_map = 0;
+    }
+    if (_rd_fh >= 0)
+    {
+        ::close(_rd_fh);
+        _rd_fh = -1;
+    }
+}
+
 u_int32_t
 fcntl::add_enqcnt(u_int32_t a)
 {
@@ -172,34 +225,6 @@ fcntl::subtr_enqcnt(u_int32_t s)
     return _rec_enqcnt;
 }
 
-u_int32_t
-fcntl::add_rd_subm_cnt_dblks(u_int32_t a)
-{
-    if (_rd_subm_cnt_dblks + a > _wr_subm_cnt_dblks)
-    {
-        std::ostringstream oss;
-        oss << "pfid=" << _pfid << " lfid=" << _lfid << " rd_subm_cnt_dblks=" << _rd_subm_cnt_dblks << " incr=" << a;
-        oss << " wr_subm_cnt_dblks=" << _wr_subm_cnt_dblks;
-        throw jexception(jerrno::JERR_FCNTL_RDOFFSOVFL, oss.str(), "fcntl", "add_rd_subm_cnt_dblks");
-    }
-    _rd_subm_cnt_dblks += a;
-    return _rd_subm_cnt_dblks;
-}
-
-u_int32_t
-fcntl::add_rd_cmpl_cnt_dblks(u_int32_t a)
-{
-    if (_rd_cmpl_cnt_dblks + a > _rd_subm_cnt_dblks)
-    {
-        std::ostringstream oss;
-        oss << "pfid=" << _pfid << " lfid=" << _lfid << " rd_cmpl_cnt_dblks=" << _rd_cmpl_cnt_dblks << " incr=" << a;
-        oss << " rd_subm_cnt_dblks=" << _rd_subm_cnt_dblks;
-        throw jexception(jerrno::JERR_FCNTL_CMPLOFFSOVFL, oss.str(), "fcntl", "add_rd_cmpl_cnt_dblks");
-    }
-    _rd_cmpl_cnt_dblks += a;
-    return _rd_cmpl_cnt_dblks;
-}
-
 u_int32_t
 fcntl::add_wr_subm_cnt_dblks(u_int32_t a)
 {
@@ -246,8 +271,8 @@ fcntl::status_str() const
 {
     std::ostringstream oss;
     oss << "pfid=" << _pfid << " ws=" << _wr_subm_cnt_dblks << " wc=" << _wr_cmpl_cnt_dblks;
-    oss << " rs=" << _rd_subm_cnt_dblks << " rc=" << _rd_cmpl_cnt_dblks;
-    oss << " ec=" << _rec_enqcnt << " ac=" << _aio_cnt;
+    oss << " rst=" << _reset_cnt;
+    oss << " ec=" << _rec_enqcnt << " ac=" << _aio_cnt << " pc=" << _rd_pin_cnt;
     return oss.str();
 }
 
@@ -45,6 +45,7 @@ class fcntl;
 #include <cstddef>
 #include <string>
 #include "jrnl/rcvdat.hpp"
+#include "jrnl/smutex.hpp"
 #include <sys/types.h>
 
 namespace mrg
@@ -55,6 +56,16 @@ namespace journal
     /**
     * \class fcntl
     * \brief Journal file controller. There is one instance per journal file.
+    *
+    * The read position within a file is not kept here, as a journal may have several readers (see
+    * rcursor), each with its own rrfc. Instead, all readers share a single read file handle, which is
+    * opened on first use, and a reset count which lets a reader detect that the file was reset for
+    * writing while it was being read.
+    *
+    * Readers in mmap read mode (see rmgr) also share a read-only mapping of the whole file, made on
+    * first use. Pointers into the mapping may be handed out to callers, who pin the file (see rd_pin)
+    * for as long as they use them; a pinned file is not reset for writing, so the data pointed to
+    * cannot be overwritten.
     */
     class fcntl
     {
@@ -64,9 +75,12 @@ namespace journal
         u_int16_t _lfid;                ///< Logical file ID (ordinal number in ring store)
         const u_int32_t _ffull_dblks;   ///< File size in dblks (incl. file header)
         int _wr_fh;                     ///< Write file handle
+        int _rd_fh;                     ///< Read file handle shared by all readers
+        smutex _rd_fh_mutex;            ///< Serializes opening of _rd_fh
+        u_int32_t _reset_cnt;           ///< Number of times this file has been reset
+        void* _rd_map;                  ///< Read-only mapping of file (mmap read mode), 0 if not mapped
+        u_int32_t _rd_pin_cnt;          ///< Number of pins on data in _rd_map
         u_int32_t _rec_enqcnt;          ///< Count of enqueued records
-        u_int32_t _rd_subm_cnt_dblks;   ///< Read file count (data blocks) for submitted AIO
-        u_int32_t _rd_cmpl_cnt_dblks;   ///< Read file count (data blocks) for completed AIO
         u_int32_t _wr_subm_cnt_dblks;   ///< Write file count (data blocks) for submitted AIO
         u_int32_t _wr_cmpl_cnt_dblks;   ///< Write file count (data blocks) for completed AIO
         u_int16_t _aio_cnt;             ///< Outstanding AIO operations on this file
@@ -79,12 +93,18 @@ namespace journal
         virtual ~fcntl();
 
         virtual bool reset(const rcvdat* const ro = 0);
-        virtual void rd_reset();
         virtual bool wr_reset(const rcvdat* const ro = 0);
 
         virtual int open_wr_fh();
         virtual void close_wr_fh();
         inline bool is_wr_fh_open() const { return _wr_fh >= 0; }
+        virtual int open_rd_fh();
+        virtual void close_rd_fh();
+        inline u_int32_t reset_cnt() const { return _reset_cnt; }
+        virtual const char* map_rd();
+        inline void pin_rd() { __sync_add_and_fetch(&_rd_pin_cnt, 1); }
+        inline void unpin_rd() { __sync_sub_and_fetch(&_rd_pin_cnt, 1); }
+        inline u_int32_t rd_pin_cnt() const { return _rd_pin_cnt; }
 
         inline const std::string& fname() const { return _fname; }
         inline u_int16_t pfid() const { return _pfid; }
@@ -97,14 +117,6 @@ namespace journal
         u_int32_t decr_enqcnt();
         u_int32_t subtr_enqcnt(u_int32_t s);
 
-        inline u_int32_t rd_subm_cnt_dblks() const { return _rd_subm_cnt_dblks; }
-        inline std::size_t rd_subm_offs() const { return _rd_subm_cnt_dblks * JRNL_DBLK_SIZE; }
-        u_int32_t add_rd_subm_cnt_dblks(u_int32_t a);
-
-        inline u_int32_t rd_cmpl_cnt_dblks() const { return _rd_cmpl_cnt_dblks; }
-        inline std::size_t rd_cmpl_offs() const { return _rd_cmpl_cnt_dblks * JRNL_DBLK_SIZE; }
-        u_int32_t add_rd_cmpl_cnt_dblks(u_int32_t a);
-
         inline u_int32_t wr_subm_cnt_dblks() const { return _wr_subm_cnt_dblks; }
         inline std::size_t wr_subm_offs() const { return _wr_subm_cnt_dblks * JRNL_DBLK_SIZE; }
         u_int32_t add_wr_subm_cnt_dblks(u_int32_t a);
@@ -124,11 +136,6 @@ namespace journal
 
         inline bool rd_void() const { return _wr_cmpl_cnt_dblks == 0; }
         inline bool rd_empty() const { return _wr_cmpl_cnt_dblks <= JRNL_SBLK_SIZE; }
-        inline u_int32_t rd_remaining_dblks() const { return _wr_cmpl_cnt_dblks - _rd_subm_cnt_dblks; }
-        inline bool is_rd_full() const { return _wr_cmpl_cnt_dblks == _rd_subm_cnt_dblks; }
-        inline bool is_rd_compl() const { return _wr_cmpl_cnt_dblks == _rd_cmpl_cnt_dblks; }
-        inline u_int32_t rd_aio_outstanding_dblks() const { return _rd_subm_cnt_dblks - _rd_cmpl_cnt_dblks; }
-        inline bool rd_file_rotate() const { return is_rd_full() && is_wr_compl(); }
 
         inline bool wr_void() const { return _wr_subm_cnt_dblks == 0; }
         inline bool wr_empty() const { return _wr_subm_cnt_dblks <= JRNL_SBLK_SIZE; }
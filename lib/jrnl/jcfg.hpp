@@ -67,12 +67,24 @@
 
 #define JRNL_RMGR_PAGE_SIZE     128         ///< Journal page size in softblocks
 #define JRNL_RMGR_PAGES         16          ///< Number of pages to use in wmgr
+#define JRNL_RMGR_INIT_RA_PAGES 2           ///< Initial read-ahead in pages (grows to the number of read pages)
 
 #define JRNL_WMGR_DEF_PAGE_SIZE 64          ///< Journal write page size in softblocks (default)
 #define JRNL_WMGR_DEF_PAGES     32          ///< Number of pages to use in wmgr (default)
 
 #define JRNL_WMGR_MAXDTOKPP     1024        ///< Max. dtoks (data blocks) per page in wmgr
 #define JRNL_WMGR_MAXWAITUS     100         ///< Max. wait time (us) before submitting AIO
+#define JRNL_WMGR_MIN_PAGES     1           ///< Min. pages kept by an idle wmgr (default)
+#define JRNL_PAGE_POOL_MAX_IDLE 256         ///< Max. idle pages of each size kept in page_pool
+#define JRNL_HUGE_PAGE_SIZE     0x200000    ///< Huge page size (bytes) used by page_alloc
+
+#define JRNL_WR_RING_SIZE       256         ///< Slots in write combining ring (power of 2)
+#define JRNL_WR_RING_SPIN       64          ///< Yields while waiting for combiner before blocking
+
+#define JRNL_MAP_STRIPES        16          ///< Lock stripes in enq_map and txn_map (power of 2)
+#define JRNL_XID_TABLE_SIZE     1024        ///< Buckets in xid intern table (power of 2)
+#define JRNL_XID_LOCK_STRIPES   64          ///< Lock stripes in xid intern table (power of 2, <= table size)
+#define JRNL_MAP_NODE_OVERHEAD  (4 * sizeof(void*)) ///< Est. bytes per std::map node beyond its value
 
 #define JRNL_INFO_EXTENSION     "jinf"      ///< Extension for journal info files
 #define JRNL_DATA_EXTENSION     "jdat"      ///< Extension for journal data files
@@ -81,6 +93,9 @@
 #define RHM_JDAT_DEQ_MAGIC      0x644d4852  ///< ("RHMd" in little endian) Magic for deq rec hdrs
 #define RHM_JDAT_ENQ_MAGIC      0x654d4852  ///< ("RHMe" in little endian) Magic for enq rec hdrs
 #define RHM_JDAT_FILE_MAGIC     0x664d4852  ///< ("RHMf" in little endian) Magic for file hdrs
+#define RHM_JDAT_MDEQ_MAGIC     0x6d4d4852  ///< ("RHMm" in little endian) Magic for multi-rid deq rec hdrs
+#define RHM_JDAT_PACK_MAGIC     0x704d4852  ///< ("RHMp" in little endian) Magic for packed rec dblk
+#define RHM_JDAT_RDEQ_MAGIC     0x724d4852  ///< ("RHMr" in little endian) Magic for range deq rec hdrs
 #define RHM_JDAT_EMPTY_MAGIC    0x784d4852  ///< ("RHMx" in little endian) Magic for empty dblk
 #define RHM_JDAT_VERSION        0x01        ///< Version (of file layout)
 #define RHM_CLEAN_CHAR          0xff        ///< Char used to clear empty space on disk
@@ -44,7 +44,10 @@
 #include "jrnl/file_hdr.hpp"
 #include "jrnl/jerrno.hpp"
 #include "jrnl/jinf.hpp"
+#include "jrnl/pack_hdr.hpp"
+#include "jrnl/rcursor.hpp"
 #include <limits>
+#include <sched.h>
 #include <sstream>
 #include <unistd.h>
 
@@ -90,7 +93,14 @@ jcntl::jcntl(const std::string& jid, const std::string& jdir, const std::string&
     _wrfc(&_lpmgr),
     _rmgr(this, _emap, _tmap, _rrfc),
     _wmgr(this, _emap, _tmap, _wrfc),
-    _rcvdat()
+    _rcvdat(),
+    _rcache_pgsize_sblks(JRNL_RMGR_PAGE_SIZE),
+    _rcache_num_pages(JRNL_RMGR_PAGES),
+    _rd_mmap(false),
+    _wr_combining(false),
+    _wr_ring(),
+    _rcursors(),
+    _rcursor_mutex()
 {}
 
 jcntl::~jcntl()
@@ -98,6 +108,9 @@ jcntl::~jcntl()
     if (_init_flag && !_stop_flag)
         try { stop(true); }
         catch (const jexception& e) { std::cerr << e << std::endl; }
+    for (std::vector<rcursor*>::iterator i = _rcursors.begin(); i != _rcursors.end(); i++)
+        delete *i;
+    _rcursors.clear();
     _lpmgr.finalize();
 }
 
@@ -132,7 +145,7 @@ jcntl::initialize(const u_int16_t num_jfiles, const bool ae, const u_int16_t ae_
     _wrfc.initialize(_jfsize_sblks);
     _rrfc.initialize();
     _rrfc.set_findex(0);
-    _rmgr.initialize(cbp);
+    _rmgr.initialize(cbp, _rcache_pgsize_sblks, _rcache_num_pages, _rd_mmap);
     _wmgr.initialize(cbp, wcache_pgsize_sblks, wcache_num_pages, JRNL_WMGR_MAXDTOKPP, JRNL_WMGR_MAXWAITUS);
 
     // Write info file (<basename>.jinf) to disk
@@ -178,7 +191,7 @@ jcntl::recover(const u_int16_t num_jfiles, const bool ae, const u_int16_t ae_max
     _wrfc.initialize(_jfsize_sblks, &_rcvdat);
     _rrfc.initialize();
     _rrfc.set_findex(_rcvdat.ffid());
-    _rmgr.initialize(cbp);
+    _rmgr.initialize(cbp, _rcache_pgsize_sblks, _rcache_num_pages, _rd_mmap);
     _wmgr.initialize(cbp, wcache_pgsize_sblks, wcache_num_pages, JRNL_WMGR_MAXDTOKPP, JRNL_WMGR_MAXWAITUS,
             (_rcvdat._lffull ? 0 : _rcvdat._eo));
 
@@ -212,55 +225,50 @@ iores
 jcntl::enqueue_data_record(const void* const data_buff, const std::size_t tot_data_len,
         const std::size_t this_data_len, data_tok* dtokp, const bool transient)
 {
-    iores r;
     check_wstatus("enqueue_data_record");
-    {
-        slock s(_wr_mutex);
-        while (handle_aio_wait(_wmgr.enqueue(data_buff, tot_data_len, this_data_len, dtokp, 0, 0, transient, false), r,
-                        dtokp)) ;
-    }
-    return r;
+    wr_op op(wr_op::ENQ, dtokp);
+    op._data_buff = data_buff;
+    op._tot_data_len = tot_data_len;
+    op._this_data_len = this_data_len;
+    op._transient = transient;
+    return write_op(op);
 }
 
 iores
 jcntl::enqueue_extern_data_record(const std::size_t tot_data_len, data_tok* dtokp, const bool transient)
 {
-    iores r;
     check_wstatus("enqueue_extern_data_record");
-    {
-        slock s(_wr_mutex);
-        while (handle_aio_wait(_wmgr.enqueue(0, tot_data_len, 0, dtokp, 0, 0, transient, true), r, dtokp)) ;
-    }
-    return r;
+    wr_op op(wr_op::ENQ, dtokp);
+    op._tot_data_len = tot_data_len;
+    op._transient = transient;
+    op._external = true;
+    return write_op(op);
 }
 
 iores
 jcntl::enqueue_txn_data_record(const void* const data_buff, const std::size_t tot_data_len,
-        const std::size_t this_data_len, data_tok* dtokp, const std::string& xid,
+        const std::size_t this_data_len, data_tok* dtokp, const xid_handle& xid,
         const bool transient)
 {
-    iores r;
     check_wstatus("enqueue_tx_data_record");
-    {
-        slock s(_wr_mutex);
-        while (handle_aio_wait(_wmgr.enqueue(data_buff, tot_data_len, this_data_len, dtokp, xid.data(), xid.size(),
-                        transient, false), r, dtokp)) ;
-    }
-    return r;
+    wr_op op(wr_op::ENQ, dtokp, &xid);
+    op._data_buff = data_buff;
+    op._tot_data_len = tot_data_len;
+    op._this_data_len = this_data_len;
+    op._transient = transient;
+    return write_op(op);
 }
 
 iores
 jcntl::enqueue_extern_txn_data_record(const std::size_t tot_data_len, data_tok* dtokp,
-        const std::string& xid, const bool transient)
+        const xid_handle& xid, const bool transient)
 {
-    iores r;
     check_wstatus("enqueue_extern_txn_data_record");
-    {
-        slock s(_wr_mutex);
-        while (handle_aio_wait(_wmgr.enqueue(0, tot_data_len, 0, dtokp, xid.data(), xid.size(), transient, true), r,
-                        dtokp)) ;
-    }
-    return r;
+    wr_op op(wr_op::ENQ, dtokp, &xid);
+    op._tot_data_len = tot_data_len;
+    op._transient = transient;
+    op._external = true;
+    return write_op(op);
 }
 
 /* TODO
@@ -284,83 +292,156 @@ iores
 jcntl::read_data_record(void** const datapp, std::size_t& dsize, void** const xidpp, std::size_t& xidsize,
         bool& transient, bool& external, data_tok* const dtokp, bool ignore_pending_txns)
 {
-    check_rstatus("read_data");
-    iores res = _rmgr.read(datapp, dsize, xidpp, xidsize, transient, external, dtokp, ignore_pending_txns);
-    if (res == RHM_IORES_RCINVALID)
+    return read_data_record(_rmgr, datapp, dsize, xidpp, xidsize, transient, external, dtokp, ignore_pending_txns);
+}
+
+iores
+jcntl::read_data_record(void** const datapp, std::size_t& dsize, void** const xidpp, std::size_t& xidsize,
+        bool& transient, bool& external, data_tok* const dtokp, rd_buf& buf, rd_pin* const pinp,
+        bool ignore_pending_txns)
+{
+    return read_data_record(_rmgr, datapp, dsize, xidpp, xidsize, transient, external, dtokp, ignore_pending_txns,
+            pinp, &buf);
+}
+
+rcursor*
+jcntl::open_rcursor(aio_callback* const cbp)
+{
+    check_rstatus("open_rcursor");
+    rcursor* rcp = new rcursor(this, &_lpmgr, _emap, _tmap);
+    try
     {
-        get_wr_events(0); // check for outstanding write events
-        iores sres = _rmgr.synchronize(); // flushes all outstanding read events
-        if (sres != RHM_IORES_SUCCESS)
-            return sres;
-        _rmgr.wait_for_validity(&_aio_cmpl_timeout, true); // throw if timeout occurs
-        res = _rmgr.read(datapp, dsize, xidpp, xidsize, transient, external, dtokp, ignore_pending_txns);
+        rcp->_rrfc.initialize();
+        rcp->_rmgr.initialize(cbp, _rcache_pgsize_sblks, _rcache_num_pages, _rd_mmap);
     }
-    return res;
+    catch (...)
+    {
+        delete rcp;
+        throw;
+    }
+    slock s(_rcursor_mutex);
+    _rcursors.push_back(rcp);
+    return rcp;
+}
+
+void
+jcntl::close_rcursor(rcursor* const rcp)
+{
+    {
+        slock s(_rcursor_mutex);
+        for (std::vector<rcursor*>::iterator i = _rcursors.begin(); i != _rcursors.end(); i++)
+        {
+            if (*i == rcp)
+            {
+                _rcursors.erase(i);
+                break;
+            }
+        }
+    }
+    delete rcp;
 }
 
 iores
 jcntl::dequeue_data_record(data_tok* const dtokp, const bool txn_coml_commit)
 {
+    check_wstatus("dequeue_data");
+    wr_op op(wr_op::DEQ, dtokp);
+    op._txn_coml_commit = txn_coml_commit;
+    return write_op(op);
+}
+
+iores
+jcntl::dequeue_data_records(const std::vector<data_tok*>& dtokl)
+{
+    if (dtokl.empty())
+        return RHM_IORES_SUCCESS;
+    if (dtokl.size() == 1)
+        return dequeue_data_record(dtokl.front());
     iores r;
     check_wstatus("dequeue_data");
     {
         slock s(_wr_mutex);
-        while (handle_aio_wait(_wmgr.dequeue(dtokp, 0, 0, txn_coml_commit), r, dtokp)) ;
+        while (handle_aio_wait(_wmgr.dequeue(dtokl), r, dtokl.front())) ;
     }
+    wr_submit_complete();
     return r;
 }
 
 iores
-jcntl::dequeue_txn_data_record(data_tok* const dtokp, const std::string& xid, const bool txn_coml_commit)
+jcntl::dequeue_data_range(data_tok* const dtokp, const u_int64_t first_rid, const u_int64_t last_rid)
 {
     iores r;
     check_wstatus("dequeue_data");
     {
         slock s(_wr_mutex);
-        while (handle_aio_wait(_wmgr.dequeue(dtokp, xid.data(), xid.size(), txn_coml_commit), r, dtokp)) ;
+        while (handle_aio_wait(_wmgr.dequeue_range(dtokp, first_rid, last_rid), r, dtokp)) ;
     }
+    wr_submit_complete();
     return r;
 }
 
 iores
-jcntl::txn_abort(data_tok* const dtokp, const std::string& xid)
+jcntl::dequeue_txn_data_record(data_tok* const dtokp, const xid_handle& xid, const bool txn_coml_commit)
+{
+    check_wstatus("dequeue_data");
+    wr_op op(wr_op::DEQ, dtokp, &xid);
+    op._txn_coml_commit = txn_coml_commit;
+    return write_op(op);
+}
+
+iores
+jcntl::txn_abort(data_tok* const dtokp, const xid_handle& xid)
 {
-    iores r;
     check_wstatus("txn_abort");
-    {
-        slock s(_wr_mutex);
-        while (handle_aio_wait(_wmgr.abort(dtokp, xid.data(), xid.size()), r, dtokp)) ;
-    }
-    return r;
+    wr_op op(wr_op::ABORT, dtokp, &xid);
+    return write_op(op);
 }
 
 iores
-jcntl::txn_commit(data_tok* const dtokp, const std::string& xid)
+jcntl::txn_commit(data_tok* const dtokp, const xid_handle& xid)
 {
-    iores r;
     check_wstatus("txn_commit");
-    {
-        slock s(_wr_mutex);
-        while (handle_aio_wait(_wmgr.commit(dtokp, xid.data(), xid.size()), r, dtokp)) ;
-    }
-    return r;
+    wr_op op(wr_op::COMMIT, dtokp, &xid);
+    return write_op(op);
 }
 
 bool
-jcntl::is_txn_synced(const std::string& xid)
+jcntl::is_txn_synced(const xid_handle& xid)
 {
     slock s(_wr_mutex);
     bool res = _wmgr.is_txn_synced(xid);
     return res;
 }
 
+int32_t
+jcntl::wait_txn_synced(const xid_handle& xid, timespec* const timeout)
+{
+    int32_t res = 0;
+    {
+        slock s(_wr_mutex);
+        while (!_wmgr.is_txn_synced(xid))
+        {
+            if (_wmgr.get_aio_evt_rem() == 0)
+                _wmgr.flush(); // the records are still in the current page
+            if ((res = _wmgr.get_events(pmgr::UNUSED, timeout)) == jerrno::AIO_TIMEOUT)
+                break;
+        }
+    }
+    _wmgr.dispatch_callbacks();
+    return res;
+}
+
 int32_t
 jcntl::get_wr_events(timespec* const timeout)
 {
-    stlock t(_wr_mutex);
-    if (!t.locked())
-        return jerrno::LOCK_TAKEN;
-    int32_t res = _wmgr.get_events(pmgr::UNUSED, timeout);
+    int32_t res;
+    {
+        stlock t(_wr_mutex);
+        if (!t.locked())
+            return jerrno::LOCK_TAKEN;
+        res = _wmgr.get_events(pmgr::UNUSED, timeout);
+    }
+    _wmgr.dispatch_callbacks();
     return res;
 }
 
@@ -381,6 +462,11 @@ jcntl::stop(const bool block_till_aio_cmpl)
     if (!_readonly_flag)
         flush(block_till_aio_cmpl);
     _rrfc.finalize();
+    {
+        slock s(_rcursor_mutex);
+        for (std::vector<rcursor*>::iterator i = _rcursors.begin(); i != _rcursors.end(); i++)
+            (*i)->_rrfc.finalize();
+    }
     _lpmgr.finalize();
 }
 
@@ -394,8 +480,6 @@ jcntl::get_earliest_fid()
         if (++ffid >= _lpmgr.num_jfiles())
             ffid = 0;
     }
-    if (!_rrfc.is_active())
-        _rrfc.set_findex(ffid);
     return ffid;
 }
 
@@ -411,11 +495,54 @@ jcntl::flush(const bool block_till_aio_cmpl)
         slock s(_wr_mutex);
         res = _wmgr.flush();
     }
+    wr_submit_complete();
     if (block_till_aio_cmpl)
         aio_cmpl_wait();
     return res;
 }
 
+void
+jcntl::set_codec(const codec* const cp, const std::size_t threshold)
+{
+    slock s(_wr_mutex);
+    _wmgr.set_codec(cp, threshold);
+}
+
+void
+jcntl::set_pack_records(const bool pack_recs)
+{
+    slock s(_wr_mutex);
+    _wmgr.set_pack_records(pack_recs);
+}
+
+void
+jcntl::set_wcache_min_pages(const u_int16_t min_pages)
+{
+    slock s(_wr_mutex);
+    _wmgr.set_min_pages(min_pages);
+}
+
+void
+jcntl::set_write_combining(const bool wr_combining)
+{
+    slock s(_wr_mutex);
+    _wr_combining = wr_combining;
+}
+
+std::size_t
+jcntl::cache_mem_bytes() const
+{
+    std::size_t bytes = _rmgr.mem_bytes();
+    {
+        slock s(_wr_mutex);
+        bytes += _wmgr.mem_bytes();
+    }
+    slock s(_rcursor_mutex);
+    for (std::vector<rcursor*>::const_iterator i = _rcursors.begin(); i != _rcursors.end(); i++)
+        bytes += (*i)->mem_bytes();
+    return bytes;
+}
+
 void
 jcntl::log(log_level ll, const std::string& log_stmt) const
 {
@@ -436,6 +563,12 @@ jcntl::chk_wr_frot()
 {
     if (_wrfc.index() == _rrfc.index())
         _rmgr.invalidate();
+    slock s(_rcursor_mutex);
+    for (std::vector<rcursor*>::iterator i = _rcursors.begin(); i != _rcursors.end(); i++)
+    {
+        if (_wrfc.index() == (*i)->_rrfc.index())
+            (*i)->_rmgr.invalidate();
+    }
 }
 
 void
@@ -480,6 +613,27 @@ jcntl::check_rstatus(const char* fn_name) const
         throw jexception(jerrno::JERR_JCNTL_STOPPED, "jcntl", fn_name);
 }
 
+iores
+jcntl::read_data_record(rmgr& rm, void** const datapp, std::size_t& dsize, void** const xidpp,
+        std::size_t& xidsize, bool& transient, bool& external, data_tok* const dtokp,
+        const bool ignore_pending_txns, rd_pin* const pinp, rd_buf* const rbufp)
+{
+    check_rstatus("read_data");
+    iores res = rm.read(datapp, dsize, xidpp, xidsize, transient, external, dtokp, ignore_pending_txns, pinp,
+            rbufp);
+    if (res == RHM_IORES_RCINVALID)
+    {
+        get_wr_events(0); // check for outstanding write events
+        iores sres = rm.synchronize(); // flushes all outstanding read events
+        if (sres != RHM_IORES_SUCCESS)
+            return sres;
+        rm.wait_for_validity(&_aio_cmpl_timeout, true); // throw if timeout occurs
+        res = rm.read(datapp, dsize, xidpp, xidsize, transient, external, dtokp, ignore_pending_txns, pinp,
+            rbufp);
+    }
+    return res;
+}
+
 void
 jcntl::write_infofile() const
 {
@@ -491,7 +645,8 @@ jcntl::write_infofile() const
         throw jexception(jerrno::JERR__RTCLOCK, oss.str(), "jcntl", "write_infofile");
     }
     jinf ji(_jid, _jdir.dirname(), _base_filename, _lpmgr.num_jfiles(), _lpmgr.is_ae(), _lpmgr.ae_max_jfiles(),
-            _jfsize_sblks, _wmgr.cache_pgsize_sblks(), _wmgr.cache_num_pages(), ts);
+            _jfsize_sblks, _wmgr.cache_pgsize_sblks(), _wmgr.cache_num_pages(), ts, _rcache_pgsize_sblks,
+            _rcache_num_pages);
     ji.write();
 }
 
@@ -512,6 +667,103 @@ jcntl::aio_cmpl_wait()
     }
 }
 
+iores
+jcntl::write_op(wr_op& op)
+{
+    if (!_wr_combining)
+    {
+        iores r;
+        {
+            slock s(_wr_mutex);
+            r = exec_wr_op(op);
+        }
+        wr_submit_complete();
+        return r;
+    }
+
+    const u_int64_t pos = _wr_ring.push(op);
+    u_int32_t spin_cnt = 0;
+    while (!_wr_ring.done(pos))
+    {
+        if (spin_cnt < JRNL_WR_RING_SPIN)
+        {
+            stlock t(_wr_mutex);
+            if (t.locked())
+                drain_wr_ring();
+            else
+            {
+                spin_cnt++;
+                ::sched_yield();
+            }
+        }
+        else
+        {
+            // The combiner is taking a while (probably waiting on AIO); block rather than spin
+            slock s(_wr_mutex);
+            drain_wr_ring();
+        }
+    }
+    _wr_ring.release(pos, op);
+    wr_submit_complete();
+    if (op._err)
+        throw op._ex;
+    return op._res;
+}
+
+void
+jcntl::wr_submit_complete()
+{
+    _wmgr.submit_pending();
+    _wmgr.dispatch_callbacks();
+}
+
+void
+jcntl::drain_wr_ring()
+{
+    wr_op* opp;
+    while ((opp = _wr_ring.front()) != 0)
+    {
+        try { opp->_res = exec_wr_op(*opp); }
+        catch (const jexception& e) { opp->set_err(e); }
+        catch (const std::exception& e)
+        {
+            opp->set_err(jexception(jerrno::JERR__UNEXPRESPONSE, e.what(), "jcntl", "drain_wr_ring"));
+        }
+        catch (...)
+        {
+            // The op must still be marked done, or its producer (and every later one) waits forever
+            opp->set_err(jexception(jerrno::JERR__UNEXPRESPONSE, "unknown exception", "jcntl", "drain_wr_ring"));
+        }
+        _wr_ring.pop_front();
+    }
+}
+
+iores
+jcntl::exec_wr_op(const wr_op& op)
+{
+    static const xid_handle no_xid;
+    const xid_handle& xid = op._xidp ? *op._xidp : no_xid;
+    iores r;
+    switch (op._type)
+    {
+        case wr_op::ENQ:
+            while (handle_aio_wait(_wmgr.enqueue(op._data_buff, op._tot_data_len, op._this_data_len, op._dtokp,
+                            xid, op._transient, op._external), r, op._dtokp)) ;
+            break;
+        case wr_op::DEQ:
+            while (handle_aio_wait(_wmgr.dequeue(op._dtokp, xid, op._txn_coml_commit), r,
+                            op._dtokp)) ;
+            break;
+        case wr_op::ABORT:
+            while (handle_aio_wait(_wmgr.abort(op._dtokp, xid), r, op._dtokp)) ;
+            break;
+        case wr_op::COMMIT:
+            while (handle_aio_wait(_wmgr.commit(op._dtokp, xid), r, op._dtokp)) ;
+            break;
+    }
+    return r;
+}
+
 bool
 jcntl::handle_aio_wait(const iores res, iores& resout, const data_tok* dtp)
 {
@@ -687,34 +939,7 @@ jcntl::rcvr_get_next_record(u_int16_t& fid, std::ifstream* ifsp, bool& lowi, rcv
                 u_int16_t start_fid = fid; // fid may increment in decode() if record folds over file boundary
                 if (!decode(er, fid, ifsp, cum_size_read, h, lowi, rd, file_pos))
                     return false;
-                if (!er.is_transient()) // Ignore transient msgs
-                {
-                    rd._enq_cnt_list[start_fid]++;
-                    if (er.xid_size())
-                    {
-                        er.get_xid(&xidp);
-                        assert(xidp != 0);
-                        std::string xid((char*)xidp, er.xid_size());
-                        _tmap.insert_txn_data(xid, txn_data(h._rid, 0, start_fid, true));
-                        if (_tmap.set_aio_compl(xid, h._rid) < txn_map::TMAP_OK) // fail - xid or rid not found
-                        {
-                            std::ostringstream oss;
-                            oss << std::hex << "_tmap.set_aio_compl: txn_enq xid=\"" << xid << "\" rid=0x" << h._rid;
-                            throw jexception(jerrno::JERR_MAP_NOTFOUND, oss.str(), "jcntl", "rcvr_get_next_record");
-                        }
-                        std::free(xidp);
-                    }
-                    else
-                    {
-                        if (_emap.insert_pfid(h._rid, start_fid) < enq_map::EMAP_OK) // fail
-                        {
-                            // The only error code emap::insert_pfid() returns is enq_map::EMAP_DUP_RID.
-                            std::ostringstream oss;
-                            oss << std::hex << "rid=0x" << h._rid << " _pfid=0x" << start_fid;
-                            throw jexception(jerrno::JERR_MAP_DUPLICATE, oss.str(), "jcntl", "rcvr_get_next_record");
-                        }
-                    }
-                }
+                rcvr_enq(er, start_fid, rd);
             }
             break;
         case RHM_JDAT_DEQ_MAGIC:
@@ -723,29 +948,23 @@ jcntl::rcvr_get_next_record(u_int16_t& fid, std::ifstream* ifsp, bool& lowi, rcv
                 u_int16_t start_fid = fid; // fid may increment in decode() if record folds over file boundary
                 if (!decode(dr, fid, ifsp, cum_size_read, h, lowi, rd, file_pos))
                     return false;
-                if (dr.xid_size())
-                {
-                    // If the enqueue is part of a pending txn, it will not yet be in emap
-                    _emap.lock(dr.deq_rid()); // ignore not found error
-                    dr.get_xid(&xidp);
-                    assert(xidp != 0);
-                    std::string xid((char*)xidp, dr.xid_size());
-                    _tmap.insert_txn_data(xid, txn_data(dr.rid(), dr.deq_rid(), start_fid, false,
-                            dr.is_txn_coml_commit()));
-                    if (_tmap.set_aio_compl(xid, dr.rid()) < txn_map::TMAP_OK) // fail - xid or rid not found
-                    {
-                        std::ostringstream oss;
-                        oss << std::hex << "_tmap.set_aio_compl: txn_deq xid=\"" << xid << "\" rid=0x" << dr.rid();
-                        throw jexception(jerrno::JERR_MAP_NOTFOUND, oss.str(), "jcntl", "rcvr_get_next_record");
-                    }
-                    std::free(xidp);
-                }
-                else
-                {
-                    int16_t enq_fid = _emap.get_remove_pfid(dr.deq_rid(), true);
-                    if (enq_fid >= enq_map::EMAP_OK) // ignore not found error
-                        rd._enq_cnt_list[enq_fid]--;
-                }
+                rcvr_deq(dr, start_fid, rd);
+            }
+            break;
+        case RHM_JDAT_MDEQ_MAGIC:
+            {
+                mdeq_rec mr;
+                if (!decode(mr, fid, ifsp, cum_size_read, h, lowi, rd, file_pos))
+                    return false;
+                rcvr_mdeq(mr, rd);
+            }
+            break;
+        case RHM_JDAT_RDEQ_MAGIC:
+            {
+                rdeq_rec rr;
+                if (!decode(rr, fid, ifsp, cum_size_read, h, lowi, rd, file_pos))
+                    return false;
+                rcvr_rdeq(rr, rd);
             }
             break;
         case RHM_JDAT_TXA_MAGIC:
@@ -800,6 +1019,10 @@ jcntl::rcvr_get_next_record(u_int16_t& fid, std::ifstream* ifsp, bool& lowi, rcv
                 std::free(xidp);
             }
             break;
+        case RHM_JDAT_PACK_MAGIC:
+            if (!rcvr_pack(fid, ifsp, h, lowi, rd, file_pos))
+                return false;
+            break;
         case RHM_JDAT_EMPTY_MAGIC:
             {
                 u_int32_t rec_dblks = jrec::size_dblks(sizeof(rec_hdr));
@@ -820,6 +1043,143 @@ jcntl::rcvr_get_next_record(u_int16_t& fid, std::ifstream* ifsp, bool& lowi, rcv
     return true;
 }
 
+void
+jcntl::rcvr_enq(enq_rec& er, const u_int16_t fid, rcvdat& rd)
+{
+    if (er.is_transient()) // Ignore transient msgs
+        return;
+    rd._enq_cnt_list[fid]++;
+    if (er.xid_size())
+    {
+        void* xidp = 0;
+        er.get_xid(&xidp);
+        assert(xidp != 0);
+        std::string xid((char*)xidp, er.xid_size());
+        _tmap.insert_txn_data(xid, txn_data(er.rid(), 0, fid, true));
+        if (_tmap.set_aio_compl(xid, er.rid()) < txn_map::TMAP_OK) // fail - xid or rid not found
+        {
+            std::ostringstream oss;
+            oss << std::hex << "_tmap.set_aio_compl: txn_enq xid=\"" << xid << "\" rid=0x" << er.rid();
+            throw jexception(jerrno::JERR_MAP_NOTFOUND, oss.str(), "jcntl", "rcvr_enq");
+        }
+        std::free(xidp);
+    }
+    else
+    {
+        if (_emap.insert_pfid(er.rid(), fid) < enq_map::EMAP_OK) // fail
+        {
+            // The only error code emap::insert_pfid() returns is enq_map::EMAP_DUP_RID.
+            std::ostringstream oss;
+            oss << std::hex << "rid=0x" << er.rid() << " _pfid=0x" << fid;
+            throw jexception(jerrno::JERR_MAP_DUPLICATE, oss.str(), "jcntl", "rcvr_enq");
+        }
+    }
+}
+
+void
+jcntl::rcvr_deq(deq_rec& dr, const u_int16_t fid, rcvdat& rd)
+{
+    if (dr.xid_size())
+    {
+        // If the enqueue is part of a pending txn, it will not yet be in emap
+        _emap.lock(dr.deq_rid()); // ignore not found error
+        void* xidp = 0;
+        dr.get_xid(&xidp);
+        assert(xidp != 0);
+        std::string xid((char*)xidp, dr.xid_size());
+        _tmap.insert_txn_data(xid, txn_data(dr.rid(), dr.deq_rid(), fid, false,
+                dr.is_txn_coml_commit()));
+        if (_tmap.set_aio_compl(xid, dr.rid()) < txn_map::TMAP_OK) // fail - xid or rid not found
+        {
+            std::ostringstream oss;
+            oss << std::hex << "_tmap.set_aio_compl: txn_deq xid=\"" << xid << "\" rid=0x" << dr.rid();
+            throw jexception(jerrno::JERR_MAP_NOTFOUND, oss.str(), "jcntl", "rcvr_deq");
+        }
+        std::free(xidp);
+    }
+    else
+    {
+        int16_t enq_fid = _emap.get_remove_pfid(dr.deq_rid(), true);
+        if (enq_fid >= enq_map::EMAP_OK) // ignore not found error
+            rd._enq_cnt_list[enq_fid]--;
+    }
+}
+
+void
+jcntl::rcvr_mdeq(mdeq_rec& mr, rcvdat& rd)
+{
+    for (std::size_t i = 0; i < mr.deq_cnt(); i++)
+    {
+        int16_t enq_fid = _emap.get_remove_pfid(mr.deq_rid(i), true);
+        if (enq_fid >= enq_map::EMAP_OK) // ignore not found error
+            rd._enq_cnt_list[enq_fid]--;
+    }
+}
+
+void
+jcntl::rcvr_rdeq(rdeq_rec& rr, rcvdat& rd)
+{
+    // Only records already recovered (i.e. enqueued before this record was written) are affected
+    std::vector<u_int32_t> pfid_cnt;
+    _emap.remove_range(rr.first_rid(), rr.last_rid(), pfid_cnt);
+    for (u_int16_t pfid = 0; pfid < pfid_cnt.size(); pfid++)
+        rd._enq_cnt_list[pfid] -= pfid_cnt[pfid];
+}
+
+bool
+jcntl::rcvr_pack(u_int16_t& fid, std::ifstream* ifsp, rec_hdr& h, bool& lowi, rcvdat& rd,
+        std::streampos& file_pos)
+{
+    if (!check_owi(fid, h, lowi, rd, file_pos))
+        return false;
+
+    // A packed dblk is always written in its entirety, so read the rest of it in one go
+    char buff[JRNL_DBLK_SIZE];
+    std::memcpy(buff, &h, sizeof(rec_hdr));
+    ifsp->read(buff + sizeof(rec_hdr), JRNL_DBLK_SIZE - sizeof(rec_hdr));
+    if (ifsp->gcount() != JRNL_DBLK_SIZE - sizeof(rec_hdr))
+    {
+        check_journal_alignment(fid, file_pos, rd);
+        return false;
+    }
+
+    std::size_t offs = pack_hdr::size();
+    std::size_t size = 0;
+    while ((size = pack_hdr::rec_size(buff, offs)) > 0)
+    {
+        rec_hdr sh;
+        std::memcpy(&sh, buff + offs, sizeof(rec_hdr));
+        if (!check_owi(fid, sh, lowi, rd, file_pos))
+            return false;
+        enq_rec er;
+        deq_rec dr;
+        try
+        {
+            if (sh._magic == RHM_JDAT_ENQ_MAGIC)
+                er.decode(sh, buff + offs, 0, 1);
+            else
+                dr.decode(sh, buff + offs, 0, 1);
+        }
+        catch (const jexception&)
+        {
+            check_journal_alignment(fid, file_pos, rd);
+            return false;
+        }
+        if (sh._magic == RHM_JDAT_ENQ_MAGIC)
+        {
+            rcvr_enq(er, fid, rd);
+            // Packed records have no xid, so the decoded buffer (if any) holds only the data
+            void* datap = 0;
+            if (er.get_data(&datap))
+                std::free(datap);
+        }
+        else
+            rcvr_deq(dr, fid, rd);
+        offs += pack_hdr::aligned_size(size);
+    }
+    return jfile_cycle(fid, ifsp, lowi, rd, false);
+}
+
 bool
 jcntl::decode(jrec& rec, u_int16_t& fid, std::ifstream* ifsp, std::size_t& cum_size_read,
         rec_hdr& h, bool& lowi, rcvdat& rd, std::streampos& file_offs)
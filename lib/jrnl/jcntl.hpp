@@ -38,6 +38,7 @@ namespace mrg
 namespace journal
 {
     class jcntl;
+    class rcursor;
 }
 }
 
@@ -51,7 +52,9 @@ namespace journal
 #include "jrnl/smutex.hpp"
 #include "jrnl/rmgr.hpp"
 #include "jrnl/wmgr.hpp"
+#include "jrnl/wr_ring.hpp"
 #include "jrnl/wrfc.hpp"
+#include <vector>
 
 namespace mrg
 {
@@ -70,6 +73,8 @@ namespace journal
     */
     class jcntl
     {
+        friend class rcursor;
+
     protected:
         /**
         * \brief Journal ID
@@ -146,6 +151,13 @@ namespace journal
         wmgr _wmgr;                 ///< Write page manager which manages AIO
         rcvdat _rcvdat;             ///< Recovery data used for recovery
         smutex _wr_mutex;           ///< Mutex for journal writes
+        u_int32_t _rcache_pgsize_sblks; ///< Read cache page size in sblks
+        u_int16_t _rcache_num_pages; ///< Number of read cache pages
+        bool _rd_mmap;              ///< Read through mapped journal files (see set_rd_mmap())
+        bool _wr_combining;         ///< Route writes through _wr_ring (see set_write_combining())
+        wr_ring _wr_ring;           ///< Write combining ring
+        std::vector<rcursor*> _rcursors; ///< Open read cursors (see open_rcursor())
+        smutex _rcursor_mutex;      ///< Mutex for _rcursors
 
     public:
         static timespec _aio_cmpl_timeout; ///< Timeout for blocking libaio returns
@@ -314,17 +326,17 @@ namespace journal
         * \param tot_data_len Total data length.
         * \param this_data_len Amount to be written in this enqueue operation.
         * \param dtokp Pointer to data token which contains the details of the enqueue operation.
-        * \param xid String containing xid. An empty string (i.e. length=0) will be considered
+        * \param xid Interned xid handle. An empty handle will be considered
         *     non-transactional.
         * \param transient Flag indicating transient persistence (ie, ignored on recover).
         *
         * \exception TODO
         */
         iores enqueue_txn_data_record(const void* const data_buff, const std::size_t tot_data_len,
-                const std::size_t this_data_len, data_tok* dtokp, const std::string& xid,
+                const std::size_t this_data_len, data_tok* dtokp, const xid_handle& xid,
                 const bool transient = false);
         iores enqueue_extern_txn_data_record(const std::size_t tot_data_len, data_tok* dtokp,
-                const std::string& xid, const bool transient = false);
+                const xid_handle& xid, const bool transient = false);
 
         /* TODO
         **
@@ -445,6 +457,47 @@ namespace journal
                 std::size_t& xidsize, bool& transient, bool& external, data_tok* const dtokp,
                 bool ignore_pending_txns = false);
 
+        /**
+        * \brief Reads the next non-dequeued data record into a buffer owned by the caller, or in
+        *     place in mmap read mode (see set_rd_mmap()), rather than into memory allocated for
+        *     each record.
+        *
+        * The data and xid are copied into buf, which is reused by each read and grows as needed
+        * (see rd_buf); datapp and xidpp then point into buf, must not be freed, and remain valid
+        * until the next read with buf. The same buf must be passed to each read until the record
+        * is complete (ie while RHM_IORES_PAGE_AIOWAIT is returned).
+        *
+        * If pinp is supplied and pinp->is_set() on return, the record was instead found in place in
+        * the mapped journal file, and datapp and xidpp point into the mapping; they remain valid
+        * until the pin is released (by release() or by the pin going out of scope). A pin already
+        * set is released before the read sets it again.
+        */
+        iores read_data_record(void** const datapp, std::size_t& dsize, void** const xidpp,
+                std::size_t& xidsize, bool& transient, bool& external, data_tok* const dtokp,
+                rd_buf& buf, rd_pin* const pinp = 0, bool ignore_pending_txns = false);
+
+        /**
+        * \brief Open a read cursor, which reads the journal from its own position and through its
+        *     own read cache, independently of read_data_record() and of any other cursor.
+        *
+        * The cursor starts at the start of the journal, and its read cache is allocated by its
+        * first read (see set_rcache_geometry()). It must be returned with close_rcursor(). See
+        * class rcursor for details.
+        *
+        * \param cbp Pointer to object containing the read callback, or 0 if none is needed.
+        *
+        * \exception jerrno::JERR__NINIT if the journal is not initialized or recovered, or
+        *     jerrno::JERR_JCNTL_STOPPED if it has been stopped.
+        */
+        rcursor* open_rcursor(aio_callback* const cbp = 0);
+
+        /**
+        * \brief Close and delete a read cursor obtained from open_rcursor().
+        */
+        void close_rcursor(rcursor* const rcp);
+
+        inline std::size_t num_rcursors() const { slock s(_rcursor_mutex); return _rcursors.size(); }
+
         /**
         * \brief Dequeues (marks as no longer needed) data record in journal.
         *
@@ -464,6 +517,56 @@ namespace journal
         */
         iores dequeue_data_record(data_tok* const dtokp, const bool txn_coml_commit = false);
 
+        /**
+        * \brief Dequeues (marks as no longer needed) several data records in journal using a
+        *     single dequeue record.
+        *
+        * Dequeues several non-transactional data records at once. Each data token in dtokl is
+        * prepared as for dequeue_data_record(); all the dequeues are written as a single
+        * multi-rid dequeue record which is much smaller than the equivalent individual dequeue
+        * records. The dequeue record takes the rid of the first data token in dtokl (or a new
+        * rid if that token does not use external rids), which is then set into all the data
+        * tokens. All data tokens are returned in the write AIO callback once the record is on
+        * disk.
+        *
+        * If the listed records are all the records enqueued within their range of rids (as results
+        * from in-order consumption or a purge of a queue), the record is written in the much
+        * smaller range form used by dequeue_data_range().
+        *
+        * If any of the records is not enqueued (or is repeated in the list), an exception is
+        * thrown and nothing is written. A list containing only one data token is written as an
+        * ordinary dequeue record.
+        *
+        * \param dtokl List of data_tok instances for the records to be dequeued.
+        *
+        * \exception TODO
+        */
+        iores dequeue_data_records(const std::vector<data_tok*>& dtokl);
+
+        /**
+        * \brief Dequeues (marks as no longer needed) all enqueued data records within a range of
+        *     rids using a single dequeue record.
+        *
+        * Dequeues every non-transactional data record currently enqueued with a rid from
+        * first_rid to last_rid (inclusive). The dequeue record is a single data block regardless
+        * of the number of records dequeued, and so this is much cheaper than the equivalent
+        * individual dequeues where a queue is consumed in order or purged. A first_rid of 0 gives
+        * a watermark which dequeues all enqueued records up to and including last_rid. Records
+        * enqueued after this call are not affected, even if their rids lie within the range.
+        *
+        * If no records in the range are enqueued, or if any record in the range is locked by a
+        * pending transactional dequeue, an exception is thrown and nothing is written.
+        *
+        * \param dtokp Pointer to data_tok instance for this dequeue record, used to track state of
+        *     the record through journal.
+        * \param first_rid First rid of range of records to be dequeued.
+        * \param last_rid Last rid of range of records to be dequeued.
+        *
+        * \exception TODO
+        */
+        iores dequeue_data_range(data_tok* const dtokp, const u_int64_t first_rid,
+                const u_int64_t last_rid);
+
         /**
         * \brief Dequeues (marks as no longer needed) data record in journal.
         *
@@ -475,7 +578,7 @@ namespace journal
         *
         * \param dtokp Pointer to data_tok instance for this data, used to track state of data
         *     through journal.
-        * \param xid String containing xid. An empty string (i.e. length=0) will be considered
+        * \param xid Interned xid handle. An empty handle will be considered
         *     non-transactional.
         * \param txn_coml_commit Only used for preparedXID journal. When used for dequeueing
         *     prepared XID list items, sets whether the complete() was called in commit or abort
@@ -483,7 +586,7 @@ namespace journal
         *
         * \exception TODO
         */
-        iores dequeue_txn_data_record(data_tok* const dtokp, const std::string& xid, const bool txn_coml_commit = false);
+        iores dequeue_txn_data_record(data_tok* const dtokp, const xid_handle& xid, const bool txn_coml_commit = false);
 
         /**
         * \brief Abort the transaction for all records enqueued or dequeued with the matching xid.
@@ -494,11 +597,11 @@ namespace journal
         *
         * \param dtokp Pointer to data_tok instance for this data, used to track state of data
         *     through journal.
-        * \param xid String containing xid.
+        * \param xid Interned xid handle.
         *
         * \exception TODO
         */
-        iores txn_abort(data_tok* const dtokp, const std::string& xid);
+        iores txn_abort(data_tok* const dtokp, const xid_handle& xid);
 
         /**
         * \brief Commit the transaction for all records enqueued or dequeued with the matching xid.
@@ -509,20 +612,39 @@ namespace journal
         *
         * \param dtokp Pointer to data_tok instance for this data, used to track state of data
         *     through journal.
-        * \param xid String containing xid.
+        * \param xid Interned xid handle.
         *
         * \exception TODO
         */
-        iores txn_commit(data_tok* const dtokp, const std::string& xid);
+        iores txn_commit(data_tok* const dtokp, const xid_handle& xid);
 
         /**
         * \brief Check whether all the enqueue records for the given xid have reached disk.
         *
-        * \param xid String containing xid.
+        * \param xid Interned xid handle.
+        *
+        * \exception TODO
+        */
+        bool is_txn_synced(const xid_handle& xid);
+
+        /**
+        * \brief Waits until all the enqueue records for the given xid have reached disk.
+        *
+        * Unlike get_wr_events(), this waits for the write lock rather than returning
+        * jerrno::LOCK_TAKEN, then gets write events, blocking for up to timeout each time, until the
+        * transaction is synced. Threads syncing on the same journal therefore take turns on that
+        * journal's write lock, and each is woken as soon as the thread before it has processed the
+        * completions it was waiting for. Completions on other journals do not wake them. If no write
+        * is outstanding but the transaction is not yet synced, its records are still in the current
+        * page, which is flushed.
+        *
+        * \param xid Interned xid handle.
+        * \param timeout Maximum time to wait for each write event.
+        * \returns jerrno::AIO_TIMEOUT if no write event was returned within timeout, 0 otherwise.
         *
         * \exception TODO
         */
-        bool is_txn_synced(const std::string& xid);
+        int32_t wait_txn_synced(const xid_handle& xid, timespec* const timeout);
 
         /**
         * \brief Forces a check for returned AIO write events.
@@ -578,7 +700,7 @@ namespace journal
                 { return _rrfc.aio_outstanding_dblks(); }
 
         inline u_int32_t get_rd_outstanding_aio_dblks(u_int16_t lfid) const
-                { return _lpmgr.get_fcntlp(lfid)->rd_aio_outstanding_dblks(); }
+                { return _rrfc.is_active() && _rrfc.index() == lfid ? _rrfc.aio_outstanding_dblks() : 0; }
 
         inline u_int16_t get_rd_fid() const { return _rrfc.index(); }
         inline u_int16_t get_wr_fid() const { return _wrfc.index(); }
@@ -594,6 +716,8 @@ namespace journal
         inline bool is_locked(const u_int64_t rid)
                 { if (_emap.is_enqueued(rid, true) < enq_map::EMAP_OK) return false; return _emap.is_locked(rid) == enq_map::EMAP_TRUE; }
         inline void enq_rid_list(std::vector<u_int64_t>& rids) { _emap.rid_list(rids); }
+        inline u_int32_t enq_range_cnt(const u_int64_t first_rid, const u_int64_t last_rid, bool& locked)
+                { return _emap.range_cnt(first_rid, last_rid, locked); }
         inline void enq_xid_list(std::vector<std::string>& xids) { _tmap.xid_list(xids); }
         inline u_int32_t get_open_txn_cnt() const { return _tmap.size(); }
         // TODO Make this a const, but txn_map must support const first.
@@ -648,6 +772,115 @@ namespace journal
 
         inline u_int32_t jfsize_sblks() const { return _jfsize_sblks; }
 
+        /**
+        * \brief Set the codec used to compress enqueue data.
+        *
+        * Enqueued data of at least threshold bytes is compressed with codec cp before it is
+        * written, provided this saves journal space; records are flagged and carry the id of the
+        * codec used, so they are decompressed transparently on read and recovery whatever codec
+        * (if any) is set at that time. External and partial enqueues are never compressed. Setting
+        * cp to 0 (the default) disables compression of subsequent enqueues.
+        */
+        void set_codec(const codec* const cp, const std::size_t threshold = 0);
+        inline const codec* get_codec() const { return _wmgr.get_codec(); }
+
+        /**
+        * \brief Enable or disable packing of small records.
+        *
+        * When enabled, dequeues and small enqueues which are not part of a transaction are written
+        * several to a data block (see pack_hdr) rather than each occupying a whole data block. Packed
+        * records are read and recovered whether or not packing is enabled at that time.
+        */
+        void set_pack_records(const bool pack_recs);
+        inline bool pack_records() const { return _wmgr.pack_records(); }
+
+        /**
+        * \brief Set the minimum number of write cache pages kept while the journal is idle.
+        *
+        * Write cache page memory is taken from the process-wide page_pool as pages are filled and
+        * returned once written, but at least min_pages pages (and never fewer than one) are kept by
+        * the journal. The maximum is the number of write cache pages given to initialize() or
+        * recover().
+        */
+        void set_wcache_min_pages(const u_int16_t min_pages);
+        inline u_int16_t wcache_min_pages() const { return _wmgr.min_pages(); }
+        inline u_int16_t wcache_res_pages() const { return _wmgr.res_pages(); }
+
+        /**
+        * \brief Set the read cache geometry used by the next initialize() or recover().
+        *
+        * The read page size pgsize_sblks must divide JRNL_RMGR_PAGE_SIZE (the unit of journal file
+        * size), otherwise initialize() and recover() throw JERR_RMGR_BADGEOM. The defaults are
+        * JRNL_RMGR_PAGE_SIZE and JRNL_RMGR_PAGES.
+        */
+        inline void set_rcache_geometry(const u_int32_t pgsize_sblks, const u_int16_t num_pages)
+        { _rcache_pgsize_sblks = pgsize_sblks; _rcache_num_pages = num_pages; }
+        inline u_int32_t rcache_pgsize_sblks() const { return _rcache_pgsize_sblks; }
+        inline u_int16_t rcache_num_pages() const { return _rcache_num_pages; }
+
+        /**
+        * \brief Free the read cache page memory if there have been no reads for idle_secs seconds.
+        *
+        * The read cache is allocated on the first read, and is allocated again (restarting reads
+        * from the start of the journal) by the first read after it is freed. The caller must ensure
+        * that this is not called concurrently with read_data_record(). Returns true if the cache
+        * was freed.
+        */
+        inline bool release_idle_rcache(const u_int32_t idle_secs) { return _rmgr.release_idle_pages(idle_secs); }
+        inline bool rcache_allocated() const { return _rmgr.pages_allocated(); }
+
+        /**
+        * \brief Read through read-only mappings of the journal files instead of through the AIO read
+        *     cache, for the next initialize() or recover() and for cursors opened after it.
+        *
+        * No read cache memory is allocated, and records can be returned in place (see the
+        * read_data_record() overload taking an rd_buf and rd_pin). Data is only read once its write AIO has
+        * completed, as the mapping is not coherent with O_DIRECT writes still in flight.
+        */
+        inline void set_rd_mmap(const bool rd_mmap) { _rd_mmap = rd_mmap; }
+        inline bool rd_mmap() const { return _rd_mmap; }
+
+        /**
+        * \brief Enable or disable write combining.
+        *
+        * When enabled, enqueues, dequeues, aborts and commits from concurrent threads are placed in
+        * a lock-free ring (see wr_ring) instead of each thread waiting for the write mutex in turn.
+        * Whichever thread obtains the write mutex executes every operation waiting in the ring in a
+        * single pass, and the other threads collect their results without taking the mutex. The
+        * records written and their order are the same as without combining.
+        */
+        void set_write_combining(const bool wr_combining);
+        inline bool write_combining() const { return _wr_combining; }
+
+        /**
+        * \brief Total size in bytes of all records written since this journal was initialized or
+        *     recovered. Together with get_wr_subm_dblks(), gives the journal write amplification.
+        */
+        inline u_int64_t get_wr_rec_bytes() const { return _wmgr.rec_bytes(); }
+
+        /**
+        * \brief Total number of data blocks submitted to disk since this journal was initialized or
+        *     recovered, including filler records and file headers.
+        */
+        inline u_int64_t get_wr_subm_dblks() const { return _wmgr.subm_dblks(); }
+
+        /**
+        * \brief Estimated heap memory, in bytes, held by the write and read caches of this journal
+        *     and of its open read cursors.
+        *
+        * Includes page memory, page control blocks and AIO structures, page and deferred dequeue
+        * token lists, file headers and compression buffers. Read cache pages are counted only while
+        * allocated; journal files mapped for reading (see set_rd_mmap()) are not counted. The value
+        * is an estimate, cheap enough to be obtained periodically while the journal is in use.
+        */
+        std::size_t cache_mem_bytes() const;
+
+        /**
+        * \brief Estimated heap memory, in bytes, held by the enqueue and transaction maps, from the
+        *     number of entries they hold.
+        */
+        inline std::size_t index_mem_bytes() const { return _emap.mem_bytes() + _tmap.mem_bytes(); }
+
         // Logging
         virtual void log(log_level level, const std::string& log_stmt) const;
         virtual void log(log_level level, const char* const log_stmt) const;
@@ -661,6 +894,7 @@ namespace journal
         // Management instrumentation callbacks
         inline virtual void instr_incr_outstanding_aio_cnt() {}
         inline virtual void instr_decr_outstanding_aio_cnt() {}
+        inline virtual void instr_add_read_bytes(const u_int64_t /*bytes*/) {}
 
         /**
         * /brief Static function for creating new fcntl objects for use with obj_arr.
@@ -681,6 +915,13 @@ namespace journal
         */
         void check_rstatus(const char* fn_name) const;
 
+        /**
+        * \brief Read through read manager rm, either this journal's own (_rmgr) or that of a cursor.
+        */
+        iores read_data_record(rmgr& rm, void** const datapp, std::size_t& dsize, void** const xidpp,
+                std::size_t& xidsize, bool& transient, bool& external, data_tok* const dtokp,
+                const bool ignore_pending_txns, rd_pin* const pinp = 0, rd_buf* const rbufp = 0);
+
         /**
         * \brief Write info file &lt;basefilename&gt;.jinf to disk
         */
@@ -697,6 +938,28 @@ namespace journal
         */
         bool handle_aio_wait(const iores res, iores& resout, const data_tok* dtp);
 
+        /**
+        * \brief Execute write operation op, either directly under the write mutex or through the
+        *     write combining ring, depending on whether write combining is enabled.
+        */
+        iores write_op(wr_op& op);
+
+        /**
+        * \brief Submit the AIO writes prepared by the last write operation and perform any pending
+        *     AIO callbacks. Called once the write mutex has been released (see wmgr).
+        */
+        void wr_submit_complete();
+
+        /**
+        * \brief Execute all ready operations in the write combining ring. Write mutex must be held.
+        */
+        void drain_wr_ring();
+
+        /**
+        * \brief Execute a single write operation. Write mutex must be held.
+        */
+        iores exec_wr_op(const wr_op& op);
+
         /**
         * \brief Analyze journal for recovery.
         */
@@ -704,6 +967,17 @@ namespace journal
 
         bool rcvr_get_next_record(u_int16_t& fid, std::ifstream* ifsp, bool& lowi, rcvdat& rd);
 
+        void rcvr_enq(enq_rec& er, const u_int16_t fid, rcvdat& rd);
+
+        void rcvr_deq(deq_rec& dr, const u_int16_t fid, rcvdat& rd);
+
+        void rcvr_mdeq(mdeq_rec& mr, rcvdat& rd);
+
+        void rcvr_rdeq(rdeq_rec& rr, rcvdat& rd);
+
+        bool rcvr_pack(u_int16_t& fid, std::ifstream* ifsp, rec_hdr& h, bool& lowi, rcvdat& rd,
+                std::streampos& rec_offset);
+
         bool decode(jrec& rec, u_int16_t& fid, std::ifstream* ifsp, std::size_t& cum_size_read,
                 rec_hdr& h, bool& lowi, rcvdat& rd, std::streampos& rec_offset);
 
@@ -85,6 +85,8 @@ const u_int32_t jerrno::JERR_FCNTL_CLOSE        = 0x0402;
 const u_int32_t jerrno::JERR_FCNTL_FILEOFFSOVFL = 0x0403;
 const u_int32_t jerrno::JERR_FCNTL_CMPLOFFSOVFL = 0x0404;
 const u_int32_t jerrno::JERR_FCNTL_RDOFFSOVFL   = 0x0405;
+const u_int32_t jerrno::JERR_FCNTL_OPENRD       = 0x0406;
+const u_int32_t jerrno::JERR_FCNTL_MMAP         = 0x0407;
 
 // class lfmgr
 const u_int32_t jerrno::JERR_LFMGR_BADAEFNUMLIM = 0x0500;
@@ -104,6 +106,7 @@ const u_int32_t jerrno::JERR_WMGR_BADDTOKSTATE  = 0x0802;
 const u_int32_t jerrno::JERR_WMGR_ENQDISCONT    = 0x0803;
 const u_int32_t jerrno::JERR_WMGR_DEQDISCONT    = 0x0804;
 const u_int32_t jerrno::JERR_WMGR_DEQRIDNOTENQ  = 0x0805;
+const u_int32_t jerrno::JERR_WMGR_DEQRIDDUP     = 0x0806;
 
 // class rmgr
 const u_int32_t jerrno::JERR_RMGR_UNKNOWNMAGIC  = 0x0900;
@@ -111,6 +114,7 @@ const u_int32_t jerrno::JERR_RMGR_RIDMISMATCH   = 0x0901;
 //const u_int32_t jerrno::JERR_RMGR_FIDMISMATCH   = 0x0902;
 const u_int32_t jerrno::JERR_RMGR_ENQSTATE      = 0x0903;
 const u_int32_t jerrno::JERR_RMGR_BADRECTYPE    = 0x0904;
+const u_int32_t jerrno::JERR_RMGR_BADGEOM       = 0x0905;
 
 // class data_tok
 const u_int32_t jerrno::JERR_DTOK_ILLEGALSTATE  = 0x0a00;
@@ -134,6 +138,12 @@ const u_int32_t jerrno::JERR_JINF_BADFILESIZE   = 0x0c08;
 const u_int32_t jerrno::JERR_JINF_OWIBAD        = 0x0c09;
 const u_int32_t jerrno::JERR_JINF_ZEROLENFILE   = 0x0c0a;
 
+// class codec
+const u_int32_t jerrno::JERR_CODEC_UNKNOWN      = 0x0d00;
+const u_int32_t jerrno::JERR_CODEC_DUPLICATE    = 0x0d01;
+const u_int32_t jerrno::JERR_CODEC_BADHDR       = 0x0d02;
+const u_int32_t jerrno::JERR_CODEC_DECOMPFAIL   = 0x0d03;
+
 // Negative returns for some functions
 const int32_t jerrno::AIO_TIMEOUT               = -1;
 const int32_t jerrno::LOCK_TAKEN                = -2;
@@ -186,6 +196,8 @@ jerrno::__init()
     _err_map[JERR_FCNTL_FILEOFFSOVFL] = "JERR_FCNTL_FILEOFFSOVFL: Attempted increase file offset past file size.";
     _err_map[JERR_FCNTL_CMPLOFFSOVFL] = "JERR_FCNTL_CMPLOFFSOVFL: Attempted increase completed file offset past submitted offset.";
     _err_map[JERR_FCNTL_RDOFFSOVFL] = "JERR_FCNTL_RDOFFSOVFL: Attempted increase read offset past write offset.";
+    _err_map[JERR_FCNTL_OPENRD] = "JERR_FCNTL_OPENRD: Unable to open file for read.";
+    _err_map[JERR_FCNTL_MMAP] = "JERR_FCNTL_MMAP: Unable to map file for read.";
 
     // class lfmgr
     _err_map[JERR_LFMGR_BADAEFNUMLIM] = "JERR_LFMGR_BADAEFNUMLIM: Auto-expand file number limit lower than initial number of journal files.";
@@ -205,6 +217,7 @@ jerrno::__init()
     _err_map[JERR_WMGR_ENQDISCONT] = "JERR_WMGR_ENQDISCONT: Enqueued new dtok when previous enqueue returned partly completed (state ENQ_PART).";
     _err_map[JERR_WMGR_DEQDISCONT] = "JERR_WMGR_DEQDISCONT: Dequeued new dtok when previous dequeue returned partly completed (state DEQ_PART).";
     _err_map[JERR_WMGR_DEQRIDNOTENQ] = "JERR_WMGR_DEQRIDNOTENQ: Dequeue rid is not enqueued.";
+    _err_map[JERR_WMGR_DEQRIDDUP] = "JERR_WMGR_DEQRIDDUP: Dequeue rid occurs more than once in a multi-rid dequeue.";
 
     // class rmgr
     _err_map[JERR_RMGR_UNKNOWNMAGIC] = "JERR_RMGR_UNKNOWNMAGIC: Found record with unknown magic.";
@@ -212,6 +225,7 @@ jerrno::__init()
     //_err_map[JERR_RMGR_FIDMISMATCH] = "JERR_RMGR_FIDMISMATCH: FID mismatch between emap and rrfc";
     _err_map[JERR_RMGR_ENQSTATE] = "JERR_RMGR_ENQSTATE: Attempted read when data token wstate was not ENQ";
     _err_map[JERR_RMGR_BADRECTYPE] = "JERR_RMGR_BADRECTYPE: Attempted operation on inappropriate record type";
+    _err_map[JERR_RMGR_BADGEOM] = "JERR_RMGR_BADGEOM: Invalid read cache page size or number of pages";
 
     // class data_tok
     _err_map[JERR_DTOK_ILLEGALSTATE] = "JERR_MTOK_ILLEGALSTATE: Attempted to change to illegal state.";
@@ -235,6 +249,12 @@ jerrno::__init()
     _err_map[JERR_JINF_OWIBAD] = "JERR_JINF_OWIBAD: Journal data files have inconsistent OWI flags; >1 transition found in non-auto-expand or min-size journal";
     _err_map[JERR_JINF_ZEROLENFILE] = "JERR_JINF_ZEROLENFILE: Journal info file zero length";
 
+    // class codec
+    _err_map[JERR_CODEC_UNKNOWN] = "JERR_CODEC_UNKNOWN: Unknown or unregistered compression codec.";
+    _err_map[JERR_CODEC_DUPLICATE] = "JERR_CODEC_DUPLICATE: Compression codec id already registered.";
+    _err_map[JERR_CODEC_BADHDR] = "JERR_CODEC_BADHDR: Invalid compressed data header.";
+    _err_map[JERR_CODEC_DECOMPFAIL] = "JERR_CODEC_DECOMPFAIL: Decompression of record data failed.";
+
     //_err_map[] = "";
 
     return true;
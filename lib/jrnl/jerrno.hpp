@@ -103,6 +103,8 @@ namespace journal
         static const u_int32_t JERR_FCNTL_FILEOFFSOVFL; ///< Increased offset past file size
         static const u_int32_t JERR_FCNTL_CMPLOFFSOVFL; ///< Increased cmpl offs past subm offs
         static const u_int32_t JERR_FCNTL_RDOFFSOVFL;   ///< Increased read offs past write offs
+        static const u_int32_t JERR_FCNTL_OPENRD;       ///< Unable to open file for read
+        static const u_int32_t JERR_FCNTL_MMAP;         ///< Unable to map file for read
 
         // class lfmgr
         static const u_int32_t JERR_LFMGR_BADAEFNUMLIM; ///< Bad auto-expand file number limit
@@ -122,6 +124,7 @@ namespace journal
         static const u_int32_t JERR_WMGR_ENQDISCONT;    ///< Enq. new dtok when previous part compl.
         static const u_int32_t JERR_WMGR_DEQDISCONT;    ///< Deq. new dtok when previous part compl.
         static const u_int32_t JERR_WMGR_DEQRIDNOTENQ;  ///< Deq. rid not enqueued
+        static const u_int32_t JERR_WMGR_DEQRIDDUP;     ///< Deq. rid repeated in multi-rid dequeue
 
         // class rmgr
         static const u_int32_t JERR_RMGR_UNKNOWNMAGIC;  ///< Found record with unknown magic
@@ -129,6 +132,7 @@ namespace journal
         //static const u_int32_t JERR_RMGR_FIDMISMATCH;   ///< FID mismatch between emap and rrfc
         static const u_int32_t JERR_RMGR_ENQSTATE;      ///< Attempted read when wstate not ENQ
         static const u_int32_t JERR_RMGR_BADRECTYPE;    ///< Attempted op on incorrect rec type
+        static const u_int32_t JERR_RMGR_BADGEOM;       ///< Invalid read cache geometry
 
         // class data_tok
         static const u_int32_t JERR_DTOK_ILLEGALSTATE;  ///< Attempted to change to illegal state
@@ -152,6 +156,12 @@ namespace journal
         static const u_int32_t JERR_JINF_OWIBAD;        ///< OWI inconsistent (>1 transition in non-ae journal)
         static const u_int32_t JERR_JINF_ZEROLENFILE;   ///< Journal info file is zero length (empty).
 
+        // class codec
+        static const u_int32_t JERR_CODEC_UNKNOWN;      ///< Unknown or unregistered codec id
+        static const u_int32_t JERR_CODEC_DUPLICATE;    ///< Codec id already registered
+        static const u_int32_t JERR_CODEC_BADHDR;       ///< Invalid compressed data header
+        static const u_int32_t JERR_CODEC_DECOMPFAIL;   ///< Decompression failed (corrupt data)
+
         // Negative returns for some functions
         static const int32_t AIO_TIMEOUT;               ///< Timeout waiting for AIO return
         static const int32_t LOCK_TAKEN;                ///< Attempted to take lock, but it was taken by another thread
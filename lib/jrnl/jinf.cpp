@@ -75,7 +75,8 @@ jinf::jinf(const std::string& jinf_filename, bool validate_flag):
 
 jinf::jinf(const std::string& jid, const std::string& jdir, const std::string& base_filename, const u_int16_t num_jfiles,
         const bool auto_expand, const u_int16_t ae_max_jfiles, const u_int32_t jfsize_sblks,
-        const u_int32_t wcache_pgsize_sblks, const u_int16_t wcache_num_pages, const timespec& ts):
+        const u_int32_t wcache_pgsize_sblks, const u_int16_t wcache_num_pages, const timespec& ts,
+        const u_int32_t rcache_pgsize_sblks, const u_int16_t rcache_num_pages):
         _jver(RHM_JDAT_VERSION),
         _jid(jid),
         _jdir(jdir),
@@ -89,8 +90,8 @@ jinf::jinf(const std::string& jid, const std::string& jdir, const std::string& b
         _dblk_size(JRNL_DBLK_SIZE),
         _wcache_pgsize_sblks(wcache_pgsize_sblks),
         _wcache_num_pages(wcache_num_pages),
-        _rcache_pgsize_sblks(JRNL_RMGR_PAGE_SIZE),
-        _rcache_num_pages(JRNL_RMGR_PAGES),
+        _rcache_pgsize_sblks(rcache_pgsize_sblks),
+        _rcache_num_pages(rcache_num_pages),
         _tm_ptr(std::localtime(&ts.tv_sec)),
         _valid_flag(false),
         _analyzed_flag(false),
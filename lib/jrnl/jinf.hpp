@@ -33,6 +33,7 @@
 #define mrg_journal_jinf_hpp
 
 #include <ctime>
+#include "jrnl/jcfg.hpp"
 #include <string>
 #include <sys/types.h>
 #include <vector>
@@ -82,7 +83,8 @@ namespace journal
         jinf(const std::string& jid, const std::string& jdir, const std::string& base_filename,
                 const u_int16_t num_jfiles, const bool auto_expand, const u_int16_t ae_max_jfiles,
                 const u_int32_t jfsize_sblks, const u_int32_t wcache_pgsize_sblks, const u_int16_t wcache_num_pages,
-                const timespec& ts);
+                const timespec& ts, const u_int32_t rcache_pgsize_sblks = JRNL_RMGR_PAGE_SIZE,
+                const u_int16_t rcache_num_pages = JRNL_RMGR_PAGES);
         virtual ~jinf();
 
         void validate();
@@ -0,0 +1,180 @@
+/**
+ * \file lzf_codec.cpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * File containing code for class mrg::journal::lzf_codec (LZF record data
+ * compression codec). See comments in file lzf_codec.hpp for details.
+ *
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#include "jrnl/lzf_codec.hpp"
+
+#include <cstring>
+
+namespace mrg
+{
+namespace journal
+{
+
+const u_int8_t lzf_codec::LZF_CODEC_ID;
+
+lzf_codec::lzf_codec(): codec() {}
+
+lzf_codec::~lzf_codec() {}
+
+std::size_t
+lzf_codec::compress(const void* const src, const std::size_t src_len, void* const dest,
+        const std::size_t dest_len) const
+{
+    const u_int8_t* const in = (const u_int8_t*)src;
+    const u_int8_t* const in_end = in + src_len;
+    u_int8_t* const out = (u_int8_t*)dest;
+    const u_int8_t* const out_end = out + dest_len;
+
+    // Hash table holds (input offset + 1) of the last position with a given 3-byte hash; 0 = empty
+    u_int32_t htab[HSIZE];
+    std::memset(htab, 0, sizeof(htab));
+
+    const u_int8_t* ip = in;
+    const u_int8_t* lit = in;
+    u_int8_t* op = out;
+    while (in_end - ip > 2)
+    {
+        const u_int32_t h = hash(ip);
+        const u_int32_t cand = htab[h];
+        htab[h] = (ip - in) + 1;
+        if (cand)
+        {
+            const u_int8_t* const ref = in + cand - 1;
+            const std::size_t off = ip - ref - 1;
+            if (off < MAX_OFF && ref[0] == ip[0] && ref[1] == ip[1] && ref[2] == ip[2])
+            {
+                std::size_t max_len = in_end - ip;
+                if (max_len > MAX_REF)
+                    max_len = MAX_REF;
+                std::size_t len = 3;
+                while (len < max_len && ref[len] == ip[len])
+                    len++;
+
+                if (!emit_literals(lit, ip - lit, op, out_end))
+                    return 0;
+                const std::size_t l = len - 2;
+                if (l < 7)
+                {
+                    if (out_end - op < 2)
+                        return 0;
+                    *op++ = (l << 5) | (off >> 8);
+                }
+                else
+                {
+                    if (out_end - op < 3)
+                        return 0;
+                    *op++ = (7 << 5) | (off >> 8);
+                    *op++ = l - 7;
+                }
+                *op++ = off & 0xff;
+
+                // Seed the table with the last position inside the match so that runs chain
+                ip += len;
+                if (in_end - ip > 2)
+                    htab[hash(ip - 1)] = (ip - 1 - in) + 1;
+                lit = ip;
+                continue;
+            }
+        }
+        ip++;
+    }
+    if (!emit_literals(lit, in_end - lit, op, out_end))
+        return 0;
+    return op - out;
+}
+
+bool
+lzf_codec::decompress(const void* const src, const std::size_t src_len, void* const dest,
+        const std::size_t dest_len) const
+{
+    const u_int8_t* ip = (const u_int8_t*)src;
+    const u_int8_t* const in_end = ip + src_len;
+    u_int8_t* const out = (u_int8_t*)dest;
+    u_int8_t* op = out;
+    const u_int8_t* const out_end = out + dest_len;
+
+    while (ip < in_end)
+    {
+        const std::size_t ctrl = *ip++;
+        if (ctrl < MAX_LIT) // literal run
+        {
+            const std::size_t len = ctrl + 1;
+            if ((std::size_t)(in_end - ip) < len || (std::size_t)(out_end - op) < len)
+                return false;
+            std::memcpy(op, ip, len);
+            op += len;
+            ip += len;
+        }
+        else // back reference
+        {
+            std::size_t len = ctrl >> 5;
+            if (len == 7)
+            {
+                if (ip >= in_end)
+                    return false;
+                len += *ip++;
+            }
+            len += 2;
+            if (ip >= in_end)
+                return false;
+            const std::size_t off = ((ctrl & 0x1f) << 8) + *ip++ + 1;
+            if ((std::size_t)(op - out) < off || (std::size_t)(out_end - op) < len)
+                return false;
+            // Source and destination may overlap (repeating patterns), so copy byte-wise
+            const u_int8_t* ref = op - off;
+            while (len--)
+                *op++ = *ref++;
+        }
+    }
+    return op == out_end;
+}
+
+bool
+lzf_codec::emit_literals(const u_int8_t* lit, std::size_t lit_len, u_int8_t*& op,
+        const u_int8_t* const op_end)
+{
+    while (lit_len)
+    {
+        std::size_t run = lit_len;
+        if (run > MAX_LIT)
+            run = MAX_LIT;
+        if ((std::size_t)(op_end - op) < run + 1)
+            return false;
+        *op++ = run - 1;
+        std::memcpy(op, lit, run);
+        op += run;
+        lit += run;
+        lit_len -= run;
+    }
+    return true;
+}
+
+} // namespace journal
+} // namespace mrg
@@ -0,0 +1,99 @@
+/**
+ * \file lzf_codec.hpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * File containing code for class mrg::journal::lzf_codec (LZF record data
+ * compression codec). See class documentation for details.
+ *
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#ifndef mrg_journal_lzf_codec_hpp
+#define mrg_journal_lzf_codec_hpp
+
+namespace mrg
+{
+namespace journal
+{
+class lzf_codec;
+}
+}
+
+#include "jrnl/codec.hpp"
+
+namespace mrg
+{
+namespace journal
+{
+
+    /**
+    * \class lzf_codec
+    * \brief Built-in codec producing the LZF stream format (as used by liblzf).
+    *
+    * LZF is a byte-oriented LZ77 variant chosen for its speed rather than its ratio; compression
+    * costs roughly one hash lookup per input byte and decompression is a simple copy loop, so it
+    * is cheap enough to sit in the enqueue path. The stream is a sequence of control bytes:
+    * <pre>
+    *   000LLLLL <L+1 literal bytes>                    literal run, 1-32 bytes
+    *   LLLooooo oooooooo                               back reference, length L+2 (L<7)
+    *   111ooooo LLLLLLLL oooooooo                      back reference, length L+9
+    * </pre>
+    * where o is the offset back from the current output position less 1 (max 8191).
+    */
+    class lzf_codec : public codec
+    {
+    public:
+        static const u_int8_t LZF_CODEC_ID = 1;
+
+    private:
+        static const u_int32_t HLOG = 13;           ///< log2 of hash table size
+        static const u_int32_t HSIZE = 1 << HLOG;   ///< Hash table size (entries)
+        static const std::size_t MAX_LIT = 1 << 5;  ///< Max literal run length
+        static const std::size_t MAX_OFF = 1 << 13; ///< Max back reference offset
+        static const std::size_t MAX_REF = (1 << 8) + (1 << 3); ///< Max back reference length
+
+    public:
+        lzf_codec();
+        virtual ~lzf_codec();
+
+        inline u_int8_t id() const { return LZF_CODEC_ID; }
+        inline const char* name() const { return "lzf"; }
+        std::size_t compress(const void* const src, const std::size_t src_len, void* const dest,
+                const std::size_t dest_len) const;
+        bool decompress(const void* const src, const std::size_t src_len, void* const dest,
+                const std::size_t dest_len) const;
+
+    private:
+        static inline u_int32_t hash(const u_int8_t* const p)
+        {
+            const u_int32_t v = (p[0] << 16) | (p[1] << 8) | p[2];
+            return (v * 2654435761U) >> (32 - HLOG);
+        }
+        static bool emit_literals(const u_int8_t* lit, std::size_t lit_len, u_int8_t*& op,
+                const u_int8_t* const op_end);
+    }; // class lzf_codec
+
+} // namespace journal
+} // namespace mrg
+
+#endif // ifndef mrg_journal_lzf_codec_hpp
@@ -0,0 +1,97 @@
+/**
+ * \file mdeq_hdr.hpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * File containing code for class mrg::journal::mdeq_hdr (multi-rid dequeue
+ * record header), used to start a dequeue record which dequeues several
+ * previously enqueued records at once.
+ *
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#ifndef mrg_journal_mdeq_hdr_hpp
+#define mrg_journal_mdeq_hdr_hpp
+
+#include <cstddef>
+#include "jrnl/rec_hdr.hpp"
+
+namespace mrg
+{
+namespace journal
+{
+
+#pragma pack(1)
+
+    /**
+    * \brief Struct for multi-rid dequeue record.
+    *
+    * Struct for a non-transactional dequeue record which dequeues deq-cnt previously enqueued
+    * records at once. This header is followed by deq-cnt 64-bit rids of the records being
+    * dequeued, and then by a rec_tail.
+    *
+    * As with the single dequeue record (deq_hdr), the rid field below is the rid of the dequeue
+    * record itself, and is distinct from the rids of the records it is dequeueing.
+    *
+    * Record header info in binary format (24 bytes):
+    * <pre>
+    *   0                           7
+    * +---+---+---+---+---+---+---+---+  -+
+    * |     magic     | v | e | flags |   |
+    * +---+---+---+---+---+---+---+---+   | struct hdr
+    * |              rid              |   |
+    * +---+---+---+---+---+---+---+---+  -+
+    * |            deq-cnt            |
+    * +---+---+---+---+---+---+---+---+
+    * v = file version (If the format or encoding of this file changes, then this
+    *     number should be incremented)
+    * e = endian flag, false (0x00) for little endian, true (0x01) for big endian
+    * </pre>
+    */
+    struct mdeq_hdr : rec_hdr
+    {
+        u_int64_t _deq_cnt;     ///< Number of dequeued record ids which follow this header
+
+        /**
+        * \brief Default constructor, which sets all values to 0.
+        */
+        inline mdeq_hdr(): rec_hdr(), _deq_cnt(0) {}
+
+        /**
+        * \brief Convenience constructor which initializes values during construction.
+        */
+        inline mdeq_hdr(const u_int32_t magic, const u_int8_t version, const u_int64_t rid,
+                const u_int64_t deq_cnt, const bool owi):
+                rec_hdr(magic, version, rid, owi), _deq_cnt(deq_cnt) {}
+
+        /**
+        * \brief Returns the size of the header in bytes.
+        */
+        inline static std::size_t size() { return sizeof(mdeq_hdr); }
+    };
+
+#pragma pack()
+
+} // namespace journal
+} // namespace mrg
+
+#endif // ifndef mrg_journal_mdeq_hdr_hpp
@@ -0,0 +1,266 @@
+/**
+ * \file mdeq_rec.cpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * This file contains the code for the mrg::journal::mdeq_rec (multi-rid
+ * dequeue record) class. See comments in file mdeq_rec.hpp for details.
+ *
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#include "jrnl/mdeq_rec.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <iomanip>
+#include "jrnl/jerrno.hpp"
+#include "jrnl/jexception.hpp"
+#include <sstream>
+
+namespace mrg
+{
+namespace journal
+{
+
+mdeq_rec::mdeq_rec():
+        _mdeq_hdr(RHM_JDAT_MDEQ_MAGIC, RHM_JDAT_VERSION, 0, 0, false),
+        _drid_arr(0),
+        _buff(),
+        _mdeq_tail(_mdeq_hdr)
+{}
+
+mdeq_rec::mdeq_rec(const u_int64_t rid, const u_int64_t* const drid_arr, const std::size_t drid_cnt,
+        const bool owi):
+        _mdeq_hdr(RHM_JDAT_MDEQ_MAGIC, RHM_JDAT_VERSION, rid, drid_cnt, owi),
+        _drid_arr(drid_arr),
+        _buff(),
+        _mdeq_tail(_mdeq_hdr)
+{}
+
+mdeq_rec::~mdeq_rec()
+{
+    clean();
+}
+
+void
+mdeq_rec::reset()
+{
+    _mdeq_hdr._rid = 0;
+    _mdeq_hdr.set_owi(false);
+    _mdeq_hdr._deq_cnt = 0;
+    _mdeq_tail._rid = 0;
+    _drid_arr = 0;
+    _buff.clear();
+}
+
+void
+mdeq_rec::reset(const u_int64_t rid, const u_int64_t* const drid_arr, const std::size_t drid_cnt,
+        const bool owi)
+{
+    _mdeq_hdr._rid = rid;
+    _mdeq_hdr.set_owi(owi);
+    _mdeq_hdr._deq_cnt = drid_cnt;
+    _mdeq_tail._rid = rid;
+    _drid_arr = drid_arr;
+    _buff.clear();
+}
+
+u_int32_t
+mdeq_rec::encode(void* wptr, u_int32_t rec_offs_dblks, u_int32_t max_size_dblks)
+{
+    assert(wptr != 0);
+    assert(max_size_dblks > 0);
+    assert(_drid_arr != 0 && _mdeq_hdr._deq_cnt > 0);
+
+    std::size_t offs = rec_offs_dblks * JRNL_DBLK_SIZE;
+    std::size_t rem = max_size_dblks * JRNL_DBLK_SIZE;
+    std::size_t wr_cnt = 0;
+    copy_seg(wptr, &_mdeq_hdr, sizeof(_mdeq_hdr), offs, rem, wr_cnt, false);
+    copy_seg(wptr, _drid_arr, _mdeq_hdr._deq_cnt * sizeof(u_int64_t), offs, rem, wr_cnt, false);
+    copy_seg(wptr, &_mdeq_tail, sizeof(_mdeq_tail), offs, rem, wr_cnt, false);
+    assert(offs == 0);
+#ifdef RHM_CLEAN
+    if (rem)
+        std::memset((char*)wptr + wr_cnt, RHM_CLEAN_CHAR, size_dblks(wr_cnt) * JRNL_DBLK_SIZE - wr_cnt);
+#endif
+    return size_dblks(wr_cnt);
+}
+
+u_int32_t
+mdeq_rec::decode(rec_hdr& h, void* rptr, u_int32_t rec_offs_dblks, u_int32_t max_size_dblks)
+{
+    assert(rptr != 0);
+    assert(max_size_dblks > 0);
+
+    std::size_t offs = rec_offs_dblks * JRNL_DBLK_SIZE;
+    std::size_t rem = max_size_dblks * JRNL_DBLK_SIZE;
+    std::size_t rd_cnt = 0;
+    if (rec_offs_dblks == 0) // Start of record
+    {
+        // Get and check header; assumption: the header will always fit into the first dblk
+        _mdeq_hdr.hdr_copy(h);
+        _mdeq_hdr._deq_cnt = *(u_int64_t*)((char*)rptr + sizeof(rec_hdr));
+        chk_hdr();
+        _drid_arr = 0;
+        _buff.resize(_mdeq_hdr._deq_cnt);
+    }
+    copy_seg(&_mdeq_hdr, rptr, sizeof(_mdeq_hdr), offs, rem, rd_cnt, true);
+    copy_seg(_buff.empty() ? 0 : &_buff[0], rptr, _buff.size() * sizeof(u_int64_t), offs, rem, rd_cnt, true);
+    copy_seg(&_mdeq_tail, rptr, sizeof(_mdeq_tail), offs, rem, rd_cnt, true);
+    if (rec_offs_dblks * JRNL_DBLK_SIZE + rd_cnt >= rec_size())
+        chk_tail();
+    return size_dblks(rd_cnt);
+}
+
+bool
+mdeq_rec::rcv_decode(rec_hdr h, std::ifstream* ifsp, std::size_t& rec_offs)
+{
+    if (rec_offs == 0)
+    {
+        _mdeq_hdr.hdr_copy(h);
+        ifsp->read((char*)&_mdeq_hdr._deq_cnt, sizeof(u_int64_t));
+        rec_offs = sizeof(_mdeq_hdr);
+        _drid_arr = 0;
+        _buff.resize(_mdeq_hdr._deq_cnt);
+    }
+    const std::size_t drid_size = _mdeq_hdr._deq_cnt * sizeof(u_int64_t);
+    if (rec_offs < sizeof(_mdeq_hdr) + drid_size)
+    {
+        // Read rid list (or continue reading rid list)
+        std::size_t offs = rec_offs - sizeof(_mdeq_hdr);
+        ifsp->read((char*)&_buff[0] + offs, drid_size - offs);
+        std::size_t size_read = ifsp->gcount();
+        rec_offs += size_read;
+        if (size_read < drid_size - offs)
+        {
+            assert(ifsp->eof());
+            // As we may have read past eof, turn off fail bit
+            ifsp->clear(ifsp->rdstate()&(~std::ifstream::failbit));
+            assert(!ifsp->fail() && !ifsp->bad());
+            return false;
+        }
+    }
+    if (rec_offs < sizeof(_mdeq_hdr) + drid_size + sizeof(rec_tail))
+    {
+        // Read tail (or continue reading tail)
+        std::size_t offs = rec_offs - sizeof(_mdeq_hdr) - drid_size;
+        ifsp->read((char*)&_mdeq_tail + offs, sizeof(rec_tail) - offs);
+        std::size_t size_read = ifsp->gcount();
+        rec_offs += size_read;
+        if (size_read < sizeof(rec_tail) - offs)
+        {
+            assert(ifsp->eof());
+            // As we may have read past eof, turn off fail bit
+            ifsp->clear(ifsp->rdstate()&(~std::ifstream::failbit));
+            assert(!ifsp->fail() && !ifsp->bad());
+            return false;
+        }
+    }
+    ifsp->ignore(rec_size_dblks() * JRNL_DBLK_SIZE - rec_size());
+    chk_tail(); // Throws if tail invalid or record incomplete
+    assert(!ifsp->fail() && !ifsp->bad());
+    return true;
+}
+
+std::string&
+mdeq_rec::str(std::string& str) const
+{
+    std::ostringstream oss;
+    oss << "mdeq_rec: m=" << _mdeq_hdr._magic;
+    oss << " v=" << (int)_mdeq_hdr._version;
+    oss << " rid=" << _mdeq_hdr._rid;
+    oss << " deq_cnt=" << _mdeq_hdr._deq_cnt;
+    str.append(oss.str());
+    return str;
+}
+
+std::size_t
+mdeq_rec::rec_size() const
+{
+    return rec_size(_mdeq_hdr._deq_cnt);
+}
+
+std::size_t
+mdeq_rec::rec_size(const std::size_t drid_cnt)
+{
+    return mdeq_hdr::size() + drid_cnt * sizeof(u_int64_t) + rec_tail::size();
+}
+
+void
+mdeq_rec::copy_seg(void* dest, const void* src, const std::size_t seg_size, std::size_t& offs,
+        std::size_t& rem, std::size_t& cnt, const bool to_seg)
+{
+    if (offs >= seg_size) // This segment was completely copied in a previous call
+    {
+        offs -= seg_size;
+        return;
+    }
+    std::size_t size = seg_size - offs;
+    if (size > rem)
+        size = rem;
+    if (size)
+    {
+        std::memcpy(static_cast<char*>(dest) + (to_seg ? offs : cnt),
+                static_cast<const char*>(src) + (to_seg ? cnt : offs), size);
+        cnt += size;
+        rem -= size;
+    }
+    offs = 0;
+}
+
+void
+mdeq_rec::chk_hdr() const
+{
+    jrec::chk_hdr(_mdeq_hdr);
+    if (_mdeq_hdr._magic != RHM_JDAT_MDEQ_MAGIC)
+    {
+        std::ostringstream oss;
+        oss << std::hex << std::setfill('0');
+        oss << "mdeq magic: rid=0x" << std::setw(16) << _mdeq_hdr._rid;
+        oss << ": expected=0x" << std::setw(8) << RHM_JDAT_MDEQ_MAGIC;
+        oss << " read=0x" << std::setw(2) << (int)_mdeq_hdr._magic;
+        throw jexception(jerrno::JERR_JREC_BADRECHDR, oss.str(), "mdeq_rec", "chk_hdr");
+    }
+}
+
+void
+mdeq_rec::chk_hdr(u_int64_t rid) const
+{
+    chk_hdr();
+    jrec::chk_rid(_mdeq_hdr, rid);
+}
+
+void
+mdeq_rec::chk_tail() const
+{
+    jrec::chk_tail(_mdeq_tail, _mdeq_hdr);
+}
+
+void
+mdeq_rec::clean()
+{
+    // clean up allocated memory here
+}
+
+} // namespace journal
+} // namespace mrg
@@ -0,0 +1,112 @@
+/**
+ * \file mdeq_rec.hpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * This file contains the code for the mrg::journal::mdeq_rec (multi-rid
+ * dequeue record) class. See class documentation for details.
+ *
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#ifndef mrg_journal_mdeq_rec_hpp
+#define mrg_journal_mdeq_rec_hpp
+
+namespace mrg
+{
+namespace journal
+{
+class mdeq_rec;
+}
+}
+
+#include <cstddef>
+#include "jrnl/jrec.hpp"
+#include "jrnl/mdeq_hdr.hpp"
+#include "jrnl/rec_tail.hpp"
+#include <vector>
+
+namespace mrg
+{
+namespace journal
+{
+
+    /**
+    * \class mdeq_rec
+    * \brief Class to handle a single journal dequeue record which dequeues several records.
+    *
+    * The record consists of an mdeq_hdr, the list of dequeued rids and a rec_tail. As the rid
+    * list may be of any length, the record may be split over several pages or files in the same
+    * way as the data portion of an enqueue record.
+    */
+    class mdeq_rec : public jrec
+    {
+    private:
+        mdeq_hdr _mdeq_hdr;             ///< Multi-rid dequeue header
+        const u_int64_t* _drid_arr;     ///< Array of dequeued rids for encoding (writing to disk)
+        std::vector<u_int64_t> _buff;   ///< Buffer to receive dequeued rids read from disk
+        rec_tail _mdeq_tail;            ///< Record tail
+
+    public:
+        // constructor used for read operations and rid list will have memory allocated
+        mdeq_rec();
+        // constructor used for write operations, where rid list already exists
+        mdeq_rec(const u_int64_t rid, const u_int64_t* const drid_arr, const std::size_t drid_cnt,
+                const bool owi);
+        virtual ~mdeq_rec();
+
+        // Prepare instance for use in reading data from journal
+        void reset();
+        // Prepare instance for use in writing data to journal
+        void reset(const u_int64_t rid, const u_int64_t* const drid_arr, const std::size_t drid_cnt,
+                const bool owi);
+        u_int32_t encode(void* wptr, u_int32_t rec_offs_dblks, u_int32_t max_size_dblks);
+        u_int32_t decode(rec_hdr& h, void* rptr, u_int32_t rec_offs_dblks,
+                u_int32_t max_size_dblks);
+        // Decode used for recover
+        bool rcv_decode(rec_hdr h, std::ifstream* ifsp, std::size_t& rec_offs);
+
+        inline u_int64_t rid() const { return _mdeq_hdr._rid; }
+        inline std::size_t deq_cnt() const { return _mdeq_hdr._deq_cnt; }
+        inline u_int64_t deq_rid(const std::size_t i) const { return _drid_arr ? _drid_arr[i] : _buff[i]; }
+        std::string& str(std::string& str) const;
+        inline std::size_t data_size() const { return 0; } // This record never carries data
+        inline std::size_t xid_size() const { return 0; } // This record is never transactional
+        std::size_t rec_size() const;
+        static std::size_t rec_size(const std::size_t drid_cnt);
+
+    private:
+        // Copy the part of a record segment (of seg_size bytes) which lies between record offset offs
+        // and offs + rem from the record buffer into the segment (to_seg, dest is the segment) or from
+        // the segment into the record buffer (dest is the buffer). cnt is the offset in the buffer.
+        static void copy_seg(void* dest, const void* src, const std::size_t seg_size, std::size_t& offs,
+                std::size_t& rem, std::size_t& cnt, const bool to_seg);
+        virtual void chk_hdr() const;
+        virtual void chk_hdr(u_int64_t rid) const;
+        virtual void chk_tail() const;
+        virtual void clean();
+    }; // class mdeq_rec
+
+} // namespace journal
+} // namespace mrg
+
+#endif // ifndef mrg_journal_mdeq_rec_hpp
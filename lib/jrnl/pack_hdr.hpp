@@ -0,0 +1,150 @@
+/**
+ * \file pack_hdr.hpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * File containing code for class mrg::journal::pack_hdr (packed record
+ * header), used to store several small records within a single data block.
+ *
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#ifndef mrg_journal_pack_hdr_hpp
+#define mrg_journal_pack_hdr_hpp
+
+#include <cstddef>
+#include <cstring>
+#include "jrnl/deq_hdr.hpp"
+#include "jrnl/enq_hdr.hpp"
+#include "jrnl/jcfg.hpp"
+#include "jrnl/rec_hdr.hpp"
+#include "jrnl/rec_tail.hpp"
+
+namespace mrg
+{
+namespace journal
+{
+
+#pragma pack(1)
+
+    /**
+    * \brief Struct for the header of a packed data block.
+    *
+    * Every record normally starts on a data block (dblk) boundary, so a record smaller than
+    * JRNL_DBLK_SIZE still costs a whole dblk on disk. A packed dblk instead holds several small
+    * non-transactional records (i.e. dequeues and small enqueues without an XID) one after
+    * another. The dblk starts with this header, whose rid is that of the first record in the
+    * dblk. Each packed record is stored complete and unchanged (header, data and tail as
+    * appropriate) starting at the next PACK_ALIGN byte boundary. The unused space at the end of
+    * the dblk is zeroed, so a zero magic (or insufficient space for a rec_hdr) ends the dblk.
+    *
+    * Packed dblk layout (JRNL_DBLK_SIZE bytes):
+    * <pre>
+    *   0                           7
+    * +---+---+---+---+---+---+---+---+  -+
+    * |     magic     | v | e | flags |   |
+    * +---+---+---+---+---+---+---+---+   | struct hdr
+    * |     rid of first record       |   |
+    * +---+---+---+---+---+---+---+---+  -+
+    * |  record 1 (deq/enq, no XID)   |
+    * +---+---+---+---+---+---+---+---+
+    * |  record 2 ...                 |
+    * +---+---+---+---+---+---+---+---+
+    * |  0 ...                        |
+    * +---+---+---+---+---+---+---+---+
+    * v = file version (If the format or encoding of this file changes, then this
+    *     number should be incremented)
+    * e = endian flag, false (0x00) for little endian, true (0x01) for big endian
+    * </pre>
+    */
+    struct pack_hdr : rec_hdr
+    {
+        static const std::size_t PACK_ALIGN = 8;    ///< Alignment of records within the dblk
+
+        /**
+        * \brief Default constructor, which sets all values to 0.
+        */
+        inline pack_hdr(): rec_hdr() {}
+
+        /**
+        * \brief Convenience constructor which initializes values during construction.
+        */
+        inline pack_hdr(const u_int32_t magic, const u_int8_t version, const u_int64_t rid,
+                const bool owi): rec_hdr(magic, version, rid, owi) {}
+
+        /**
+        * \brief Returns the size of a record of rec_size bytes once aligned within a packed dblk.
+        */
+        inline static std::size_t aligned_size(const std::size_t rec_size)
+        { return (rec_size + PACK_ALIGN - 1) & ~(PACK_ALIGN - 1); }
+
+        /**
+        * \brief Returns true if a record of rec_size bytes can be added at byte offset offs of a
+        *     packed dblk.
+        */
+        inline static bool fits(const std::size_t offs, const std::size_t rec_size)
+        { return offs + rec_size <= JRNL_DBLK_SIZE; }
+
+        /**
+        * \brief Returns the size in bytes of the packed record at byte offset offs of the packed
+        *     dblk dblkp, or 0 if there are no further records in the dblk.
+        */
+        static std::size_t rec_size(const void* const dblkp, const std::size_t offs)
+        {
+            if (offs + rec_hdr::size() > JRNL_DBLK_SIZE)
+                return 0;
+            std::size_t size = 0;
+            const char* const rptr = (const char*)dblkp + offs;
+            u_int32_t magic;
+            std::memcpy(&magic, rptr, sizeof(magic));
+            if (magic == RHM_JDAT_ENQ_MAGIC && offs + enq_hdr::size() <= JRNL_DBLK_SIZE)
+            {
+                enq_hdr eh;
+                std::memcpy(&eh, rptr, sizeof(eh));
+                if (eh._xidsize > JRNL_DBLK_SIZE || eh._dsize > JRNL_DBLK_SIZE)
+                    return 0;
+                size = enq_hdr::size() + eh._xidsize + (eh.is_external() ? 0 : eh._dsize) +
+                        rec_tail::size();
+            }
+            else if (magic == RHM_JDAT_DEQ_MAGIC && offs + deq_hdr::size() <= JRNL_DBLK_SIZE)
+            {
+                deq_hdr dh;
+                std::memcpy(&dh, rptr, sizeof(dh));
+                if (dh._xidsize > JRNL_DBLK_SIZE)
+                    return 0;
+                size = deq_hdr::size() + (dh._xidsize ? dh._xidsize + rec_tail::size() : 0);
+            }
+            return fits(offs, size) ? size : 0;
+        }
+
+        /**
+        * \brief Returns the size of the header in bytes.
+        */
+        inline static std::size_t size() { return sizeof(pack_hdr); }
+    };
+
+#pragma pack()
+
+} // namespace journal
+} // namespace mrg
+
+#endif // ifndef mrg_journal_pack_hdr_hpp
@@ -0,0 +1,146 @@
+/**
+ * \file page_alloc.cpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * File containing code for class mrg::journal::page_alloc (allocation
+ * policy for journal page cache memory). See comments in file
+ * page_alloc.hpp for details.
+ *
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+
+#include "jrnl/page_alloc.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include "jrnl/jcfg.hpp"
+#include "jrnl/jerrno.hpp"
+#include "jrnl/jexception.hpp"
+#include "jrnl/slock.hpp"
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace mrg
+{
+namespace journal
+{
+
+smutex page_alloc::_mutex;
+u_int32_t page_alloc::_policy = page_alloc::PA_DEFAULT;
+u_int32_t page_alloc::_outstanding = 0;
+
+bool
+page_alloc::set_policy(const u_int32_t policy)
+{
+    slock s(_mutex);
+    if (_outstanding && policy != _policy)
+        return false;
+    _policy = policy;
+    return true;
+}
+
+u_int32_t
+page_alloc::policy()
+{
+    slock s(_mutex);
+    return _policy;
+}
+
+void*
+page_alloc::alloc(const std::size_t size, const std::size_t align)
+{
+    slock s(_mutex);
+    void* p = 0;
+    if (_policy == PA_DEFAULT)
+    {
+        if (::posix_memalign(&p, align, size))
+        {
+            std::ostringstream oss;
+            oss << "posix_memalign(): blksize=" << align << " size=" << size;
+            oss << FORMAT_SYSERR(errno);
+            throw jexception(jerrno::JERR__MALLOC, oss.str(), "page_alloc", "alloc");
+        }
+        _outstanding++;
+        return p;
+    }
+
+    // mmap() returns page aligned memory, which is not yet faulted in
+    p = MAP_FAILED;
+    const bool huge = (_policy & PA_HUGE_PAGES) && size % JRNL_HUGE_PAGE_SIZE == 0;
+#ifdef MAP_HUGETLB
+    if (huge)
+        p = ::mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+    if (p == MAP_FAILED) // No explicit huge pages configured; fall back to normal (or transparent huge) pages
+    {
+        p = ::mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+        {
+            std::ostringstream oss;
+            oss << "mmap(): size=" << size << " policy=0x" << std::hex << _policy << std::dec;
+            oss << FORMAT_SYSERR(errno);
+            throw jexception(jerrno::JERR__MALLOC, oss.str(), "page_alloc", "alloc");
+        }
+#ifdef MADV_HUGEPAGE
+        if (huge)
+            ::madvise(p, size, MADV_HUGEPAGE); // Only a hint; failure is harmless
+#endif
+    }
+    // Fault the memory in from this thread so that it is placed on this thread's NUMA node
+    if (_policy & PA_NUMA_LOCAL)
+        std::memset(p, 0, size);
+    _outstanding++;
+    return p;
+}
+
+void
+page_alloc::free(void* const p, const std::size_t size)
+{
+    if (p == 0)
+        return;
+    slock s(_mutex);
+    if (_policy == PA_DEFAULT)
+        std::free(p);
+    else
+        ::munmap(p, size);
+    _outstanding--;
+}
+
+u_int32_t
+page_alloc::current_node()
+{
+#ifdef SYS_getcpu
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (::syscall(SYS_getcpu, &cpu, &node, 0) == 0)
+        return node;
+#endif
+    return 0;
+}
+
+} // namespace journal
+} // namespace mrg
@@ -0,0 +1,99 @@
+/**
+ * \file page_alloc.hpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * File containing code for class mrg::journal::page_alloc (allocation
+ * policy for journal page cache memory). See class documentation for
+ * details.
+ *
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+
+#ifndef mrg_journal_page_alloc_hpp
+#define mrg_journal_page_alloc_hpp
+
+#include <cstddef>
+#include "jrnl/smutex.hpp"
+#include <sys/types.h>
+
+namespace mrg
+{
+namespace journal
+{
+
+    /**
+    * \class page_alloc
+    * \brief Process-wide allocation policy for journal page cache memory (the write pages lent by
+    *     page_pool and the read caches of rmgr).
+    *
+    * With the default policy (PA_DEFAULT), pages are allocated with posix_memalign(). Otherwise they
+    * are mapped with mmap() and:
+    * - PA_HUGE_PAGES: allocations which are a multiple of JRNL_HUGE_PAGE_SIZE are backed by
+    *   explicit huge pages (MAP_HUGETLB) where these are available, falling back to transparent huge
+    *   pages (madvise(MADV_HUGEPAGE)) and then to normal pages. page_pool carves smaller write pages
+    *   out of huge page sized slabs so that they too benefit.
+    * - PA_NUMA_LOCAL: memory is faulted in by the allocating thread, so that under the kernel's
+    *   default (first touch) policy it is placed on that thread's NUMA node. As journal pages are
+    *   allocated by the thread writing to or reading from the journal, the cache ends up on the node
+    *   of the thread which drives it. page_pool keeps idle pages for each node separately.
+    *
+    * The policy may only be changed while no memory allocated by this class is outstanding, as
+    * memory must be freed the way it was allocated; set_policy() returns false otherwise.
+    */
+    class page_alloc
+    {
+    public:
+        enum policy_flags
+        {
+            PA_DEFAULT = 0x0,           ///< posix_memalign(), no placement
+            PA_HUGE_PAGES = 0x1,        ///< Back large allocations with huge pages
+            PA_NUMA_LOCAL = 0x2         ///< Place memory on the allocating thread's NUMA node
+        };
+
+    private:
+        static smutex _mutex;
+        static u_int32_t _policy;       ///< Current policy (policy_flags)
+        static u_int32_t _outstanding;  ///< Allocations not yet freed
+
+    public:
+        // Set the allocation policy; returns false (and leaves the policy unchanged) if memory is outstanding
+        static bool set_policy(const u_int32_t policy);
+        static u_int32_t policy();
+        static inline bool huge_pages() { return policy() & PA_HUGE_PAGES; }
+        static inline bool numa_local() { return policy() & PA_NUMA_LOCAL; }
+
+        // Allocate size bytes aligned to at least align bytes (a power of 2 no greater than the system
+        // page size); throws JERR__MALLOC on failure
+        static void* alloc(const std::size_t size, const std::size_t align);
+        // Free memory returned by alloc() with the same size
+        static void free(void* const p, const std::size_t size);
+
+        // NUMA node of the CPU on which the calling thread is running (0 if unknown)
+        static u_int32_t current_node();
+    };
+
+} // namespace journal
+} // namespace mrg
+
+#endif // ifndef mrg_journal_page_alloc_hpp
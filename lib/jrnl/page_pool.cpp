@@ -0,0 +1,187 @@
+/**
+ * \file page_pool.cpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * File containing code for class mrg::journal::page_pool (process-wide
+ * pool of write cache pages). See comments in file page_pool.hpp for
+ * details.
+ *
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#include "jrnl/page_pool.hpp"
+
+#include "jrnl/jcfg.hpp"
+#include "jrnl/page_alloc.hpp"
+#include "jrnl/slock.hpp"
+
+namespace mrg
+{
+namespace journal
+{
+
+smutex page_pool::_mutex;
+page_pool::page_list_map page_pool::_idle;
+page_pool::page_info_map page_pool::_pages;
+u_int32_t page_pool::_alloc_pages = 0;
+u_int32_t page_pool::_used_pages = 0;
+u_int64_t page_pool::_alloc_bytes = 0;
+page_pool_listener* page_pool::_lp = 0;
+
+void*
+page_pool::get_page(const std::size_t size)
+{
+    slock s(_mutex);
+    const u_int32_t node = page_alloc::numa_local() ? page_alloc::current_node() : 0;
+    page_list& pl = _idle[page_key(node, size)];
+    void* pp = 0;
+    int32_t alloc_chg = 0;
+    if (pl.empty())
+        pp = alloc_page(node, size, alloc_chg);
+    else
+    {
+        pp = pl.back();
+        pl.pop_back();
+    }
+    _used_pages++;
+    if (_lp)
+        _lp->pool_pages_chg(alloc_chg, 1);
+    return pp;
+}
+
+void
+page_pool::put_page(void* const pp, const std::size_t size)
+{
+    slock s(_mutex);
+    page_info_map_itr itr = _pages.find(pp);
+    const u_int32_t node = itr == _pages.end() ? 0 : itr->second._node;
+    const bool slab = itr != _pages.end() && itr->second._slab;
+    page_list& pl = _idle[page_key(node, size)];
+    int32_t alloc_chg = 0;
+    if (slab || pl.size() < JRNL_PAGE_POOL_MAX_IDLE)
+        pl.push_back(pp);
+    else
+    {
+        page_alloc::free(pp, size);
+        if (itr != _pages.end())
+            _pages.erase(itr);
+        _alloc_pages--;
+        _alloc_bytes -= size;
+        alloc_chg = -1;
+    }
+    _used_pages--;
+    if (_lp)
+        _lp->pool_pages_chg(alloc_chg, -1);
+}
+
+void
+page_pool::drop_page(void* const pp, const std::size_t size)
+{
+    slock s(_mutex);
+    page_info_map_itr itr = _pages.find(pp);
+    int32_t alloc_chg = 0;
+    // A slab page cannot be freed on its own; it is retired, and stays allocated with its slab
+    if (itr == _pages.end() || !itr->second._slab)
+    {
+        page_alloc::free(pp, size);
+        if (itr != _pages.end())
+            _pages.erase(itr);
+        _alloc_pages--;
+        _alloc_bytes -= size;
+        alloc_chg = -1;
+    }
+    _used_pages--;
+    if (_lp)
+        _lp->pool_pages_chg(alloc_chg, -1);
+}
+void
+page_pool::set_listener(page_pool_listener* const lp)
+{
+    slock s(_mutex);
+    _lp = lp;
+    if (_lp)
+        _lp->pool_pages_chg(_alloc_pages, _used_pages);
+}
+
+void
+page_pool::clear_listener(page_pool_listener* const lp)
+{
+    slock s(_mutex);
+    if (_lp == lp)
+        _lp = 0;
+}
+
+u_int32_t
+page_pool::alloc_pages()
+{
+    slock s(_mutex);
+    return _alloc_pages;
+}
+
+u_int32_t
+page_pool::used_pages()
+{
+    slock s(_mutex);
+    return _used_pages;
+}
+
+u_int64_t
+page_pool::alloc_bytes()
+{
+    slock s(_mutex);
+    return _alloc_bytes;
+}
+
+// Private functions
+
+void*
+page_pool::alloc_page(const u_int32_t node, const std::size_t size, int32_t& alloc_chg)
+{
+    const std::size_t sblksize = JRNL_SBLK_SIZE * JRNL_DBLK_SIZE;
+    if (page_alloc::huge_pages() && size < JRNL_HUGE_PAGE_SIZE && JRNL_HUGE_PAGE_SIZE % size == 0)
+    {
+        // Carve a huge page sized slab into pages, keeping all but the first as idle pages
+        char* const slab = (char*)page_alloc::alloc(JRNL_HUGE_PAGE_SIZE, sblksize);
+        const u_int32_t num_pages = JRNL_HUGE_PAGE_SIZE / size;
+        page_list& pl = _idle[page_key(node, size)];
+        for (u_int32_t i=0; i<num_pages; i++)
+        {
+            _pages.insert(page_info_map::value_type(slab + i * size, page_info(node, true)));
+            if (i)
+                pl.push_back(slab + i * size);
+        }
+        _alloc_pages += num_pages;
+        _alloc_bytes += JRNL_HUGE_PAGE_SIZE;
+        alloc_chg = num_pages;
+        return slab;
+    }
+    void* const pp = page_alloc::alloc(size, sblksize);
+    _pages.insert(page_info_map::value_type(pp, page_info(node, false)));
+    _alloc_pages++;
+    _alloc_bytes += size;
+    alloc_chg = 1;
+    return pp;
+}
+
+} // namespace journal
+} // namespace mrg
@@ -0,0 +1,124 @@
+/**
+ * \file page_pool.hpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * File containing code for class mrg::journal::page_pool (process-wide
+ * pool of write cache pages). See class documentation for details.
+ *
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#ifndef mrg_journal_page_pool_hpp
+#define mrg_journal_page_pool_hpp
+
+#include <cstddef>
+#include "jrnl/smutex.hpp"
+#include <map>
+#include <sys/types.h>
+#include <utility>
+#include <vector>
+
+namespace mrg
+{
+namespace journal
+{
+
+    /**
+    * \class page_pool_listener
+    * \brief Interface through which page_pool reports changes in the number of pages it has
+    *     allocated and lent out.
+    */
+    class page_pool_listener
+    {
+    public:
+        virtual ~page_pool_listener() {}
+        virtual void pool_pages_chg(const int32_t alloc_chg, const int32_t used_chg) = 0;
+    };
+
+    /**
+    * \class page_pool
+    * \brief Process-wide pool of aligned write cache pages, lent to journals while they have data
+    *     to write.
+    *
+    * Rather than allocating its whole write cache up front, a journal (wmgr) takes a page from the
+    * pool when it starts to fill it and returns it once the page's AIO write is complete, keeping
+    * only a configurable minimum number of pages while idle. The memory used by the write caches of
+    * a large number of mostly idle journals is therefore proportional to the pages actually being
+    * written rather than to the number of journals.
+    *
+    * Pages are pooled by size, as journals may use different page sizes. Returned pages are kept
+    * for reuse up to JRNL_PAGE_POOL_MAX_IDLE pages of each size; pages beyond this are freed.
+    *
+    * Memory is obtained through page_alloc. When huge pages are in use, pages smaller than
+    * JRNL_HUGE_PAGE_SIZE are carved out of huge page sized slabs; these pages are never freed
+    * individually and so are always kept for reuse. When NUMA local placement is in use, idle pages
+    * are kept separately for each node and a page is only reused on the node it was allocated on.
+    */
+    class page_pool
+    {
+    private:
+        struct page_info
+        {
+            u_int32_t _node;                ///< NUMA node on which page was allocated
+            bool _slab;                     ///< Page is part of a huge page slab
+            page_info(const u_int32_t node, const bool slab) : _node(node), _slab(slab) {}
+        };
+        typedef std::pair<u_int32_t, std::size_t> page_key;
+        typedef std::vector<void*> page_list;
+        typedef std::map<page_key, page_list> page_list_map;
+        typedef page_list_map::iterator page_list_map_itr;
+        typedef std::map<void*, page_info> page_info_map;
+        typedef page_info_map::iterator page_info_map_itr;
+
+        static smutex _mutex;
+        static page_list_map _idle;         ///< Idle pages, by NUMA node and page size
+        static page_info_map _pages;        ///< All allocated pages (in use or idle)
+        static u_int32_t _alloc_pages;      ///< Pages allocated (in use or idle)
+        static u_int32_t _used_pages;       ///< Pages currently lent to journals
+        static u_int64_t _alloc_bytes;      ///< Bytes allocated (in use or idle)
+        static page_pool_listener* _lp;     ///< Listener for page count changes, if any
+
+    public:
+        // Take a page of size bytes from the pool, allocating it if no idle page is available
+        static void* get_page(const std::size_t size);
+        // Return a page previously obtained from get_page() with the same size
+        static void put_page(void* const pp, const std::size_t size);
+        // Free a page previously obtained from get_page() which cannot be reused (eg AIO pending)
+        static void drop_page(void* const pp, const std::size_t size);
+        // Set the listener, which is first told the current page counts; 0 removes it
+        static void set_listener(page_pool_listener* const lp);
+        // Remove the listener if it is lp
+        static void clear_listener(page_pool_listener* const lp);
+
+        static u_int32_t alloc_pages();
+        static u_int32_t used_pages();
+        static u_int64_t alloc_bytes();
+
+    private:
+        static void* alloc_page(const u_int32_t node, const std::size_t size, int32_t& alloc_chg);
+    };
+
+} // namespace journal
+} // namespace mrg
+
+#endif // ifndef mrg_journal_page_pool_hpp
@@ -38,6 +38,7 @@
 #include "jrnl/jcfg.hpp"
 #include "jrnl/jcntl.hpp"
 #include "jrnl/jerrno.hpp"
+#include "jrnl/page_alloc.hpp"
 #include <sstream>
 
 
@@ -54,6 +55,8 @@ pmgr::page_cb::page_cb(u_int16_t index):
         _pdtokl(0),
         _wfh(0),
         _rfh(0),
+        _rreset_cnt(0),
+        _rpages(0),
         _pbuff(0)
 {}
 
@@ -104,7 +107,8 @@ pmgr::~pmgr()
 }
 
 void
-pmgr::initialize(aio_callback* const cbp, const u_int32_t cache_pgsize_sblks, const u_int16_t cache_num_pages)
+pmgr::initialize(aio_callback* const cbp, const u_int32_t cache_pgsize_sblks, const u_int16_t cache_num_pages,
+        const bool alloc_pages)
 {
     // As static use of this class keeps old values around, clean up first...
     pmgr::clean();
@@ -117,14 +121,17 @@ pmgr::initialize(aio_callback* const cbp, const u_int32_t cache_pgsize_sblks, co
     _cbp = cbp;
 
     // 1. Allocate page memory (as a single block)
-    std::size_t cache_pgsize = _cache_num_pages * _cache_pgsize_sblks * _sblksize;
-    if (::posix_memalign(&_page_base_ptr, _sblksize, cache_pgsize))
+    if (alloc_pages)
     {
-        clean();
-        std::ostringstream oss;
-        oss << "posix_memalign(): blksize=" << _sblksize << " size=" << cache_pgsize;
-        oss << FORMAT_SYSERR(errno);
-        throw jexception(jerrno::JERR__MALLOC, oss.str(), "pmgr", "initialize");
+        try
+        {
+            _page_base_ptr = page_alloc::alloc(_cache_num_pages * _cache_pgsize_sblks * _sblksize, _sblksize);
+        }
+        catch (const jexception&)
+        {
+            clean();
+            throw;
+        }
     }
     // 2. Allocate array of page pointers
     _page_ptr_arr = (void**)std::malloc(_cache_num_pages * sizeof(void*));
@@ -142,7 +149,7 @@ pmgr::initialize(aio_callback* const cbp, const u_int32_t cache_pgsize_sblks, co
     // 6. Set page pointers in _page_ptr_arr, _page_cb_arr and iocbs to pages within page block
     for (u_int16_t i=0; i<_cache_num_pages; i++)
     {
-        _page_ptr_arr[i] = (void*)((char*)_page_base_ptr + _cache_pgsize_sblks * _sblksize * i);
+        _page_ptr_arr[i] = alloc_pages ? (void*)((char*)_page_base_ptr + _cache_pgsize_sblks * _sblksize * i) : 0;
         _page_cb_arr[i]._index = i;
         _page_cb_arr[i]._state = UNUSED;
         _page_cb_arr[i]._pbuff = _page_ptr_arr[i];
@@ -173,7 +180,7 @@ pmgr::clean()
     if (_ioctx)
         aio::queue_release(_ioctx);
 
-    std::free(_page_base_ptr);
+    page_alloc::free(_page_base_ptr, _cache_num_pages * _cache_pgsize_sblks * _sblksize);
     _page_base_ptr = 0;
 
     if (_page_cb_arr)
@@ -194,6 +201,21 @@ pmgr::clean()
     _aio_event_arr = 0;
 }
 
+std::size_t
+pmgr::mem_bytes() const
+{
+    if (!_page_cb_arr)
+        return 0;
+    std::size_t bytes = _cache_num_pages * (sizeof(void*) + sizeof(page_cb) + sizeof(aio_cb) +
+            sizeof(std::deque<data_tok*>));
+    bytes += (_cache_num_pages + _jc->num_jfiles()) * sizeof(aio_event);
+    if (_page_base_ptr)
+        bytes += std::size_t(_cache_num_pages) * _cache_pgsize_sblks * _sblksize;
+    for (u_int16_t i=0; i<_cache_num_pages; i++)
+        bytes += _page_cb_arr[i]._pdtokl->size() * sizeof(data_tok*);
+    return bytes;
+}
+
 const char*
 pmgr::page_state_str(page_state ps)
 {
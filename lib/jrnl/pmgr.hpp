@@ -90,7 +90,9 @@ namespace journal
             u_int32_t _rdblks;          ///< Total number of dblks in page
             std::deque<data_tok*>* _pdtokl; ///< Page message tokens list
             fcntl* _wfh;                ///< File handle for incrementing write compl counts
-            fcntl* _rfh;                ///< File handle for incrementing read compl counts
+            fcntl* _rfh;                ///< File read into this page
+            u_int32_t _rreset_cnt;      ///< Reset count of _rfh when read was submitted
+            u_int16_t _rpages;          ///< Number of pages filled by the read submitted for this page
             void* _pbuff;               ///< Page buffer
 
             page_cb(u_int16_t index);   ///< Convenience constructor
@@ -128,10 +130,14 @@ namespace journal
         static const char* page_state_str(page_state ps);
         inline u_int32_t cache_pgsize_sblks() const { return _cache_pgsize_sblks; }
         inline u_int16_t cache_num_pages() const { return _cache_num_pages; }
+        // Estimated heap memory held by page memory, control blocks and page token lists
+        virtual std::size_t mem_bytes() const;
 
     protected:
+        // If alloc_pages is false, no page memory is allocated and all page pointers are 0; the
+        // subclass then manages page memory itself (see wmgr).
         virtual void initialize(aio_callback* const cbp, const u_int32_t cache_pgsize_sblks,
-                const u_int16_t cache_num_pages);
+                const u_int16_t cache_num_pages, const bool alloc_pages = true);
         virtual void rotate_page() = 0;
         virtual void clean();
     };
@@ -0,0 +1,68 @@
+/**
+ * \file rcursor.cpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * File containing code for class mrg::journal::rcursor (independent read
+ * position within a journal). See comments in file rcursor.hpp for details.
+ *
+ * Copyright (c) 2007, 2008, 2009, 2010 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+
+#include "jrnl/rcursor.hpp"
+
+#include "jrnl/jcntl.hpp"
+
+namespace mrg
+{
+namespace journal
+{
+
+rcursor::rcursor(jcntl* const jc, const lpmgr* const lpmp, enq_map& emap, txn_map& tmap):
+        _jc(jc),
+        _rrfc(lpmp),
+        _rmgr(jc, emap, tmap, _rrfc)
+{}
+
+rcursor::~rcursor()
+{}
+
+iores
+rcursor::read_data_record(void** const datapp, std::size_t& dsize, void** const xidpp, std::size_t& xidsize,
+        bool& transient, bool& external, data_tok* const dtokp, bool ignore_pending_txns)
+{
+    return _jc->read_data_record(_rmgr, datapp, dsize, xidpp, xidsize, transient, external, dtokp,
+            ignore_pending_txns);
+}
+
+iores
+rcursor::read_data_record(void** const datapp, std::size_t& dsize, void** const xidpp, std::size_t& xidsize,
+        bool& transient, bool& external, data_tok* const dtokp, rd_buf& buf, rd_pin* const pinp,
+        bool ignore_pending_txns)
+{
+    return _jc->read_data_record(_rmgr, datapp, dsize, xidpp, xidsize, transient, external, dtokp,
+            ignore_pending_txns, pinp, &buf);
+}
+
+} // namespace journal
+} // namespace mrg
@@ -0,0 +1,115 @@
+/**
+ * \file rcursor.hpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * File containing code for class mrg::journal::rcursor (independent read
+ * position within a journal). See class documentation for details.
+ *
+ * Copyright (c) 2007, 2008, 2009 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+
+#ifndef mrg_journal_rcursor_hpp
+#define mrg_journal_rcursor_hpp
+
+namespace mrg
+{
+namespace journal
+{
+class jcntl;
+class rcursor;
+}
+}
+
+#include <cstddef>
+#include "jrnl/aio_callback.hpp"
+#include "jrnl/enums.hpp"
+#include "jrnl/rd_buf.hpp"
+#include "jrnl/rd_pin.hpp"
+#include "jrnl/rmgr.hpp"
+#include "jrnl/rrfc.hpp"
+
+namespace mrg
+{
+namespace journal
+{
+
+    /**
+    * \class rcursor
+    * \brief A read position within a journal, independent of the journal's own read position and of
+    *     any other cursor.
+    *
+    * Each cursor has its own read file controller (rrfc) and read manager (rmgr), and so its own read
+    * page cache, AIO context and position in the journal files. The journal file handles used for
+    * reading are shared with the journal and all its other cursors. Several threads may therefore
+    * read the same journal at the same time, each through its own cursor, without waiting for one
+    * another or disturbing each other's position. A cursor itself must only be used by one thread
+    * at a time.
+    *
+    * Cursors are obtained from jcntl::open_rcursor() once the journal is initialized or recovered,
+    * and must be returned with jcntl::close_rcursor(). Stopping the journal invalidates all its
+    * cursors.
+    */
+    class rcursor
+    {
+        friend class jcntl;
+
+    private:
+        jcntl* _jc;             ///< Journal being read
+        rrfc _rrfc;             ///< Read file controller for this cursor
+        rmgr _rmgr;             ///< Read page manager for this cursor
+
+        rcursor(jcntl* const jc, const lpmgr* const lpmp, enq_map& emap, txn_map& tmap);
+        ~rcursor();
+
+    public:
+        /**
+        * \brief Reads the next non-dequeued data record after this cursor's position. See
+        *     jcntl::read_data_record() for details of the parameters and of freeing the returned data.
+        */
+        iores read_data_record(void** const datapp, std::size_t& dsize, void** const xidpp,
+                std::size_t& xidsize, bool& transient, bool& external, data_tok* const dtokp,
+                bool ignore_pending_txns = false);
+
+        // Read into buf or in place, see jcntl::read_data_record() taking an rd_buf
+        iores read_data_record(void** const datapp, std::size_t& dsize, void** const xidpp,
+                std::size_t& xidsize, bool& transient, bool& external, data_tok* const dtokp,
+                rd_buf& buf, rd_pin* const pinp = 0, bool ignore_pending_txns = false);
+
+        /**
+        * \brief Restart reading from the start of the journal on the next read.
+        */
+        inline void invalidate() { _rmgr.invalidate(); }
+
+        // See jcntl::release_idle_rcache() and jcntl::rcache_allocated()
+        inline bool release_idle_pages(const u_int32_t idle_secs) { return _rmgr.release_idle_pages(idle_secs); }
+        inline bool pages_allocated() const { return _rmgr.pages_allocated(); }
+        inline u_int16_t read_ahead_pages() const { return _rmgr.read_ahead_pages(); }
+        // See jcntl::cache_mem_bytes()
+        inline std::size_t mem_bytes() const { return _rmgr.mem_bytes(); }
+    };
+
+} // namespace journal
+} // namespace mrg
+
+#endif // ifndef mrg_journal_rcursor_hpp
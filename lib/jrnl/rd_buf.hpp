@@ -0,0 +1,127 @@
+/**
+ * \file rd_buf.hpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * Messaging journal class mrg::journal::rd_buf, a reusable buffer into
+ * which records are read. See class documentation for details.
+ *
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#ifndef mrg_journal_rd_buf_hpp
+#define mrg_journal_rd_buf_hpp
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include "jrnl/jerrno.hpp"
+#include "jrnl/jexception.hpp"
+#include <sstream>
+
+namespace mrg
+{
+namespace journal
+{
+
+    /**
+    * \class rd_buf
+    * \brief Caller-owned buffer, reused from one read to the next, into which the xid and data of
+    *     records are read.
+    *
+    * A read made with an rd_buf (see jcntl::read_data_record()) places the xid and data of the
+    * record in this buffer rather than in memory allocated for each record, and the pointers
+    * returned point into it. They must not be freed, and remain valid until the next read made
+    * with the same buffer. The buffer grows as needed to hold the largest record read, and keeps
+    * its memory until release() or destruction, so reading many records costs few allocations.
+    * reserve() may be used to size the buffer in advance when the largest record size is known.
+    *
+    * A spare area of the same kind holds uncompressed data while a compressed record is expanded;
+    * the two are then swapped.
+    */
+    class rd_buf
+    {
+    private:
+        void* _buff;                    ///< Buffer holding the last record read
+        std::size_t _capacity;          ///< Size of _buff
+        void* _spare;                   ///< Spare buffer, used to expand compressed records
+        std::size_t _spare_capacity;    ///< Size of _spare
+
+    public:
+        inline rd_buf() : _buff(0), _capacity(0), _spare(0), _spare_capacity(0) {}
+        inline ~rd_buf() { release(); }
+
+        // Ensure that the buffer holds at least size bytes, and return it. Its contents are not kept.
+        inline void* reserve(const std::size_t size) { return grow(_buff, _capacity, size); }
+        // Ensure that the spare buffer holds at least size bytes, and return it
+        inline void* reserve_spare(const std::size_t size) { return grow(_spare, _spare_capacity, size); }
+        // Make the spare buffer the buffer, and the buffer the spare
+        inline void swap()
+        {
+            void* const b = _buff; _buff = _spare; _spare = b;
+            const std::size_t c = _capacity; _capacity = _spare_capacity; _spare_capacity = c;
+        }
+        inline void* data() const { return _buff; }
+        inline std::size_t capacity() const { return _capacity; }
+        // Memory held by the buffer and its spare
+        inline std::size_t mem_bytes() const { return _capacity + _spare_capacity; }
+        // Free all memory held by the buffer
+        inline void release()
+        {
+            std::free(_buff);
+            _buff = 0;
+            _capacity = 0;
+            std::free(_spare);
+            _spare = 0;
+            _spare_capacity = 0;
+        }
+
+    private:
+        // Buffers grow to at least twice their previous size, so a run of slightly increasing record
+        // sizes does not reallocate on every read
+        static inline void* grow(void*& buff, std::size_t& capacity, const std::size_t size)
+        {
+            if (size <= capacity && buff)
+                return buff;
+            const std::size_t new_capacity = size > 2 * capacity ? (size ? size : 1) : 2 * capacity;
+            std::free(buff);
+            buff = std::malloc(new_capacity);
+            if (buff == 0)
+            {
+                capacity = 0;
+                std::ostringstream oss;
+                oss << "size=" << new_capacity << ": malloc() failed: " << FORMAT_SYSERR(errno);
+                throw jexception(jerrno::JERR__MALLOC, oss.str(), "rd_buf", "grow");
+            }
+            capacity = new_capacity;
+            return buff;
+        }
+
+        rd_buf(const rd_buf&);
+        rd_buf& operator=(const rd_buf&);
+    };
+
+} // namespace journal
+} // namespace mrg
+
+#endif // ifndef mrg_journal_rd_buf_hpp
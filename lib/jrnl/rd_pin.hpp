@@ -0,0 +1,72 @@
+/**
+ * \file rd_pin.hpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * Messaging journal class mrg::journal::rd_pin, which pins data read in place
+ * from a mapped journal file. See class documentation for details.
+ *
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#ifndef mrg_journal_rd_pin_hpp
+#define mrg_journal_rd_pin_hpp
+
+#include "jrnl/fcntl.hpp"
+
+namespace mrg
+{
+namespace journal
+{
+
+    /**
+    * \class rd_pin
+    * \brief Pin on a journal file whose mapping holds data returned by a read.
+    *
+    * In mmap read mode, a read made with an rd_pin may return xid and data pointers into the mapped
+    * journal file instead of allocated copies. The pin is then set, and the file is not reset for
+    * writing (so the data cannot be overwritten) until the pin is released, which replaces freeing
+    * the returned buffer. If the pin is not set after a read, the data was copied as usual and must
+    * be freed by the caller. A pin is released when it goes out of scope.
+    */
+    class rd_pin
+    {
+    private:
+        fcntl* _fcp;                    ///< Pinned file, 0 if not set
+
+    public:
+        inline rd_pin() : _fcp(0) {}
+        inline ~rd_pin() { release(); }
+
+        inline bool is_set() const { return _fcp != 0; }
+        inline void set(fcntl* const fcp) { release(); _fcp = fcp; _fcp->pin_rd(); }
+        inline void release() { if (_fcp) { _fcp->unpin_rd(); _fcp = 0; } }
+
+    private:
+        rd_pin(const rd_pin&);
+        rd_pin& operator=(const rd_pin&);
+    };
+
+} // namespace journal
+} // namespace mrg
+
+#endif // ifndef mrg_journal_rd_pin_hpp
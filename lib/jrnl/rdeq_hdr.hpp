@@ -0,0 +1,103 @@
+/**
+ * \file rdeq_hdr.hpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * File containing code for class mrg::journal::rdeq_hdr (range dequeue
+ * record header), used for a dequeue record which dequeues all enqueued
+ * records within a range of rids.
+ *
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#ifndef mrg_journal_rdeq_hdr_hpp
+#define mrg_journal_rdeq_hdr_hpp
+
+#include <cstddef>
+#include "jrnl/rec_hdr.hpp"
+
+namespace mrg
+{
+namespace journal
+{
+
+#pragma pack(1)
+
+    /**
+    * \brief Struct for range dequeue record.
+    *
+    * Struct for a non-transactional dequeue record which dequeues every record with a rid in the
+    * range first-rid to last-rid (inclusive) that is enqueued at the point at which this record
+    * is written. A first-rid of 0 makes this a watermark which dequeues all enqueued records up
+    * to and including last-rid, as results from the in-order consumption of a queue. Records
+    * enqueued after this record is written are not affected, even if their rid lies within the
+    * range.
+    *
+    * This record consists of the header only; as it always fits within a single dblk, it has no
+    * rec_tail.
+    *
+    * Record header info in binary format (32 bytes):
+    * <pre>
+    *   0                           7
+    * +---+---+---+---+---+---+---+---+  -+
+    * |     magic     | v | e | flags |   |
+    * +---+---+---+---+---+---+---+---+   | struct hdr
+    * |              rid              |   |
+    * +---+---+---+---+---+---+---+---+  -+
+    * |           first-rid           |
+    * +---+---+---+---+---+---+---+---+
+    * |           last-rid            |
+    * +---+---+---+---+---+---+---+---+
+    * v = file version (If the format or encoding of this file changes, then this
+    *     number should be incremented)
+    * e = endian flag, false (0x00) for little endian, true (0x01) for big endian
+    * </pre>
+    */
+    struct rdeq_hdr : rec_hdr
+    {
+        u_int64_t _first_rid;   ///< First rid of range of records being dequeued
+        u_int64_t _last_rid;    ///< Last rid of range of records being dequeued
+
+        /**
+        * \brief Default constructor, which sets all values to 0.
+        */
+        inline rdeq_hdr(): rec_hdr(), _first_rid(0), _last_rid(0) {}
+
+        /**
+        * \brief Convenience constructor which initializes values during construction.
+        */
+        inline rdeq_hdr(const u_int32_t magic, const u_int8_t version, const u_int64_t rid,
+                const u_int64_t first_rid, const u_int64_t last_rid, const bool owi):
+                rec_hdr(magic, version, rid, owi), _first_rid(first_rid), _last_rid(last_rid) {}
+
+        /**
+        * \brief Returns the size of the header in bytes.
+        */
+        inline static std::size_t size() { return sizeof(rdeq_hdr); }
+    };
+
+#pragma pack()
+
+} // namespace journal
+} // namespace mrg
+
+#endif // ifndef mrg_journal_rdeq_hdr_hpp
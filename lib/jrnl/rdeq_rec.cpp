@@ -0,0 +1,174 @@
+/**
+ * \file rdeq_rec.cpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * This file contains the code for the mrg::journal::rdeq_rec (range
+ * dequeue record) class. See comments in file rdeq_rec.hpp for details.
+ *
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#include "jrnl/rdeq_rec.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <iomanip>
+#include "jrnl/jerrno.hpp"
+#include "jrnl/jexception.hpp"
+#include <sstream>
+
+namespace mrg
+{
+namespace journal
+{
+
+rdeq_rec::rdeq_rec():
+        _rdeq_hdr(RHM_JDAT_RDEQ_MAGIC, RHM_JDAT_VERSION, 0, 0, 0, false)
+{}
+
+rdeq_rec::rdeq_rec(const u_int64_t rid, const u_int64_t first_rid, const u_int64_t last_rid,
+        const bool owi):
+        _rdeq_hdr(RHM_JDAT_RDEQ_MAGIC, RHM_JDAT_VERSION, rid, first_rid, last_rid, owi)
+{}
+
+rdeq_rec::~rdeq_rec()
+{}
+
+void
+rdeq_rec::reset()
+{
+    _rdeq_hdr._rid = 0;
+    _rdeq_hdr.set_owi(false);
+    _rdeq_hdr._first_rid = 0;
+    _rdeq_hdr._last_rid = 0;
+}
+
+void
+rdeq_rec::reset(const u_int64_t rid, const u_int64_t first_rid, const u_int64_t last_rid,
+        const bool owi)
+{
+    _rdeq_hdr._rid = rid;
+    _rdeq_hdr.set_owi(owi);
+    _rdeq_hdr._first_rid = first_rid;
+    _rdeq_hdr._last_rid = last_rid;
+}
+
+u_int32_t
+rdeq_rec::encode(void* wptr, u_int32_t rec_offs_dblks, u_int32_t max_size_dblks)
+{
+    assert(wptr != 0);
+    assert(rec_offs_dblks == 0); // Never split
+    assert(max_size_dblks > 0);
+
+    std::memcpy(wptr, (void*)&_rdeq_hdr, sizeof(_rdeq_hdr));
+#ifdef RHM_CLEAN
+    std::memset((char*)wptr + sizeof(_rdeq_hdr), RHM_CLEAN_CHAR, JRNL_DBLK_SIZE - sizeof(_rdeq_hdr));
+#endif
+    return size_dblks(sizeof(_rdeq_hdr));
+}
+
+u_int32_t
+rdeq_rec::decode(rec_hdr& h, void* rptr, u_int32_t rec_offs_dblks, u_int32_t max_size_dblks)
+{
+    assert(rptr != 0);
+    assert(rec_offs_dblks == 0); // Never split
+    assert(max_size_dblks > 0);
+
+    _rdeq_hdr.hdr_copy(h);
+    std::memcpy((char*)&_rdeq_hdr + sizeof(rec_hdr), (char*)rptr + sizeof(rec_hdr),
+            sizeof(_rdeq_hdr) - sizeof(rec_hdr));
+    chk_hdr();
+    return size_dblks(sizeof(_rdeq_hdr));
+}
+
+bool
+rdeq_rec::rcv_decode(rec_hdr h, std::ifstream* ifsp, std::size_t& rec_offs)
+{
+    if (rec_offs == 0)
+    {
+        _rdeq_hdr.hdr_copy(h);
+        rec_offs = sizeof(rec_hdr);
+    }
+    // Read the rest of the header (or continue reading it)
+    const std::size_t offs = rec_offs;
+    ifsp->read((char*)&_rdeq_hdr + offs, sizeof(_rdeq_hdr) - offs);
+    std::size_t size_read = ifsp->gcount();
+    rec_offs += size_read;
+    if (size_read < sizeof(_rdeq_hdr) - offs)
+    {
+        assert(ifsp->eof());
+        // As we may have read past eof, turn off fail bit
+        ifsp->clear(ifsp->rdstate()&(~std::ifstream::failbit));
+        assert(!ifsp->fail() && !ifsp->bad());
+        return false;
+    }
+    ifsp->ignore(rec_size_dblks() * JRNL_DBLK_SIZE - rec_size());
+    chk_hdr();
+    assert(!ifsp->fail() && !ifsp->bad());
+    return true;
+}
+
+std::string&
+rdeq_rec::str(std::string& str) const
+{
+    std::ostringstream oss;
+    oss << "rdeq_rec: m=" << _rdeq_hdr._magic;
+    oss << " v=" << (int)_rdeq_hdr._version;
+    oss << " rid=" << _rdeq_hdr._rid;
+    oss << " first_rid=" << _rdeq_hdr._first_rid;
+    oss << " last_rid=" << _rdeq_hdr._last_rid;
+    str.append(oss.str());
+    return str;
+}
+
+void
+rdeq_rec::chk_hdr() const
+{
+    jrec::chk_hdr(_rdeq_hdr);
+    if (_rdeq_hdr._magic != RHM_JDAT_RDEQ_MAGIC)
+    {
+        std::ostringstream oss;
+        oss << std::hex << std::setfill('0');
+        oss << "rdeq magic: rid=0x" << std::setw(16) << _rdeq_hdr._rid;
+        oss << ": expected=0x" << std::setw(8) << RHM_JDAT_RDEQ_MAGIC;
+        oss << " read=0x" << std::setw(2) << (int)_rdeq_hdr._magic;
+        throw jexception(jerrno::JERR_JREC_BADRECHDR, oss.str(), "rdeq_rec", "chk_hdr");
+    }
+    if (_rdeq_hdr._first_rid > _rdeq_hdr._last_rid)
+    {
+        std::ostringstream oss;
+        oss << std::hex << "rdeq range: rid=0x" << _rdeq_hdr._rid;
+        oss << " first_rid=0x" << _rdeq_hdr._first_rid << " last_rid=0x" << _rdeq_hdr._last_rid;
+        throw jexception(jerrno::JERR_JREC_BADRECHDR, oss.str(), "rdeq_rec", "chk_hdr");
+    }
+}
+
+void
+rdeq_rec::chk_hdr(u_int64_t rid) const
+{
+    chk_hdr();
+    jrec::chk_rid(_rdeq_hdr, rid);
+}
+
+} // namespace journal
+} // namespace mrg
@@ -0,0 +1,97 @@
+/**
+ * \file rdeq_rec.hpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * This file contains the code for the mrg::journal::rdeq_rec (range
+ * dequeue record) class. See class documentation for details.
+ *
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#ifndef mrg_journal_rdeq_rec_hpp
+#define mrg_journal_rdeq_rec_hpp
+
+namespace mrg
+{
+namespace journal
+{
+class rdeq_rec;
+}
+}
+
+#include <cstddef>
+#include "jrnl/jrec.hpp"
+#include "jrnl/rdeq_hdr.hpp"
+
+namespace mrg
+{
+namespace journal
+{
+
+    /**
+    * \class rdeq_rec
+    * \brief Class to handle a single journal dequeue record which dequeues a range of rids.
+    *
+    * The record consists of an rdeq_hdr only, and is always contained within a single dblk.
+    */
+    class rdeq_rec : public jrec
+    {
+    private:
+        rdeq_hdr _rdeq_hdr;             ///< Range dequeue header
+
+    public:
+        rdeq_rec();
+        rdeq_rec(const u_int64_t rid, const u_int64_t first_rid, const u_int64_t last_rid,
+                const bool owi);
+        virtual ~rdeq_rec();
+
+        // Prepare instance for use in reading data from journal
+        void reset();
+        // Prepare instance for use in writing data to journal
+        void reset(const u_int64_t rid, const u_int64_t first_rid, const u_int64_t last_rid,
+                const bool owi);
+        u_int32_t encode(void* wptr, u_int32_t rec_offs_dblks, u_int32_t max_size_dblks);
+        u_int32_t decode(rec_hdr& h, void* rptr, u_int32_t rec_offs_dblks,
+                u_int32_t max_size_dblks);
+        // Decode used for recover
+        bool rcv_decode(rec_hdr h, std::ifstream* ifsp, std::size_t& rec_offs);
+
+        inline u_int64_t rid() const { return _rdeq_hdr._rid; }
+        inline u_int64_t first_rid() const { return _rdeq_hdr._first_rid; }
+        inline u_int64_t last_rid() const { return _rdeq_hdr._last_rid; }
+        std::string& str(std::string& str) const;
+        inline std::size_t data_size() const { return 0; } // This record never carries data
+        inline std::size_t xid_size() const { return 0; } // This record is never transactional
+        inline std::size_t rec_size() const { return rdeq_hdr::size(); }
+
+    private:
+        virtual void chk_hdr() const;
+        virtual void chk_hdr(u_int64_t rid) const;
+        virtual void chk_tail() const {} // No tail
+        virtual void clean() {}
+    }; // class rdeq_rec
+
+} // namespace journal
+} // namespace mrg
+
+#endif // ifndef mrg_journal_rdeq_rec_hpp
@@ -56,7 +56,6 @@ rfc::set_findex(const u_int16_t fc_index)
 {
     _fc_index = fc_index;
     _curr_fc = _lpmp->get_fcntlp(fc_index);
-    _curr_fc->rd_reset();
 }
 
 void
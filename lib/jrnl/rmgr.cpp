@@ -37,6 +37,10 @@
 #include <cstdlib>
 #include "jrnl/jcntl.hpp"
 #include "jrnl/jerrno.hpp"
+#include "jrnl/mdeq_rec.hpp"
+#include "jrnl/pack_hdr.hpp"
+#include "jrnl/page_alloc.hpp"
+#include "jrnl/rdeq_hdr.hpp"
 #include <sstream>
 
 namespace mrg
@@ -50,7 +54,13 @@ rmgr::rmgr(jcntl* jc, enq_map& emap, txn_map& tmap, rrfc& rrfc):
         _hdr(),
         _fhdr_buffer(0),
         _fhdr_aio_cb_ptr(0),
-        _fhdr_rd_outstanding(false)
+        _fhdr_rd_outstanding(false),
+        _pack_offs(0),
+        _rd_activity(false),
+        _idle_since(),
+        _ra_pages(0),
+        _ra_consumed(0),
+        _mmap(false)
 {}
 
 rmgr::~rmgr()
@@ -59,9 +69,20 @@ rmgr::~rmgr()
 }
 
 void
-rmgr::initialize(aio_callback* const cbp)
+rmgr::initialize(aio_callback* const cbp, const u_int32_t cache_pgsize_sblks, const u_int16_t cache_num_pages,
+        const bool mmap)
 {
-    pmgr::initialize(cbp, JRNL_RMGR_PAGE_SIZE, JRNL_RMGR_PAGES);
+    // Read pages must divide the file size, which is a multiple of JRNL_RMGR_PAGE_SIZE sblks
+    if (cache_num_pages == 0 || cache_pgsize_sblks == 0 || cache_pgsize_sblks > JRNL_RMGR_PAGE_SIZE ||
+            JRNL_RMGR_PAGE_SIZE % cache_pgsize_sblks)
+    {
+        std::ostringstream oss;
+        oss << "cache_pgsize_sblks=" << cache_pgsize_sblks << " cache_num_pages=" << cache_num_pages;
+        oss << " (page size must divide " << JRNL_RMGR_PAGE_SIZE << " sblks)";
+        throw jexception(jerrno::JERR_RMGR_BADGEOM, oss.str(), "rmgr", "initialize");
+    }
+    // Page memory is allocated on first use (see alloc_pages())
+    pmgr::initialize(cbp, cache_pgsize_sblks, cache_num_pages, false);
     clean();
     // Allocate memory for reading file header
     if (::posix_memalign(&_fhdr_buffer, _sblksize, _sblksize))
@@ -73,6 +94,12 @@ rmgr::initialize(aio_callback* const cbp)
     }
     _fhdr_aio_cb_ptr = new aio_cb;
     std::memset(_fhdr_aio_cb_ptr, 0, sizeof(aio_cb*));
+    _pack_offs = 0;
+    _rd_activity = false;
+    // Read-ahead starts small so that random reads are cheap, and grows while reads are sequential
+    _ra_pages = _cache_num_pages < JRNL_RMGR_INIT_RA_PAGES ? _cache_num_pages : JRNL_RMGR_INIT_RA_PAGES;
+    _ra_consumed = 0;
+    _mmap = mmap;
 }
 
 void
@@ -88,10 +115,73 @@ rmgr::clean()
     }
 }
 
+void
+rmgr::alloc_pages()
+{
+    if (_page_base_ptr)
+        return;
+    _page_base_ptr = page_alloc::alloc(_cache_num_pages * _cache_pgsize_sblks * _sblksize, _sblksize);
+    for (u_int16_t i=0; i<_cache_num_pages; i++)
+    {
+        _page_ptr_arr[i] = (void*)((char*)_page_base_ptr + _cache_pgsize_sblks * _sblksize * i);
+        _page_cb_arr[i]._pbuff = _page_ptr_arr[i];
+    }
+}
+
+void
+rmgr::free_pages()
+{
+    page_alloc::free(_page_base_ptr, _cache_num_pages * _cache_pgsize_sblks * _sblksize);
+    _page_base_ptr = 0;
+    for (u_int16_t i=0; i<_cache_num_pages; i++)
+    {
+        _page_ptr_arr[i] = 0;
+        _page_cb_arr[i]._pbuff = 0;
+        _page_cb_arr[i]._rdblks = 0;
+        _page_cb_arr[i]._state = UNUSED;
+    }
+}
+
+bool
+rmgr::release_idle_pages(const u_int32_t idle_secs)
+{
+    // In mmap read mode there is no page memory, but the read position is still reset so that an idle
+    // reader does not hold on to the mapped pages
+    if (_mmap ? !_rrfc.is_valid() : !_page_base_ptr)
+        return false;
+    if (_rd_activity)
+    {
+        _rd_activity = false;
+        _idle_since.now();
+        return false;
+    }
+    // Leave the pages alone while reads are in flight; they will be reaped by the next read
+    if (_aio_evt_rem || _fhdr_rd_outstanding)
+        return false;
+    time_ns idle;
+    idle.now();
+    idle -= _idle_since;
+    if (idle.tv_sec < (std::time_t)idle_secs)
+        return false;
+
+    // The next read starts again from the beginning of the journal
+    invalidate();
+    _rrfc.unset_findex();
+    _pg_index = 0;
+    _pg_offset_dblks = 0;
+    _pack_offs = 0;
+    _ra_pages = _cache_num_pages < JRNL_RMGR_INIT_RA_PAGES ? _cache_num_pages : JRNL_RMGR_INIT_RA_PAGES;
+    _ra_consumed = 0;
+    free_pages();
+    return true;
+}
+
 iores
 rmgr::read(void** const datapp, std::size_t& dsize, void** const xidpp, std::size_t& xidsize,
-        bool& transient, bool& external, data_tok* dtokp,  bool ignore_pending_txns)
+        bool& transient, bool& external, data_tok* dtokp,  bool ignore_pending_txns, rd_pin* const pinp,
+        rd_buf* const rbufp)
 {
+    _rd_activity = true;
     iores res = pre_read_check(dtokp);
     if (res != RHM_IORES_SUCCESS)
     {
@@ -144,7 +234,9 @@ rmgr::read(void** const datapp, std::size_t& dsize, void** const xidpp, std::siz
         if (_page_cb_arr[_pg_index]._state != AIO_COMPLETE)
         {
             aio_cycle();
-            return RHM_IORES_PAGE_AIOWAIT;
+            // In mmap read mode, aio_cycle() completes the page at once if its data has been written
+            if (!_mmap || _page_cb_arr[_pg_index]._state != AIO_COMPLETE)
+                return RHM_IORES_PAGE_AIOWAIT;
         }
         void* rptr = (void*)((char*)_page_ptr_arr[_pg_index] + (_pg_offset_dblks * JRNL_DBLK_SIZE));
         std::memcpy(&_hdr, rptr, sizeof(rec_hdr));
@@ -152,40 +244,15 @@ rmgr::read(void** const datapp, std::size_t& dsize, void** const xidpp, std::siz
         {
             case RHM_JDAT_ENQ_MAGIC:
             {
-                _enq_rec.reset(); // sets enqueue rec size
+                _enq_rec.reset(rbufp); // sets enqueue rec size
                 // Check if RID of this rec is still enqueued, if so read it, else skip
                 bool is_enq = false;
-                int16_t fid = _emap.get_pfid(_hdr._rid);
-                if (fid < enq_map::EMAP_OK)
-                {
-                    bool enforce_txns = !_jc->is_read_only() && !ignore_pending_txns;
-                    // Block read for transactionally locked record (only when not recovering)
-                    if (fid == enq_map::EMAP_LOCKED && enforce_txns)
-                        return RHM_IORES_TXPENDING;
-
-                    // (Recover mode only) Ok, not in emap - now search tmap, if present then read
-                    is_enq = _tmap.is_enq(_hdr._rid);
-                    if (enforce_txns && is_enq)
-                        return RHM_IORES_TXPENDING;
-                }
-                else
-                    is_enq = true;
+                const iores res = enq_check(_hdr, dtokp, ignore_pending_txns, is_enq);
+                if (res != RHM_IORES_SUCCESS)
+                    return res;
 
-                if (is_enq) // ok, this record is enqueued, check it, then read it...
+                if (is_enq) // ok, this record is enqueued, read it...
                 {
-                    if (dtokp->rid())
-                    {
-                        if (_hdr._rid != dtokp->rid())
-                        {
-                            std::ostringstream oss;
-                            oss << std::hex << "rid=0x" << _hdr._rid << "; dtok_rid=0x" << dtokp->rid()
-                                << "; dtok_id=0x" << dtokp->id();
-                            throw jexception(jerrno::JERR_RMGR_RIDMISMATCH, oss.str(), "rmgr", "read");
-                        }
-                    }
-                    else
-                        dtokp->set_rid(_hdr._rid);
-
 // TODO: Add member _fid to pmgr::page_cb which indicates the fid from which this page was
 // populated. When this value is set in wmgr::flush() somewehere, then uncomment the following
 // check:
@@ -200,7 +267,7 @@ rmgr::read(void** const datapp, std::size_t& dsize, void** const xidpp, std::siz
 //                              "read");
 //                     }
 
-                    const iores res = read_enq(_hdr, rptr, dtokp);
+                    const iores res = read_enq(_hdr, rptr, dtokp, pinp);
                     dsize = _enq_rec.get_data(datapp);
                     xidsize = _enq_rec.get_xid(xidpp);
                     transient = _enq_rec.is_transient();
@@ -214,12 +281,34 @@ rmgr::read(void** const datapp, std::size_t& dsize, void** const xidpp, std::siz
             case RHM_JDAT_DEQ_MAGIC:
                 consume_xid_rec(_hdr, rptr, dtokp);
                 break;
+            case RHM_JDAT_MDEQ_MAGIC:
+                consume_xid_rec(_hdr, rptr, dtokp);
+                break;
+            case RHM_JDAT_RDEQ_MAGIC:
+                consume_xid_rec(_hdr, rptr, dtokp);
+                break;
             case RHM_JDAT_TXA_MAGIC:
                 consume_xid_rec(_hdr, rptr, dtokp);
                 break;
             case RHM_JDAT_TXC_MAGIC:
                 consume_xid_rec(_hdr, rptr, dtokp);
                 break;
+            case RHM_JDAT_PACK_MAGIC:
+            {
+                const iores res = read_pack(rptr, dtokp, ignore_pending_txns, rbufp);
+                if (res != RHM_IORES_EMPTY) // RHM_IORES_EMPTY: no enqueued records left in dblk
+                {
+                    if (res == RHM_IORES_SUCCESS)
+                    {
+                        dsize = _enq_rec.get_data(datapp);
+                        xidsize = _enq_rec.get_xid(xidpp);
+                        transient = _enq_rec.is_transient();
+                        external = _enq_rec.is_external();
+                    }
+                    return res;
+                }
+                break;
+            }
             case RHM_JDAT_EMPTY_MAGIC:
                 consume_filler();
                 break;
@@ -249,6 +338,7 @@ rmgr::get_events(page_state state, timespec* const timeout, bool flush)
 
     std::vector<u_int16_t> pil;
     pil.reserve(ret);
+    const u_int32_t pg_size_dblks = _cache_pgsize_sblks * JRNL_SBLK_SIZE;
     for (int i=0; i<ret; i++) // Index of returned AIOs
     {
         if (_aio_evt_rem == 0)
@@ -271,38 +361,33 @@ rmgr::get_events(page_state state, timespec* const timeout, bool flush)
             oss << " fh=" << aiocbp->aio_fildes << "]";
             throw jexception(jerrno::JERR__AIO, oss.str(), "rmgr", "get_events");
         }
+        _jc->instr_add_read_bytes(aioret);
 
         if (pcbp) // Page reads have pcb
         {
-            if (pcbp->_rfh->rd_subm_cnt_dblks() >= JRNL_SBLK_SIZE) // Detects if write reset of this fcntl obj has occurred.
+            if (pcbp->_rfh->reset_cnt() == pcbp->_rreset_cnt) // Detects if write reset of this fcntl obj has occurred.
             {
                 // Increment the completed read offset
-                // NOTE: We cannot use _rrfc here, as it may have rotated since submitting count.
-                // Use stored pointer to fcntl in the pcb instead.
-                pcbp->_rdblks = aiocbp->u.c.nbytes / JRNL_DBLK_SIZE;
-                pcbp->_rfh->add_rd_cmpl_cnt_dblks(pcbp->_rdblks);
-                pcbp->_state = state;
-                pil[i] = pcbp->_index;
+                // NOTE: _rrfc may have rotated since submitting count, in which case the completed read offset
+                // of the file this page was read from is no longer needed.
+                u_int32_t rdblks = aiocbp->u.c.nbytes / JRNL_DBLK_SIZE;
+                if (pcbp->_rfh == _rrfc.file_controller())
+                    _rrfc.add_cmpl_cnt_dblks(rdblks);
+                // A single read may have filled several consecutive pages
+                for (u_int16_t j=0; j<pcbp->_rpages; j++)
+                {
+                    page_cb& pcb = _page_cb_arr[pcbp->_index + j];
+                    pcb._rdblks = rdblks > pg_size_dblks ? pg_size_dblks : rdblks;
+                    rdblks -= pcb._rdblks;
+                    pcb._state = state;
+                    pil.push_back(pcb._index);
+                }
             }
         }
         else // File header reads have no pcb
         {
             std::memcpy(&_fhdr, _fhdr_buffer, sizeof(file_hdr));
-            _rrfc.add_cmpl_cnt_dblks(JRNL_SBLK_SIZE);
-
-            u_int32_t fro_dblks = (_fhdr._fro / JRNL_DBLK_SIZE) - JRNL_SBLK_SIZE;
-            // Check fro_dblks does not exceed the write pointers which can happen in some corrupted journal recoveries
-            if (fro_dblks > _jc->wr_subm_cnt_dblks(_fhdr._pfid) - JRNL_SBLK_SIZE)
-                fro_dblks = _jc->wr_subm_cnt_dblks(_fhdr._pfid) - JRNL_SBLK_SIZE;
-            _pg_cntr = fro_dblks / (JRNL_RMGR_PAGE_SIZE * JRNL_SBLK_SIZE);
-            u_int32_t tot_pg_offs_dblks = _pg_cntr * JRNL_RMGR_PAGE_SIZE * JRNL_SBLK_SIZE;
-            _pg_index = _pg_cntr % JRNL_RMGR_PAGES;
-            _pg_offset_dblks = fro_dblks - tot_pg_offs_dblks;
-            _rrfc.add_subm_cnt_dblks(tot_pg_offs_dblks);
-            _rrfc.add_cmpl_cnt_dblks(tot_pg_offs_dblks);
-
-            _fhdr_rd_outstanding = false;
-            _rrfc.set_valid();
+            fhdr_read_complete();
         }
     }
 
@@ -336,12 +421,23 @@ rmgr::flush(timespec* timeout)
         }
     }
 
+    // Pages read ahead but not consumed were wasted; if these outnumber the pages consumed since the last
+    // flush, the reader is not reading sequentially and reads ahead less
+    u_int16_t wasted = 0;
+    for (u_int16_t i=0; i<_cache_num_pages; i++)
+        if (i != _pg_index && _page_cb_arr[i]._state == AIO_COMPLETE)
+            wasted++;
+    if (wasted > _ra_consumed && _ra_pages > 1)
+        _ra_pages /= 2;
+    _ra_consumed = 0;
+
     // Reset all read states and pointers
     for (int i=0; i<_cache_num_pages; i++)
         _page_cb_arr[i]._state = UNUSED;
     _rrfc.unset_findex();
     _pg_index = 0;
     _pg_offset_dblks = 0;
+    _pack_offs = 0;
 }
 
 bool
@@ -400,7 +496,45 @@ rmgr::pre_read_check(data_tok* dtokp)
 }
 
 iores
-rmgr::read_enq(rec_hdr& h, void* rptr, data_tok* dtokp)
+rmgr::enq_check(const rec_hdr& h, data_tok* dtokp, const bool ignore_pending_txns, bool& is_enq)
+{
+    is_enq = false;
+    int16_t fid = _emap.get_pfid(h._rid);
+    if (fid < enq_map::EMAP_OK)
+    {
+        bool enforce_txns = !_jc->is_read_only() && !ignore_pending_txns;
+        // Block read for transactionally locked record (only when not recovering)
+        if (fid == enq_map::EMAP_LOCKED && enforce_txns)
+            return RHM_IORES_TXPENDING;
+
+        // (Recover mode only) Ok, not in emap - now search tmap, if present then read
+        is_enq = _tmap.is_enq(h._rid);
+        if (enforce_txns && is_enq)
+            return RHM_IORES_TXPENDING;
+    }
+    else
+        is_enq = true;
+
+    if (is_enq) // ok, this record is enqueued, check it
+    {
+        if (dtokp->rid())
+        {
+            if (h._rid != dtokp->rid())
+            {
+                std::ostringstream oss;
+                oss << std::hex << "rid=0x" << h._rid << "; dtok_rid=0x" << dtokp->rid()
+                    << "; dtok_id=0x" << dtokp->id();
+                throw jexception(jerrno::JERR_RMGR_RIDMISMATCH, oss.str(), "rmgr", "enq_check");
+            }
+        }
+        else
+            dtokp->set_rid(h._rid);
+    }
+    return RHM_IORES_SUCCESS;
+}
+
+iores
+rmgr::read_enq(rec_hdr& h, void* rptr, data_tok* dtokp, rd_pin* const pinp)
 {
     if (_page_cb_arr[_pg_index]._state != AIO_COMPLETE)
     {
@@ -408,6 +542,13 @@ rmgr::read_enq(rec_hdr& h, void* rptr, data_tok* dtokp)
         return RHM_IORES_PAGE_AIOWAIT;
     }
 
+    if (read_enq_in_place(h, rptr, dtokp, pinp))
+    {
+        dtokp->set_rstate(data_tok::READ);
+        dtokp->set_dsize(_enq_rec.data_size());
+        return RHM_IORES_SUCCESS;
+    }
+
     // Read data from this page, first block will have header and data size.
     u_int32_t dblks_rd = _enq_rec.decode(h, rptr, dtokp->dblocks_read(), dblks_rem());
     dtokp->incr_dblocks_read(dblks_rd);
@@ -435,12 +576,99 @@ rmgr::read_enq(rec_hdr& h, void* rptr, data_tok* dtokp)
     if (dblks_rem() == 0)
         rotate_page();
 
+    // Record is complete; expand compressed data so that callers only ever see the original data
+    if (_enq_rec.is_compressed())
+        _enq_rec.decompress();
+
     // Set the record size in dtokp
     dtokp->set_rstate(data_tok::READ);
     dtokp->set_dsize(_enq_rec.data_size());
     return RHM_IORES_SUCCESS;
 }
 
+bool
+rmgr::read_enq_in_place(rec_hdr& h, void* rptr, data_tok* dtokp, rd_pin* const pinp)
+{
+    if (!_mmap || !pinp || dtokp->dblocks_read())
+        return false;
+    enq_hdr ehdr;
+    std::memcpy(&ehdr, rptr, sizeof(enq_hdr));
+    const u_int32_t rec_dblks = jrec::size_dblks(enq_rec::rec_size(ehdr._xidsize, ehdr._dsize,
+            ehdr.is_external()));
+    // Compressed records must be expanded into a buffer; records continuing in the next file are not
+    // contiguous in the mapping
+    if (ehdr.is_compressed() || rec_dblks > contig_dblks_rem())
+        return false;
+
+    // Pin the file before checking that it has not been reset for writing since the page was set up,
+    // so that it cannot be reset while the caller uses the record
+    const page_cb& pcb = _page_cb_arr[_pg_index];
+    pinp->set(pcb._rfh);
+    if (pcb._rfh->reset_cnt() != pcb._rreset_cnt)
+    {
+        pinp->release();
+        return false;
+    }
+    _enq_rec.decode_in_place(h, rptr);
+    dtokp->incr_dblocks_read(rec_dblks);
+
+    // Move the read position past the record, rotating through any pages it covers
+    u_int32_t rem_dblks = rec_dblks;
+    while (rem_dblks > dblks_rem())
+    {
+        const u_int32_t pg_dblks = dblks_rem();
+        rem_dblks -= pg_dblks;
+        _pg_offset_dblks += pg_dblks;
+        rotate_page();
+    }
+    _pg_offset_dblks += rem_dblks;
+    if (dblks_rem() == 0)
+        rotate_page();
+    return true;
+}
+
+iores
+rmgr::read_pack(void* rptr, data_tok* dtokp, const bool ignore_pending_txns, rd_buf* const rbufp)
+{
+    // Records in a packed dblk are read one per call; _pack_offs remembers the position of the
+    // next record between calls while the packed dblk remains at the current read position.
+    if (_pack_offs == 0)
+        _pack_offs = pack_hdr::size();
+    std::size_t size = 0;
+    while ((size = pack_hdr::rec_size(rptr, _pack_offs)) > 0)
+    {
+        void* srptr = (void*)((char*)rptr + _pack_offs);
+        rec_hdr sh;
+        std::memcpy(&sh, srptr, sizeof(rec_hdr));
+        if (sh._magic == RHM_JDAT_ENQ_MAGIC)
+        {
+            bool is_enq = false;
+            const iores res = enq_check(sh, dtokp, ignore_pending_txns, is_enq);
+            if (res != RHM_IORES_SUCCESS)
+                return res;
+            if (is_enq)
+            {
+                _hdr.hdr_copy(sh);
+                _enq_rec.reset(rbufp); // sets enqueue rec size
+                _enq_rec.decode(sh, srptr, 0, 1); // Packed records are always complete
+                _pack_offs += pack_hdr::aligned_size(size);
+                // A small record may both be compressed and packed; expand it as for unpacked records
+                if (_enq_rec.is_compressed())
+                    _enq_rec.decompress();
+                dtokp->set_rstate(data_tok::READ);
+                dtokp->set_dsize(_enq_rec.data_size());
+                return RHM_IORES_SUCCESS;
+            }
+        }
+        _pack_offs += pack_hdr::aligned_size(size);
+    }
+
+    // No further records in this packed dblk, move past it
+    _pack_offs = 0;
+    consume_filler();
+    return RHM_IORES_EMPTY;
+}
+
 void
 rmgr::consume_xid_rec(rec_hdr& h, void* rptr, data_tok* dtokp)
 {
@@ -462,6 +690,14 @@ rmgr::consume_xid_rec(rec_hdr& h, void* rptr, data_tok* dtokp)
         else
             dtokp->set_dsize(sizeof(deq_hdr));
     }
+    else if (h._magic == RHM_JDAT_MDEQ_MAGIC)
+    {
+        mdeq_hdr mhdr;
+        std::memcpy(&mhdr, rptr, sizeof(mdeq_hdr));
+        dtokp->set_dsize(mdeq_rec::rec_size(mhdr._deq_cnt));
+    }
+    else if (h._magic == RHM_JDAT_RDEQ_MAGIC)
+        dtokp->set_dsize(sizeof(rdeq_hdr));
     else if (h._magic == RHM_JDAT_TXA_MAGIC || h._magic == RHM_JDAT_TXC_MAGIC)
     {
         txn_hdr thdr;
@@ -481,7 +717,7 @@ rmgr::consume_xid_rec(rec_hdr& h, void* rptr, data_tok* dtokp)
 void
 rmgr::consume_filler()
 {
-    // Filler (Magic "RHMx") is one dblk by definition
+    // Filler (Magic "RHMx") and packed dblks (Magic "RHMp") are one dblk by definition
     _pg_offset_dblks++;
     if (dblks_rem() == 0)
         rotate_page();
@@ -542,16 +778,19 @@ rmgr::aio_cycle()
         // Flush and reset all read states and pointers
         flush(&jcntl::_aio_cmpl_timeout);
 
-        _jc->get_earliest_fid(); // determine initial file to read; calls _rrfc.set_findex() to set value
+        _rrfc.set_findex(_jc->get_earliest_fid()); // determine initial file to read
         // If this file has not yet been written to, return RHM_IORES_EMPTY
         if (_rrfc.is_void() && !_rrfc.is_wr_aio_outstanding())
             return RHM_IORES_EMPTY;
         init_file_header_read(); // send off AIO read request for file header
-        return RHM_IORES_SUCCESS;
+        // In mmap read mode the file header has already been read, so pages can be set up now
+        if (!_mmap)
+            return RHM_IORES_SUCCESS;
     }
 
     int16_t first_uninit = -1;
     u_int16_t num_uninit = 0;
+    u_int16_t num_pending = 0;
     u_int16_t num_compl = 0;
     bool outstanding = false;
     // Index must start with current buffer and cycle around so that first
@@ -570,6 +809,7 @@ rmgr::aio_cycle()
                 break;
             case AIO_PENDING:
                 outstanding = true;
+                num_pending++;
                 break;
             case AIO_COMPLETE:
                 num_compl++;
@@ -577,11 +817,14 @@ rmgr::aio_cycle()
             default:;
         }
     }
+    // Only read as far ahead as the read-ahead window allows
+    const u_int16_t num_ahead = num_pending + num_compl;
+    const u_int16_t ra_rem = _ra_pages > num_ahead ? _ra_pages - num_ahead : 0;
     iores res = RHM_IORES_SUCCESS;
     if (num_uninit)
-        res = init_aio_reads(first_uninit, num_uninit);
+        res = init_aio_reads(first_uninit, num_uninit < ra_rem ? num_uninit : ra_rem);
     else if (num_compl == _cache_num_pages) // This condition exists after invalidation
-        res = init_aio_reads(0, _cache_num_pages);
+        res = init_aio_reads(0, _ra_pages);
     if (outstanding)
         get_events(AIO_COMPLETE, 0);
     return res;
@@ -590,7 +833,9 @@ rmgr::aio_cycle()
 iores
 rmgr::init_aio_reads(const int16_t first_uninit, const u_int16_t num_uninit)
 {
-    for (int16_t i=0; i<num_uninit; i++)
+    const u_int32_t pg_size_dblks = _cache_pgsize_sblks * JRNL_SBLK_SIZE;
+    u_int16_t i = 0;
+    while (i < num_uninit)
     {
         if (_rrfc.is_void()) // Nothing to do; this file not yet written to
             break;
@@ -601,26 +846,56 @@ rmgr::init_aio_reads(const int16_t first_uninit, const u_int16_t num_uninit)
             _rrfc.add_cmpl_cnt_dblks(JRNL_SBLK_SIZE);
         }
 
-        // TODO: Future perf improvement: Do a single AIO read for all available file
-        // space into all contiguous empty pages in one AIO operation.
-
         u_int32_t file_rem_dblks = _rrfc.remaining_dblks();
         file_rem_dblks -= file_rem_dblks % JRNL_SBLK_SIZE; // round down to closest sblk boundary
-        u_int32_t pg_size_dblks = JRNL_RMGR_PAGE_SIZE * JRNL_SBLK_SIZE;
-        u_int32_t rd_size = file_rem_dblks > pg_size_dblks ? pg_size_dblks : file_rem_dblks;
-        if (rd_size)
+        if (file_rem_dblks)
         {
-            int16_t pi = (i + first_uninit) % _cache_num_pages;
-            // TODO: For perf, combine contiguous pages into single read
-            //   1 or 2 AIOs needed depending on whether read block folds
-            aio_cb* aiocbp = &_aio_cb_arr[pi];
-            aio::prep_pread_2(aiocbp, _rrfc.fh(), _page_ptr_arr[pi], rd_size * JRNL_DBLK_SIZE, _rrfc.subm_offs());
-            if (aio::submit(_ioctx, 1, &aiocbp) < 0)
-                throw jexception(jerrno::JERR__AIO, "rmgr", "init_aio_reads");
-            _rrfc.add_subm_cnt_dblks(rd_size);
-            _aio_evt_rem++;
-            _page_cb_arr[pi]._state = AIO_PENDING;
-            _page_cb_arr[pi]._rfh = _rrfc.file_controller();
+            // Fill as many of the remaining pages as possible with one read, which cannot fold around the end
+            // of the cache nor extend past the data available in this file
+            const u_int16_t pi = (i + first_uninit) % _cache_num_pages;
+            u_int16_t num_pages = (file_rem_dblks + pg_size_dblks - 1) / pg_size_dblks;
+            if (num_pages > num_uninit - i)
+                num_pages = num_uninit - i;
+            if (num_pages > _cache_num_pages - pi)
+                num_pages = _cache_num_pages - pi;
+            const u_int32_t rd_size = file_rem_dblks > num_pages * pg_size_dblks ? num_pages * pg_size_dblks :
+                    file_rem_dblks;
+            if (_mmap)
+            {
+                // Point the pages at the data in the mapped file, which is complete as it has been written
+                char* const mp = const_cast<char*>(_rrfc.file_controller()->map_rd()) + _rrfc.subm_offs();
+                u_int32_t rem_dblks = rd_size;
+                for (u_int16_t j=pi; j<pi+num_pages; j++)
+                {
+                    _page_ptr_arr[j] = mp + (j - pi) * pg_size_dblks * JRNL_DBLK_SIZE;
+                    _page_cb_arr[j]._rdblks = rem_dblks > pg_size_dblks ? pg_size_dblks : rem_dblks;
+                    rem_dblks -= _page_cb_arr[j]._rdblks;
+                    _page_cb_arr[j]._state = AIO_COMPLETE;
+                    _page_cb_arr[j]._rfh = _rrfc.file_controller();
+                    _page_cb_arr[j]._rreset_cnt = _rrfc.reset_cnt();
+                }
+                _rrfc.add_subm_cnt_dblks(rd_size);
+                _rrfc.add_cmpl_cnt_dblks(rd_size);
+            }
+            else
+            {
+                alloc_pages(); // No-op once allocated
+                aio_cb* aiocbp = &_aio_cb_arr[pi];
+                aio::prep_pread_2(aiocbp, _rrfc.fh(), _page_ptr_arr[pi], rd_size * JRNL_DBLK_SIZE,
+                        _rrfc.subm_offs());
+                if (aio::submit(_ioctx, 1, &aiocbp) < 0)
+                    throw jexception(jerrno::JERR__AIO, "rmgr", "init_aio_reads");
+                _rrfc.add_subm_cnt_dblks(rd_size);
+                _aio_evt_rem++;
+                _page_cb_arr[pi]._rpages = num_pages;
+                for (u_int16_t j=pi; j<pi+num_pages; j++)
+                {
+                    _page_cb_arr[j]._state = AIO_PENDING;
+                    _page_cb_arr[j]._rfh = _rrfc.file_controller();
+                    _page_cb_arr[j]._rreset_cnt = _rrfc.reset_cnt();
+                }
+            }
+            i += num_pages;
         }
         else // If there is nothing to read for this page, neither will there be for the others...
             break;
@@ -633,9 +908,15 @@ rmgr::init_aio_reads(const int16_t first_uninit, const u_int16_t num_uninit)
 void
 rmgr::rotate_page()
 {
+    // Consuming as many pages in sequence as are read ahead doubles the read-ahead
+    if (++_ra_consumed >= _ra_pages && _ra_pages < _cache_num_pages)
+    {
+        _ra_pages = _ra_pages * 2 < _cache_num_pages ? _ra_pages * 2 : _cache_num_pages;
+        _ra_consumed = 0;
+    }
     _page_cb_arr[_pg_index]._rdblks = 0;
     _page_cb_arr[_pg_index]._state = UNUSED;
-    if (_pg_offset_dblks >= JRNL_RMGR_PAGE_SIZE * JRNL_SBLK_SIZE)
+    if (_pg_offset_dblks >= _cache_pgsize_sblks * JRNL_SBLK_SIZE)
     {
         _pg_offset_dblks = 0;
         _pg_cntr++;
@@ -647,7 +928,7 @@ rmgr::rotate_page()
     // This counter is for bookkeeping only, page rotates are handled directly in init_aio_reads()
     // FIXME: _pg_cntr should be sync'd with aio ops, not use of page as it is now...
     // Need to move reset into if (_rrfc.file_rotate()) above.
-    if (_pg_cntr >= (_jc->jfsize_sblks() / JRNL_RMGR_PAGE_SIZE))
+    if (_pg_cntr >= (_jc->jfsize_sblks() / _cache_pgsize_sblks))
         _pg_cntr = 0;
 }
 
@@ -657,6 +938,25 @@ rmgr::dblks_rem() const
     return _page_cb_arr[_pg_index]._rdblks - _pg_offset_dblks;
 }
 
+u_int32_t
+rmgr::contig_dblks_rem() const
+{
+    // Count the dblks of the pages following the current one which continue it in the same mapped file
+    u_int32_t dblks = dblks_rem();
+    const page_cb* pcbp = &_page_cb_arr[_pg_index];
+    char* next_ptr = (char*)_page_ptr_arr[_pg_index] + pcbp->_rdblks * JRNL_DBLK_SIZE;
+    for (u_int16_t i=_pg_index+1; i<_cache_num_pages; i++)
+    {
+        const page_cb& pcb = _page_cb_arr[i];
+        if (pcb._state != AIO_COMPLETE || pcb._rfh != pcbp->_rfh || pcb._rreset_cnt != pcbp->_rreset_cnt ||
+                _page_ptr_arr[i] != next_ptr)
+            break;
+        dblks += pcb._rdblks;
+        next_ptr += pcb._rdblks * JRNL_DBLK_SIZE;
+    }
+    return dblks;
+}
+
 void
 rmgr::set_params_null(void** const datapp, std::size_t& dsize, void** const xidpp, std::size_t& xidsize)
 {
@@ -670,6 +970,13 @@ void
 rmgr::init_file_header_read()
 {
     _jc->fhdr_wr_sync(_rrfc.index()); // wait if the file header write is outstanding
+    if (_mmap)
+    {
+        std::memcpy(&_fhdr, _rrfc.file_controller()->map_rd(), sizeof(file_hdr));
+        _rrfc.add_subm_cnt_dblks(JRNL_SBLK_SIZE);
+        fhdr_read_complete();
+        return;
+    }
     int rfh = _rrfc.fh();
     aio::prep_pread_2(_fhdr_aio_cb_ptr, rfh, _fhdr_buffer, _sblksize, 0);
     if (aio::submit(_ioctx, 1, &_fhdr_aio_cb_ptr) < 0)
@@ -679,6 +986,26 @@ rmgr::init_file_header_read()
     _fhdr_rd_outstanding = true;
 }
 
+void
+rmgr::fhdr_read_complete()
+{
+    _rrfc.add_cmpl_cnt_dblks(JRNL_SBLK_SIZE);
+
+    u_int32_t fro_dblks = (_fhdr._fro / JRNL_DBLK_SIZE) - JRNL_SBLK_SIZE;
+    // Check fro_dblks does not exceed the write pointers which can happen in some corrupted journal recoveries
+    if (fro_dblks > _jc->wr_subm_cnt_dblks(_fhdr._pfid) - JRNL_SBLK_SIZE)
+        fro_dblks = _jc->wr_subm_cnt_dblks(_fhdr._pfid) - JRNL_SBLK_SIZE;
+    _pg_cntr = fro_dblks / (_cache_pgsize_sblks * JRNL_SBLK_SIZE);
+    u_int32_t tot_pg_offs_dblks = _pg_cntr * _cache_pgsize_sblks * JRNL_SBLK_SIZE;
+    _pg_index = _pg_cntr % _cache_num_pages;
+    _pg_offset_dblks = fro_dblks - tot_pg_offs_dblks;
+    _rrfc.add_subm_cnt_dblks(tot_pg_offs_dblks);
+    _rrfc.add_cmpl_cnt_dblks(tot_pg_offs_dblks);
+
+    _fhdr_rd_outstanding = false;
+    _rrfc.set_valid();
+}
+
 /* TODO (sometime in the future)
 const iores
 rmgr::get(const u_int64_t& rid, const std::size_t& dsize, const std::size_t& dsize_avail,
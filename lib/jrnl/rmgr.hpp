@@ -44,9 +44,13 @@ class rmgr;
 #include <cstring>
 #include "jrnl/enums.hpp"
 #include "jrnl/file_hdr.hpp"
+#include "jrnl/jcfg.hpp"
 #include "jrnl/pmgr.hpp"
+#include "jrnl/rd_buf.hpp"
+#include "jrnl/rd_pin.hpp"
 #include "jrnl/rec_hdr.hpp"
 #include "jrnl/rrfc.hpp"
+#include "jrnl/time_ns.hpp"
 
 namespace mrg
 {
@@ -58,6 +62,31 @@ namespace journal
     *
     * The read page cache works on the principle of filling as many pages as possilbe in advance of
     * reading the data. This ensures that delays caused by AIO operations are minimized.
+    *
+    * Page memory is not allocated until the first read from the journal files, as most journals
+    * are never read once recovered. It may be freed again by release_idle_pages() once no reads
+    * have been made for a while; the next read then reallocates it and restarts from the start of
+    * the journal, as after invalidate().
+    *
+    * The number of pages read ahead of the page being read adapts to the way the journal is read.
+    * It is halved each time the reader is invalidated (ie jumps back to an earlier record) having
+    * consumed fewer pages than were left unused in the cache, down to a single page; and doubled
+    * each time as many pages as are read ahead are consumed in sequence, up to the whole cache.
+    * Runs of empty pages which are contiguous both in the cache and in the journal file are filled
+    * by a single AIO read, so sequential readers make few large reads while random readers read
+    * little more than the page containing the record they want.
+    *
+    * In mmap read mode, no page memory is allocated and no AIO reads are made: each page is instead
+    * set to point into a read-only mapping of the journal file (see fcntl::map_rd()) as soon as the
+    * data it covers has been written. Only data whose write AIO has completed is ever exposed, as
+    * the mapping is only coherent with the O_DIRECT writes once they complete. If the caller of
+    * read() supplies an rd_pin, an uncompressed record lying within a single file is decoded in
+    * place, and the xid and data pointers returned point into the mapping; other records are copied
+    * as usual.
+    *
+    * Records are copied into memory allocated for each record, or into the caller's rd_buf if one is
+    * supplied to read(). The same rd_buf must then be supplied to each read() until the record is
+    * complete.
     */
     class rmgr : public pmgr
     {
@@ -69,20 +98,34 @@ namespace journal
         aio_cb* _fhdr_aio_cb_ptr;   ///< iocb pointer for fhdr reads
         file_hdr _fhdr;             ///< file header instance for reading file headers
         bool _fhdr_rd_outstanding;  ///< true if a fhdr read is outstanding
+        std::size_t _pack_offs;     ///< Byte offset of next record in current packed dblk (0 = none)
+        bool _rd_activity;          ///< Set by each read, cleared by release_idle_pages()
+        time_ns _idle_since;        ///< Time at which release_idle_pages() last found read activity
+        u_int16_t _ra_pages;        ///< Max. pages read ahead of the current page (incl. current page)
+        u_int16_t _ra_consumed;     ///< Pages consumed since _ra_pages last changed or cache flushed
+        bool _mmap;                 ///< Pages point into the mapped journal files (mmap read mode)
 
     public:
         rmgr(jcntl* jc, enq_map& emap, txn_map& tmap, rrfc& rrfc);
         virtual ~rmgr();
 
-        void initialize(aio_callback* const cbp);
+        void initialize(aio_callback* const cbp, const u_int32_t cache_pgsize_sblks = JRNL_RMGR_PAGE_SIZE,
+                const u_int16_t cache_num_pages = JRNL_RMGR_PAGES, const bool mmap = false);
         iores read(void** const datapp, std::size_t& dsize, void** const xidpp,
                 std::size_t& xidsize, bool& transient, bool& external, data_tok* dtokp,
-                bool ignore_pending_txns);
+                bool ignore_pending_txns, rd_pin* const pinp = 0, rd_buf* const rbufp = 0);
         int32_t get_events(page_state state, timespec* const timeout, bool flush = false);
         void recover_complete();
         inline iores synchronize() { if (_rrfc.is_valid()) return RHM_IORES_SUCCESS; return aio_cycle(); }
         void invalidate();
         bool wait_for_validity(timespec* const timeout, const bool throw_on_timeout = false);
+        // Free the page memory if there have been no reads for at least idle_secs seconds. Must
+        // not be called concurrently with read(). Returns true if the pages were freed (or, in mmap
+        // read mode, released).
+        bool release_idle_pages(const u_int32_t idle_secs);
+        inline bool pages_allocated() const { return _page_base_ptr != 0; }
+        inline u_int16_t read_ahead_pages() const { return _ra_pages; }
+        inline bool is_mmap() const { return _mmap; }
 
         /* TODO (if required)
         const iores get(const u_int64_t& rid, const std::size_t& dsize, const std::size_t& dsize_avail,
@@ -92,9 +135,15 @@ namespace journal
 
     private:
         void clean();
+        void alloc_pages();
+        void free_pages();
         void flush(timespec* timeout);
         iores pre_read_check(data_tok* dtokp);
-        iores read_enq(rec_hdr& h, void* rptr, data_tok* dtokp);
+        iores enq_check(const rec_hdr& h, data_tok* dtokp, const bool ignore_pending_txns,
+                bool& is_enq);
+        iores read_enq(rec_hdr& h, void* rptr, data_tok* dtokp, rd_pin* const pinp = 0);
+        bool read_enq_in_place(rec_hdr& h, void* rptr, data_tok* dtokp, rd_pin* const pinp);
+        iores read_pack(void* rptr, data_tok* dtokp, const bool ignore_pending_txns, rd_buf* const rbufp);
         void consume_xid_rec(rec_hdr& h, void* rptr, data_tok* dtokp);
         void consume_filler();
         iores skip(data_tok* dtokp);
@@ -102,9 +151,11 @@ namespace journal
         iores init_aio_reads(const int16_t first_uninit, const u_int16_t num_uninit);
         void rotate_page();
         u_int32_t dblks_rem() const;
+        u_int32_t contig_dblks_rem() const;
         void set_params_null(void** const datapp, std::size_t& dsize, void** const xidpp,
                 std::size_t& xidsize);
         void init_file_header_read();
+        void fhdr_read_complete();
     };
 
 } // namespace journal
@@ -33,24 +33,26 @@
 
 #include "jrnl/rrfc.hpp"
 
-#include <cerrno>
-#include <fcntl.h>
-#include <unistd.h>
 #include "jrnl/jerrno.hpp"
 #include "jrnl/jexception.hpp"
+#include <sstream>
 
 namespace mrg
 {
 namespace journal
 {
 
-rrfc::rrfc(const lpmgr* lpmp): rfc(lpmp), _fh(-1), _valid(false)
+rrfc::rrfc(const lpmgr* lpmp):
+        rfc(lpmp),
+        _fh(-1),
+        _valid(false),
+        _subm_cnt_dblks(0),
+        _cmpl_cnt_dblks(0),
+        _reset_cnt(0)
 {}
 
 rrfc::~rrfc()
-{
-    close_fh();
-}
+{}
 
 void
 rrfc::finalize()
@@ -63,14 +65,17 @@ void
 rrfc::set_findex(const u_int16_t fc_index)
 {
     rfc::set_findex(fc_index);
-    open_fh(_curr_fc->fname());
+    _fh = _curr_fc->open_rd_fh();
+    _subm_cnt_dblks = 0;
+    _cmpl_cnt_dblks = 0;
+    _reset_cnt = _curr_fc->reset_cnt();
 }
 
 void
 rrfc::unset_findex()
 {
     set_invalid();
-    close_fh();
+    _fh = -1;
     rfc::unset_findex();
 }
 
@@ -86,39 +91,45 @@ rrfc::rotate()
     return RHM_IORES_SUCCESS;
 }
 
-std::string
-rrfc::status_str() const
+u_int32_t
+rrfc::add_subm_cnt_dblks(u_int32_t a)
 {
-    std::ostringstream oss;
-    oss << "rrfc: " << rfc::status_str();
-    if (is_active())
-        oss << " fcntl[" << _fc_index << "]: " << _curr_fc->status_str();
-    return oss.str();
+    if (_subm_cnt_dblks + a > _curr_fc->wr_subm_cnt_dblks())
+    {
+        std::ostringstream oss;
+        oss << "pfid=" << _curr_fc->pfid() << " lfid=" << _curr_fc->lfid() << " rd_subm_cnt_dblks=" << _subm_cnt_dblks;
+        oss << " incr=" << a << " wr_subm_cnt_dblks=" << _curr_fc->wr_subm_cnt_dblks();
+        throw jexception(jerrno::JERR_FCNTL_RDOFFSOVFL, oss.str(), "rrfc", "add_subm_cnt_dblks");
+    }
+    _subm_cnt_dblks += a;
+    return _subm_cnt_dblks;
 }
 
-// === protected functions ===
-
-void
-rrfc::open_fh(const std::string& fn)
+u_int32_t
+rrfc::add_cmpl_cnt_dblks(u_int32_t a)
 {
-    close_fh();
-    _fh = ::open(fn.c_str(), O_RDONLY | O_DIRECT);
-    if (_fh < 0)
+    if (_cmpl_cnt_dblks + a > _subm_cnt_dblks)
     {
         std::ostringstream oss;
-        oss << "file=\"" << fn << "\"" << FORMAT_SYSERR(errno);
-        throw jexception(jerrno::JERR_RRFC_OPENRD, oss.str(), "rrfc", "open_fh");
+        oss << "pfid=" << _curr_fc->pfid() << " lfid=" << _curr_fc->lfid() << " rd_cmpl_cnt_dblks=" << _cmpl_cnt_dblks;
+        oss << " incr=" << a << " rd_subm_cnt_dblks=" << _subm_cnt_dblks;
+        throw jexception(jerrno::JERR_FCNTL_CMPLOFFSOVFL, oss.str(), "rrfc", "add_cmpl_cnt_dblks");
     }
+    _cmpl_cnt_dblks += a;
+    return _cmpl_cnt_dblks;
 }
 
-void
-rrfc::close_fh()
+std::string
+rrfc::status_str() const
 {
-    if (_fh >= 0)
+    std::ostringstream oss;
+    oss << "rrfc: " << rfc::status_str();
+    if (is_active())
     {
-        ::close(_fh);
-        _fh = -1;
+        oss << " fcntl[" << _fc_index << "]: " << _curr_fc->status_str();
+        oss << " rs=" << _subm_cnt_dblks << " rc=" << _cmpl_cnt_dblks;
     }
+    return oss.str();
 }
 
 } // namespace journal
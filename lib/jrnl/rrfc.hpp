@@ -55,8 +55,8 @@ namespace journal
     *     pipeline in a rotating file buffer or journal. See class rfc for further details.
     *
     * The states that exist in this class are identical to class rfc from which it inherits, but in addition, the value
-    * of the read file handle _fh is also considered. The calls to set_findex also opens the file handle _fh to the
-    * active file for reading. Similarly, unset_findex() closes this file handle.
+    * of the read file handle _fh is also considered. The calls to set_findex also obtain the file handle _fh to the
+    * active file for reading. Similarly, unset_findex() releases this file handle.
     *
     * <pre>
     *                                                                   is_init()  is_active()
@@ -81,6 +81,10 @@ namespace journal
     *                  +===+                    _fh >= 0
     * </pre>
     *
+    * The read position within the active file (the submitted and completed read counts) is held here rather than in
+    * the file controller, so that several instances (one per read cursor, see rcursor) may read the same journal
+    * independently. The read file handle _fh is owned by the file controller and shared by all instances.
+    *
     * In adition to the states above, class rrfc contains a validity flag. This is operated indepenedently of the state
     * machine. This flag (_valid) indicates when the read buffers are valid for reading. This is not strictly a state,
     * but simply a flag used to keep track of the status, and is set/unset with calls to set_valid() and set_invalid()
@@ -89,8 +93,11 @@ namespace journal
     class rrfc : public rfc
     {
     protected:
-        int _fh;                ///< Read file handle
+        int _fh;                ///< Read file handle (owned by _curr_fc)
         bool _valid;            ///< Flag is true when read pages contain vailid data
+        u_int32_t _subm_cnt_dblks; ///< Read file count (data blocks) for submitted AIO
+        u_int32_t _cmpl_cnt_dblks; ///< Read file count (data blocks) for completed AIO
+        u_int32_t _reset_cnt;   ///< Reset count of _curr_fc when it was set
 
     public:
         rrfc(const lpmgr* lpmp);
@@ -109,12 +116,12 @@ namespace journal
         void finalize();
 
         /**
-        * \brief Opens the file handle for reading a particular fid. Moves to state open.
+        * \brief Obtains the file handle for reading a particular fid and resets the read position. Moves to state open.
         */
         void set_findex(const u_int16_t fc_index);
 
         /**
-        * \brief Closes the read file handle and nulls the active fcntl pointer. Moves to state closed.
+        * \brief Releases the read file handle and nulls the active fcntl pointer. Moves to state closed.
         */
         void unset_findex();
 
@@ -148,29 +155,30 @@ namespace journal
 
         inline int fh() const { return _fh; }
 
-        inline u_int32_t subm_cnt_dblks() const { return _curr_fc->rd_subm_cnt_dblks(); }
-        inline std::size_t subm_offs() const { return _curr_fc->rd_subm_offs(); }
-        inline u_int32_t add_subm_cnt_dblks(u_int32_t a) { return _curr_fc->add_rd_subm_cnt_dblks(a); }
+        inline u_int32_t subm_cnt_dblks() const { return _subm_cnt_dblks; }
+        inline std::size_t subm_offs() const { return _subm_cnt_dblks * JRNL_DBLK_SIZE; }
+        u_int32_t add_subm_cnt_dblks(u_int32_t a);
+
+        inline u_int32_t cmpl_cnt_dblks() const { return _cmpl_cnt_dblks; }
+        inline std::size_t cmpl_offs() const { return _cmpl_cnt_dblks * JRNL_DBLK_SIZE; }
+        u_int32_t add_cmpl_cnt_dblks(u_int32_t a);
 
-        inline u_int32_t cmpl_cnt_dblks() const { return _curr_fc->rd_cmpl_cnt_dblks(); }
-        inline std::size_t cmpl_offs() const { return _curr_fc->rd_cmpl_offs(); }
-        inline u_int32_t add_cmpl_cnt_dblks(u_int32_t a) { return _curr_fc->add_rd_cmpl_cnt_dblks(a); }
+        // Reset count of the active file when it was set; if the file's count has since changed, the file has been
+        // reset for writing and data read from it is stale
+        inline u_int32_t reset_cnt() const { return _reset_cnt; }
 
         inline bool is_void() const { return _curr_fc->rd_void(); }
         inline bool is_empty() const { return _curr_fc->rd_empty(); }
-        inline u_int32_t remaining_dblks() const { return _curr_fc->rd_remaining_dblks(); }
-        inline bool is_full() const { return _curr_fc->is_rd_full(); }
-        inline bool is_compl() const { return _curr_fc->is_rd_compl(); }
-        inline u_int32_t aio_outstanding_dblks() const { return _curr_fc->rd_aio_outstanding_dblks(); }
-        inline bool file_rotate() const { return _curr_fc->rd_file_rotate(); }
+        inline u_int32_t remaining_dblks() const { return _curr_fc->wr_cmpl_cnt_dblks() - _subm_cnt_dblks; }
+        inline bool is_full() const { return _curr_fc->wr_cmpl_cnt_dblks() == _subm_cnt_dblks; }
+        inline bool is_compl() const { return _curr_fc->wr_cmpl_cnt_dblks() == _cmpl_cnt_dblks; }
+        inline u_int32_t aio_outstanding_dblks() const { return _subm_cnt_dblks - _cmpl_cnt_dblks; }
+        inline bool file_rotate() const { return is_full() && _curr_fc->is_wr_compl(); }
         inline bool is_wr_aio_outstanding() const { return _curr_fc->wr_aio_outstanding_dblks() > 0; }
 
         // Debug aid
         std::string status_str() const;
 
-    protected:
-        void open_fh(const std::string& fn);
-        void close_fh();
     }; // class rrfc
 
 } // namespace journal
@@ -32,6 +32,7 @@
 
 #include "jrnl/txn_map.hpp"
 
+#include <algorithm>
 #include <iomanip>
 #include "jrnl/jerrno.hpp"
 #include "jrnl/jexception.hpp"
@@ -61,7 +62,6 @@ txn_data_struct::txn_data_struct(const u_int64_t rid, const u_int64_t drid, cons
 {}
 
 txn_map::txn_map():
-        _map(),
         _pfid_txn_cnt()
 {}
 
@@ -80,61 +80,70 @@ txn_map::get_txn_pfid_cnt(const u_int16_t pfid) const
 }
 
 bool
-txn_map::insert_txn_data(const std::string& xid, const txn_data& td)
+txn_map::insert_txn_data(const xid_handle& xid, const txn_data& td)
 {
     bool ok = true;
-    slock s(_mutex);
-    xmap_itr itr = _map.find(xid);
-    if (itr == _map.end()) // not found in map
+    xmap_stripe& st = stripe(xid);
     {
-        txn_data_list list;
-        list.push_back(td);
-        std::pair<xmap_itr, bool> ret = _map.insert(xmap_param(xid, list));
-        if (!ret.second) // duplicate
-            ok = false;
+        slock s(st._mutex);
+        xmap_itr itr = st._map.find(xid);
+        if (itr == st._map.end()) // not found in map
+        {
+            txn_data_list list;
+            list.push_back(td);
+            std::pair<xmap_itr, bool> ret = st._map.insert(xmap_param(xid, list));
+            if (!ret.second) // duplicate
+                ok = false;
+        }
+        else
+            itr->second.push_back(td);
     }
-    else
-        itr->second.push_back(td);
-    _pfid_txn_cnt.at(td._pfid)++;
+    __sync_add_and_fetch(&_pfid_txn_cnt.at(td._pfid), 1);
     return ok;
 }
 
 const txn_data_list
-txn_map::get_tdata_list(const std::string& xid)
+txn_map::get_tdata_list(const xid_handle& xid)
 {
-    slock s(_mutex);
-    return get_tdata_list_nolock(xid);
+    xmap_stripe& st = stripe(xid);
+    slock s(st._mutex);
+    return get_tdata_list_nolock(st, xid);
 }
 
 const txn_data_list
-txn_map::get_tdata_list_nolock(const std::string& xid)
+txn_map::get_tdata_list_nolock(xmap_stripe& st, const xid_handle& xid)
 {
-    xmap_itr itr = _map.find(xid);
-    if (itr == _map.end()) // not found in map
+    xmap_itr itr = st._map.find(xid);
+    if (itr == st._map.end()) // not found in map
         return _empty_data_list;
     return itr->second;
 }
 
 const txn_data_list
-txn_map::get_remove_tdata_list(const std::string& xid)
+txn_map::get_remove_tdata_list(const xid_handle& xid)
 {
-    slock s(_mutex);
-    xmap_itr itr = _map.find(xid);
-    if (itr == _map.end()) // not found in map
-        return _empty_data_list;
-    txn_data_list list = itr->second;
-    _map.erase(itr);
+    txn_data_list list;
+    xmap_stripe& st = stripe(xid);
+    {
+        slock s(st._mutex);
+        xmap_itr itr = st._map.find(xid);
+        if (itr == st._map.end()) // not found in map
+            return _empty_data_list;
+        list.swap(itr->second);
+        st._map.erase(itr);
+    }
     for (tdl_itr i=list.begin(); i!=list.end(); i++)
-        _pfid_txn_cnt.at(i->_pfid)--;
+        __sync_sub_and_fetch(&_pfid_txn_cnt.at(i->_pfid), 1);
     return list;
 }
 
 bool
-txn_map::in_map(const std::string& xid)
+txn_map::in_map(const xid_handle& xid)
 {
-    slock s(_mutex);
-    xmap_itr itr= _map.find(xid);
-    return itr != _map.end();
+    xmap_stripe& st = stripe(xid);
+    slock s(st._mutex);
+    xmap_itr itr= st._map.find(xid);
+    return itr != st._map.end();
 }
 
 u_int32_t
@@ -152,25 +161,30 @@ txn_map::deq_cnt()
 u_int32_t
 txn_map::cnt(const bool enq_flag)
 {
-    slock s(_mutex);
     u_int32_t c = 0;
-    for (xmap_itr i = _map.begin(); i != _map.end(); i++)
+    for (int k = 0; k < JRNL_MAP_STRIPES; k++)
     {
-        for (tdl_itr j = i->second.begin(); j < i->second.end(); j++)
+        xmap_stripe& st = _stripes[k];
+        slock s(st._mutex);
+        for (xmap_itr i = st._map.begin(); i != st._map.end(); i++)
         {
-            if (j->_enq_flag == enq_flag)
-                c++;
+            for (tdl_itr j = i->second.begin(); j < i->second.end(); j++)
+            {
+                if (j->_enq_flag == enq_flag)
+                    c++;
+            }
         }
     }
     return c;
 }
 
 int16_t
-txn_map::is_txn_synced(const std::string& xid)
+txn_map::is_txn_synced(const xid_handle& xid)
 {
-    slock s(_mutex);
-    xmap_itr itr = _map.find(xid);
-    if (itr == _map.end()) // not found in map
+    xmap_stripe& st = stripe(xid);
+    slock s(st._mutex);
+    xmap_itr itr = st._map.find(xid);
+    if (itr == st._map.end()) // not found in map
         return TMAP_XID_NOT_FOUND;
     bool is_synced = true;
     for (tdl_itr litr = itr->second.begin(); litr < itr->second.end(); litr++)
@@ -185,11 +199,12 @@ txn_map::is_txn_synced(const std::string& xid)
 }
 
 int16_t
-txn_map::set_aio_compl(const std::string& xid, const u_int64_t rid)
+txn_map::set_aio_compl(const xid_handle& xid, const u_int64_t rid)
 {
-    slock s(_mutex);
-    xmap_itr itr = _map.find(xid);
-    if (itr == _map.end()) // xid not found in map
+    xmap_stripe& st = stripe(xid);
+    slock s(st._mutex);
+    xmap_itr itr = st._map.find(xid);
+    if (itr == st._map.end()) // xid not found in map
         return TMAP_XID_NOT_FOUND;
     for (tdl_itr litr = itr->second.begin(); litr < itr->second.end(); litr++)
     {
@@ -204,32 +219,32 @@ txn_map::set_aio_compl(const std::string& xid, const u_int64_t rid)
 }
 
 bool
-txn_map::data_exists(const std::string& xid, const u_int64_t rid)
+txn_map::data_exists(const xid_handle& xid, const u_int64_t rid)
 {
-    bool found = false;
+    xmap_stripe& st = stripe(xid);
+    slock s(st._mutex);
+    xmap_itr itr = st._map.find(xid);
+    if (itr == st._map.end()) // not found in map
+        return false;
+    for (tdl_itr litr = itr->second.begin(); litr < itr->second.end(); litr++)
     {
-        slock s(_mutex);
-        txn_data_list tdl = get_tdata_list_nolock(xid);
-        tdl_itr itr = tdl.begin();
-        while (itr != tdl.end() && !found)
-        {
-            found = itr->_rid == rid;
-            itr++;
-        }
+        if (litr->_rid == rid)
+            return true;
     }
-    return found;
+    return false;
 }
 
 bool
 txn_map::is_enq(const u_int64_t rid)
 {
     bool found = false;
+    for (int k = 0; k < JRNL_MAP_STRIPES && !found; k++)
     {
-        slock s(_mutex);
-        for (xmap_itr i = _map.begin(); i != _map.end() && !found; i++)
+        xmap_stripe& st = _stripes[k];
+        slock s(st._mutex);
+        for (xmap_itr i = st._map.begin(); i != st._map.end() && !found; i++)
         {
-            txn_data_list list = i->second;
-            for (tdl_itr j = list.begin(); j < list.end() && !found; j++)
+            for (tdl_itr j = i->second.begin(); j < i->second.end() && !found; j++)
             {
                 if (j->_enq_flag)
                     found = j->_rid == rid;
@@ -241,15 +256,72 @@ txn_map::is_enq(const u_int64_t rid)
     return found;
 }
 
+void
+txn_map::clear()
+{
+    for (int k = 0; k < JRNL_MAP_STRIPES; k++)
+    {
+        slock s(_stripes[k]._mutex);
+        _stripes[k]._map.clear();
+    }
+}
+
+bool
+txn_map::empty() const
+{
+    for (int k = 0; k < JRNL_MAP_STRIPES; k++)
+    {
+        slock s(_stripes[k]._mutex);
+        if (!_stripes[k]._map.empty())
+            return false;
+    }
+    return true;
+}
+
+size_t
+txn_map::size() const
+{
+    size_t cnt = 0;
+    for (int k = 0; k < JRNL_MAP_STRIPES; k++)
+    {
+        slock s(_stripes[k]._mutex);
+        cnt += _stripes[k]._map.size();
+    }
+    return cnt;
+}
+
+size_t
+txn_map::mem_bytes() const
+{
+    size_t bytes = _pfid_txn_cnt.capacity() * sizeof(u_int32_t);
+    for (int k = 0; k < JRNL_MAP_STRIPES; k++)
+    {
+        slock s(_stripes[k]._mutex);
+        for (xmap_citr itr = _stripes[k]._map.begin(); itr != _stripes[k]._map.end(); itr++)
+            bytes += sizeof(xmap::value_type) + JRNL_MAP_NODE_OVERHEAD + itr->second.capacity() * sizeof(txn_data);
+    }
+    return bytes;
+}
+
 void
 txn_map::xid_list(std::vector<std::string>& xv)
 {
     xv.clear();
+    for (int k = 0; k < JRNL_MAP_STRIPES; k++)
     {
-        slock s(_mutex);
-        for (xmap_itr itr = _map.begin(); itr != _map.end(); itr++)
-            xv.push_back(itr->first);
+        slock s(_stripes[k]._mutex);
+        for (xmap_itr itr = _stripes[k]._map.begin(); itr != _stripes[k]._map.end(); itr++)
+            xv.push_back(itr->first.str());
     }
+    // Keep the xid ordering of a single map
+    std::sort(xv.begin(), xv.end());
+}
+
+// Selects the stripe for xid using its (FNV-1a) hash
+txn_map::xmap_stripe&
+txn_map::stripe(const xid_handle& xid)
+{
+    return _stripes[xid.hash() & (JRNL_MAP_STRIPES - 1)];
 }
 
 } // namespace journal
@@ -41,7 +41,9 @@ namespace journal
 }
 }
 
+#include "jrnl/jcfg.hpp"
 #include "jrnl/smutex.hpp"
+#include "jrnl/xid_handle.hpp"
 #include <map>
 #include <pthread.h>
 #include <string>
@@ -107,6 +109,13 @@ namespace journal
     *   xid3 --- vector< [ rid, drid, pfid, enq_flag, commit_flag, aio_compl ] >
     *   ...
     * </pre>
+    *
+    * As with enq_map, the map is split into JRNL_MAP_STRIPES stripes selected by a hash of the
+    * xid, each with its own mutex. AIO completions (set_aio_compl()) and sync checks
+    * (is_txn_synced()) on one transaction therefore do not block operations on others.
+    *
+    * The map is keyed by interned xid handle (see xid_handle), so lookups compare handles rather
+    * than strings, and the stripe is selected using the handle's precomputed hash.
     */
     class txn_map
     {
@@ -119,12 +128,18 @@ namespace journal
         static int16_t TMAP_SYNCED;
 
     private:
-        typedef std::pair<std::string, txn_data_list> xmap_param;
-        typedef std::map<std::string, txn_data_list> xmap;
+        typedef std::pair<xid_handle, txn_data_list> xmap_param;
+        typedef std::map<xid_handle, txn_data_list> xmap;
         typedef xmap::iterator xmap_itr;
+        typedef xmap::const_iterator xmap_citr;
+
+        struct xmap_stripe
+        {
+            xmap _map;
+            smutex _mutex;
+        };
 
-        xmap _map;
-        smutex _mutex;
+        xmap_stripe _stripes[JRNL_MAP_STRIPES];
         std::vector<u_int32_t> _pfid_txn_cnt;
         const txn_data_list _empty_data_list;
 
@@ -134,23 +149,25 @@ namespace journal
 
         void set_num_jfiles(const u_int16_t num_jfiles);
         u_int32_t get_txn_pfid_cnt(const u_int16_t pfid) const;
-        bool insert_txn_data(const std::string& xid, const txn_data& td);
-        const txn_data_list get_tdata_list(const std::string& xid);
-        const txn_data_list get_remove_tdata_list(const std::string& xid);
-        bool in_map(const std::string& xid);
+        bool insert_txn_data(const xid_handle& xid, const txn_data& td);
+        const txn_data_list get_tdata_list(const xid_handle& xid);
+        const txn_data_list get_remove_tdata_list(const xid_handle& xid);
+        bool in_map(const xid_handle& xid);
         u_int32_t enq_cnt();
         u_int32_t deq_cnt();
-        int16_t is_txn_synced(const std::string& xid); // -1=xid not found; 0=not synced; 1=synced
-        int16_t set_aio_compl(const std::string& xid, const u_int64_t rid); // -2=rid not found; -1=xid not found; 0=done
-        bool data_exists(const std::string& xid, const u_int64_t rid);
+        int16_t is_txn_synced(const xid_handle& xid); // -1=xid not found; 0=not synced; 1=synced
+        int16_t set_aio_compl(const xid_handle& xid, const u_int64_t rid); // -2=rid not found; -1=xid not found; 0=done
+        bool data_exists(const xid_handle& xid, const u_int64_t rid);
         bool is_enq(const u_int64_t rid);
-        inline void clear() { _map.clear(); }
-        inline bool empty() const { return _map.empty(); }
-        inline size_t size() const { return _map.size(); }
+        void clear();
+        bool empty() const;
+        size_t size() const;
+        size_t mem_bytes() const; // Estimated heap memory held by the map, including txn_data lists
         void xid_list(std::vector<std::string>& xv);
     private:
         u_int32_t cnt(const bool enq_flag);
-        const txn_data_list get_tdata_list_nolock(const std::string& xid);
+        const txn_data_list get_tdata_list_nolock(xmap_stripe& st, const xid_handle& xid);
+        xmap_stripe& stripe(const xid_handle& xid);
     };
 
 } // namespace journal
@@ -32,6 +32,7 @@
 
 #include "jrnl/wmgr.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
 #include <cstdlib>
@@ -39,6 +40,8 @@
 #include "jrnl/file_hdr.hpp"
 #include "jrnl/jcntl.hpp"
 #include "jrnl/jerrno.hpp"
+#include "jrnl/pack_hdr.hpp"
+#include "jrnl/slock.hpp"
 #include <sstream>
 
 namespace mrg
@@ -58,11 +61,25 @@ wmgr::wmgr(jcntl* jc, enq_map& emap, txn_map& tmap, wrfc& wrfc):
         _jfsize_dblks(0),
         _jfsize_pgs(0),
         _num_jfiles(0),
+        _min_pages(JRNL_WMGR_MIN_PAGES),
+        _res_pages(0),
         _enq_busy(false),
         _deq_busy(false),
         _abort_busy(false),
         _commit_busy(false),
-        _txn_pending_set()
+        _txn_pending_set(),
+        _codec(0),
+        _cmpr_threshold(0),
+        _cmpr_buff(0),
+        _cmpr_buff_size(0),
+        _cmpr_dsize(0),
+        _pack_recs(false),
+        _pack_ptr(0),
+        _pack_offs(0),
+        _rec_bytes(0),
+        _subm_dblks(0),
+        _subm_list(),
+        _cb_dtokl()
 {}
 
 wmgr::wmgr(jcntl* jc, enq_map& emap, txn_map& tmap, wrfc& wrfc,
@@ -78,11 +95,25 @@ wmgr::wmgr(jcntl* jc, enq_map& emap, txn_map& tmap, wrfc& wrfc,
         _jfsize_dblks(0),
         _jfsize_pgs(0),
         _num_jfiles(0),
+        _min_pages(JRNL_WMGR_MIN_PAGES),
+        _res_pages(0),
         _enq_busy(false),
         _deq_busy(false),
         _abort_busy(false),
         _commit_busy(false),
-        _txn_pending_set()
+        _txn_pending_set(),
+        _codec(0),
+        _cmpr_threshold(0),
+        _cmpr_buff(0),
+        _cmpr_buff_size(0),
+        _cmpr_dsize(0),
+        _pack_recs(false),
+        _pack_ptr(0),
+        _pack_offs(0),
+        _rec_bytes(0),
+        _subm_dblks(0),
+        _subm_list(),
+        _cb_dtokl()
 {}
 
 wmgr::~wmgr()
@@ -119,19 +150,22 @@ wmgr::initialize(aio_callback* const cbp, const u_int32_t wcache_pgsize_sblks,
 
 iores
 wmgr::enqueue(const void* const data_buff, const std::size_t tot_data_len,
-        const std::size_t this_data_len, data_tok* dtokp, const void* const xid_ptr,
-        const std::size_t xid_len, const bool transient, const bool external)
+        const std::size_t this_data_len, data_tok* dtokp, const xid_handle& xid,
+        const bool transient, const bool external)
 {
-    if (xid_len)
-        assert(xid_ptr != 0);
-
     if (_deq_busy || _abort_busy || _commit_busy)
         return RHM_IORES_BUSY;
 
     if (this_data_len != tot_data_len && !external)
         return RHM_IORES_NOTIMPL;
 
-    iores res = pre_write_check(WMGR_ENQUEUE, dtokp, xid_len, tot_data_len, external);
+    // Compress on the first call only; continuations must re-encode the same packed data
+    if (!_enq_busy)
+        _cmpr_dsize = compress_data(data_buff, tot_data_len, external);
+    const void* const wr_data_buff = _cmpr_dsize ? _cmpr_buff : data_buff;
+    const std::size_t wr_data_len = _cmpr_dsize ? _cmpr_dsize : tot_data_len;
+
+    iores res = pre_write_check(WMGR_ENQUEUE, dtokp, xid.size(), wr_data_len, external);
     if (res != RHM_IORES_SUCCESS)
         return res;
 
@@ -149,26 +183,30 @@ wmgr::enqueue(const void* const data_buff, const std::size_t tot_data_len,
     }
 
     u_int64_t rid = (dtokp->external_rid() | cont) ? dtokp->rid() : _wrfc.get_incr_rid();
-    _enq_rec.reset(rid, data_buff, tot_data_len, xid_ptr, xid_len, _wrfc.owi(), transient,
-            external);
+    _enq_rec.reset(rid, wr_data_buff, wr_data_len, xid.data(), xid.size(), _wrfc.owi(), transient,
+            external, _cmpr_dsize > 0);
     if (!cont)
     {
         dtokp->set_rid(rid);
         dtokp->set_dequeue_rid(0);
-        if (xid_len)
-            dtokp->set_xid(xid_ptr, xid_len);
-        else
-            dtokp->clear_xid();
+        dtokp->set_xid(xid);
         _enq_busy = true;
     }
+    const bool packed = !cont && packable(_enq_rec.rec_size(), xid.size());
     bool done = false;
     while (!done)
     {
         assert(_pg_offset_dblks < _cache_pgsize_sblks * JRNL_SBLK_SIZE);
-        void* wptr = (void*)((char*)_page_ptr_arr[_pg_index] + _pg_offset_dblks * JRNL_DBLK_SIZE);
         u_int32_t data_offs_dblks = dtokp->dblocks_written();
-        u_int32_t ret = _enq_rec.encode(wptr, data_offs_dblks,
-                (_cache_pgsize_sblks * JRNL_SBLK_SIZE) - _pg_offset_dblks);
+        u_int32_t ret;
+        if (packed)
+            ret = pack_encode(_enq_rec, rid);
+        else
+        {
+            void* wptr = (void*)((char*)_page_ptr_arr[_pg_index] + _pg_offset_dblks * JRNL_DBLK_SIZE);
+            ret = _enq_rec.encode(wptr, data_offs_dblks,
+                    (_cache_pgsize_sblks * JRNL_SBLK_SIZE) - _pg_offset_dblks);
+        }
 
         // Remember fid which contains the record header in case record is split over several files
         if (data_offs_dblks == 0)
@@ -179,8 +217,8 @@ wmgr::enqueue(const void* const data_buff, const std::size_t tot_data_len,
         dtokp->incr_pg_cnt();
         _page_cb_arr[_pg_index]._pdtokl->push_back(dtokp);
 
-        // Is the encoding of this record complete?
-        if (dtokp->dblocks_written() >= _enq_rec.rec_size_dblks())
+        // Is the encoding of this record complete? (Packed records always complete at once.)
+        if (packed || dtokp->dblocks_written() >= _enq_rec.rec_size_dblks())
         {
             // TODO: Incorrect - must set state to ENQ_CACHED; ENQ_SUBM is set when AIO returns.
             dtokp->set_wstate(data_tok::ENQ_SUBM);
@@ -191,9 +229,8 @@ wmgr::enqueue(const void* const data_buff, const std::size_t tot_data_len,
             // enqueued.
             _wrfc.incr_enqcnt(dtokp->fid());
 
-            if (xid_len) // If part of transaction, add to transaction map
+            if (!xid.empty()) // If part of transaction, add to transaction map
             {
-                std::string xid((char*)xid_ptr, xid_len);
                 _tmap.insert_txn_data(xid, txn_data(rid, 0, dtokp->fid(), true));
             }
             else
@@ -206,6 +243,16 @@ wmgr::enqueue(const void* const data_buff, const std::size_t tot_data_len,
                     throw jexception(jerrno::JERR_MAP_DUPLICATE, oss.str(), "wmgr", "enqueue");
                 }
             }
+            _rec_bytes += _enq_rec.rec_size();
+
+            // Record is now in the page cache; don't hold on to buffers for unusually large records
+            _cmpr_dsize = 0;
+            if (_cmpr_buff_size > _cache_pgsize_sblks * JRNL_SBLK_SIZE * JRNL_DBLK_SIZE)
+            {
+                std::free(_cmpr_buff);
+                _cmpr_buff = 0;
+                _cmpr_buff_size = 0;
+            }
 
             done = true;
         }
@@ -221,11 +268,8 @@ wmgr::enqueue(const void* const data_buff, const std::size_t tot_data_len,
 }
 
 iores
-wmgr::dequeue(data_tok* dtokp, const void* const xid_ptr, const std::size_t xid_len, const bool txn_coml_commit)
+wmgr::dequeue(data_tok* dtokp, const xid_handle& xid, const bool txn_coml_commit)
 {
-    if (xid_len)
-        assert(xid_ptr != 0);
-
     if (_enq_busy || _abort_busy || _commit_busy)
         return RHM_IORES_BUSY;
 
@@ -249,7 +293,7 @@ wmgr::dequeue(data_tok* dtokp, const void* const xid_ptr, const std::size_t xid_
     const bool ext_rid = dtokp->external_rid();
     u_int64_t rid = (ext_rid | cont) ? dtokp->rid() : _wrfc.get_incr_rid();
     u_int64_t dequeue_rid = (ext_rid | cont) ? dtokp->dequeue_rid() : dtokp->rid();
-    _deq_rec.reset(rid, dequeue_rid, xid_ptr, xid_len, _wrfc.owi(), txn_coml_commit);
+    _deq_rec.reset(rid, dequeue_rid, xid.data(), xid.size(), _wrfc.owi(), txn_coml_commit);
     if (!cont)
     {
 	    if (!ext_rid)
@@ -257,22 +301,26 @@ wmgr::dequeue(data_tok* dtokp, const void* const xid_ptr, const std::size_t xid_
 		    dtokp->set_rid(rid);
 		    dtokp->set_dequeue_rid(dequeue_rid);
 	    }
-        if (xid_len)
-            dtokp->set_xid(xid_ptr, xid_len);
-        else
-            dtokp->clear_xid();
+        dtokp->set_xid(xid);
         dequeue_check(dtokp->xid(), dequeue_rid);
         dtokp->set_dblocks_written(0); // Reset dblks_written from previous op
         _deq_busy = true;
     }
+    const bool packed = !cont && packable(_deq_rec.rec_size(), xid.size());
     bool done = false;
     while (!done)
     {
         assert(_pg_offset_dblks < _cache_pgsize_sblks * JRNL_SBLK_SIZE);
-        void* wptr = (void*)((char*)_page_ptr_arr[_pg_index] + _pg_offset_dblks * JRNL_DBLK_SIZE);
         u_int32_t data_offs_dblks = dtokp->dblocks_written();
-        u_int32_t ret = _deq_rec.encode(wptr, data_offs_dblks,
-                (_cache_pgsize_sblks * JRNL_SBLK_SIZE) - _pg_offset_dblks);
+        u_int32_t ret;
+        if (packed)
+            ret = pack_encode(_deq_rec, rid);
+        else
+        {
+            void* wptr = (void*)((char*)_page_ptr_arr[_pg_index] + _pg_offset_dblks * JRNL_DBLK_SIZE);
+            ret = _deq_rec.encode(wptr, data_offs_dblks,
+                    (_cache_pgsize_sblks * JRNL_SBLK_SIZE) - _pg_offset_dblks);
+        }
 
         // Remember fid which contains the record header in case record is split over several files
         if (data_offs_dblks == 0)
@@ -283,17 +331,16 @@ wmgr::dequeue(data_tok* dtokp, const void* const xid_ptr, const std::size_t xid_
         dtokp->incr_pg_cnt();
         _page_cb_arr[_pg_index]._pdtokl->push_back(dtokp);
 
-        // Is the encoding of this record complete?
-        if (dtokp->dblocks_written() >= _deq_rec.rec_size_dblks())
+        // Is the encoding of this record complete? (Packed records always complete at once.)
+        if (packed || dtokp->dblocks_written() >= _deq_rec.rec_size_dblks())
         {
             // TODO: Incorrect - must set state to ENQ_CACHED; ENQ_SUBM is set when AIO returns.
             dtokp->set_wstate(data_tok::DEQ_SUBM);
 
-            if (xid_len) // If part of transaction, add to transaction map
+            if (!xid.empty()) // If part of transaction, add to transaction map
             {
                 // If the enqueue is part of a pending txn, it will not yet be in emap
                 _emap.lock(dequeue_rid); // ignore rid not found error
-                std::string xid((char*)xid_ptr, xid_len);
                 _tmap.insert_txn_data(xid, txn_data(rid, dequeue_rid, dtokp->fid(), false));
             }
             else
@@ -316,6 +363,7 @@ wmgr::dequeue(data_tok* dtokp, const void* const xid_ptr, const std::size_t xid_
                 }
                 _wrfc.decr_enqcnt(fid);
             }
+            _rec_bytes += _deq_rec.rec_size();
 
             done = true;
         }
@@ -331,10 +379,182 @@ wmgr::dequeue(data_tok* dtokp, const void* const xid_ptr, const std::size_t xid_
 }
 
 iores
-wmgr::abort(data_tok* dtokp, const void* const xid_ptr, const std::size_t xid_len)
+wmgr::dequeue(const std::vector<data_tok*>& dtokl)
+{
+    assert(!dtokl.empty());
+
+    if (_enq_busy || _abort_busy || _commit_busy)
+        return RHM_IORES_BUSY;
+
+    // The first data_tok tracks the progress of the record through the cache; all data_toks in
+    // the list are placed on the same pages and so complete together.
+    data_tok* dtokp = dtokl.front();
+    iores res = pre_write_check(WMGR_DEQUEUE, dtokp);
+    if (res != RHM_IORES_SUCCESS)
+        return res;
+
+    bool cont = false;
+    if (_deq_busy) // If dequeue() exited last time with RHM_IORES_FULL or RHM_IORES_PAGE_AIOWAIT
+    {
+        if (dtokp->wstate() == data_tok::DEQ_PART)
+            cont = true;
+        else
+        {
+            std::ostringstream oss;
+            oss << "This data_tok: id=" << dtokp->id() << " state=" << dtokp->wstate_str();
+            throw jexception(jerrno::JERR_WMGR_DEQDISCONT, oss.str(), "wmgr", "dequeue");
+        }
+    }
+
+    const bool ext_rid = dtokp->external_rid();
+    u_int64_t rid = (ext_rid | cont) ? dtokp->rid() : _wrfc.get_incr_rid();
+    std::vector<data_tok*>::const_iterator i;
+    if (!cont)
+    {
+        _mdeq_drids.clear();
+        for (i = dtokl.begin(); i != dtokl.end(); i++)
+        {
+            if (!(*i)->is_dequeueable())
+            {
+                std::ostringstream oss;
+                oss << "jrnl=" << _jc->id()  << " op=" << _op_str[WMGR_DEQUEUE];
+                oss << " dtok_id=" << (*i)->id() << " dtok_state=" << (*i)->wstate_str();
+                throw jexception(jerrno::JERR_WMGR_BADDTOKSTATE, oss.str(), "wmgr", "dequeue");
+            }
+            _mdeq_drids.push_back(ext_rid ? (*i)->dequeue_rid() : (*i)->rid());
+        }
+
+        // Check all rids before writing anything, so that a bad rid leaves no partial record
+        std::vector<u_int64_t> sorted_drids(_mdeq_drids);
+        std::sort(sorted_drids.begin(), sorted_drids.end());
+        std::vector<u_int64_t>::const_iterator dup = std::adjacent_find(sorted_drids.begin(),
+                sorted_drids.end());
+        if (dup != sorted_drids.end())
+        {
+            std::ostringstream oss;
+            oss << "jrnl=" << _jc->id() << " drid=0x" << std::hex << *dup;
+            throw jexception(jerrno::JERR_WMGR_DEQRIDDUP, oss.str(), "wmgr", "dequeue");
+        }
+        for (std::vector<u_int64_t>::const_iterator j = _mdeq_drids.begin(); j != _mdeq_drids.end(); j++)
+            dequeue_check(std::string(), *j);
+
+        std::vector<u_int64_t>::const_iterator j = _mdeq_drids.begin();
+        for (i = dtokl.begin(); i != dtokl.end(); i++, j++)
+        {
+            (*i)->set_rid(rid);
+            (*i)->set_dequeue_rid(*j);
+            (*i)->clear_xid();
+            (*i)->set_dblocks_written(0); // Reset dblks_written from previous op
+        }
+
+        // If the rids are all the records enqueued within their range (as results from in-order
+        // consumption or a purge), a single range dequeue record replaces the list of rids
+        bool locked = false;
+        if (_emap.range_cnt(sorted_drids.front(), sorted_drids.back(), locked) == sorted_drids.size() &&
+                !locked)
+            return rdeq_encode(dtokl, rid, sorted_drids.front(), sorted_drids.back());
+        _deq_busy = true;
+    }
+    _mdeq_rec.reset(rid, &_mdeq_drids[0], _mdeq_drids.size(), _wrfc.owi());
+    bool done = false;
+    while (!done)
+    {
+        assert(_pg_offset_dblks < _cache_pgsize_sblks * JRNL_SBLK_SIZE);
+        void* wptr = (void*)((char*)_page_ptr_arr[_pg_index] + _pg_offset_dblks * JRNL_DBLK_SIZE);
+        u_int32_t data_offs_dblks = dtokp->dblocks_written();
+        u_int32_t ret = _mdeq_rec.encode(wptr, data_offs_dblks,
+                (_cache_pgsize_sblks * JRNL_SBLK_SIZE) - _pg_offset_dblks);
+
+        _pg_offset_dblks += ret;
+        _cached_offset_dblks += ret;
+        for (i = dtokl.begin(); i != dtokl.end(); i++)
+        {
+            // Remember fid which contains the record header in case record is split over several files
+            if (data_offs_dblks == 0)
+                (*i)->set_fid(_wrfc.index());
+            (*i)->incr_dblocks_written(ret);
+            (*i)->incr_pg_cnt();
+            _page_cb_arr[_pg_index]._pdtokl->push_back(*i);
+        }
+
+        // Is the encoding of this record complete?
+        if (dtokp->dblocks_written() >= _mdeq_rec.rec_size_dblks())
+        {
+            // TODO: Incorrect - must set state to ENQ_CACHED; ENQ_SUBM is set when AIO returns.
+            for (i = dtokl.begin(); i != dtokl.end(); i++)
+                (*i)->set_wstate(data_tok::DEQ_SUBM);
+
+            for (std::vector<u_int64_t>::const_iterator j = _mdeq_drids.begin(); j != _mdeq_drids.end(); j++)
+            {
+                int16_t fid = _emap.get_remove_pfid(*j);
+                if (fid < enq_map::EMAP_OK) // fail
+                {
+                    std::ostringstream oss;
+                    oss << std::hex << "rid=0x" << rid << " drid=0x" << *j;
+                    if (fid == enq_map::EMAP_RID_NOT_FOUND)
+                        throw jexception(jerrno::JERR_MAP_NOTFOUND, oss.str(), "wmgr", "dequeue");
+                    if (fid == enq_map::EMAP_LOCKED)
+                        throw jexception(jerrno::JERR_MAP_LOCKED, oss.str(), "wmgr", "dequeue");
+                }
+                _wrfc.decr_enqcnt(fid);
+            }
+            _rec_bytes += _mdeq_rec.rec_size();
+
+            done = true;
+        }
+        else
+        {
+            for (i = dtokl.begin(); i != dtokl.end(); i++)
+                (*i)->set_wstate(data_tok::DEQ_PART);
+        }
+
+        file_header_check(rid, cont, _mdeq_rec.rec_size_dblks() - data_offs_dblks);
+        flush_check(res, cont, done);
+    }
+    if (dtokp->wstate() >= data_tok::DEQ_SUBM)
+        _deq_busy = false;
+    return res;
+}
+
+iores
+wmgr::dequeue_range(data_tok* dtokp, const u_int64_t first_rid, const u_int64_t last_rid)
+{
+    if (_enq_busy || _deq_busy || _abort_busy || _commit_busy)
+        return RHM_IORES_BUSY;
+
+    iores res = pre_write_check(WMGR_DEQUEUE, dtokp);
+    if (res != RHM_IORES_SUCCESS)
+        return res;
+
+    // Check the range before writing anything
+    bool locked = false;
+    const u_int32_t cnt = first_rid <= last_rid ? _emap.range_cnt(first_rid, last_rid, locked) : 0;
+    if (locked)
+    {
+        std::ostringstream oss;
+        oss << "jrnl=" << _jc->id() << std::hex << " first_rid=0x" << first_rid << " last_rid=0x" << last_rid;
+        throw jexception(jerrno::JERR_MAP_LOCKED, oss.str(), "wmgr", "dequeue_range");
+    }
+    if (cnt == 0)
+    {
+        std::ostringstream oss;
+        oss << "jrnl=" << _jc->id() << std::hex << " first_rid=0x" << first_rid << " last_rid=0x" << last_rid;
+        throw jexception(jerrno::JERR_WMGR_DEQRIDNOTENQ, oss.str(), "wmgr", "dequeue_range");
+    }
+
+    const u_int64_t rid = dtokp->external_rid() ? dtokp->rid() : _wrfc.get_incr_rid();
+    dtokp->set_rid(rid);
+    dtokp->set_dequeue_rid(last_rid);
+    dtokp->clear_xid();
+    dtokp->set_dblocks_written(0); // Reset dblks_written from previous op
+    return rdeq_encode(std::vector<data_tok*>(1, dtokp), rid, first_rid, last_rid);
+}
+
+iores
+wmgr::abort(data_tok* dtokp, const xid_handle& xid)
 {
     // commit and abort MUST have a valid xid
-    assert(xid_ptr != 0 && xid_len > 0);
+    assert(!xid.empty());
 
     if (_enq_busy || _deq_busy || _commit_busy)
         return RHM_IORES_BUSY;
@@ -357,12 +577,12 @@ wmgr::abort(data_tok* dtokp, const void* const xid_ptr, const std::size_t xid_le
     }
 
     u_int64_t rid = (dtokp->external_rid() | cont) ? dtokp->rid() : _wrfc.get_incr_rid();
-    _txn_rec.reset(RHM_JDAT_TXA_MAGIC, rid, xid_ptr, xid_len, _wrfc.owi());
+    _txn_rec.reset(RHM_JDAT_TXA_MAGIC, rid, xid.data(), xid.size(), _wrfc.owi());
     if (!cont)
     {
         dtokp->set_rid(rid);
         dtokp->set_dequeue_rid(0);
-        dtokp->set_xid(xid_ptr, xid_len);
+        dtokp->set_xid(xid);
         dtokp->set_dblocks_written(0); // Reset dblks_written from previous op
         _abort_busy = true;
     }
@@ -390,7 +610,6 @@ wmgr::abort(data_tok* dtokp, const void* const xid_ptr, const std::size_t xid_le
             dtokp->set_wstate(data_tok::ABORT_SUBM);
 
             // Delete this txn from tmap, unlock any locked records in emap
-            std::string xid((char*)xid_ptr, xid_len);
             txn_data_list tdl = _tmap.get_remove_tdata_list(xid); // tdl will be empty if xid not found
             for (tdl_itr itr = tdl.begin(); itr != tdl.end(); itr++)
             {
@@ -399,13 +618,14 @@ wmgr::abort(data_tok* dtokp, const void* const xid_ptr, const std::size_t xid_le
                 if (itr->_enq_flag)
                     _wrfc.decr_enqcnt(itr->_pfid);
             }
-            std::pair<std::set<std::string>::iterator, bool> res = _txn_pending_set.insert(xid);
+            std::pair<std::set<xid_handle>::iterator, bool> res = _txn_pending_set.insert(xid);
             if (!res.second)
             {
                 std::ostringstream oss;
                 oss << std::hex << "_txn_pending_set: xid=\"" << xid << "\"";
                 throw jexception(jerrno::JERR_MAP_DUPLICATE, oss.str(), "wmgr", "abort");
             }
+            _rec_bytes += _txn_rec.rec_size();
 
             done = true;
         }
@@ -421,10 +641,10 @@ wmgr::abort(data_tok* dtokp, const void* const xid_ptr, const std::size_t xid_le
 }
 
 iores
-wmgr::commit(data_tok* dtokp, const void* const xid_ptr, const std::size_t xid_len)
+wmgr::commit(data_tok* dtokp, const xid_handle& xid)
 {
     // commit and abort MUST have a valid xid
-    assert(xid_ptr != 0 && xid_len > 0);
+    assert(!xid.empty());
 
     if (_enq_busy || _deq_busy || _abort_busy)
         return RHM_IORES_BUSY;
@@ -447,12 +667,12 @@ wmgr::commit(data_tok* dtokp, const void* const xid_ptr, const std::size_t xid_l
     }
 
     u_int64_t rid = (dtokp->external_rid() | cont) ? dtokp->rid() : _wrfc.get_incr_rid();
-    _txn_rec.reset(RHM_JDAT_TXC_MAGIC, rid, xid_ptr, xid_len, _wrfc.owi());
+    _txn_rec.reset(RHM_JDAT_TXC_MAGIC, rid, xid.data(), xid.size(), _wrfc.owi());
     if (!cont)
     {
         dtokp->set_rid(rid);
         dtokp->set_dequeue_rid(0);
-        dtokp->set_xid(xid_ptr, xid_len);
+        dtokp->set_xid(xid);
         dtokp->set_dblocks_written(0); // Reset dblks_written from previous op
         _commit_busy = true;
     }
@@ -480,7 +700,6 @@ wmgr::commit(data_tok* dtokp, const void* const xid_ptr, const std::size_t xid_l
             dtokp->set_wstate(data_tok::COMMIT_SUBM);
 
             // Delete this txn from tmap, process records into emap
-            std::string xid((char*)xid_ptr, xid_len);
             txn_data_list tdl = _tmap.get_remove_tdata_list(xid); // tdl will be empty if xid not found
             for (tdl_itr itr = tdl.begin(); itr != tdl.end(); itr++)
             {
@@ -515,13 +734,14 @@ wmgr::commit(data_tok* dtokp, const void* const xid_ptr, const std::size_t xid_l
                     _wrfc.decr_enqcnt(fid);
                 }
             }
-            std::pair<std::set<std::string>::iterator, bool> res = _txn_pending_set.insert(xid);
+            std::pair<std::set<xid_handle>::iterator, bool> res = _txn_pending_set.insert(xid);
             if (!res.second)
             {
                 std::ostringstream oss;
                 oss << std::hex << "_txn_pending_set: xid=\"" << xid << "\"";
                 throw jexception(jerrno::JERR_MAP_DUPLICATE, oss.str(), "wmgr", "commit");
             }
+            _rec_bytes += _txn_rec.rec_size();
 
             done = true;
         }
@@ -634,22 +854,26 @@ wmgr::write_flush()
             page_cb* pcbp = (page_cb*)(aiocbp->data); // This page control block (pcb)
             pcbp->_wdblks = _cached_offset_dblks;
             pcbp->_wfh = _wrfc.file_controller();
-            if (aio::submit(_ioctx, 1, &aiocbp) < 0)
-                throw jexception(jerrno::JERR__AIO, "wmgr", "write_flush");
+            queue_aio(aiocbp); // Submitted by submit_pending(), normally once the write lock is released
             _wrfc.add_subm_cnt_dblks(_cached_offset_dblks);
             _wrfc.incr_aio_cnt();
             _aio_evt_rem++;
+            _subm_dblks += _cached_offset_dblks;
             _cached_offset_dblks = 0;
+            _pack_ptr = 0; // Page submitted, no further records may be added to its packed dblk
             _jc->instr_incr_outstanding_aio_cnt();
 
            rotate_page(); // increments _pg_index, resets _pg_offset_dblks if req'd
            if (_page_cb_arr[_pg_index]._state == UNUSED)
-               _page_cb_arr[_pg_index]._state = IN_USE;
+               use_page(_pg_index);
         }
     }
-    get_events(UNUSED, 0);
+    // Recycle pages whose writes have already completed, but don't wait for any; if the next page
+    // is still pending, the caller gets RHM_IORES_PAGE_AIOWAIT and waits for it through get_events().
+    timespec poll_ts = {0, 0};
+    reap_events(UNUSED, &poll_ts, false);
     if (_page_cb_arr[_pg_index]._state == UNUSED)
-        _page_cb_arr[_pg_index]._state = IN_USE;
+        use_page(_pg_index);
     return res;
 }
 
@@ -664,6 +888,74 @@ wmgr::rotate_file()
 
 int32_t
 wmgr::get_events(page_state state, timespec* const timeout, bool flush)
+{
+    if (_aio_evt_rem == 0) // no events to get
+        return 0;
+    // Writes still waiting in the submit stage would never complete
+    submit_pending();
+    return reap_events(state, timeout, flush);
+}
+
+void
+wmgr::submit_pending()
+{
+    slock s(_subm_mutex);
+    std::size_t subm_cnt = 0;
+    while (subm_cnt < _subm_list.size())
+    {
+        int ret = aio::submit(_ioctx, _subm_list.size() - subm_cnt, &_subm_list[subm_cnt]);
+        if (ret < 0)
+        {
+            _subm_list.erase(_subm_list.begin(), _subm_list.begin() + subm_cnt);
+            std::ostringstream oss;
+            oss << "io_submit() failed: " << std::strerror(-ret) << " (" << ret << ")";
+            throw jexception(jerrno::JERR__AIO, oss.str(), "wmgr", "submit_pending");
+        }
+        subm_cnt += ret;
+    }
+    _subm_list.clear();
+}
+
+void
+wmgr::dispatch_callbacks()
+{
+    std::vector<data_tok*> dtokl;
+    while (true)
+    {
+        {
+            stlock t(_cb_dispatch_mutex);
+            if (!t.locked())
+                return; // The thread performing callbacks will also perform any queued by this thread
+            while (true)
+            {
+                {
+                    slock s(_cb_mutex);
+                    dtokl.swap(_cb_dtokl);
+                }
+                if (dtokl.empty())
+                    break;
+                if (_cbp)
+                    _cbp->wr_aio_cb(dtokl);
+                dtokl.clear();
+            }
+        }
+        // Completions may have been queued after the last check, but before the dispatch lock was
+        // released (in which case the thread queueing them failed to get the dispatch lock)
+        slock s(_cb_mutex);
+        if (_cb_dtokl.empty())
+            return;
+    }
+}
+
+void
+wmgr::queue_aio(aio_cb* aiocbp)
+{
+    slock s(_subm_mutex);
+    _subm_list.push_back(aiocbp);
+}
+
+int32_t
+wmgr::reap_events(page_state state, timespec* const timeout, bool flush)
 {
     if (_aio_evt_rem == 0) // no events to get
         return 0;
@@ -719,7 +1011,7 @@ wmgr::get_events(page_state state, timespec* const timeout, bool flush)
                 data_tok* dtokp = pcbp->_pdtokl->at(k);
                 if (dtokp->decr_pg_cnt() == 0)
                 {
-                    std::set<std::string>::iterator it;
+                    std::set<xid_handle>::iterator it;
                     switch (dtokp->wstate())
                     {
                     case data_tok::ENQ_SUBM:
@@ -795,10 +1087,15 @@ wmgr::get_events(page_state state, timespec* const timeout, bool flush)
             // Clean up this pcb's data_tok list
             pcbp->_pdtokl->clear();
             pcbp->_state = state;
+            if (state == UNUSED && _res_pages > _min_pages && pcbp->_index != _pg_index)
+                release_page(pcbp->_index);
 
-            // Perform AIO return callback
-            if (_cbp && tot_data_toks)
-                _cbp->wr_aio_cb(dtokl);
+            // Queue AIO return callback, performed by dispatch_callbacks() outside the write lock
+            if (_cbp && !dtokl.empty())
+            {
+                slock s(_cb_mutex);
+                _cb_dtokl.insert(_cb_dtokl.end(), dtokl.begin(), dtokl.end());
+            }
         }
         else // File header writes have no pcb
         {
@@ -816,21 +1113,21 @@ wmgr::get_events(page_state state, timespec* const timeout, bool flush)
 }
 
 bool
-wmgr::is_txn_synced(const std::string& xid)
+wmgr::is_txn_synced(const xid_handle& xid)
 {
     // Ignore xid not found error here
     if (_tmap.is_txn_synced(xid) == txn_map::TMAP_NOT_SYNCED)
         return false;
     // Check for outstanding commit/aborts
-    std::set<std::string>::iterator it = _txn_pending_set.find(xid);
+    std::set<xid_handle>::iterator it = _txn_pending_set.find(xid);
     return it == _txn_pending_set.end();
 }
 
 void
 wmgr::initialize(aio_callback* const cbp, const u_int32_t wcache_pgsize_sblks, const u_int16_t wcache_num_pages)
 {
-    pmgr::initialize(cbp, wcache_pgsize_sblks, wcache_num_pages);
-    wmgr::clean();
+    wmgr::clean(); // Also returns any pages held from a previous initialization
+    pmgr::initialize(cbp, wcache_pgsize_sblks, wcache_num_pages, false);
     _num_jfiles = _jc->num_jfiles();
     if (::posix_memalign(&_fhdr_base_ptr, _sblksize, _sblksize * _num_jfiles))
     {
@@ -850,16 +1147,28 @@ wmgr::initialize(aio_callback* const cbp, const u_int32_t wcache_pgsize_sblks, c
         _fhdr_ptr_arr[i] = (void*)((char*)_fhdr_base_ptr + _sblksize * i);
         _fhdr_aio_cb_arr[i] = new aio_cb;
     }
-    _page_cb_arr[0]._state = IN_USE;
+    use_page(0);
     _ddtokl.clear();
     _cached_offset_dblks = 0;
     _enq_busy = false;
+    _pack_ptr = 0;
+    _pack_offs = 0;
+    _rec_bytes = 0;
+    _subm_dblks = 0;
+    {
+        slock s(_subm_mutex);
+        _subm_list.clear();
+        _subm_list.reserve(_cache_num_pages + _num_jfiles);
+    }
+    {
+        slock s(_cb_mutex);
+        _cb_dtokl.clear();
+    }
 }
 
 iores
 wmgr::pre_write_check(const _op_type op, const data_tok* const dtokp,
-        const std::size_t xidsize, const std::size_t dsize, const bool external
-        ) const
+        const std::size_t xidsize, const std::size_t dsize, const bool external)
 {
     // Check status of current file
     if (!_wrfc.is_wr_reset())
@@ -872,7 +1181,7 @@ wmgr::pre_write_check(const _op_type op, const data_tok* const dtokp,
     if (_page_cb_arr[_pg_index]._state != IN_USE)
     {
         if (_page_cb_arr[_pg_index]._state == UNUSED)
-            _page_cb_arr[_pg_index]._state = IN_USE;
+            use_page(_pg_index);
         else if (_page_cb_arr[_pg_index]._state == AIO_PENDING)
             return RHM_IORES_PAGE_AIOWAIT;
         else
@@ -924,7 +1233,7 @@ wmgr::pre_write_check(const _op_type op, const data_tok* const dtokp,
 }
 
 void
-wmgr::dequeue_check(const std::string& xid, const u_int64_t drid)
+wmgr::dequeue_check(const xid_handle& xid, const u_int64_t drid)
 {
     // First check emap
     bool found = false;
@@ -953,6 +1262,111 @@ wmgr::dequeue_check(const std::string& xid, const u_int64_t drid)
     }
 }
 
+iores
+wmgr::rdeq_encode(const std::vector<data_tok*>& dtokl, const u_int64_t rid, const u_int64_t first_rid,
+        const u_int64_t last_rid)
+{
+    _rdeq_rec.reset(rid, first_rid, last_rid, _wrfc.owi());
+
+    // The record is a single dblk, so it is never split across pages or files
+    assert(_pg_offset_dblks < _cache_pgsize_sblks * JRNL_SBLK_SIZE);
+    void* wptr = (void*)((char*)_page_ptr_arr[_pg_index] + _pg_offset_dblks * JRNL_DBLK_SIZE);
+    u_int32_t ret = _rdeq_rec.encode(wptr, 0, (_cache_pgsize_sblks * JRNL_SBLK_SIZE) - _pg_offset_dblks);
+    _pg_offset_dblks += ret;
+    _cached_offset_dblks += ret;
+    for (std::vector<data_tok*>::const_iterator i = dtokl.begin(); i != dtokl.end(); i++)
+    {
+        (*i)->set_fid(_wrfc.index());
+        (*i)->incr_dblocks_written(ret);
+        (*i)->incr_pg_cnt();
+        _page_cb_arr[_pg_index]._pdtokl->push_back(*i);
+        // TODO: Incorrect - must set state to ENQ_CACHED; ENQ_SUBM is set when AIO returns.
+        (*i)->set_wstate(data_tok::DEQ_SUBM);
+    }
+
+    std::vector<u_int32_t> pfid_cnt;
+    _emap.remove_range(first_rid, last_rid, pfid_cnt);
+    for (u_int16_t pfid = 0; pfid < pfid_cnt.size(); pfid++)
+        if (pfid_cnt[pfid])
+            _wrfc.subtr_enqcnt(pfid, pfid_cnt[pfid]);
+    _rec_bytes += _rdeq_rec.rec_size();
+
+    iores res = RHM_IORES_SUCCESS;
+    bool cont = false;
+    bool done = true;
+    file_header_check(rid, cont, ret);
+    flush_check(res, cont, done);
+    return res;
+}
+
+std::size_t
+wmgr::compress_data(const void* const data_buff, const std::size_t dsize, const bool external)
+{
+    if (_codec == 0 || external || dsize < _cmpr_threshold || dsize <= JRNL_DBLK_SIZE)
+        return 0;
+
+    // Only worthwhile if at least one dblk is saved, so the packed data may be no larger than this
+    const std::size_t max_size = dsize - JRNL_DBLK_SIZE;
+    if (_cmpr_buff_size < max_size)
+    {
+        std::free(_cmpr_buff);
+        _cmpr_buff = std::malloc(max_size);
+        if (_cmpr_buff == 0) // Not fatal; write this record uncompressed
+        {
+            _cmpr_buff_size = 0;
+            return 0;
+        }
+        _cmpr_buff_size = max_size;
+    }
+    return codec::pack(_codec, data_buff, dsize, _cmpr_buff, max_size);
+}
+
+void
+wmgr::set_codec(const codec* const cp, const std::size_t threshold)
+{
+    _codec = cp;
+    _cmpr_threshold = threshold;
+}
+
+bool
+wmgr::packable(const std::size_t rec_size, const std::size_t xid_len) const
+{
+    // Transactional records are never packed, which keeps the txn recovery paths unchanged
+    return _pack_recs && xid_len == 0 && pack_hdr::fits(pack_hdr::size(), rec_size);
+}
+
+bool
+wmgr::pack_open(const std::size_t rec_size) const
+{
+    // The packed dblk may only be appended while it is the last (unflushed) dblk in the current
+    // page; any other record or flush written since closes it.
+    return _pack_ptr && _cached_offset_dblks && _pg_offset_dblks &&
+            _pack_ptr == (char*)_page_ptr_arr[_pg_index] + (_pg_offset_dblks - 1) * JRNL_DBLK_SIZE &&
+            pack_hdr::fits(_pack_offs, rec_size);
+}
+
+u_int32_t
+wmgr::pack_encode(jrec& rec, const u_int64_t rid)
+{
+    // Encode into a scratch dblk, as encode() pads the record out to the end of its dblk
+    char buff[JRNL_DBLK_SIZE];
+    rec.encode(buff, 0, 1);
+    const std::size_t size = rec.rec_size();
+    u_int32_t ret = 0;
+    if (!pack_open(size))
+    {
+        _pack_ptr = (char*)_page_ptr_arr[_pg_index] + _pg_offset_dblks * JRNL_DBLK_SIZE;
+        pack_hdr phdr(RHM_JDAT_PACK_MAGIC, RHM_JDAT_VERSION, rid, _wrfc.owi());
+        std::memcpy(_pack_ptr, &phdr, sizeof(phdr));
+        std::memset((char*)_pack_ptr + sizeof(phdr), 0, JRNL_DBLK_SIZE - sizeof(phdr));
+        _pack_offs = sizeof(phdr);
+        ret = 1;
+    }
+    std::memcpy((char*)_pack_ptr + _pack_offs, buff, size);
+    _pack_offs += pack_hdr::aligned_size(size);
+    return ret;
+}
+
 void
 wmgr::dblk_roundup()
 {
@@ -980,10 +1394,10 @@ wmgr::write_fhdr(u_int64_t rid, u_int16_t fid, u_int16_t lid, std::size_t fro)
 #endif
     aio_cb* aiocbp = _fhdr_aio_cb_arr[fid];
     aio::prep_pwrite(aiocbp, _wrfc.fh(), _fhdr_ptr_arr[fid], _sblksize, 0);
-    if (aio::submit(_ioctx, 1, &aiocbp) < 0)
-        throw jexception(jerrno::JERR__AIO, "wmgr", "write_fhdr");
+    queue_aio(aiocbp);
     _aio_evt_rem++;
     _wrfc.add_subm_cnt_dblks(JRNL_SBLK_SIZE);
+    _subm_dblks += JRNL_SBLK_SIZE;
     _wrfc.incr_aio_cnt();
     _wrfc.file_controller()->set_wr_fhdr_aio_outstanding(true);
 }
@@ -1001,15 +1415,100 @@ wmgr::rotate_page()
         _pg_index = 0;
 }
 
+void
+wmgr::set_min_pages(const u_int16_t min_pages)
+{
+    _min_pages = min_pages ? min_pages : 1; // The current page is always kept
+    if (_page_cb_arr)
+        release_idle_pages();
+}
+
+void
+wmgr::use_page(const u_int16_t pi)
+{
+    if (_page_ptr_arr[pi] == 0)
+    {
+        _page_ptr_arr[pi] = page_pool::get_page(_cache_pgsize_sblks * _sblksize);
+        _page_cb_arr[pi]._pbuff = _page_ptr_arr[pi];
+        _res_pages++;
+    }
+    _page_cb_arr[pi]._state = IN_USE;
+}
+
+void
+wmgr::release_page(const u_int16_t pi)
+{
+    if (_page_ptr_arr[pi])
+    {
+        page_pool::put_page(_page_ptr_arr[pi], _cache_pgsize_sblks * _sblksize);
+        _page_ptr_arr[pi] = 0;
+        _page_cb_arr[pi]._pbuff = 0;
+        _res_pages--;
+    }
+}
+
+void
+wmgr::release_idle_pages()
+{
+    for (u_int16_t i=0; i<_cache_num_pages && _res_pages > _min_pages; i++)
+    {
+        if (_page_cb_arr[i]._state == UNUSED && i != _pg_index)
+            release_page(i);
+    }
+}
+
+std::size_t
+wmgr::mem_bytes() const
+{
+    std::size_t bytes = pmgr::mem_bytes();
+    bytes += std::size_t(_res_pages) * _cache_pgsize_sblks * _sblksize;
+    if (_fhdr_base_ptr)
+        bytes += _num_jfiles * (_sblksize + sizeof(void*) + sizeof(aio_cb*) + sizeof(aio_cb));
+    bytes += _ddtokl.size() * sizeof(data_tok*);
+    bytes += _mdeq_drids.capacity() * sizeof(u_int64_t);
+    bytes += _txn_pending_set.size() * (sizeof(xid_handle) + JRNL_MAP_NODE_OVERHEAD);
+    bytes += _cmpr_buff_size;
+    {
+        slock s(_subm_mutex);
+        bytes += _subm_list.capacity() * sizeof(aio_cb*);
+    }
+    {
+        slock s(_cb_mutex);
+        bytes += _cb_dtokl.capacity() * sizeof(data_tok*);
+    }
+    return bytes;
+}
+
 void
 wmgr::clean()
 {
+    if (_page_cb_arr)
+    {
+        for (u_int16_t i=0; i<_cache_num_pages; i++)
+        {
+            // A page still being written cannot be reused, so it is dropped rather than returned
+            if (_page_cb_arr[i]._state == AIO_PENDING && _page_ptr_arr[i])
+            {
+                page_pool::drop_page(_page_ptr_arr[i], _cache_pgsize_sblks * _sblksize);
+                _page_ptr_arr[i] = 0;
+                _page_cb_arr[i]._pbuff = 0;
+                _res_pages--;
+            }
+            else
+                release_page(i);
+        }
+    }
+
     std::free(_fhdr_base_ptr);
     _fhdr_base_ptr = 0;
 
     std::free(_fhdr_ptr_arr);
     _fhdr_ptr_arr = 0;
 
+    std::free(_cmpr_buff);
+    _cmpr_buff = 0;
+    _cmpr_buff_size = 0;
+
     if (_fhdr_aio_cb_arr)
     {
         for (u_int32_t i=0; i<_num_jfiles; i++)
@@ -1024,7 +1523,7 @@ wmgr::status_str() const
 {
     std::ostringstream oss;
     oss << "wmgr: pi=" << _pg_index << " pc=" << _pg_cntr;
-    oss << " po=" << _pg_offset_dblks << " aer=" << _aio_evt_rem;
+    oss << " po=" << _pg_offset_dblks << " aer=" << _aio_evt_rem << " rp=" << _res_pages;
     oss << " edac:" << (_enq_busy?"T":"F") << (_deq_busy?"T":"F");
     oss << (_abort_busy?"T":"F") << (_commit_busy?"T":"F");
     oss << " ps=[";
@@ -42,10 +42,17 @@ class wmgr;
 }
 
 #include <cstring>
+#include "jrnl/codec.hpp"
 #include "jrnl/enums.hpp"
+#include "jrnl/mdeq_rec.hpp"
+#include "jrnl/page_pool.hpp"
 #include "jrnl/pmgr.hpp"
+#include "jrnl/rdeq_rec.hpp"
+#include "jrnl/smutex.hpp"
 #include "jrnl/wrfc.hpp"
+#include "jrnl/xid_handle.hpp"
 #include <set>
+#include <vector>
 
 namespace mrg
 {
@@ -67,6 +74,24 @@ namespace journal
     * waiting around for excessive time.
     *
     * The usual tradeoff between data storage latency and throughput performance applies.
+    *
+    * Writing is split into three stages so that encoding does not wait on I/O:
+    * <ol>
+    * <li>Encode: the write operations encode records into the current page and prepare the AIO
+    *     write for each page as it is filled. This runs under the journal write lock, but makes no
+    *     system calls and does not wait for earlier writes to complete unless every page is in
+    *     use.</li>
+    * <li>Submit: submit_pending() submits the prepared writes in a single io_submit() call. It is
+    *     protected by its own lock, so jcntl calls it after releasing the write lock.</li>
+    * <li>Complete: get_events() collects completed writes and recycles their pages under the write
+    *     lock, but only queues the completed data tokens; dispatch_callbacks() then performs the
+    *     AIO callbacks, in completion order, without the write lock held.</li>
+    * </ol>
+    *
+    * The number of pages is the most the cache may use. Page memory is taken from the process-wide
+    * page_pool when a page is first written, and is returned to it once the page's write completes,
+    * except that the cache keeps at least min_pages() pages (and always the current page) while
+    * idle.
     */
     class wmgr : public pmgr
     {
@@ -82,6 +107,8 @@ namespace journal
         u_int32_t _jfsize_dblks;        ///< Journal file size in dblks (NOT sblks!)
         u_int32_t _jfsize_pgs;          ///< Journal file size in cache pages
         u_int16_t _num_jfiles;          ///< Number of files used in iocb mallocs
+        u_int16_t _min_pages;           ///< Min. pages kept from page_pool while idle
+        u_int16_t _res_pages;           ///< Pages currently held from page_pool
 
         // TODO: Convert _enq_busy etc into a proper threadsafe lock
         // TODO: Convert to enum? Are these encodes mutually exclusive?
@@ -95,8 +122,29 @@ namespace journal
 
         enq_rec _enq_rec;               ///< Enqueue record used for encoding/decoding
         deq_rec _deq_rec;               ///< Dequeue record used for encoding/decoding
+        mdeq_rec _mdeq_rec;             ///< Multi-rid dequeue record used for encoding/decoding
+        std::vector<u_int64_t> _mdeq_drids; ///< Rids dequeued by multi-rid dequeue in progress
+        rdeq_rec _rdeq_rec;             ///< Range dequeue record used for encoding/decoding
         txn_rec _txn_rec;               ///< Transaction record used for encoding/decoding
-        std::set<std::string> _txn_pending_set; ///< Set containing xids of pending commits/aborts
+        std::set<xid_handle> _txn_pending_set;  ///< Set containing xids of pending commits/aborts
+
+        const codec* _codec;            ///< Codec used to compress enqueue data (0 = none)
+        std::size_t _cmpr_threshold;    ///< Min enqueue data size (bytes) for compression
+        void* _cmpr_buff;               ///< Buffer holding packed data of current enqueue
+        std::size_t _cmpr_buff_size;    ///< Size of _cmpr_buff in bytes
+        std::size_t _cmpr_dsize;        ///< Packed size of current enqueue data (0 = uncompressed)
+
+        bool _pack_recs;                ///< Flag true if small non-txn records are packed into dblks
+        void* _pack_ptr;                ///< Packed dblk open for appending in current page (0 = none)
+        std::size_t _pack_offs;         ///< Byte offset of next free space in _pack_ptr
+        u_int64_t _rec_bytes;           ///< Total size of all records written (bytes)
+        u_int64_t _subm_dblks;          ///< Total dblks submitted to disk, incl. fillers and file hdrs
+
+        smutex _subm_mutex;             ///< Protects _subm_list, held during io_submit()
+        std::vector<aio_cb*> _subm_list; ///< Prepared AIO writes waiting to be submitted
+        smutex _cb_mutex;               ///< Protects _cb_dtokl
+        std::vector<data_tok*> _cb_dtokl; ///< Completed data tokens waiting for their AIO callback
+        smutex _cb_dispatch_mutex;      ///< Held while performing callbacks, keeps completion order
 
     public:
         wmgr(jcntl* jc, enq_map& emap, txn_map& tmap, wrfc& wrfc);
@@ -108,18 +156,33 @@ namespace journal
                 const u_int16_t wcache_num_pages, const u_int32_t max_dtokpp,
                 const u_int32_t max_iowait_us, std::size_t eo = 0);
         iores enqueue(const void* const data_buff, const std::size_t tot_data_len,
-                const std::size_t this_data_len, data_tok* dtokp, const void* const xid_ptr,
-                const std::size_t xid_len, const bool transient, const bool external);
-        iores dequeue(data_tok* dtokp, const void* const xid_ptr, const std::size_t xid_len,
-                const bool txn_coml_commit);
-        iores abort(data_tok* dtokp, const void* const xid_ptr, const std::size_t xid_len);
-        iores commit(data_tok* dtokp, const void* const xid_ptr, const std::size_t xid_len);
+                const std::size_t this_data_len, data_tok* dtokp, const xid_handle& xid,
+                const bool transient, const bool external);
+        iores dequeue(data_tok* dtokp, const xid_handle& xid, const bool txn_coml_commit);
+        iores dequeue(const std::vector<data_tok*>& dtokl);
+        iores dequeue_range(data_tok* dtokp, const u_int64_t first_rid, const u_int64_t last_rid);
+        iores abort(data_tok* dtokp, const xid_handle& xid);
+        iores commit(data_tok* dtokp, const xid_handle& xid);
         iores flush();
         int32_t get_events(page_state state, timespec* const timeout, bool flush = false);
-        bool is_txn_synced(const std::string& xid);
+        void submit_pending();
+        void dispatch_callbacks();
+        bool is_txn_synced(const xid_handle& xid);
         inline bool curr_pg_blocked() const { return _page_cb_arr[_pg_index]._state != UNUSED; }
         inline bool curr_file_blocked() const { return _wrfc.aio_cnt() > 0; }
         inline u_int32_t unflushed_dblks() { return _cached_offset_dblks; }
+        void set_codec(const codec* const cp, const std::size_t threshold);
+        inline const codec* get_codec() const { return _codec; }
+        inline std::size_t compress_threshold() const { return _cmpr_threshold; }
+        inline void set_pack_records(const bool pack_recs) { _pack_recs = pack_recs; }
+        inline bool pack_records() const { return _pack_recs; }
+        inline u_int64_t rec_bytes() const { return _rec_bytes; }
+        inline u_int64_t subm_dblks() const { return _subm_dblks; }
+        void set_min_pages(const u_int16_t min_pages);
+        inline u_int16_t min_pages() const { return _min_pages; }
+        inline u_int16_t res_pages() const { return _res_pages; }
+        // Includes pages held from page_pool, file headers, deferred dequeues and pending lists
+        std::size_t mem_bytes() const;
 
         // Debug aid
         const std::string status_str() const;
@@ -128,16 +191,27 @@ namespace journal
         void initialize(aio_callback* const cbp, const u_int32_t wcache_pgsize_sblks,
                 const u_int16_t wcache_num_pages);
         iores pre_write_check(const _op_type op, const data_tok* const dtokp,
-                const std::size_t xidsize = 0, const std::size_t dsize = 0, const bool external = false)
-                const;
-        void dequeue_check(const std::string& xid, const u_int64_t drid);
+                const std::size_t xidsize = 0, const std::size_t dsize = 0, const bool external = false);
+        void dequeue_check(const xid_handle& xid, const u_int64_t drid);
+        iores rdeq_encode(const std::vector<data_tok*>& dtokl, const u_int64_t rid,
+                const u_int64_t first_rid, const u_int64_t last_rid);
+        std::size_t compress_data(const void* const data_buff, const std::size_t dsize,
+                const bool external);
+        bool packable(const std::size_t rec_size, const std::size_t xid_len) const;
+        bool pack_open(const std::size_t rec_size) const;
+        u_int32_t pack_encode(jrec& rec, const u_int64_t rid);
         void file_header_check(const u_int64_t rid, const bool cont, const u_int32_t rec_dblks_rem);
         void flush_check(iores& res, bool& cont, bool& done);
         iores write_flush();
+        void queue_aio(aio_cb* aiocbp);
+        int32_t reap_events(page_state state, timespec* const timeout, bool flush);
         iores rotate_file();
         void dblk_roundup();
         void write_fhdr(u_int64_t rid, u_int16_t fid, u_int16_t lid, std::size_t fro);
         void rotate_page();
+        void use_page(const u_int16_t pi);
+        void release_page(const u_int16_t pi);
+        void release_idle_pages();
         void clean();
     };
 
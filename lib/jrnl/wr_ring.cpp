@@ -0,0 +1,114 @@
+/**
+ * \file wr_ring.cpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * File containing code for class mrg::journal::wr_ring (journal write
+ * combining ring). See comments in file wr_ring.hpp for details.
+ *
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#include "jrnl/wr_ring.hpp"
+
+#include <cassert>
+#include <sched.h>
+
+namespace mrg
+{
+namespace journal
+{
+
+wr_ring::wr_ring(): _tail(0), _head(0)
+{
+    assert((JRNL_WR_RING_SIZE & (JRNL_WR_RING_SIZE - 1)) == 0 && JRNL_WR_RING_SIZE > 2);
+    for (u_int64_t i = 0; i < JRNL_WR_RING_SIZE; i++)
+        _slots[i]._seq = i;
+}
+
+wr_ring::~wr_ring() {}
+
+u_int64_t
+wr_ring::push(const wr_op& op)
+{
+    while (true)
+    {
+        const u_int64_t pos = _tail;
+        slot& s = _slots[pos & (JRNL_WR_RING_SIZE - 1)];
+        const u_int64_t seq = s._seq;
+        if (seq == pos)
+        {
+            if (__sync_bool_compare_and_swap(&_tail, pos, pos + 1))
+            {
+                s._op = op;
+                __sync_synchronize(); // op must be visible before the slot is marked ready
+                s._seq = pos + 1;
+                return pos;
+            }
+        }
+        else if (seq < pos)
+            ::sched_yield(); // ring full: slot still in use from the previous lap
+        // otherwise another producer reserved pos first; try again at the new tail
+    }
+}
+
+bool
+wr_ring::done(const u_int64_t pos) const
+{
+    if (_slots[pos & (JRNL_WR_RING_SIZE - 1)]._seq != pos + 2)
+        return false;
+    __sync_synchronize(); // result must not be read before the done state
+    return true;
+}
+
+void
+wr_ring::release(const u_int64_t pos, wr_op& op)
+{
+    slot& s = _slots[pos & (JRNL_WR_RING_SIZE - 1)];
+    assert(s._seq == pos + 2);
+    op = s._op;
+    __sync_synchronize();
+    s._seq = pos + JRNL_WR_RING_SIZE;
+}
+
+wr_op*
+wr_ring::front()
+{
+    slot& s = _slots[_head & (JRNL_WR_RING_SIZE - 1)];
+    if (s._seq != _head + 1)
+        return 0;
+    __sync_synchronize(); // op must not be read before the ready state
+    return &s._op;
+}
+
+void
+wr_ring::pop_front()
+{
+    slot& s = _slots[_head & (JRNL_WR_RING_SIZE - 1)];
+    assert(s._seq == _head + 1);
+    __sync_synchronize(); // result must be visible before the slot is marked done
+    s._seq = _head + 2;
+    _head++;
+}
+
+} // namespace journal
+} // namespace mrg
@@ -0,0 +1,160 @@
+/**
+ * \file wr_ring.hpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * File containing code for class mrg::journal::wr_ring (journal write
+ * combining ring) and struct mrg::journal::wr_op (a single queued write
+ * operation). See class documentation for details.
+ *
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#ifndef mrg_journal_wr_ring_hpp
+#define mrg_journal_wr_ring_hpp
+
+namespace mrg
+{
+namespace journal
+{
+class wr_ring;
+}
+}
+
+#include <cstddef>
+#include "jrnl/data_tok.hpp"
+#include "jrnl/jcfg.hpp"
+#include "jrnl/jexception.hpp"
+#include "jrnl/enums.hpp"
+#include "jrnl/xid_handle.hpp"
+#include <sys/types.h>
+
+namespace mrg
+{
+namespace journal
+{
+
+    /**
+    * \brief A single journal write operation (enqueue, dequeue, abort or commit) as passed through
+    *     a wr_ring, together with its result.
+    *
+    * Any pointers (data buffer, xid) refer to memory owned by the thread which submitted the
+    * operation, which waits for the operation to complete before it returns.
+    */
+    struct wr_op
+    {
+        enum op_type { ENQ, DEQ, ABORT, COMMIT };
+
+        op_type _type;                  ///< Operation type
+        const void* _data_buff;         ///< Enqueue only: data buffer
+        std::size_t _tot_data_len;      ///< Enqueue only: total data size
+        std::size_t _this_data_len;     ///< Enqueue only: size of data in this call
+        data_tok* _dtokp;               ///< Data token for this operation
+        const xid_handle* _xidp;        ///< Xid for transactional operations, 0 otherwise
+        bool _transient;                ///< Enqueue only: transient flag
+        bool _external;                 ///< Enqueue only: external flag
+        bool _txn_coml_commit;          ///< Dequeue only: transaction complete on commit flag
+
+        iores _res;                     ///< Result of the operation once complete
+        bool _err;                      ///< True if the operation threw an exception
+        jexception _ex;                 ///< Exception thrown by the operation if _err is set
+
+        inline wr_op(): _type(ENQ), _data_buff(0), _tot_data_len(0), _this_data_len(0), _dtokp(0),
+                _xidp(0), _transient(false), _external(false), _txn_coml_commit(false),
+                _res(RHM_IORES_SUCCESS), _err(false), _ex() {}
+        inline wr_op(const op_type type, data_tok* const dtokp, const xid_handle* const xidp = 0):
+                _type(type), _data_buff(0), _tot_data_len(0), _this_data_len(0), _dtokp(dtokp),
+                _xidp(xidp), _transient(false), _external(false), _txn_coml_commit(false),
+                _res(RHM_IORES_SUCCESS), _err(false), _ex() {}
+        inline void set_err(const jexception& e) { _ex = e; _err = true; }
+    };
+
+    /**
+    * \class wr_ring
+    * \brief Fixed-size multi-producer, single-consumer ring of journal write operations.
+    *
+    * Threads writing to a journal reserve a slot in the ring without taking a lock and place
+    * their operation in it. Whichever thread then holds the journal write lock (the combiner)
+    * executes all ready operations in ring order in a single pass, so that one lock acquisition
+    * serves many writers. Each producer waits until its own operation is marked done, then copies
+    * out the result and releases the slot.
+    *
+    * Each slot carries a sequence number which encodes its state for ring position pos:
+    * <pre>
+    *   seq == pos                   free, may be reserved for pos
+    *   seq == pos + 1               ready, operation waiting to be executed
+    *   seq == pos + 2               done, result waiting to be collected
+    *   seq == pos + JRNL_WR_RING_SIZE   released, free for the next lap
+    * </pre>
+    * Slot reservation uses the GCC atomic builtins; only the combiner (which holds the journal
+    * write lock) moves the head of the ring.
+    */
+    class wr_ring
+    {
+    private:
+        struct slot
+        {
+            volatile u_int64_t _seq;    ///< Slot sequence number, see class documentation
+            wr_op _op;                  ///< Operation in this slot
+        };
+
+        slot _slots[JRNL_WR_RING_SIZE]; ///< Ring slots
+        volatile u_int64_t _tail;       ///< Next position to be reserved by a producer
+        u_int64_t _head;                ///< Next position to be executed by the combiner
+
+    public:
+        wr_ring();
+        virtual ~wr_ring();
+
+        /**
+        * \brief Reserve a slot, copy op into it and mark it ready. Returns the ring position, which
+        *     is used to collect the result. Yields while the ring is full.
+        */
+        u_int64_t push(const wr_op& op);
+
+        /**
+        * \brief Returns true once the operation at ring position pos has been executed.
+        */
+        bool done(const u_int64_t pos) const;
+
+        /**
+        * \brief Copy the completed operation at position pos (including its result) into op and
+        *     release the slot.
+        */
+        void release(const u_int64_t pos, wr_op& op);
+
+        /**
+        * \brief Combiner only: returns the next ready operation, or 0 if the operation at the head
+        *     of the ring is not yet ready (or the ring is empty).
+        */
+        wr_op* front();
+
+        /**
+        * \brief Combiner only: mark the operation returned by front() done and advance the head.
+        */
+        void pop_front();
+    };
+
+} // namespace journal
+} // namespace mrg
+
+#endif // ifndef mrg_journal_wr_ring_hpp
@@ -0,0 +1,136 @@
+/**
+ * \file xid_handle.cpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * File containing code for class mrg::journal::xid_handle (interned
+ * transaction id handle). See comments in file xid_handle.hpp for details.
+ *
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#include "jrnl/xid_handle.hpp"
+
+#include <cstring>
+#include "jrnl/slock.hpp"
+
+namespace mrg
+{
+namespace journal
+{
+
+smutex xid_handle::_mutex[JRNL_XID_LOCK_STRIPES];
+xid_handle::rep* xid_handle::_table[JRNL_XID_TABLE_SIZE];
+volatile std::size_t xid_handle::_cnt = 0;
+const std::string xid_handle::_empty;
+
+xid_handle::xid_handle(const std::string& xid): _rep(xid.empty() ? 0 : intern(xid.data(), xid.size()))
+{}
+
+xid_handle::xid_handle(const void* const xidp, const std::size_t xid_len): _rep(xid_len ? intern(xidp, xid_len) : 0)
+{}
+
+xid_handle&
+xid_handle::operator=(const xid_handle& h)
+{
+    if (h._rep != _rep)
+    {
+        if (h._rep)
+            __sync_add_and_fetch(&h._rep->_ref_cnt, 1);
+        if (_rep)
+            release(_rep);
+        _rep = h._rep;
+    }
+    return *this;
+}
+
+// static
+u_int32_t
+xid_handle::hash(const void* const xidp, const std::size_t xid_len)
+{
+    // FNV-1a
+    u_int32_t h = 2166136261U;
+    const unsigned char* p = (const unsigned char*)xidp;
+    for (std::size_t i = 0; i < xid_len; i++)
+        h = (h ^ p[i]) * 16777619U;
+    return h;
+}
+
+// static
+std::size_t
+xid_handle::interned_cnt()
+{
+    return _cnt;
+}
+
+// static
+xid_handle::rep*
+xid_handle::intern(const void* const xidp, const std::size_t xid_len)
+{
+    const u_int32_t h = hash(xidp, xid_len);
+    rep*& bucket = _table[h & (JRNL_XID_TABLE_SIZE - 1)];
+    slock s(bucket_mutex(h));
+    for (rep* r = bucket; r; r = r->_next)
+    {
+        if (r->_hash == h && r->_xid.size() == xid_len && std::memcmp(r->_xid.data(), xidp, xid_len) == 0)
+        {
+            // A rep in the table always has a non-zero count, as the last reference is only dropped under
+            // the bucket lock (see release())
+            __sync_add_and_fetch(&r->_ref_cnt, 1);
+            return r;
+        }
+    }
+    rep* r = new rep(xidp, xid_len, h);
+    r->_next = bucket;
+    bucket = r;
+    __sync_add_and_fetch(&_cnt, 1);
+    return r;
+}
+
+// static
+void
+xid_handle::release(rep* const r)
+{
+    // Drop references other than the last without locking
+    u_int32_t cnt = r->_ref_cnt;
+    while (cnt > 1)
+    {
+        const u_int32_t prev = __sync_val_compare_and_swap(&r->_ref_cnt, cnt, cnt - 1);
+        if (prev == cnt)
+            return;
+        cnt = prev;
+    }
+    // Possibly the last reference: drop it under the bucket lock so that intern() cannot find the rep as it
+    // is removed
+    slock s(bucket_mutex(r->_hash));
+    if (__sync_sub_and_fetch(&r->_ref_cnt, 1))
+        return;
+    rep** pp = &_table[r->_hash & (JRNL_XID_TABLE_SIZE - 1)];
+    while (*pp != r)
+        pp = &(*pp)->_next;
+    *pp = r->_next;
+    __sync_sub_and_fetch(&_cnt, 1);
+    delete r;
+}
+
+} // namespace journal
+} // namespace mrg
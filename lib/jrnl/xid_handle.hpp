@@ -0,0 +1,123 @@
+/**
+ * \file xid_handle.hpp
+ *
+ * Qpid asynchronous store plugin library
+ *
+ * File containing code for class mrg::journal::xid_handle (interned
+ * transaction id handle). See class documentation for details.
+ *
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#ifndef mrg_journal_xid_handle_hpp
+#define mrg_journal_xid_handle_hpp
+
+#include <cstddef>
+#include <ostream>
+#include "jrnl/jcfg.hpp"
+#include "jrnl/smutex.hpp"
+#include <string>
+#include <sys/types.h>
+
+namespace mrg
+{
+namespace journal
+{
+
+    /**
+    * \class xid_handle
+    * \brief Reference-counted handle to an interned transaction id (xid).
+    *
+    * Every distinct xid in use is held once in a process-wide intern table, together with its
+    * precomputed hash. Handles to the same xid therefore share a single representation: copying a
+    * handle only increments a reference count, and handles are compared by identity rather than by
+    * comparing strings. A transaction's handle is created once (when the transaction context is
+    * created) and then passed through the journal, so that transactional records do not cause
+    * string allocations or compares. The xid is removed from the table when its last handle is
+    * destroyed.
+    *
+    * A handle may be implicitly constructed from a std::string, which interns the string (one
+    * table lookup, and an allocation if the xid is not yet in use), so that callers which only
+    * have a string may still use the journal interface.
+    *
+    * The intern table lock is striped: each bucket is guarded by one of JRNL_XID_LOCK_STRIPES
+    * locks, so that transactions with different xids rarely contend on interning or release.
+    *
+    * operator< orders handles by the hash of the xid, then by the xid itself. The order therefore
+    * depends only on the xids, and is the same from one run (or recovery) to the next.
+    */
+    class xid_handle
+    {
+    private:
+        struct rep
+        {
+            rep* _next;                     ///< Next rep in the same intern table bucket
+            const u_int32_t _hash;          ///< FNV-1a hash of the xid
+            volatile u_int32_t _ref_cnt;    ///< Number of handles to this rep
+            const std::string _xid;         ///< The xid itself
+            rep(const void* const xidp, const std::size_t xid_len, const u_int32_t hash):
+                    _next(0), _hash(hash), _ref_cnt(1), _xid((const char*)xidp, xid_len) {}
+        };
+
+        rep* _rep;                          ///< Interned xid, or 0 for an empty handle
+
+        static smutex _mutex[JRNL_XID_LOCK_STRIPES]; ///< Protect the intern table buckets, striped by hash
+        static rep* _table[JRNL_XID_TABLE_SIZE]; ///< Intern table, chained by hash
+        static volatile std::size_t _cnt;   ///< Number of interned xids
+        static const std::string _empty;
+
+    public:
+        inline xid_handle(): _rep(0) {}
+        xid_handle(const std::string& xid);
+        xid_handle(const void* const xidp, const std::size_t xid_len);
+        inline xid_handle(const xid_handle& h): _rep(h._rep) { if (_rep) __sync_add_and_fetch(&_rep->_ref_cnt, 1); }
+        inline ~xid_handle() { if (_rep) release(_rep); }
+
+        xid_handle& operator=(const xid_handle& h);
+        inline void clear() { if (_rep) { release(_rep); _rep = 0; } }
+
+        inline bool empty() const { return _rep == 0; }
+        inline const std::string& str() const { return _rep ? _rep->_xid : _empty; }
+        inline const char* data() const { return _rep ? _rep->_xid.data() : 0; }
+        inline std::size_t size() const { return _rep ? _rep->_xid.size() : 0; }
+        inline u_int32_t hash() const { return _rep ? _rep->_hash : 0; }
+
+        inline bool operator==(const xid_handle& h) const { return _rep == h._rep; }
+        inline bool operator!=(const xid_handle& h) const { return _rep != h._rep; }
+        inline bool operator<(const xid_handle& h) const
+        { return _rep != h._rep && (hash() != h.hash() ? hash() < h.hash() : str() < h.str()); }
+
+        static u_int32_t hash(const void* const xidp, const std::size_t xid_len);
+        static std::size_t interned_cnt();
+
+    private:
+        static rep* intern(const void* const xidp, const std::size_t xid_len);
+        static void release(rep* const r);
+        static inline smutex& bucket_mutex(const u_int32_t h) { return _mutex[h & (JRNL_XID_LOCK_STRIPES - 1)]; }
+    };
+
+    inline std::ostream& operator<<(std::ostream& os, const xid_handle& h) { return os << h.str(); }
+
+} // namespace journal
+} // namespace mrg
+
+#endif // ifndef mrg_journal_xid_handle_hpp
@@ -32,6 +32,7 @@
 #include "JournalInstance.hpp"
 
 #include <iostream>
+#include <sstream>
 
 namespace mrg
 {
@@ -44,12 +45,17 @@ namespace jtest
 #ifdef JOURNAL2
                                      mrg::journal2::Journal* const jrnlPtr) :
 #else
-                                     mrg::journal::jcntl* const jrnlPtr) :
+                                     mrg::journal::jcntl* const jrnlPtr,
+                                     const uint16_t enqTxnBlkSize) :
 #endif
         _numMsgs(numMsgs),
         _msgSize(msgSize),
         _msgData(msgData),
         _jrnlPtr(jrnlPtr),
+#ifndef JOURNAL2
+        _enqTxnBlkSize(enqTxnBlkSize),
+        _txnCnt(0),
+#endif
         _threadSwitch(false)
     {}
 
@@ -67,13 +73,24 @@ namespace jtest
     {
         bool misfireFlag = false;
         uint32_t i = 0;
+#ifndef JOURNAL2
+        std::string xid; // thread local
+        std::vector<mrg::journal::data_tok*> txnDtokList; // thread local
+#endif
         while (i < _numMsgs) {
 #ifdef JOURNAL2
             mrg::journal2::DataToken* dtokPtr = new mrg::journal2::DataToken();
             mrg::journal2::ioRes jrnlIoRes = _jrnlPtr->enqueue(_msgData, _msgSize, dtokPtr);
 #else
+            if (_enqTxnBlkSize && txnDtokList.empty()) {
+                std::ostringstream oss;
+                oss << "perf-xid-" << _jrnlPtr->id() << "-" << _txnCnt++;
+                xid = oss.str();
+            }
             mrg::journal::data_tok* dtokPtr = new mrg::journal::data_tok();
-            mrg::journal::iores jrnlIoRes = _jrnlPtr->enqueue_data_record(_msgData, _msgSize, _msgSize, dtokPtr);
+            mrg::journal::iores jrnlIoRes = _enqTxnBlkSize ?
+                    _jrnlPtr->enqueue_txn_data_record(_msgData, _msgSize, _msgSize, dtokPtr, xid) :
+                    _jrnlPtr->enqueue_data_record(_msgData, _msgSize, _msgSize, dtokPtr);
 #endif
             switch (jrnlIoRes) {
 #ifdef JOURNAL2
@@ -83,6 +100,14 @@ namespace jtest
 #endif
                     i++;
                     misfireFlag = false;
+#ifndef JOURNAL2
+                    if (_enqTxnBlkSize) {
+                        txnDtokList.push_back(dtokPtr);
+                        if (txnDtokList.size() == _enqTxnBlkSize || i == _numMsgs) {
+                            _commit(xid, txnDtokList);
+                        }
+                    }
+#endif
                     break;
 #ifdef JOURNAL2
                 case mrg::journal2::RHM_IORES_BUSY:
@@ -117,6 +142,46 @@ namespace jtest
         _jrnlPtr->flush(false);
     }
 
+#ifndef JOURNAL2
+    void
+    JournalInstance::_commit(const std::string& xid, std::vector<mrg::journal::data_tok*>& dtokList)
+    {
+        { // --- START OF CRITICAL SECTION ---
+            std::lock_guard<std::mutex> l(_unprocCallbackListMutex);
+            _txnMap[xid]._dtokList.swap(dtokList);
+        } // --- END OF CRITICAL SECTION ---
+        dtokList.clear();
+        mrg::journal::data_tok* dtokPtr = new mrg::journal::data_tok();
+        bool done = false;
+        while (!done) {
+            mrg::journal::iores jrnlIoRes = _jrnlPtr->txn_commit(dtokPtr, xid);
+            switch (jrnlIoRes) {
+                case mrg::journal::RHM_IORES_SUCCESS:
+                    done = true;
+                    break;
+                case mrg::journal::RHM_IORES_BUSY:
+                    _jrnlPtr->get_wr_events(0);
+                    break;
+                default:
+                    std::cerr << "txn_commit FAILED with " << mrg::journal::iores_str(jrnlIoRes) << std::endl;
+                    delete dtokPtr;
+                    done = true;
+            }
+        }
+    }
+
+    void
+    JournalInstance::_releaseTxn(std::map<std::string, TxnState>::iterator itr)
+    {
+        TxnState& ts = itr->second;
+        if (ts._committed && ts._enqDoneCnt == ts._dtokList.size()) {
+            for (std::size_t i = 0; i < ts._dtokList.size(); i++)
+                _unprocCallbackList.push(ts._dtokList[i]);
+            _txnMap.erase(itr);
+        }
+    }
+#endif
+
 
     // *** MUST BE THREAD-SAFE ****
     // This method will be called by multiple threads simultaneously
@@ -237,12 +302,33 @@ namespace jtest
 #else
             switch (dtokPtr->wstate()) {
                 case mrg::journal::data_tok::ENQ:
+                    if (dtokPtr->has_xid()) {
+                        // Transactional enqueues may only be dequeued once the transaction is committed
+                        std::lock_guard<std::mutex> l(_unprocCallbackListMutex);
+                        std::map<std::string, TxnState>::iterator itr =
+                                _txnMap.insert(std::make_pair(dtokPtr->xid().str(), TxnState())).first;
+                        itr->second._enqDoneCnt++;
+                        _releaseTxn(itr);
+                        break;
+                    }
 #endif
                     { // --- START OF CRITICAL SECTION ---
                         std::lock_guard<std::mutex> l(_unprocCallbackListMutex);
                         _unprocCallbackList.push(dtokPtr);
                     } // --- END OF CRITICAL SECTION ---
                 break;
+#ifndef JOURNAL2
+            case mrg::journal::data_tok::COMMITTED:
+                { // --- START OF CRITICAL SECTION ---
+                    std::lock_guard<std::mutex> l(_unprocCallbackListMutex);
+                    std::map<std::string, TxnState>::iterator itr =
+                            _txnMap.insert(std::make_pair(dtokPtr->xid().str(), TxnState())).first;
+                    itr->second._committed = true;
+                    _releaseTxn(itr);
+                } // --- END OF CRITICAL SECTION ---
+                delete dtokPtr;
+                break;
+#endif
             default:
                 delete dtokPtr;
             }
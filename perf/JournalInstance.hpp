@@ -32,9 +32,13 @@
 #ifndef mrg_jtest_JournalInstance_hpp
 #define mrg_jtest_JournalInstance_hpp
 
+#include <atomic>
 #include <cstdint>
+#include <map>
 #include <mutex>
 #include <queue>
+#include <string>
+#include <vector>
 
 #ifdef JOURNAL2
 #include "jrnl2/AioCallback.hpp"
@@ -73,6 +77,21 @@ namespace jtest
 #else
         mrg::journal::jcntl* const _jrnlPtr;    ///< Journal instance pointer
         std::queue<mrg::journal::data_tok*> _unprocCallbackList; ///< Queue of unprocessed callbacks to be dequeued
+
+        /**
+         * \brief Enqueues of one transaction, which may be dequeued only once the commit and every enqueue
+         * has completed.
+         */
+        struct TxnState
+        {
+            std::vector<mrg::journal::data_tok*> _dtokList; ///< Enqueues in this transaction
+            std::size_t _enqDoneCnt;            ///< Number of enqueues whose AIO has completed
+            bool _committed;                    ///< True once the commit AIO has completed
+            TxnState() : _enqDoneCnt(0), _committed(false) {}
+        };
+        const uint16_t _enqTxnBlkSize;          ///< Number of enqueues per transaction, 0 for non-transactional
+        std::atomic<uint32_t> _txnCnt;          ///< Source of unique xids
+        std::map<std::string, TxnState> _txnMap; ///< Open transactions, protected by _unprocCallbackListMutex
 #endif
         std::mutex _unprocCallbackListMutex;    ///< Mutex which protects the unprocessed callback queue
         bool _threadSwitch;                     ///< A switch which alternates worker threads between enq and deq
@@ -91,6 +110,19 @@ namespace jtest
          */
         void _doEnqueues();
 
+#ifndef JOURNAL2
+        /**
+         * \brief Commit transaction xid, which contains the enqueues in dtokList.
+         */
+        void _commit(const std::string& xid, std::vector<mrg::journal::data_tok*>& dtokList);
+
+        /**
+         * \brief Move the enqueues of a transaction to the unprocessed callback list once it is complete. Must be
+         * called with _unprocCallbackListMutex held.
+         */
+        void _releaseTxn(std::map<std::string, TxnState>::iterator itr);
+#endif
+
         /**
          * \brief Worker thread dequeue task
          *
@@ -109,6 +141,7 @@ namespace jtest
          * \param msgSize Size of each message being enqueued
          * \param msgData Pointer to message content (all messages have identical content)
          * \param jrnlPtr Pinter to journal instance which is to be tested
+         * \param enqTxnBlkSize Number of enqueues per transaction (0 = non-transactional enqueues)
          */
 #ifdef JOURNAL2
         JournalInstance(const uint32_t numMsgs,
@@ -119,7 +152,8 @@ namespace jtest
         JournalInstance(const uint32_t numMsgs,
                         const uint32_t msgSize,
                         const char* msgData,
-                        mrg::journal::jcntl* const jrnlPtr);
+                        mrg::journal::jcntl* const jrnlPtr,
+                        const uint16_t enqTxnBlkSize = 0);
 #endif
 
         /**
@@ -168,6 +202,11 @@ namespace jtest
         void readAioCompleteCallback(std::vector<uint16_t>& buffPageCtrlBlkIndexList);
 #else
         void rd_aio_cb(std::vector<uint16_t>& buffPageCtrlBlkIndexList);
+
+        /**
+         * \brief Return the journal under test, used to collect write statistics once the test is complete.
+         */
+        inline const mrg::journal::jcntl* jrnlPtr() const { return _jrnlPtr; }
 #endif
     };
 
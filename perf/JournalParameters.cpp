@@ -45,6 +45,8 @@ namespace jtest
     uint16_t JournalParameters::_s_defaultAutoExpandMaxJrnlFiles = 0;
     uint16_t JournalParameters::_s_defaultWriteBuffNumPgs = 32;
     uint32_t JournalParameters::_s_defaultWriteBuffPgSize_sblks = 128;
+    bool JournalParameters::_s_defaultPackRecords = false;
+    bool JournalParameters::_s_defaultWriteCombining = false;
 
     JournalParameters::JournalParameters() :
         Streamable(),
@@ -55,7 +57,9 @@ namespace jtest
         _autoExpand(_s_defaultAutoExpand),
         _autoExpandMaxJrnlFiles(_s_defaultAutoExpandMaxJrnlFiles),
         _writeBuffNumPgs(_s_defaultWriteBuffNumPgs),
-        _writeBuffPgSize_sblks(_s_defaultWriteBuffPgSize_sblks)
+        _writeBuffPgSize_sblks(_s_defaultWriteBuffPgSize_sblks),
+        _packRecords(_s_defaultPackRecords),
+        _writeCombining(_s_defaultWriteCombining)
     {}
 
     JournalParameters::JournalParameters(const std::string& jrnlDir,
@@ -65,7 +69,9 @@ namespace jtest
                                          const bool autoExpand,
                                          const uint16_t autoExpandMaxJrnlFiles,
                                          const uint16_t writeBuffNumPgs,
-                                         const uint32_t writeBuffPgSize_sblks) :
+                                         const uint32_t writeBuffPgSize_sblks,
+                                         const bool packRecords,
+                                         const bool writeCombining) :
         Streamable(),
         _jrnlDir(jrnlDir),
         _jrnlBaseFileName(jrnlBaseFileName),
@@ -74,7 +80,9 @@ namespace jtest
         _autoExpand(autoExpand),
         _autoExpandMaxJrnlFiles(autoExpandMaxJrnlFiles),
         _writeBuffNumPgs(writeBuffNumPgs),
-        _writeBuffPgSize_sblks(writeBuffPgSize_sblks)
+        _writeBuffPgSize_sblks(writeBuffPgSize_sblks),
+        _packRecords(packRecords),
+        _writeCombining(writeCombining)
     {}
 
     JournalParameters::JournalParameters(const JournalParameters& jp) :
@@ -86,7 +94,9 @@ namespace jtest
         _autoExpand(jp._autoExpand),
         _autoExpandMaxJrnlFiles(jp._autoExpandMaxJrnlFiles),
         _writeBuffNumPgs(jp._writeBuffNumPgs),
-        _writeBuffPgSize_sblks(jp._writeBuffPgSize_sblks)
+        _writeBuffPgSize_sblks(jp._writeBuffPgSize_sblks),
+        _packRecords(jp._packRecords),
+        _writeCombining(jp._writeCombining)
     {}
 
     void
@@ -101,6 +111,8 @@ namespace jtest
         os << "  autoExpandMaxJrnlFiles = " << _autoExpandMaxJrnlFiles << std::endl;
         os << "  writeBuffNumPgs = " << _writeBuffNumPgs << std::endl;
         os << "  writeBuffPgSize_sblks = " << _writeBuffPgSize_sblks << std::endl;
+        os << "  packRecords = " << _packRecords << std::endl;
+        os << "  writeCombining = " << _writeCombining << std::endl;
     }
 
 } // namespace jtest
@@ -57,6 +57,8 @@ namespace jtest
         static uint16_t _s_defaultAutoExpandMaxJrnlFiles;   ///< Default auto-expand file number limit (0 = no limit)
         static uint16_t _s_defaultWriteBuffNumPgs;          ///< Default number of write buffer pages
         static uint32_t _s_defaultWriteBuffPgSize_sblks;    ///< Default size of each write buffer page in softblocks
+        static bool _s_defaultPackRecords;                  ///< Default record packing flag (packs small records into shared dblks)
+        static bool _s_defaultWriteCombining;               ///< Default write combining flag (combines concurrent writes to a journal)
 
         std::string _jrnlDir;                               ///< Journal directory
         std::string _jrnlBaseFileName;                      ///< Journal base file name
@@ -66,6 +68,8 @@ namespace jtest
         uint16_t _autoExpandMaxJrnlFiles;                   ///< Auto-expand file number limit (0 = no limit)
         uint16_t _writeBuffNumPgs;                          ///< Number of write buffer pages
         uint32_t _writeBuffPgSize_sblks;                    ///< Size of each write buffer page in softblocks
+        bool _packRecords;                                  ///< Record packing flag (packs small records into shared dblks)
+        bool _writeCombining;                               ///< Write combining flag (combines concurrent writes to a journal)
 
         /**
          * \brief Default constructor
@@ -87,6 +91,8 @@ namespace jtest
          * \param autoExpandMaxJrnlFiles Default auto-expand file number limit (0 = no limit)
          * \param writeBuffNumPgs Number of write buffer pages
          * \param writeBuffPgSize_sblks Size of each write buffer page in softblocks
+         * \param packRecords Record packing flag (packs small records into shared dblks)
+         * \param writeCombining Write combining flag (combines concurrent writes to a journal)
          */
         JournalParameters(const std::string& jrnlDir,
                           const std::string& jrnlBaseFileName,
@@ -95,7 +101,9 @@ namespace jtest
                           const bool autoExpand,
                           const uint16_t autoExpandMaxJrnlFiles,
                           const uint16_t writeBuffNumPgs,
-                          const uint32_t writeBuffPgSize_sblks);
+                          const uint32_t writeBuffPgSize_sblks,
+                          const bool packRecords = _s_defaultPackRecords,
+                          const bool writeCombining = _s_defaultWriteCombining);
 
         /**
          * \brief Copy constructor
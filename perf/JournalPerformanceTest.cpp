@@ -100,13 +100,20 @@ namespace jtest
 #else
             jp = new mrg::journal::jcntl(jname.str(), jdir.str(), _jrnlParams._jrnlBaseFileName);
 #endif
+#ifdef JOURNAL2
             ptp = new JournalInstance(_testParams._numMsgs, _testParams._msgSize, msgData, jp);
+#else
+            ptp = new JournalInstance(_testParams._numMsgs, _testParams._msgSize, msgData, jp,
+                                      _testParams._enqTxnBlockSize);
+#endif
 #ifdef JOURNAL2
             jp->initialize(&_jrnlParams, ptp);
 #else
             jp->initialize(_jrnlParams._numJrnlFiles, _jrnlParams._autoExpand, _jrnlParams._autoExpandMaxJrnlFiles,
                         _jrnlParams._jrnlFileSize_sblks, _jrnlParams._writeBuffNumPgs,
                         _jrnlParams._writeBuffPgSize_sblks, ptp);
+            jp->set_pack_records(_jrnlParams._packRecords);
+            jp->set_write_combining(_jrnlParams._writeCombining);
 #endif
 
             _jrnlList.push_back(ptp);
@@ -137,6 +144,12 @@ namespace jtest
                 threads.pop_front();
             }
         } // --- End of timed section ---
+#ifndef JOURNAL2
+        for (uint16_t q = 0; q < _testParams._numQueues; q++) {
+            const mrg::journal::jcntl* jp = _jrnlList[q]->jrnlPtr();
+            _jrnlPerf.addWriteStats(jp->get_wr_rec_bytes(), jp->get_wr_subm_dblks() * JRNL_DBLK_SIZE);
+        }
+#endif
     }
 
     void
@@ -201,6 +214,10 @@ namespace jtest
            << JournalParameters::_s_defaultWriteBuffNumPgs << "]" << std::endl;
         os << " -c --wcache_pgsize_sblks:        Size of each write buffer page in sblks (512 byte blocks) ["
            << JournalParameters::_s_defaultWriteBuffPgSize_sblks << "]" << std::endl;
+        os << " -k --pack_records:               Pack small records into shared data blocks ["
+           << (JournalParameters::_s_defaultPackRecords?"T":"F") << "]" << std::endl;
+        os << " -w --write_combining:            Combine concurrent writes to each journal ["
+           << (JournalParameters::_s_defaultWriteCombining?"T":"F") << "]" << std::endl;
 #endif
 }
 
@@ -219,6 +236,9 @@ namespace jtest
             {"msg_size", required_argument, 0, 'S'},
             {"num_queues", required_argument, 0, 'q'},
             {"num_threads_per_queue", required_argument, 0, 't'},
+#ifndef JOURNAL2
+            {"enq_txn_blk_size", required_argument, 0, 'E'},
+#endif
 
             // Journal params
             {"jrnl_dir", required_argument, 0, 'd'},
@@ -229,6 +249,10 @@ namespace jtest
             {"ae_max_jfiles", required_argument, 0, 'e'},
             {"wcache_num_pages", required_argument, 0, 'p'},
             {"wcache_pgsize_sblks", required_argument, 0, 'c'},
+#ifndef JOURNAL2
+            {"pack_records", no_argument, 0, 'k'},
+            {"write_combining", no_argument, 0, 'w'},
+#endif
 
             {0, 0, 0, 0}
         };
@@ -237,7 +261,7 @@ namespace jtest
         int c = 0;
         while (true) {
             int option_index = 0;
-            c = getopt_long(argc, argv, "ab:c:d:e:f:hm:p:q:s:S:t:", long_options, &option_index);
+            c = getopt_long(argc, argv, "ab:c:d:e:E:f:hkm:p:q:s:S:t:w", long_options, &option_index);
             if (c == -1) break;
             switch (c) {
                 // Test params
@@ -253,6 +277,11 @@ namespace jtest
                 case 't':
                     tp._numThreadPairsPerQueue = uint16_t(std::atoi(optarg));
                     break;
+#ifndef JOURNAL2
+                case 'E':
+                    tp._enqTxnBlockSize = uint16_t(std::atoi(optarg));
+                    break;
+#endif
 
                 // Store params
                 case 'd':
@@ -279,6 +308,14 @@ namespace jtest
                 case 'c':
                     sp._writeBuffPgSize_sblks = uint32_t(std::atol(optarg));
                     break;
+#ifndef JOURNAL2
+                case 'k':
+                    sp._packRecords = true;
+                    break;
+                case 'w':
+                    sp._writeCombining = true;
+                    break;
+#endif
 
                 // Other
                 case 'h':
@@ -41,9 +41,18 @@ namespace jtest
     PerformanceResult::PerformanceResult(const TestParameters& tp) :
         ScopedTimable(),
         Streamable(),
-        _testParams(tp)
+        _testParams(tp),
+        _recBytes(0),
+        _diskBytes(0)
     {}
 
+    void
+    PerformanceResult::addWriteStats(const uint64_t recBytes, const uint64_t diskBytes)
+    {
+        _recBytes += recBytes;
+        _diskBytes += diskBytes;
+    }
+
     void
     PerformanceResult::toStream(std::ostream& os) const
     {
@@ -58,6 +67,14 @@ namespace jtest
         double msgsRate = double(totalMsgs) / _elapsed;
         os << "     Msg throughput: " << (msgsRate / 1e3) << " kMsgs/sec" << std::endl;
         os << "                     " << (msgsRate * _testParams._msgSize / 1e6) << " MB/sec" << std::endl;
+        if (_diskBytes) {
+            uint64_t msgBytes = uint64_t(totalMsgs) * _testParams._msgSize;
+            os << "  Msg bytes written: " << msgBytes << std::endl;
+            os << "  Rec bytes written: " << _recBytes << std::endl;
+            os << " Disk bytes written: " << _diskBytes << std::endl;
+            os << "Write amplification: " << (double(_diskBytes) / msgBytes) << " (disk/msg bytes)" << std::endl;
+            os << "                     " << (double(_diskBytes) / _recBytes) << " (disk/rec bytes)" << std::endl;
+        }
     }
 
 } // namespace jtest
@@ -32,6 +32,7 @@
 #ifndef mrg_jtest_PerformanceResult_hpp
 #define mrg_jtest_PerformanceResult_hpp
 
+#include <cstdint>
 #include <iostream>
 
 #include "TestParameters.hpp"
@@ -64,11 +65,21 @@ namespace jtest
      *      Total no. msgs: 40000
      *      Msg throughput: 24.0587 kMsgs/sec
      *                      49.2723 MB/sec
+     *   Msg bytes written: 81920000
+     *   Rec bytes written: 84480000
+     *  Disk bytes written: 87040000
+     * Write amplification: 1.0625 (disk/msg bytes)
+     *                      1.0303 (disk/rec bytes)
      * </pre>
+     * The write statistics are only printed once they have been set with addWriteStats(). Msg bytes counts message
+     * content only, rec bytes counts every encoded journal record (headers, xids and tails included, but excluding
+     * dblk alignment padding) and disk bytes counts all bytes submitted for writing to the journal files.
      */
     class PerformanceResult : public ScopedTimable, public Streamable
     {
         TestParameters _testParams; ///< Test parameters used for performance calculations
+        uint64_t _recBytes;         ///< Number of encoded record bytes written to the journals
+        uint64_t _diskBytes;        ///< Number of bytes submitted for writing to the journal files
 
     public:
         /**
@@ -85,6 +96,14 @@ namespace jtest
          */
         virtual ~PerformanceResult() {}
 
+        /**
+         * \brief Add the write statistics of one journal to the results
+         *
+         * \param recBytes Number of encoded record bytes written to the journal
+         * \param diskBytes Number of bytes submitted for writing to the journal files
+         */
+        void addWriteStats(const uint64_t recBytes, const uint64_t diskBytes);
+
         /**
          * \brief Stream the performance test results to an output stream
          *
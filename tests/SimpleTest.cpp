@@ -25,6 +25,10 @@
 
 #include "MessageStoreImpl.h"
 #include <iostream>
+#include "jrnl/jdir.hpp"
+#include <pthread.h>
+#include <set>
+#include <unistd.h>
 #include "MessageUtils.h"
 #include "StoreException.h"
 #include <qpid/broker/Queue.h>
@@ -261,6 +265,78 @@ QPID_AUTO_TEST_CASE(QueueDestroy)
     cout << "ok" << endl;
 }
 
+QPID_AUTO_TEST_CASE(QueueDestroyAsync)
+{
+    cout << test_filename << ".QueueDestroyAsync: " << flush;
+
+    string name("MyDurableQueue");
+    MessageStoreImpl::StoreOptions opts;
+    opts.storeDir = test_dir;
+    opts.numJrnlFiles = 4;
+    opts.jrnlFsizePgs = 1;
+    opts.asyncQueueDestroy = true;
+    {
+        MessageStoreImpl store(timer);
+        opts.truncateFlag = true; // truncate store
+        store.init(&opts);
+        Queue queue(name, 0, &store, 0);
+        store.create(queue, qpid::framing::FieldTable());
+        std::string jrnlDir(static_cast<JournalImpl*>(queue.getExternalQueueStore())->dirname());
+        BOOST_REQUIRE(::access(jrnlDir.c_str(), F_OK) == 0);
+        store.destroy(queue);
+        // Journal dir is renamed before destroy() returns; deletion of the files is left to the reaper
+        BOOST_CHECK(::access(jrnlDir.c_str(), F_OK) != 0);
+
+        // A queue of the same name may be re-created straight away
+        Queue queue2(name, 0, &store, 0);
+        store.create(queue2, qpid::framing::FieldTable());
+        store.destroy(queue2);
+    }//db will be closed
+    {
+        MessageStoreImpl store(timer);
+        opts.truncateFlag = false;
+        store.init(&opts);
+        QueueRegistry registry;
+        registry.setStore (&store);
+        recover(store, registry);
+        BOOST_REQUIRE(!registry.find(name));
+    }
+
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(OrphanJrnlDirReaped)
+{
+    cout << test_filename << ".OrphanJrnlDirReaped: " << flush;
+
+    string name("MyDurableQueue");
+    std::string jrnlDir;
+    std::string orphanDir;
+    {
+        MessageStoreImpl store(timer);
+        store.init(test_dir, 4, 1, true); // truncate store
+        Queue queue(name, 0, &store, 0);
+        store.create(queue, qpid::framing::FieldTable());
+        jrnlDir = static_cast<JournalImpl*>(queue.getExternalQueueStore())->dirname();
+        // As left by a crash after a queue was deleted from the BDB, but before its journal dir was moved
+        orphanDir = store.getStoreDir() + "/rhm/jrnl/0000/MyDeletedQueue";
+        mrg::journal::jdir::create_dir(orphanDir);
+    }//db will be closed
+    {
+        MessageStoreImpl store(timer);
+        store.init(test_dir, 4, 1);
+        QueueRegistry registry;
+        registry.setStore (&store);
+        recover(store, registry);
+        BOOST_REQUIRE(registry.find(name));
+        // The orphan is moved away during recovery; the journal of the recovered queue is left alone
+        BOOST_CHECK(::access(orphanDir.c_str(), F_OK) != 0);
+        BOOST_CHECK(::access(jrnlDir.c_str(), F_OK) == 0);
+    }
+
+    cout << "ok" << endl;
+}
+
 QPID_AUTO_TEST_CASE(Enqueue)
 {
     cout << test_filename << ".Enqueue: " << flush;
@@ -360,6 +436,197 @@ QPID_AUTO_TEST_CASE(Dequeue)
     cout << "ok" << endl;
 }
 
+QPID_AUTO_TEST_CASE(MmapLoadThenWrap)
+{
+    cout << test_filename << ".MmapLoadThenWrap: " << flush;
+
+    string name("MyDurableQueue");
+    string exchange("MyExchange");
+    string routingKey("MyRoutingKey");
+    string data("abcdefg");
+    MessageStoreImpl::StoreOptions opts;
+    opts.storeDir = test_dir;
+    opts.numJrnlFiles = 4;
+    opts.jrnlFsizePgs = 1;
+    opts.truncateFlag = true; // truncate store
+    opts.mmapReads = true;
+    opts.contentCacheSizeKib = 0;
+    MessageStoreImpl store(timer);
+    store.init(&opts);
+    Queue::shared_ptr queue(new Queue(name, 0, &store, 0));
+    FieldTable settings;
+    queue->create(settings);
+
+    boost::intrusive_ptr<Message> msg = MessageUtils::createMessage(exchange, routingKey, Uuid(true), true, 7);
+    MessageUtils::addContent(msg, data);
+    queue->enqueue(0, msg);
+    store.flush(*queue);
+    string loaded;
+    store.loadContent(*queue, msg, loaded, 0, data.size());
+    BOOST_CHECK_EQUAL(data, loaded);
+    QueuedMessage qm;
+    qm.payload = msg;
+    queue->dequeue(0, qm);
+
+    // The load must not leave the file holding the msg pinned, or the journal cannot wrap back onto it
+    string bigData(1024, 'x');
+    for (int i = 0; i < 1000; i++) {
+        boost::intrusive_ptr<Message> m = MessageUtils::createMessage(exchange, routingKey, Uuid(true), true, bigData.size());
+        MessageUtils::addContent(m, bigData);
+        queue->enqueue(0, m);
+        QueuedMessage q;
+        q.payload = m;
+        queue->dequeue(0, q);
+    }
+
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(ContentCache)
+{
+    cout << test_filename << ".ContentCache: " << flush;
+
+    string name("MyDurableQueue");
+    string exchange("MyExchange");
+    string routingKey("MyRoutingKey");
+    MessageStoreImpl::StoreOptions opts;
+    opts.storeDir = test_dir;
+    opts.numJrnlFiles = 4;
+    opts.jrnlFsizePgs = 1;
+    opts.truncateFlag = true; // truncate store
+    opts.contentCacheSizeKib = 1; // Room for the content of two of the msgs below, but not three
+    MessageStoreImpl store(timer);
+    store.init(&opts);
+    Queue::shared_ptr queue(new Queue(name, 0, &store, 0));
+    FieldTable settings;
+    queue->create(settings);
+    JournalImpl* jc = static_cast<JournalImpl*>(queue->getExternalQueueStore());
+
+    const size_t size = 400;
+    const size_t chunk = size / 2;
+    string data[3];
+    boost::intrusive_ptr<Message> msg[3];
+    for (int i = 0; i < 3; i++) {
+        data[i].assign(size, 'a' + i);
+        msg[i] = MessageUtils::createMessage(exchange, routingKey, Uuid(true), true, size);
+        MessageUtils::addContent(msg[i], data[i]);
+        queue->enqueue(0, msg[i]);
+    }
+    store.flush(*queue);
+
+    // Load two msgs chunk by chunk, interleaved: only the first chunk of each is read from the journal
+    const int loads[4][2] = {{0, 0}, {1, 0}, {0, 1}, {1, 1}}; // {msg, chunk}
+    for (int l = 0; l < 4; l++) {
+        string loaded;
+        store.loadContent(*queue, msg[loads[l][0]], loaded, loads[l][1] * chunk, chunk);
+        BOOST_CHECK_EQUAL(data[loads[l][0]].substr(loads[l][1] * chunk, chunk), loaded);
+    }
+    BOOST_CHECK_EQUAL(jc->get_content_cache_misses(), u_int64_t(2));
+    BOOST_CHECK_EQUAL(jc->get_content_cache_hits(), u_int64_t(2));
+    BOOST_CHECK_EQUAL(jc->get_content_cache_bytes(), 2 * size);
+
+    // A third msg evicts the least recently used one (msg 0), but not msg 1
+    string loaded;
+    store.loadContent(*queue, msg[2], loaded, 0, chunk);
+    BOOST_CHECK_EQUAL(data[2].substr(0, chunk), loaded);
+    BOOST_CHECK_EQUAL(jc->get_content_cache_bytes(), 2 * size);
+    loaded.clear();
+    store.loadContent(*queue, msg[1], loaded, 0, chunk);
+    BOOST_CHECK_EQUAL(jc->get_content_cache_hits(), u_int64_t(3));
+    loaded.clear();
+    store.loadContent(*queue, msg[0], loaded, chunk, chunk);
+    BOOST_CHECK_EQUAL(data[0].substr(chunk, chunk), loaded);
+    BOOST_CHECK_EQUAL(jc->get_content_cache_misses(), u_int64_t(4));
+    BOOST_CHECK_EQUAL(jc->get_content_cache_hits(), u_int64_t(3));
+
+    // A dequeued msg is dropped from the cache (msgs 0 and 1 are cached now, msg 2 was evicted by msg 0)
+    QueuedMessage qm;
+    qm.payload = msg[1];
+    queue->dequeue(0, qm);
+    BOOST_CHECK_EQUAL(jc->get_content_cache_bytes(), size);
+    qm.payload = msg[2];
+    queue->dequeue(0, qm);
+    BOOST_CHECK_EQUAL(jc->get_content_cache_bytes(), size);
+    qm.payload = msg[0];
+    queue->dequeue(0, qm);
+    BOOST_CHECK_EQUAL(jc->get_content_cache_bytes(), size_t(0));
+
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(SharedJournal)
+{
+    cout << test_filename << ".SharedJournal: " << flush;
+
+    string name1("MySharedQueue1");
+    string name2("MySharedQueue2");
+    string name3("MySharedQueue3");
+    string exchange("MyExchange");
+    string routingKey("MyRoutingKey");
+    string data1("abcdefg");
+    string data2("hijklmn");
+    MessageStoreImpl::StoreOptions opts;
+    opts.storeDir = test_dir;
+    opts.numJrnlFiles = 4;
+    opts.jrnlFsizePgs = 1;
+    opts.sharedJournals = 2;
+    {
+        MessageStoreImpl store(timer);
+        opts.truncateFlag = true; // truncate store
+        store.init(&opts);
+        Queue::shared_ptr queue1(new Queue(name1, 0, &store, 0));
+        Queue::shared_ptr queue2(new Queue(name2, 0, &store, 0));
+        Queue::shared_ptr queue3(new Queue(name3, 0, &store, 0));
+        FieldTable settings;
+        queue1->create(settings);
+        queue2->create(settings);
+        queue3->create(settings);
+        BOOST_REQUIRE(dynamic_cast<SharedQueueStore*>(queue1->getExternalQueueStore()));
+
+        // msg1 is on all three queues, msg2 on queue2 only
+        boost::intrusive_ptr<Message> msg1 = MessageUtils::createMessage(exchange, routingKey, Uuid(true), true, 7);
+        MessageUtils::addContent(msg1, data1);
+        boost::intrusive_ptr<Message> msg2 = MessageUtils::createMessage(exchange, routingKey, Uuid(true), true, 7);
+        MessageUtils::addContent(msg2, data2);
+        queue1->enqueue(0, msg1);
+        queue2->enqueue(0, msg1);
+        queue3->enqueue(0, msg1);
+        queue2->enqueue(0, msg2);
+
+        QueuedMessage qm;
+        qm.payload = msg1;
+        queue1->dequeue(0, qm);
+
+        // The records of a destroyed queue are dequeued from the shared journal
+        store.destroy(*queue3);
+    }//db will be closed
+    {
+        MessageStoreImpl store(timer);
+        opts.truncateFlag = false;
+        store.init(&opts);
+        QueueRegistry registry;
+        registry.setStore (&store);
+        recover(store, registry);
+        Queue::shared_ptr queue1 = registry.find(name1);
+        Queue::shared_ptr queue2 = registry.find(name2);
+        BOOST_REQUIRE(queue1);
+        BOOST_REQUIRE(queue2);
+        BOOST_REQUIRE(!registry.find(name3));
+        BOOST_CHECK_EQUAL((u_int32_t) 0, queue1->getMessageCount());
+        BOOST_CHECK_EQUAL((u_int32_t) 2, queue2->getMessageCount());
+        BOOST_CHECK_EQUAL((u_int64_t) 7, queue2->get().payload->contentSize());
+
+        // A queue may keep its own journal
+        Queue::shared_ptr queue4(new Queue("MyUnsharedQueue", 0, &store, 0));
+        FieldTable settings;
+        settings.setInt("qpid.shared_journal", 0);
+        queue4->create(settings);
+        BOOST_CHECK(!dynamic_cast<SharedQueueStore*>(queue4->getExternalQueueStore()));
+    }
+
+    cout << "ok" << endl;
+}
+
 QPID_AUTO_TEST_CASE(ExchangeCreateAndDestroy)
 {
     cout << test_filename << ".ExchangeCreateAndDestroy: " << flush;
@@ -494,4 +761,55 @@ QPID_AUTO_TEST_CASE(ExchangeImplicitUnbind)
     cout << "ok" << endl;
 }
 
+struct IdBlock
+{
+    IdSequence* seq;
+    std::vector<uint64_t> ids;
+};
+
+void* allocIds(void* arg)
+{
+    IdBlock* b = static_cast<IdBlock*>(arg);
+    for (std::size_t i = 0; i < b->ids.size(); i++)
+        b->ids[i] = b->seq->next();
+    return 0;
+}
+
+QPID_AUTO_TEST_CASE(IdSequenceLease)
+{
+    cout << test_filename << ".IdSequenceLease: " << flush;
+
+    const std::size_t numThreads = 4;
+    const std::size_t numIds = 1000;
+    for (uint32_t leaseSize = 0; leaseSize <= 64; leaseSize += 64) {
+        IdSequence seq;
+        seq.setLeaseSize(leaseSize);
+        pthread_t threads[numThreads];
+        IdBlock blocks[numThreads];
+        for (std::size_t t = 0; t < numThreads; t++) {
+            blocks[t].seq = &seq;
+            blocks[t].ids.resize(numIds);
+            BOOST_REQUIRE_EQUAL(::pthread_create(&threads[t], 0, allocIds, &blocks[t]), 0);
+        }
+        std::set<uint64_t> all;
+        for (std::size_t t = 0; t < numThreads; t++) {
+            ::pthread_join(threads[t], 0);
+            for (std::size_t i = 0; i < numIds; i++) {
+                BOOST_CHECK(blocks[t].ids[i] != 0);
+                if (i) BOOST_CHECK(blocks[t].ids[i] > blocks[t].ids[i - 1]); // increasing per thread
+                all.insert(blocks[t].ids[i]);
+            }
+        }
+        BOOST_CHECK_EQUAL(all.size(), numThreads * numIds); // unique
+
+        // After a reset (recovery), no id below the reset value is handed out, including from leases
+        // taken before the reset, and 0 is skipped when folding around
+        seq.reset(0xffffffffffffffffULL);
+        BOOST_CHECK_EQUAL(seq.next(), 0xffffffffffffffffULL);
+        BOOST_CHECK_EQUAL(seq.next(), 1ULL);
+    }
+
+    cout << "ok" << endl;
+}
+
 QPID_AUTO_TEST_SUITE_END()
@@ -25,6 +25,8 @@
 
 #include "MessageStoreImpl.h"
 #include <iostream>
+#include <pthread.h>
+#include <sstream>
 #include "MessageUtils.h"
 #include "StoreException.h"
 #include "qpid/broker/Queue.h"
@@ -97,6 +99,11 @@ class TestMessageStore: public MessageStoreImpl
         }
         completed(*dynamic_cast<TxnCtxt*>(txn), false);
     }
+    bool isPreparedListInitialized() {
+        for (std::vector<tpl_ptr>::iterator i = tplStores.begin(); i != tplStores.end(); i++)
+            if ((*i)->is_ready()) return true;
+        return false;
+    }
 };
 
 // === Helper fns ===
@@ -240,6 +247,138 @@ void testMultiQueueTxn(const unsigned num_queues_rem, const bool complete_prepar
     checkMsg(queueB, 0);
 }
 
+void testSingleQueueTxn(const bool commit)
+{
+    setup<TestMessageStore>();
+    TestMessageStore* tmsp = static_cast<TestMessageStore*>(store.get());
+    std::auto_ptr<TransactionContext> txn(store->begin());
+
+    boost::intrusive_ptr<Message> msgA = createMessage("MessageA", "exchange", "routing_key");
+    queueA->enqueue(txn.get(), msgA);
+    boost::intrusive_ptr<Message> msgB = createMessage("MessageB", "exchange", "routing_key");
+    queueA->enqueue(txn.get(), msgB);
+    if (commit)
+        store->commit(*txn);
+    else
+        store->abort(*txn);
+    // A local txn on a single queue completes without using the TPL
+    BOOST_CHECK(!tmsp->isPreparedListInitialized());
+    restart<MessageStoreImpl>();
+
+    if (commit)
+    {
+        checkMsg(queueA, 2, "MessageA");
+        checkMsg(queueA, 1, "MessageB");
+    }
+    checkMsg(queueA, 0);
+    checkMsg(queueB, 0);
+}
+
+void testMultiQueueSync()
+{
+    setup<TestMessageStore>();
+    TestMessageStore* tmsp = static_cast<TestMessageStore*>(store.get());
+    std::auto_ptr<TransactionContext> txn1(tmsp->begin());
+    std::auto_ptr<TransactionContext> txn2(tmsp->begin());
+
+    // Interleave the records of two txns on both queues
+    boost::intrusive_ptr<Message> msgA = createMessage("MessageA", "exchange", "routing_key");
+    boost::intrusive_ptr<Message> msgB = createMessage("MessageB", "exchange", "routing_key");
+    queueA->enqueue(txn1.get(), msgA);
+    queueA->enqueue(txn2.get(), msgB);
+    queueB->enqueue(txn2.get(), msgB);
+    queueB->enqueue(txn1.get(), msgA);
+
+    // Once sync() returns, each txn's records must be on disk on every journal it touched
+    JournalImpl* jcA = static_cast<JournalImpl*>(queueA->getExternalQueueStore());
+    JournalImpl* jcB = static_cast<JournalImpl*>(queueB->getExternalQueueStore());
+    TxnCtxt* tc1 = static_cast<TxnCtxt*>(txn1.get());
+    TxnCtxt* tc2 = static_cast<TxnCtxt*>(txn2.get());
+    tc1->sync();
+    BOOST_CHECK(jcA->is_txn_synced(tc1->getXidHandle()));
+    BOOST_CHECK(jcB->is_txn_synced(tc1->getXidHandle()));
+    tc2->sync();
+    BOOST_CHECK(jcA->is_txn_synced(tc2->getXidHandle()));
+    BOOST_CHECK(jcB->is_txn_synced(tc2->getXidHandle()));
+
+    tmsp->commit(*txn1, true);
+    tmsp->commit(*txn2, true);
+    restart<TestMessageStore>();
+
+    checkMsg(queueA, 2, "MessageA");
+    checkMsg(queueA, 1, "MessageB");
+    checkMsg(queueB, 2, "MessageB");
+    checkMsg(queueB, 1, "MessageA");
+    checkMsg(queueA, 0);
+    checkMsg(queueB, 0);
+}
+
+struct TxnClientArgs
+{
+    Queue::shared_ptr queue;
+    unsigned numTxns;
+    unsigned msgsPerTxn;
+    bool failed;
+};
+
+// Commits txns which each enqueue several msgs on the client's own queue. The store is used directly, as the
+// broker queue is not shared between threads.
+void* txnClient(void* arg)
+{
+    TxnClientArgs* a = static_cast<TxnClientArgs*>(arg);
+    try {
+        for (unsigned i = 0; i < a->numTxns; i++) {
+            std::auto_ptr<TransactionContext> txn(store->begin());
+            for (unsigned m = 0; m < a->msgsPerTxn; m++) {
+                boost::intrusive_ptr<PersistableMessage> msg(createMessage("Message"));
+                store->enqueue(txn.get(), msg, *a->queue);
+            }
+            store->commit(*txn);
+        }
+    } catch (const std::exception& e) {
+        cerr << "txnClient: queue " << a->queue->getName() << ": " << e.what() << endl;
+        a->failed = true;
+    }
+    return 0;
+}
+
+void testConcurrentCommit()
+{
+    const unsigned numClients = 8;
+    const unsigned numTxns = 25;
+    const unsigned msgsPerTxn = 4;
+    setup<MessageStoreImpl>();
+    FieldTable settings;
+    pthread_t threads[numClients];
+    TxnClientArgs args[numClients];
+    for (unsigned c = 0; c < numClients; c++) {
+        std::ostringstream name;
+        name << "queueC" << c;
+        args[c].queue = Queue::shared_ptr(new Queue(name.str(), 0, store.get(), 0));
+        args[c].queue->create(settings);
+        args[c].numTxns = numTxns;
+        args[c].msgsPerTxn = msgsPerTxn;
+        args[c].failed = false;
+    }
+    for (unsigned c = 0; c < numClients; c++)
+        BOOST_REQUIRE_EQUAL(::pthread_create(&threads[c], 0, txnClient, &args[c]), 0);
+    for (unsigned c = 0; c < numClients; c++) {
+        ::pthread_join(threads[c], 0);
+        BOOST_CHECK(!args[c].failed);
+        args[c].queue.reset();
+    }
+
+    // Every txn was committed on its own queue
+    restart<MessageStoreImpl>();
+    for (unsigned c = 0; c < numClients; c++) {
+        std::ostringstream name;
+        name << "queueC" << c;
+        Queue::shared_ptr queue = queues->find(name.str());
+        BOOST_REQUIRE(queue);
+        BOOST_CHECK_EQUAL(numTxns * msgsPerTxn, queue->getMessageCount());
+    }
+}
+
 boost::intrusive_ptr<Message> nonTxEnq(Queue::shared_ptr q)
 {
     boost::intrusive_ptr<Message> msg = createMessage("Message", "exchange", "routingKey");
@@ -294,6 +433,20 @@ QPID_AUTO_TEST_CASE(Abort)
     cout << "ok" << endl;
 }
 
+QPID_AUTO_TEST_CASE(SingleQueueCommit)
+{
+    cout << test_filename << ".SingleQueueCommit: " << flush;
+    testSingleQueueTxn(true);
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(SingleQueueAbort)
+{
+    cout << test_filename << ".SingleQueueAbort: " << flush;
+    testSingleQueueTxn(false);
+    cout << "ok" << endl;
+}
+
 QPID_AUTO_TEST_CASE(MultiQueueCommit)
 {
     cout << test_filename << ".MultiQueueCommit: " << flush;
@@ -350,6 +503,20 @@ QPID_AUTO_TEST_CASE(MultiQueueAllQueueAbortRecover)
     cout << "ok" << endl;
 }
 
+QPID_AUTO_TEST_CASE(MultiQueueSync)
+{
+    cout << test_filename << ".MultiQueueSync: " << flush;
+    testMultiQueueSync();
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(ConcurrentCommit)
+{
+    cout << test_filename << ".ConcurrentCommit: " << flush;
+    testConcurrentCommit();
+    cout << "ok" << endl;
+}
+
 QPID_AUTO_TEST_CASE(LockedRecordTest)
 {
     cout << test_filename << ".LockedRecordTest: " << flush;
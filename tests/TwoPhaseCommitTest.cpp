@@ -25,6 +25,8 @@
 
 #include "MessageStoreImpl.h"
 #include <iostream>
+#include <pthread.h>
+#include <sstream>
 #include "MessageUtils.h"
 #include "qpid/broker/Queue.h"
 #include "qpid/broker/RecoveryManagerImpl.h"
@@ -196,7 +198,13 @@ class TwoPhaseCommitTest
             return static_cast<JournalImpl*>(queue.getExternalQueueStore())->get_open_txn_cnt();
         }
         u_int32_t getRemainingPreparedListTxns() {
-            return tplStorePtr->get_open_txn_cnt();
+            u_int32_t cnt = 0;
+            for (std::vector<tpl_ptr>::iterator i = tplStores.begin(); i != tplStores.end(); i++)
+                cnt += (*i)->get_open_txn_cnt();
+            return cnt;
+        }
+        std::size_t getPreparedListShards() {
+            return tplStores.size();
         }
     };
 
@@ -211,6 +219,7 @@ class TwoPhaseCommitTest
     boost::intrusive_ptr<Message> msg1;
     boost::intrusive_ptr<Message> msg2;
     boost::intrusive_ptr<Message> msg4;
+    u_int16_t tplShards;
 
     void recoverPrepared(bool commit)
     {
@@ -325,11 +334,22 @@ class TwoPhaseCommitTest
 	    return msg4;
     }
 
+    void initStore(const bool truncate)
+    {
+        MessageStoreImpl::StoreOptions opts;
+        opts.storeDir = test_dir;
+        opts.numJrnlFiles = 4;
+        opts.jrnlFsizePgs = 1;
+        opts.truncateFlag = truncate;
+        opts.tplNumShards = tplShards;
+        store->init(&opts);
+    }
+
     template <class T>
     void setup()
     {
         store = std::auto_ptr<T>(new T(timer));
-        store->init(test_dir, 4, 1, true); // truncate store
+        initStore(true); // truncate store
 
         //create two queues:
         FieldTable settings;
@@ -355,7 +375,7 @@ class TwoPhaseCommitTest
         links.reset();
 
         store = std::auto_ptr<T>(new T(timer));
-        store->init(test_dir, 4, 1);
+        initStore(false);
         sys::Timer t;
         ExchangeRegistry exchanges;
         queues = std::auto_ptr<QueueRegistry>(new QueueRegistry);
@@ -402,7 +422,7 @@ class TwoPhaseCommitTest
     }
 
 public:
-    TwoPhaseCommitTest() : nameA("queueA"), nameB("queueB") {}
+    TwoPhaseCommitTest() : nameA("queueA"), nameB("queueB"), tplShards(1) {}
 
     void testCommitEnqueue()
     {
@@ -507,6 +527,96 @@ public:
     {
         testMultiQueueTxn(2, false, false);
     }
+
+    void testRecoverPreparedSharded()
+    {
+        // Prepare txns over several TPL shards, then recover with only one shard configured
+        const unsigned numTxns = 8;
+        tplShards = 4;
+        setup<TestMessageStore>();
+        for (unsigned i = 0; i < numTxns; i++) {
+            std::ostringstream xid;
+            xid << "xid-" << i;
+            std::auto_ptr<TPCTransactionContext> txn(store->begin(xid.str()));
+            enqueue(txn.get(), xid.str(), queueA);
+            store->prepare(*txn);
+        }
+        tplShards = 1;
+        restart<TestMessageStore>();
+        TestMessageStore* sptr = static_cast<TestMessageStore*>(store.get());
+        BOOST_CHECK_EQUAL(std::size_t(4), sptr->getPreparedListShards());
+        BOOST_CHECK_EQUAL(u_int32_t(numTxns), sptr->getRemainingPreparedListTxns());
+        BOOST_CHECK_EQUAL(u_int32_t(0), queueA->getMessageCount());
+
+        for (unsigned i = 0; i < numTxns; i++) {
+            std::ostringstream xid;
+            xid << "xid-" << i;
+            dtxmgr->commit(xid.str(), false);
+        }
+        BOOST_CHECK_EQUAL(u_int32_t(numTxns), queueA->getMessageCount());
+        BOOST_CHECK_EQUAL(u_int32_t(0), sptr->getRemainingPreparedListTxns());
+    }
+
+    struct PrepareThreadArgs
+    {
+        TwoPhaseCommitTest* test;
+        unsigned thread;
+        unsigned numTxns;
+        bool failed;
+    };
+
+    // Prepares and commits txns which each enqueue one msg, so that prepares from several threads are grouped
+    // into shared TPL flushes. The store is used directly, as the broker queue is not shared between threads.
+    static void* prepareAndCommit(void* arg)
+    {
+        PrepareThreadArgs* a = static_cast<PrepareThreadArgs*>(arg);
+        try {
+            for (unsigned i = 0; i < a->numTxns; i++) {
+                std::ostringstream xid;
+                xid << "xid-" << a->thread << "-" << i;
+                std::auto_ptr<TPCTransactionContext> txn(a->test->store->begin(xid.str()));
+                boost::intrusive_ptr<PersistableMessage> msg(a->test->createMessage(xid.str()));
+                a->test->store->enqueue(txn.get(), msg, *a->test->queueA);
+                a->test->store->prepare(*txn);
+                a->test->store->commit(*txn);
+            }
+        } catch (const std::exception& e) {
+            cerr << "prepareAndCommit: thread " << a->thread << ": " << e.what() << endl;
+            a->failed = true;
+        }
+        return 0;
+    }
+
+    void testConcurrentPrepare()
+    {
+        const unsigned numThreads = 8;
+        const unsigned numTxns = 25;
+        setup<TestMessageStore>();
+        pthread_t threads[numThreads];
+        PrepareThreadArgs args[numThreads];
+        for (unsigned t = 0; t < numThreads; t++) {
+            args[t].test = this;
+            args[t].thread = t;
+            args[t].numTxns = numTxns;
+            args[t].failed = false;
+            BOOST_REQUIRE_EQUAL(::pthread_create(&threads[t], 0, prepareAndCommit, &args[t]), 0);
+        }
+        for (unsigned t = 0; t < numThreads; t++) {
+            ::pthread_join(threads[t], 0);
+            BOOST_CHECK(!args[t].failed);
+        }
+        TestMessageStore* sptr = static_cast<TestMessageStore*>(store.get());
+        BOOST_CHECK_EQUAL(u_int32_t(0), sptr->getRemainingTxns(*queueA));
+        BOOST_CHECK_EQUAL(u_int32_t(0), sptr->getRemainingPreparedListTxns());
+
+        // Every txn was committed, so all msgs are recovered and no txn is left in doubt
+        restart<TestMessageStore>();
+        sptr = static_cast<TestMessageStore*>(store.get());
+        BOOST_REQUIRE(queueA);
+        BOOST_CHECK_EQUAL(u_int32_t(numThreads * numTxns), queueA->getMessageCount());
+        BOOST_CHECK_EQUAL(u_int32_t(0), sptr->getRemainingTxns(*queueA));
+        BOOST_CHECK_EQUAL(u_int32_t(0), sptr->getRemainingPreparedListTxns());
+    }
 };
 
 TwoPhaseCommitTest tpct;
@@ -648,4 +758,18 @@ QPID_AUTO_TEST_CASE(MultiQueueAllQueueAbortRecover)
     cout << "ok" << endl;
 }
 
+QPID_AUTO_TEST_CASE(RecoverPreparedSharded)
+{
+    cout << test_filename << ".RecoverPreparedSharded: " << flush;
+    tpct.testRecoverPreparedSharded();
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(ConcurrentPrepare)
+{
+    cout << test_filename << ".ConcurrentPrepare: " << flush;
+    tpct.testConcurrentPrepare();
+    cout << "ok" << endl;
+}
+
 QPID_AUTO_TEST_SUITE_END()
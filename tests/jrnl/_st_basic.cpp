@@ -25,6 +25,9 @@
 #include <cmath>
 #include <iostream>
 #include "jrnl/jcntl.hpp"
+#include <pthread.h>
+#include <set>
+#include <unistd.h>
 
 using namespace boost::unit_test;
 using namespace mrg::journal;
@@ -395,6 +398,406 @@ QPID_AUTO_TEST_CASE(double_dequeue)
     cout << "ok" << endl;
 }
 
+// Data tokens are owned by the writer threads, so the callback must not delete them
+class mt_test_jrnl_cb : public test_jrnl_cb
+{
+    virtual void wr_aio_cb(std::vector<data_tok*>& /*dtokl*/) {}
+};
+
+struct wr_thread_args
+{
+    jcntl* jcp;
+    u_int64_t first_rid;
+    unsigned num_msgs;
+    test_dtok* enq_dtoks;
+    test_dtok* deq_dtoks;
+    unsigned err_cnt;
+};
+
+// Enqueues num_msgs messages with rids first_rid onwards, then dequeues the even-numbered ones
+void*
+wr_thread(void* p)
+{
+    wr_thread_args* a = static_cast<wr_thread_args*>(p);
+    string msg;
+    try
+    {
+        for (unsigned m=0; m<a->num_msgs; m++)
+        {
+            const u_int64_t rid = a->first_rid + m;
+            test_dtok* dtp = &a->enq_dtoks[m];
+            dtp->set_rid(rid);
+            dtp->set_external_rid(true);
+            create_msg(msg, rid, 20);
+            if (a->jcp->enqueue_data_record(msg.c_str(), msg.size(), msg.size(), dtp, false) != RHM_IORES_SUCCESS)
+                a->err_cnt++;
+        }
+        for (unsigned m=0; m<a->num_msgs; m+=2)
+        {
+            test_dtok* dtp = &a->deq_dtoks[m];
+            dtp->set_wstate(data_tok::ENQ);
+            dtp->set_rid(a->first_rid + a->num_msgs + m);
+            dtp->set_dequeue_rid(a->first_rid + m);
+            dtp->set_external_rid(true);
+            if (a->jcp->dequeue_data_record(dtp) != RHM_IORES_SUCCESS)
+                a->err_cnt++;
+        }
+    }
+    catch (const exception&) { a->err_cnt++; }
+    return 0;
+}
+
+QPID_AUTO_TEST_CASE(write_combining_multi_thread)
+{
+    string test_name = get_test_name(test_filename, "write_combining_multi_thread");
+    try
+    {
+        const unsigned num_threads = 8;
+        const unsigned num_msgs = 500; // per thread
+        set<string> exp_msgs;
+        string msg;
+        string rmsg;
+        string xid;
+        bool transientFlag;
+        bool externalFlag;
+        test_dtok* dtoks = new test_dtok[2 * num_threads * num_msgs];
+        {
+            mt_test_jrnl_cb cb;
+            test_jrnl jc(test_name, test_dir, test_name, cb);
+            jc.initialize(NUM_DEFAULT_JFILES, false, 0, DEFAULT_JFSIZE_SBLKS);
+            jc.set_write_combining(true);
+            BOOST_CHECK(jc.write_combining());
+
+            wr_thread_args args[num_threads];
+            pthread_t threads[num_threads];
+            for (unsigned t=0; t<num_threads; t++)
+            {
+                args[t].jcp = &jc;
+                args[t].first_rid = 2 * t * num_msgs;
+                args[t].num_msgs = num_msgs;
+                args[t].enq_dtoks = &dtoks[2 * t * num_msgs];
+                args[t].deq_dtoks = &dtoks[(2 * t + 1) * num_msgs];
+                args[t].err_cnt = 0;
+                for (unsigned m=1; m<num_msgs; m+=2)
+                    exp_msgs.insert(create_msg(msg, args[t].first_rid + m, 20));
+                BOOST_REQUIRE_EQUAL(::pthread_create(&threads[t], 0, wr_thread, &args[t]), 0);
+            }
+            for (unsigned t=0; t<num_threads; t++)
+            {
+                ::pthread_join(threads[t], 0);
+                BOOST_CHECK_EQUAL(args[t].err_cnt, 0U);
+            }
+            jc.flush(true);
+
+            // Every thread's remaining messages must be read back, each exactly once
+            set<string> rd_msgs(exp_msgs);
+            for (unsigned i=0; i<exp_msgs.size(); i++)
+            {
+                read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+                BOOST_CHECK_EQUAL(rd_msgs.erase(rmsg), 1U);
+            }
+            read_msg(jc, rmsg, xid, transientFlag, externalFlag, RHM_IORES_EMPTY);
+        }
+        delete[] dtoks;
+        {
+            u_int64_t hrid;
+            test_jrnl_cb cb;
+            test_jrnl jc(test_name, test_dir, test_name, cb);
+            jc.recover(NUM_DEFAULT_JFILES, false, 0, DEFAULT_JFSIZE_SBLKS, 0, hrid);
+            BOOST_CHECK_EQUAL(hrid, u_int64_t(2 * num_threads * num_msgs - 2));
+            jc.recover_complete();
+            const std::size_t num_exp = exp_msgs.size();
+            for (unsigned i=0; i<num_exp; i++)
+            {
+                read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+                BOOST_CHECK_EQUAL(exp_msgs.erase(rmsg), 1U);
+            }
+            read_msg(jc, rmsg, xid, transientFlag, externalFlag, RHM_IORES_EMPTY);
+        }
+    }
+    catch(const exception& e) { BOOST_FAIL(e.what()); }
+    cout << "ok" << endl;
+}
+
+// Journal whose write lock the test can hold, so that writers queue up in the write combining ring
+class held_test_jrnl : public test_jrnl
+{
+public:
+    held_test_jrnl(const std::string& jid, const std::string& jdir, const std::string& base_filename,
+            test_jrnl_cb& cb0) : test_jrnl(jid, jdir, base_filename, cb0) {}
+    inline smutex& wr_mutex() { return _wr_mutex; }
+    // Flush the current page as a writer holding the write lock does, but leave the write in the submit
+    // stage, as if the writer had yet to call submit_pending()
+    inline void flush_unsubmitted() { slock s(_wr_mutex); _wmgr.flush(); }
+    inline void submit_pending() { _wmgr.submit_pending(); }
+};
+
+pthread_barrier_t ring_full_barrier;
+
+void*
+wr_thread_at_barrier(void* p)
+{
+    ::pthread_barrier_wait(&ring_full_barrier);
+    return wr_thread(p);
+}
+
+QPID_AUTO_TEST_CASE(write_combining_ring_full)
+{
+    string test_name = get_test_name(test_filename, "write_combining_ring_full");
+    try
+    {
+        // More writers than ring slots: while the write lock is held, the ring fills and the remaining
+        // writers wait for a slot
+        const unsigned num_threads = JRNL_WR_RING_SIZE + 8;
+        const unsigned num_msgs = 10; // per thread
+        set<string> exp_msgs;
+        string msg;
+        string rmsg;
+        string xid;
+        bool transientFlag;
+        bool externalFlag;
+        test_dtok* dtoks = new test_dtok[2 * num_threads * num_msgs];
+        {
+            mt_test_jrnl_cb cb;
+            held_test_jrnl jc(test_name, test_dir, test_name, cb);
+            jc.initialize(NUM_DEFAULT_JFILES, false, 0, DEFAULT_JFSIZE_SBLKS);
+            jc.set_write_combining(true);
+
+            wr_thread_args args[num_threads];
+            pthread_t threads[num_threads];
+            BOOST_REQUIRE_EQUAL(::pthread_barrier_init(&ring_full_barrier, 0, num_threads + 1), 0);
+            {
+                slock s(jc.wr_mutex());
+                for (unsigned t=0; t<num_threads; t++)
+                {
+                    args[t].jcp = &jc;
+                    args[t].first_rid = 2 * t * num_msgs;
+                    args[t].num_msgs = num_msgs;
+                    args[t].enq_dtoks = &dtoks[2 * t * num_msgs];
+                    args[t].deq_dtoks = &dtoks[(2 * t + 1) * num_msgs];
+                    args[t].err_cnt = 0;
+                    for (unsigned m=1; m<num_msgs; m+=2)
+                        exp_msgs.insert(create_msg(msg, args[t].first_rid + m, 20));
+                    BOOST_REQUIRE_EQUAL(::pthread_create(&threads[t], 0, wr_thread_at_barrier, &args[t]), 0);
+                }
+                ::pthread_barrier_wait(&ring_full_barrier);
+                ::usleep(200000); // Let the writers fill the ring and block
+            }
+            for (unsigned t=0; t<num_threads; t++)
+            {
+                ::pthread_join(threads[t], 0);
+                BOOST_CHECK_EQUAL(args[t].err_cnt, 0U);
+            }
+            ::pthread_barrier_destroy(&ring_full_barrier);
+            jc.flush(true);
+
+            set<string> rd_msgs(exp_msgs);
+            for (unsigned i=0; i<exp_msgs.size(); i++)
+            {
+                read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+                BOOST_CHECK_EQUAL(rd_msgs.erase(rmsg), 1U);
+            }
+            read_msg(jc, rmsg, xid, transientFlag, externalFlag, RHM_IORES_EMPTY);
+        }
+        delete[] dtoks;
+        {
+            u_int64_t hrid;
+            test_jrnl_cb cb;
+            test_jrnl jc(test_name, test_dir, test_name, cb);
+            jc.recover(NUM_DEFAULT_JFILES, false, 0, DEFAULT_JFSIZE_SBLKS, 0, hrid);
+            BOOST_CHECK_EQUAL(hrid, u_int64_t(2 * num_threads * num_msgs - 2));
+            jc.recover_complete();
+            const std::size_t num_exp = exp_msgs.size();
+            for (unsigned i=0; i<num_exp; i++)
+            {
+                read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+                BOOST_CHECK_EQUAL(exp_msgs.erase(rmsg), 1U);
+            }
+            read_msg(jc, rmsg, xid, transientFlag, externalFlag, RHM_IORES_EMPTY);
+        }
+    }
+    catch(const exception& e) { BOOST_FAIL(e.what()); }
+    cout << "ok" << endl;
+}
+
+struct get_events_thread_args
+{
+    jcntl* jcp;
+    unsigned timeout_cnt;
+};
+
+// Gets write events until none are outstanding, or until a wait times out
+void*
+get_events_thread(void* p)
+{
+    get_events_thread_args* a = static_cast<get_events_thread_args*>(p);
+    while (a->jcp->get_wr_aio_evt_rem() && a->timeout_cnt == 0)
+    {
+        timespec ts = {1, 0};
+        if (a->jcp->get_wr_events(&ts) == jerrno::AIO_TIMEOUT)
+            a->timeout_cnt++;
+    }
+    return 0;
+}
+
+QPID_AUTO_TEST_CASE(submit_while_getting_events)
+{
+    string test_name = get_test_name(test_filename, "submit_while_getting_events");
+    try
+    {
+        string msg;
+        mt_test_jrnl_cb cb;
+        held_test_jrnl jc(test_name, test_dir, test_name, cb);
+        jc.initialize(NUM_DEFAULT_JFILES, false, 0, DEFAULT_JFSIZE_SBLKS);
+        test_dtok dtok;
+        dtok.set_rid(0);
+        dtok.set_external_rid(true);
+        create_msg(msg, 0, MSG_SIZE);
+        BOOST_CHECK_EQUAL(jc.enqueue_data_record(msg.c_str(), msg.size(), msg.size(), &dtok, false),
+                RHM_IORES_SUCCESS);
+
+        // Complete earlier writes (eg the file header), so that only the page write below is outstanding
+        while (jc.get_wr_aio_evt_rem())
+        {
+            timespec ts = {1, 0};
+            jc.get_wr_events(&ts);
+        }
+
+        // The page write waits in the submit stage; a thread getting events must submit it rather than wait
+        // for a write which was never submitted
+        jc.flush_unsubmitted();
+        BOOST_CHECK_EQUAL(dtok.wstate(), data_tok::ENQ_SUBM);
+        BOOST_CHECK_EQUAL(jc.get_wr_aio_evt_rem(), 1U);
+        get_events_thread_args args = {&jc, 0};
+        pthread_t thread;
+        BOOST_REQUIRE_EQUAL(::pthread_create(&thread, 0, get_events_thread, &args), 0);
+        ::pthread_join(thread, 0);
+        BOOST_CHECK_EQUAL(args.timeout_cnt, 0U);
+        BOOST_CHECK_EQUAL(dtok.wstate(), data_tok::ENQ);
+
+        // The writer's own submit then finds nothing left to submit
+        jc.submit_pending();
+        BOOST_CHECK_EQUAL(jc.get_wr_aio_evt_rem(), 0U);
+        string rmsg;
+        string xid;
+        bool transientFlag;
+        bool externalFlag;
+        read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+        BOOST_CHECK_EQUAL(rmsg, msg);
+        read_msg(jc, rmsg, xid, transientFlag, externalFlag, RHM_IORES_EMPTY);
+    }
+    catch(const exception& e) { BOOST_FAIL(e.what()); }
+    cout << "ok" << endl;
+}
+
+// Records the order in which write callbacks are performed, and whether any two overlap
+class ordered_test_jrnl_cb : public test_jrnl_cb
+{
+public:
+    smutex _mutex;
+    vector<u_int64_t> _rids;
+    volatile u_int32_t _in_cb;
+    unsigned _overlap_cnt;
+    ordered_test_jrnl_cb() : _in_cb(0), _overlap_cnt(0) {}
+    virtual void wr_aio_cb(std::vector<data_tok*>& dtokl)
+    {
+        if (__sync_fetch_and_add(&_in_cb, 1))
+            _overlap_cnt++;
+        {
+            slock s(_mutex);
+            for (std::vector<data_tok*>::const_iterator i=dtokl.begin(); i!=dtokl.end(); i++)
+                _rids.push_back((*i)->rid());
+        }
+        __sync_fetch_and_sub(&_in_cb, 1);
+    }
+};
+
+// Enqueues num_msgs messages with rids first_rid onwards, getting write events after each
+void*
+enq_get_events_thread(void* p)
+{
+    wr_thread_args* a = static_cast<wr_thread_args*>(p);
+    string msg;
+    try
+    {
+        for (unsigned m=0; m<a->num_msgs; m++)
+        {
+            const u_int64_t rid = a->first_rid + m;
+            test_dtok* dtp = &a->enq_dtoks[m];
+            dtp->set_rid(rid);
+            dtp->set_external_rid(true);
+            create_msg(msg, rid, 20);
+            iores res;
+            while ((res = a->jcp->enqueue_data_record(msg.c_str(), msg.size(), msg.size(), dtp, false)) ==
+                    RHM_IORES_PAGE_AIOWAIT)
+            {
+                timespec ts = {0, 1000000};
+                a->jcp->get_wr_events(&ts);
+            }
+            if (res != RHM_IORES_SUCCESS)
+                a->err_cnt++;
+            timespec ts = {0, 0};
+            a->jcp->get_wr_events(&ts);
+        }
+    }
+    catch (const exception&) { a->err_cnt++; }
+    return 0;
+}
+
+QPID_AUTO_TEST_CASE(callbacks_in_order_multi_thread)
+{
+    string test_name = get_test_name(test_filename, "callbacks_in_order_multi_thread");
+    try
+    {
+        // Several threads complete writes and dispatch their callbacks; every record's callback must be
+        // performed exactly once, one batch at a time, and in the order in which the records were written
+        const unsigned num_threads = 8;
+        const unsigned num_msgs = 1000; // per thread
+        string msg;
+        string rmsg;
+        string xid;
+        bool transientFlag;
+        bool externalFlag;
+        test_dtok* dtoks = new test_dtok[num_threads * num_msgs];
+        {
+            ordered_test_jrnl_cb cb;
+            test_jrnl jc(test_name, test_dir, test_name, cb);
+            jc.initialize(NUM_DEFAULT_JFILES, false, 0, DEFAULT_JFSIZE_SBLKS);
+
+            wr_thread_args args[num_threads];
+            pthread_t threads[num_threads];
+            for (unsigned t=0; t<num_threads; t++)
+            {
+                args[t].jcp = &jc;
+                args[t].first_rid = t * num_msgs;
+                args[t].num_msgs = num_msgs;
+                args[t].enq_dtoks = &dtoks[t * num_msgs];
+                args[t].deq_dtoks = 0;
+                args[t].err_cnt = 0;
+                BOOST_REQUIRE_EQUAL(::pthread_create(&threads[t], 0, enq_get_events_thread, &args[t]), 0);
+            }
+            for (unsigned t=0; t<num_threads; t++)
+            {
+                ::pthread_join(threads[t], 0);
+                BOOST_CHECK_EQUAL(args[t].err_cnt, 0U);
+            }
+            jc.flush(true);
+
+            BOOST_CHECK_EQUAL(cb._overlap_cnt, 0U);
+            BOOST_REQUIRE_EQUAL(cb._rids.size(), std::size_t(num_threads * num_msgs));
+            for (unsigned i=0; i<cb._rids.size(); i++)
+            {
+                read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+                BOOST_CHECK_EQUAL(rmsg, create_msg(msg, cb._rids[i], 20));
+            }
+            read_msg(jc, rmsg, xid, transientFlag, externalFlag, RHM_IORES_EMPTY);
+        }
+        delete[] dtoks;
+    }
+    catch(const exception& e) { BOOST_FAIL(e.what()); }
+    cout << "ok" << endl;
+}
+
 #else
 /*
  * ==============================================
@@ -25,6 +25,7 @@
 #include <cmath>
 #include <iostream>
 #include "jrnl/jcntl.hpp"
+#include <pthread.h>
 
 using namespace boost::unit_test;
 using namespace mrg::journal;
@@ -238,4 +239,133 @@ QPID_AUTO_TEST_CASE(enqueue_dequeue_abort_interleaved)
     cout << "ok" << endl;
 }
 
+QPID_AUTO_TEST_CASE(multi_journal_sync)
+{
+    string test_name = get_test_name(test_filename, "multi_journal_sync");
+    try
+    {
+        string msg;
+        string xid;
+
+        test_jrnl_cb cb;
+        test_jrnl jc1(test_name + "_1", test_dir, test_name + "_1", cb);
+        test_jrnl jc2(test_name + "_2", test_dir, test_name + "_2", cb);
+        jc1.initialize(NUM_TEST_JFILES, false, 0, TEST_JFSIZE_SBLKS);
+        jc2.initialize(NUM_TEST_JFILES, false, 0, TEST_JFSIZE_SBLKS);
+        create_xid(xid, 0, XID_SIZE);
+        for (int m=0; m<NUM_MSGS; m++)
+        {
+            BOOST_CHECK_EQUAL(enq_txn_msg(jc1, m, create_msg(msg, m, MSG_SIZE), xid, false), u_int64_t(m));
+            BOOST_CHECK_EQUAL(enq_txn_msg(jc2, m, create_msg(msg, m, MSG_SIZE), xid, false), u_int64_t(m));
+        }
+        jc1.flush();
+        jc2.flush();
+
+        // The enqueues on both journals are in flight; wait for each in turn
+        timespec timeout = {10, 0};
+        BOOST_CHECK(jc1.wait_txn_synced(xid, &timeout) != jerrno::AIO_TIMEOUT);
+        BOOST_CHECK(jc2.wait_txn_synced(xid, &timeout) != jerrno::AIO_TIMEOUT);
+        BOOST_CHECK(jc1.is_txn_synced(xid));
+        BOOST_CHECK(jc2.is_txn_synced(xid));
+        txn_commit(jc1, NUM_MSGS, xid);
+        txn_commit(jc2, NUM_MSGS, xid);
+    }
+    catch(const exception& e) { BOOST_FAIL(e.what()); }
+    cout << "ok" << endl;
+}
+
+struct sync_thread_args
+{
+    jcntl* jcp[2];
+    u_int64_t first_rid;
+    unsigned num_msgs;
+    string xid;
+    unsigned err_cnt;
+};
+
+// Enqueues num_msgs transactional messages with rids first_rid onwards on both journals, then waits until the
+// transaction is synced on both
+void*
+sync_thread(void* p)
+{
+    sync_thread_args* a = static_cast<sync_thread_args*>(p);
+    string msg;
+    try
+    {
+        for (unsigned m=0; m<a->num_msgs; m++)
+        {
+            const u_int64_t rid = a->first_rid + m;
+            create_msg(msg, rid, MSG_SIZE);
+            for (int j=0; j<2; j++)
+            {
+                test_dtok* dtp = new test_dtok;
+                dtp->set_rid(rid);
+                dtp->set_external_rid(true);
+                iores res;
+                while ((res = a->jcp[j]->enqueue_txn_data_record(msg.c_str(), msg.size(), msg.size(), dtp, a->xid,
+                        false)) == RHM_IORES_PAGE_AIOWAIT)
+                {
+                    timespec ts = {0, 1000000};
+                    a->jcp[j]->get_wr_events(&ts);
+                }
+                if (res != RHM_IORES_SUCCESS)
+                    a->err_cnt++;
+                if (dtp->done())
+                    delete dtp;
+            }
+        }
+        a->jcp[0]->flush();
+        a->jcp[1]->flush();
+        timespec timeout = {10, 0};
+        for (int j=0; j<2; j++)
+        {
+            if (a->jcp[j]->wait_txn_synced(a->xid, &timeout) == jerrno::AIO_TIMEOUT || !a->jcp[j]->is_txn_synced(a->xid))
+                a->err_cnt++;
+        }
+    }
+    catch (const exception&) { a->err_cnt++; }
+    return 0;
+}
+
+QPID_AUTO_TEST_CASE(multi_journal_sync_multi_thread)
+{
+    string test_name = get_test_name(test_filename, "multi_journal_sync_multi_thread");
+    try
+    {
+        // Several transactions sync on the same two journals at once; each must see its own records synced on
+        // both, whichever thread gets the write events for them
+        const unsigned num_threads = 8;
+        const unsigned num_msgs = 20; // per thread
+        test_jrnl_cb cb;
+        test_jrnl jc1(test_name + "_1", test_dir, test_name + "_1", cb);
+        test_jrnl jc2(test_name + "_2", test_dir, test_name + "_2", cb);
+        jc1.initialize(NUM_TEST_JFILES, false, 0, TEST_JFSIZE_SBLKS);
+        jc2.initialize(NUM_TEST_JFILES, false, 0, TEST_JFSIZE_SBLKS);
+        pthread_t threads[num_threads];
+        sync_thread_args args[num_threads];
+        for (unsigned t=0; t<num_threads; t++)
+        {
+            args[t].jcp[0] = &jc1;
+            args[t].jcp[1] = &jc2;
+            args[t].first_rid = t * num_msgs;
+            args[t].num_msgs = num_msgs;
+            create_xid(args[t].xid, t, XID_SIZE);
+            args[t].err_cnt = 0;
+            BOOST_REQUIRE_EQUAL(::pthread_create(&threads[t], 0, sync_thread, &args[t]), 0);
+        }
+        for (unsigned t=0; t<num_threads; t++)
+        {
+            ::pthread_join(threads[t], 0);
+            BOOST_CHECK_EQUAL(args[t].err_cnt, 0U);
+        }
+        for (unsigned t=0; t<num_threads; t++)
+        {
+            txn_commit(jc1, num_threads * num_msgs + t, args[t].xid);
+            txn_commit(jc2, num_threads * num_msgs + t, args[t].xid);
+        }
+    }
+    catch(const exception& e) { BOOST_FAIL(e.what()); }
+    cout << "ok" << endl;
+}
+
 QPID_AUTO_TEST_SUITE_END()
@@ -715,6 +715,66 @@ deq_msg(jcntl& jc, const u_int64_t drid, const u_int64_t rid, const iores exp_re
     catch (exception& e) { delete dtp; throw; }
 }
 
+u_int64_t
+deq_msgs(jcntl& jc, const u_int64_t first_drid, const std::size_t drid_cnt, const u_int64_t drid_step,
+                const u_int64_t rid, const iores exp_ret = RHM_IORES_SUCCESS)
+{
+    ostringstream ctxt;
+    ctxt << "deq_msgs(" << first_drid << "+" << drid_cnt << "*" << drid_step << ")";
+    std::vector<data_tok*> dtokl;
+    for (std::size_t i=0; i<drid_cnt; i++)
+    {
+        test_dtok* dtp = new test_dtok;
+        BOOST_CHECK_MESSAGE(dtp != 0, "Data token allocation failed (dtp == 0).");
+        dtp->set_rid(rid);
+        dtp->set_dequeue_rid(first_drid + i * drid_step);
+        dtp->set_external_rid(true);
+        dtp->set_wstate(data_tok::ENQ);
+        dtokl.push_back(dtp);
+    }
+    try
+    {
+        iores res = jc.dequeue_data_records(dtokl);
+        if (res != exp_ret)
+        {
+            for (std::size_t i=1; i<dtokl.size(); i++)
+                delete dtokl[i];
+            check_iores(ctxt.str(), res, exp_ret, static_cast<test_dtok*>(dtokl.front()));
+        }
+        for (std::size_t i=0; i<dtokl.size(); i++)
+            if (static_cast<test_dtok*>(dtokl[i])->done()) delete dtokl[i];
+        return rid;
+    }
+    catch (exception& e)
+    {
+        for (std::size_t i=0; i<dtokl.size(); i++)
+            delete dtokl[i];
+        throw;
+    }
+}
+
+u_int64_t
+deq_range(jcntl& jc, const u_int64_t first_drid, const u_int64_t last_drid, const u_int64_t rid,
+                const iores exp_ret = RHM_IORES_SUCCESS)
+{
+    ostringstream ctxt;
+    ctxt << "deq_range(" << first_drid << "-" << last_drid << ")";
+    test_dtok* dtp = new test_dtok;
+    BOOST_CHECK_MESSAGE(dtp != 0, "Data token allocation failed (dtp == 0).");
+    dtp->set_rid(rid);
+    dtp->set_external_rid(true);
+    dtp->set_wstate(data_tok::ENQ);
+    try
+    {
+        iores res = jc.dequeue_data_range(dtp, first_drid, last_drid);
+        check_iores(ctxt.str(), res, exp_ret, dtp);
+        u_int64_t dtok_rid = dtp->rid();
+        if (dtp->done()) delete dtp;
+        return dtok_rid;
+    }
+    catch (exception& e) { delete dtp; throw; }
+}
+
 u_int64_t
 deq_txn_msg(jcntl& jc, const u_int64_t drid, const u_int64_t rid, const string& xid,
                 const iores exp_ret = RHM_IORES_SUCCESS)
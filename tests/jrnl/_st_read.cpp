@@ -25,6 +25,8 @@
 #include <cmath>
 #include <iostream>
 #include "jrnl/jcntl.hpp"
+#include "jrnl/lzf_codec.hpp"
+#include "jrnl/rcursor.hpp"
 
 using namespace boost::unit_test;
 using namespace mrg::journal;
@@ -36,6 +38,34 @@ const string test_filename("_st_read");
 
 #include "_st_helper_fns.hpp"
 
+// As read_msg(), but reads through read cursor rcp rather than the journal's own read position
+void
+read_cursor_msg(rcursor* const rcp, string& msg, bool& transient, bool& external, const iores exp_ret = RHM_IORES_SUCCESS)
+{
+    void* mp = 0;
+    std::size_t msize = 0;
+    void* xp = 0;
+    std::size_t xsize = 0;
+    test_dtok dt;
+    dt.set_wstate(data_tok::ENQ);
+
+    unsigned aio_sleep_cnt = 0;
+    iores res = rcp->read_data_record(&mp, msize, &xp, xsize, transient, external, &dt);
+    while (res == RHM_IORES_PAGE_AIOWAIT && ++aio_sleep_cnt <= MAX_AIO_SLEEPS)
+    {
+        usleep(AIO_SLEEP_TIME);
+        res = rcp->read_data_record(&mp, msize, &xp, xsize, transient, external, &dt);
+    }
+    BOOST_CHECK_MESSAGE(res == exp_ret, "read_cursor_msg: Expected " << iores_str(exp_ret) << "; got "
+            << iores_str(res));
+    if (mp)
+        msg.assign((char*)mp, msize);
+    if (xp)
+        std::free(xp);
+    else if (mp)
+        std::free(mp);
+}
+
 // === Test suite ===
 
 #ifndef LONG_TEST
@@ -224,6 +254,324 @@ QPID_AUTO_TEST_CASE(multi_page_enqueue_recovered_read_dequeue_block)
     cout << "ok" << endl;
 }
 
+QPID_AUTO_TEST_CASE(compressed_enqueue_recovered_read_dequeue_block)
+{
+    string test_name = get_test_name(test_filename, "compressed_enqueue_recovered_read_dequeue_block");
+    try
+    {
+        // Alternate between large (compressed) and small (below threshold) messages
+        {
+            string msg;
+            string rmsg;
+            string xid;
+            bool transientFlag;
+            bool externalFlag;
+
+            test_jrnl_cb cb;
+            test_jrnl jc(test_name, test_dir, test_name, cb);
+            jc.initialize(2*NUM_TEST_JFILES, false, 0, 10*TEST_JFSIZE_SBLKS);
+            jc.set_codec(codec::get(lzf_codec::LZF_CODEC_ID), 2*MSG_SIZE);
+            for (int m=0; m<NUM_MSGS*20; m++)
+                enq_msg(jc, m, create_msg(msg, m, (m%2 ? 1 : 64)*MSG_SIZE), false);
+            jc.flush();
+            for (int m=0; m<NUM_MSGS*20; m++)
+            {
+                read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+                BOOST_CHECK_EQUAL(create_msg(msg, m, (m%2 ? 1 : 64)*MSG_SIZE), rmsg);
+            }
+        }
+        // Recover without setting a codec; records must still be expanded on read
+        {
+            string msg;
+            u_int64_t hrid;
+            string rmsg;
+            string xid;
+            bool transientFlag;
+            bool externalFlag;
+
+            test_jrnl_cb cb;
+            test_jrnl jc(test_name, test_dir, test_name, cb);
+            jc.recover(2*NUM_TEST_JFILES, false, 0, 10*TEST_JFSIZE_SBLKS, 0, hrid);
+            BOOST_CHECK_EQUAL(hrid, u_int64_t(NUM_MSGS*20 - 1));
+            jc.recover_complete();
+            for (int m=0; m<NUM_MSGS*20; m++)
+            {
+                read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+                BOOST_CHECK_EQUAL(create_msg(msg, m, (m%2 ? 1 : 64)*MSG_SIZE), rmsg);
+                BOOST_CHECK_EQUAL(xid.size(), std::size_t(0));
+                BOOST_CHECK_EQUAL(transientFlag, false);
+                BOOST_CHECK_EQUAL(externalFlag, false);
+            }
+            read_msg(jc, rmsg, xid, transientFlag, externalFlag, RHM_IORES_EMPTY);
+            for (int m=0; m<NUM_MSGS*20; m++)
+                deq_msg(jc, m, m+NUM_MSGS*20);
+            read_msg(jc, rmsg, xid, transientFlag, externalFlag, RHM_IORES_EMPTY);
+        }
+    }
+    catch(const exception& e) { BOOST_FAIL(e.what()); }
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(compressed_packed_enqueue_recovered_read)
+{
+    string test_name = get_test_name(test_filename, "compressed_packed_enqueue_recovered_read");
+    try
+    {
+        // Compressible msgs small enough to be packed once compressed
+        {
+            string msg;
+            string rmsg;
+            string xid;
+            bool transientFlag;
+            bool externalFlag;
+
+            test_jrnl_cb cb;
+            test_jrnl jc(test_name, test_dir, test_name, cb);
+            jc.initialize(NUM_TEST_JFILES, false, 0, TEST_JFSIZE_SBLKS);
+            jc.set_codec(codec::get(lzf_codec::LZF_CODEC_ID), 64);
+            jc.set_pack_records(true);
+            for (int m=0; m<NUM_MSGS*20; m++)
+                enq_msg(jc, m, create_msg(msg, m, 300), false);
+            jc.flush();
+            for (int m=0; m<NUM_MSGS*20; m++)
+            {
+                read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+                BOOST_CHECK_EQUAL(create_msg(msg, m, 300), rmsg);
+            }
+            read_msg(jc, rmsg, xid, transientFlag, externalFlag, RHM_IORES_EMPTY);
+        }
+        // Recover without codec or packing; records must still be expanded on read
+        {
+            string msg;
+            u_int64_t hrid;
+            string rmsg;
+            string xid;
+            bool transientFlag;
+            bool externalFlag;
+
+            test_jrnl_cb cb;
+            test_jrnl jc(test_name, test_dir, test_name, cb);
+            jc.recover(NUM_TEST_JFILES, false, 0, TEST_JFSIZE_SBLKS, 0, hrid);
+            BOOST_CHECK_EQUAL(hrid, u_int64_t(NUM_MSGS*20 - 1));
+            jc.recover_complete();
+            for (int m=0; m<NUM_MSGS*20; m++)
+            {
+                read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+                BOOST_CHECK_EQUAL(create_msg(msg, m, 300), rmsg);
+            }
+            read_msg(jc, rmsg, xid, transientFlag, externalFlag, RHM_IORES_EMPTY);
+            for (int m=0; m<NUM_MSGS*20; m++)
+                deq_msg(jc, m, m+NUM_MSGS*20);
+        }
+    }
+    catch(const exception& e) { BOOST_FAIL(e.what()); }
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(packed_enqueue_dequeue_recovered_read)
+{
+    string test_name = get_test_name(test_filename, "packed_enqueue_dequeue_recovered_read");
+    try
+    {
+        // Small enqueues interleaved with dequeues, so that both share packed dblks
+        {
+            string msg;
+            string rmsg;
+            string xid;
+            bool transientFlag;
+            bool externalFlag;
+
+            test_jrnl_cb cb;
+            test_jrnl jc(test_name, test_dir, test_name, cb);
+            jc.initialize(NUM_TEST_JFILES, false, 0, TEST_JFSIZE_SBLKS);
+            jc.set_pack_records(true);
+            for (int m=0; m<NUM_MSGS*20; m++)
+            {
+                enq_msg(jc, m, create_msg(msg, m, 11), false);
+                if (m%2)
+                    deq_msg(jc, m-1, NUM_MSGS*20 + m/2);
+            }
+            jc.flush();
+            // Without packing, each record would occupy at least one dblk
+            BOOST_CHECK(jc.get_wr_subm_dblks() < u_int64_t(NUM_MSGS*30));
+            BOOST_CHECK_EQUAL(jc.get_wr_rec_bytes(), u_int64_t(NUM_MSGS*20*(enq_rec::rec_size(0, 11, false)) +
+                    NUM_MSGS*10*sizeof(deq_hdr)));
+            for (int m=1; m<NUM_MSGS*20; m+=2)
+            {
+                read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+                BOOST_CHECK_EQUAL(create_msg(msg, m, 11), rmsg);
+            }
+            read_msg(jc, rmsg, xid, transientFlag, externalFlag, RHM_IORES_EMPTY);
+        }
+        // Recover without packing; packed records must still be found
+        {
+            string msg;
+            u_int64_t hrid;
+            string rmsg;
+            string xid;
+            bool transientFlag;
+            bool externalFlag;
+
+            test_jrnl_cb cb;
+            test_jrnl jc(test_name, test_dir, test_name, cb);
+            jc.recover(NUM_TEST_JFILES, false, 0, TEST_JFSIZE_SBLKS, 0, hrid);
+            BOOST_CHECK_EQUAL(hrid, u_int64_t(NUM_MSGS*30 - 1));
+            jc.recover_complete();
+            for (int m=1; m<NUM_MSGS*20; m+=2)
+            {
+                read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+                BOOST_CHECK_EQUAL(create_msg(msg, m, 11), rmsg);
+                BOOST_CHECK_EQUAL(xid.size(), std::size_t(0));
+                BOOST_CHECK_EQUAL(transientFlag, false);
+                BOOST_CHECK_EQUAL(externalFlag, false);
+            }
+            read_msg(jc, rmsg, xid, transientFlag, externalFlag, RHM_IORES_EMPTY);
+            for (int m=1; m<NUM_MSGS*20; m+=2)
+                deq_msg(jc, m, NUM_MSGS*30 + m/2);
+            read_msg(jc, rmsg, xid, transientFlag, externalFlag, RHM_IORES_EMPTY);
+        }
+    }
+    catch(const exception& e) { BOOST_FAIL(e.what()); }
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(multi_rid_dequeue_recovered_read)
+{
+    string test_name = get_test_name(test_filename, "multi_rid_dequeue_recovered_read");
+    try
+    {
+        // A single dequeue record carrying enough rids to span several cache pages. Only even rids
+        // are dequeued, so that the rids cannot be written as a range.
+        const int num_msgs = NUM_MSGS*2000;
+        {
+            string msg;
+            string rmsg;
+            string xid;
+            bool transientFlag;
+            bool externalFlag;
+
+            test_jrnl_cb cb;
+            test_jrnl jc(test_name, test_dir, test_name, cb);
+            jc.initialize(2*NUM_TEST_JFILES, false, 0, 10*TEST_JFSIZE_SBLKS);
+            for (int m=0; m<num_msgs; m++)
+                enq_msg(jc, m, create_msg(msg, m, 11), false);
+            u_int64_t rec_bytes = jc.get_wr_rec_bytes();
+            deq_msgs(jc, 0, 2, 2, num_msgs);
+            deq_msgs(jc, 4, num_msgs/2 - 2, 2, num_msgs + 1);
+            BOOST_CHECK_EQUAL(jc.get_wr_rec_bytes() - rec_bytes, u_int64_t(mdeq_rec::rec_size(2) +
+                    mdeq_rec::rec_size(num_msgs/2 - 2)));
+            // One rid already dequeued: the whole record must be rejected, leaving rid num_msgs-3 enqueued
+            BOOST_CHECK_THROW(deq_msgs(jc, num_msgs - 3, 2, 1, num_msgs + 2), jexception);
+            jc.flush();
+            for (int m=1; m<num_msgs; m+=2)
+            {
+                read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+                BOOST_CHECK_EQUAL(create_msg(msg, m, 11), rmsg);
+            }
+            read_msg(jc, rmsg, xid, transientFlag, externalFlag, RHM_IORES_EMPTY);
+        }
+        {
+            string msg;
+            u_int64_t hrid;
+            string rmsg;
+            string xid;
+            bool transientFlag;
+            bool externalFlag;
+
+            test_jrnl_cb cb;
+            test_jrnl jc(test_name, test_dir, test_name, cb);
+            jc.recover(2*NUM_TEST_JFILES, false, 0, 10*TEST_JFSIZE_SBLKS, 0, hrid);
+            BOOST_CHECK_EQUAL(hrid, u_int64_t(num_msgs + 1));
+            jc.recover_complete();
+            for (int m=1; m<num_msgs; m+=2)
+            {
+                read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+                BOOST_CHECK_EQUAL(create_msg(msg, m, 11), rmsg);
+            }
+            read_msg(jc, rmsg, xid, transientFlag, externalFlag, RHM_IORES_EMPTY);
+            // The remaining rids are now all those enqueued within their range, so are written as a range
+            u_int64_t rec_bytes = jc.get_wr_rec_bytes();
+            deq_msgs(jc, 1, num_msgs/2, 2, num_msgs + 2);
+            BOOST_CHECK_EQUAL(jc.get_wr_rec_bytes() - rec_bytes, u_int64_t(sizeof(rdeq_hdr)));
+            BOOST_CHECK_EQUAL(jc.get_enq_cnt(), u_int32_t(0));
+            read_msg(jc, rmsg, xid, transientFlag, externalFlag, RHM_IORES_EMPTY);
+        }
+    }
+    catch(const exception& e) { BOOST_FAIL(e.what()); }
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(range_dequeue_recovered_read)
+{
+    string test_name = get_test_name(test_filename, "range_dequeue_recovered_read");
+    try
+    {
+        const int num_msgs = NUM_MSGS*200;
+        {
+            string msg;
+            string rmsg;
+            string xid;
+            bool transientFlag;
+            bool externalFlag;
+
+            test_jrnl_cb cb;
+            test_jrnl jc(test_name, test_dir, test_name, cb);
+            jc.initialize(NUM_TEST_JFILES, false, 0, TEST_JFSIZE_SBLKS);
+            // Enqueue odd rids only, leaving even rids to be enqueued after the dequeues
+            for (int m=1; m<num_msgs; m+=2)
+                enq_msg(jc, m, create_msg(msg, m, 11), false);
+            // Watermark over first half, then a range in the middle of the second half
+            deq_range(jc, 0, num_msgs/2 - 1, num_msgs);
+            deq_range(jc, 3*num_msgs/4, 3*num_msgs/4 + 9, num_msgs + 1);
+            // Nothing left to dequeue in these ranges
+            BOOST_CHECK_THROW(deq_range(jc, 0, num_msgs/2 - 1, num_msgs + 2), jexception);
+            BOOST_CHECK_THROW(deq_range(jc, 3*num_msgs/4, 3*num_msgs/4 + 9, num_msgs + 2), jexception);
+            // An enqueue after the watermark, but with a rid inside it, is not dequeued by it
+            enq_msg(jc, 0, create_msg(msg, 0, 11), false);
+            jc.flush();
+            for (int m=num_msgs/2 + 1; m<num_msgs; m+=2)
+            {
+                if (m >= 3*num_msgs/4 && m <= 3*num_msgs/4 + 9)
+                    continue;
+                read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+                BOOST_CHECK_EQUAL(create_msg(msg, m, 11), rmsg);
+            }
+            read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+            BOOST_CHECK_EQUAL(create_msg(msg, 0, 11), rmsg);
+            read_msg(jc, rmsg, xid, transientFlag, externalFlag, RHM_IORES_EMPTY);
+        }
+        {
+            string msg;
+            u_int64_t hrid;
+            string rmsg;
+            string xid;
+            bool transientFlag;
+            bool externalFlag;
+
+            test_jrnl_cb cb;
+            test_jrnl jc(test_name, test_dir, test_name, cb);
+            jc.recover(NUM_TEST_JFILES, false, 0, TEST_JFSIZE_SBLKS, 0, hrid);
+            BOOST_CHECK_EQUAL(hrid, u_int64_t(num_msgs + 1));
+            jc.recover_complete();
+            BOOST_CHECK_EQUAL(jc.get_enq_cnt(), u_int32_t(1 + num_msgs/4 - 5));
+            for (int m=num_msgs/2 + 1; m<num_msgs; m+=2)
+            {
+                if (m >= 3*num_msgs/4 && m <= 3*num_msgs/4 + 9)
+                    continue;
+                read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+                BOOST_CHECK_EQUAL(create_msg(msg, m, 11), rmsg);
+            }
+            read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+            BOOST_CHECK_EQUAL(create_msg(msg, 0, 11), rmsg);
+            read_msg(jc, rmsg, xid, transientFlag, externalFlag, RHM_IORES_EMPTY);
+            deq_range(jc, 0, num_msgs, num_msgs + 2);
+            BOOST_CHECK_EQUAL(jc.get_enq_cnt(), u_int32_t(0));
+        }
+    }
+    catch(const exception& e) { BOOST_FAIL(e.what()); }
+    cout << "ok" << endl;
+}
+
 QPID_AUTO_TEST_CASE(enqueue_recover_read_recovered_read_dequeue_block)
 {
     string test_name = get_test_name(test_filename, "enqueue_recover_read_recovered_read_dequeue_block");
@@ -360,6 +708,267 @@ QPID_AUTO_TEST_CASE(cache_cycled_delayed_read)
     cout << "ok" << endl;
 }
 
+QPID_AUTO_TEST_CASE(small_page_lazy_released_read_cache)
+{
+    string test_name = get_test_name(test_filename, "small_page_lazy_released_read_cache");
+    try
+    {
+        string msg;
+        string rmsg;
+        string xid;
+        bool transientFlag;
+        bool externalFlag;
+
+        test_jrnl_cb cb;
+        test_jrnl jc(test_name, test_dir, test_name, cb);
+        jc.set_rcache_geometry(JRNL_RMGR_PAGE_SIZE / 8, 4); // messages span several read pages
+        jc.initialize(NUM_TEST_JFILES, false, 0, TEST_JFSIZE_SBLKS);
+        BOOST_CHECK(!jc.rcache_allocated());
+        for (int m=0; m<NUM_MSGS; m++)
+            enq_msg(jc, m, create_msg(msg, m, 16*MSG_SIZE), false);
+        jc.flush();
+        BOOST_CHECK(!jc.rcache_allocated()); // Writing does not allocate the read cache
+        read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+        BOOST_CHECK_EQUAL(create_msg(msg, 0, 16*MSG_SIZE), rmsg);
+        BOOST_CHECK(jc.rcache_allocated());
+
+        // The first call sees the read above; the second frees the cache
+        BOOST_CHECK(!jc.release_idle_rcache(0));
+        BOOST_CHECK(jc.release_idle_rcache(0));
+        BOOST_CHECK(!jc.rcache_allocated());
+
+        // Reads start again from the first record
+        for (int m=0; m<NUM_MSGS; m++)
+        {
+            read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+            BOOST_CHECK_EQUAL(create_msg(msg, m, 16*MSG_SIZE), rmsg);
+        }
+        read_msg(jc, rmsg, xid, transientFlag, externalFlag, RHM_IORES_EMPTY);
+        for (int m=0; m<NUM_MSGS; m++)
+            deq_msg(jc, m, m+NUM_MSGS);
+    }
+    catch(const exception& e) { BOOST_FAIL(e.what()); }
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(adaptive_read_ahead)
+{
+    string test_name = get_test_name(test_filename, "adaptive_read_ahead");
+    try
+    {
+        string msg;
+        string rmsg;
+        bool transientFlag;
+        bool externalFlag;
+        const int num_msgs = 4 * NUM_MSGS;
+
+        test_jrnl_cb cb;
+        test_jrnl jc(test_name, test_dir, test_name, cb);
+        jc.set_rcache_geometry(JRNL_RMGR_PAGE_SIZE / 8, 4); // messages span several read pages
+        jc.initialize(NUM_TEST_JFILES, false, 0, TEST_JFSIZE_SBLKS);
+        for (int m=0; m<num_msgs; m++)
+            enq_msg(jc, m, create_msg(msg, m, 16*MSG_SIZE), false);
+        jc.flush();
+        rcursor* rc = jc.open_rcursor(&cb);
+        BOOST_CHECK_EQUAL(rc->read_ahead_pages(), u_int16_t(JRNL_RMGR_INIT_RA_PAGES));
+
+        // Repeatedly jumping back to the first record wastes most of the read-ahead, which shrinks
+        for (int i=0; i<4; i++)
+        {
+            rc->invalidate();
+            read_cursor_msg(rc, rmsg, transientFlag, externalFlag);
+            BOOST_CHECK_EQUAL(create_msg(msg, 0, 16*MSG_SIZE), rmsg);
+        }
+        rc->invalidate();
+        read_cursor_msg(rc, rmsg, transientFlag, externalFlag);
+        BOOST_CHECK_EQUAL(rc->read_ahead_pages(), u_int16_t(1));
+
+        // Reading in sequence grows it, up to the number of read pages
+        for (int m=1; m<num_msgs; m++)
+        {
+            read_cursor_msg(rc, rmsg, transientFlag, externalFlag);
+            BOOST_CHECK_EQUAL(create_msg(msg, m, 16*MSG_SIZE), rmsg);
+        }
+        read_cursor_msg(rc, rmsg, transientFlag, externalFlag, RHM_IORES_EMPTY);
+        BOOST_CHECK_EQUAL(rc->read_ahead_pages(), u_int16_t(4));
+        jc.close_rcursor(rc);
+        for (int m=0; m<num_msgs; m++)
+            deq_msg(jc, m, m+num_msgs);
+    }
+    catch(const exception& e) { BOOST_FAIL(e.what()); }
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(independent_read_cursors)
+{
+    string test_name = get_test_name(test_filename, "independent_read_cursors");
+    try
+    {
+        string msg;
+        string rmsg;
+        string xid;
+        bool transientFlag;
+        bool externalFlag;
+
+        test_jrnl_cb cb;
+        test_jrnl jc(test_name, test_dir, test_name, cb);
+        jc.set_rcache_geometry(JRNL_RMGR_PAGE_SIZE / 8, 4); // messages span several read pages
+        jc.initialize(NUM_TEST_JFILES, false, 0, TEST_JFSIZE_SBLKS);
+        for (int m=0; m<NUM_MSGS; m++)
+            enq_msg(jc, m, create_msg(msg, m, 16*MSG_SIZE), false);
+        jc.flush();
+
+        rcursor* rc1 = jc.open_rcursor(&cb);
+        rcursor* rc2 = jc.open_rcursor(&cb);
+        BOOST_CHECK_EQUAL(jc.num_rcursors(), std::size_t(2));
+
+        // Interleaved reads from each cursor (and the journal itself) do not disturb the others' positions
+        read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+        BOOST_CHECK_EQUAL(create_msg(msg, 0, 16*MSG_SIZE), rmsg);
+        for (int m=0; m<NUM_MSGS; m++)
+        {
+            read_cursor_msg(rc1, rmsg, transientFlag, externalFlag);
+            BOOST_CHECK_EQUAL(create_msg(msg, m, 16*MSG_SIZE), rmsg);
+            if (m % 2 == 0)
+            {
+                read_cursor_msg(rc2, rmsg, transientFlag, externalFlag);
+                BOOST_CHECK_EQUAL(create_msg(msg, m / 2, 16*MSG_SIZE), rmsg);
+            }
+        }
+        read_cursor_msg(rc1, rmsg, transientFlag, externalFlag, RHM_IORES_EMPTY);
+        for (int m=(NUM_MSGS + 1) / 2; m<NUM_MSGS; m++)
+        {
+            read_cursor_msg(rc2, rmsg, transientFlag, externalFlag);
+            BOOST_CHECK_EQUAL(create_msg(msg, m, 16*MSG_SIZE), rmsg);
+        }
+        read_cursor_msg(rc2, rmsg, transientFlag, externalFlag, RHM_IORES_EMPTY);
+        read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+        BOOST_CHECK_EQUAL(create_msg(msg, 1, 16*MSG_SIZE), rmsg);
+
+        // An invalidated cursor starts again from the first record
+        rc1->invalidate();
+        read_cursor_msg(rc1, rmsg, transientFlag, externalFlag);
+        BOOST_CHECK_EQUAL(create_msg(msg, 0, 16*MSG_SIZE), rmsg);
+
+        jc.close_rcursor(rc1);
+        jc.close_rcursor(rc2);
+        BOOST_CHECK_EQUAL(jc.num_rcursors(), std::size_t(0));
+        for (int m=0; m<NUM_MSGS; m++)
+            deq_msg(jc, m, m+NUM_MSGS);
+    }
+    catch(const exception& e) { BOOST_FAIL(e.what()); }
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(reused_read_buffer)
+{
+    string test_name = get_test_name(test_filename, "reused_read_buffer");
+    try
+    {
+        string msg;
+        bool transientFlag;
+        bool externalFlag;
+
+        test_jrnl_cb cb;
+        test_jrnl jc(test_name, test_dir, test_name, cb);
+        jc.initialize(2*NUM_TEST_JFILES, false, 0, 10*TEST_JFSIZE_SBLKS);
+        jc.set_codec(codec::get(lzf_codec::LZF_CODEC_ID), 2*MSG_SIZE);
+        for (int m=0; m<NUM_MSGS; m++)
+            enq_msg(jc, m, create_msg(msg, m, (m%2 ? 1 : 64)*MSG_SIZE), false);
+        jc.flush();
+
+        // Each record, compressed or not, is read into the same buffer, which only grows to hold the largest
+        rd_buf buf;
+        for (int m=0; m<NUM_MSGS; m++)
+        {
+            void* mp = 0;
+            std::size_t msize = 0;
+            void* xp = 0;
+            std::size_t xsize = 0;
+            test_dtok dt;
+            dt.set_wstate(data_tok::ENQ);
+            unsigned aio_sleep_cnt = 0;
+            iores res = jc.read_data_record(&mp, msize, &xp, xsize, transientFlag, externalFlag, &dt, buf);
+            while (res == RHM_IORES_PAGE_AIOWAIT && ++aio_sleep_cnt <= MAX_AIO_SLEEPS)
+            {
+                usleep(AIO_SLEEP_TIME);
+                res = jc.read_data_record(&mp, msize, &xp, xsize, transientFlag, externalFlag, &dt, buf);
+            }
+            BOOST_CHECK_EQUAL(res, RHM_IORES_SUCCESS);
+            BOOST_CHECK(mp == buf.data());
+            BOOST_CHECK_EQUAL(create_msg(msg, m, (m%2 ? 1 : 64)*MSG_SIZE), string((char*)mp, msize));
+        }
+        BOOST_CHECK(buf.capacity() >= std::size_t(64*MSG_SIZE));
+        BOOST_CHECK(buf.capacity() < std::size_t(2*64*MSG_SIZE));
+        for (int m=0; m<NUM_MSGS; m++)
+            deq_msg(jc, m, m+NUM_MSGS);
+    }
+    catch(const exception& e) { BOOST_FAIL(e.what()); }
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(mmap_read_pin)
+{
+    string test_name = get_test_name(test_filename, "mmap_read_pin");
+    try
+    {
+        string msg;
+        string rmsg;
+        string xid;
+        bool transientFlag;
+        bool externalFlag;
+
+        test_jrnl_cb cb;
+        test_jrnl jc(test_name, test_dir, test_name, cb);
+        jc.set_rcache_geometry(JRNL_RMGR_PAGE_SIZE / 8, 4); // messages span several read pages
+        jc.set_rd_mmap(true);
+        jc.initialize(NUM_TEST_JFILES, false, 0, TEST_JFSIZE_SBLKS);
+        for (int m=0; m<NUM_MSGS; m++)
+            enq_msg(jc, m, create_msg(msg, m, 16*MSG_SIZE), false);
+        jc.flush();
+
+        // Reads which are not pinned are copied as usual
+        read_msg(jc, rmsg, xid, transientFlag, externalFlag);
+        BOOST_CHECK_EQUAL(create_msg(msg, 0, 16*MSG_SIZE), rmsg);
+        BOOST_CHECK(!jc.rcache_allocated());
+
+        // Pinned reads return pointers into the mapped file, which stay valid until the pin is released
+        rcursor* rc = jc.open_rcursor(&cb);
+        rd_buf buf;
+        rd_pin pin;
+        for (int m=0; m<NUM_MSGS; m++)
+        {
+            void* mp = 0;
+            std::size_t msize = 0;
+            void* xp = 0;
+            std::size_t xsize = 0;
+            test_dtok dt;
+            dt.set_wstate(data_tok::ENQ);
+            unsigned aio_sleep_cnt = 0;
+            iores res = rc->read_data_record(&mp, msize, &xp, xsize, transientFlag, externalFlag, &dt, buf, &pin);
+            while (res == RHM_IORES_PAGE_AIOWAIT && ++aio_sleep_cnt <= MAX_AIO_SLEEPS)
+            {
+                usleep(AIO_SLEEP_TIME);
+                res = rc->read_data_record(&mp, msize, &xp, xsize, transientFlag, externalFlag, &dt, buf, &pin);
+            }
+            BOOST_CHECK_EQUAL(res, RHM_IORES_SUCCESS);
+            BOOST_CHECK(pin.is_set());
+            BOOST_CHECK_EQUAL(create_msg(msg, m, 16*MSG_SIZE), string((char*)mp, msize));
+            BOOST_CHECK_EQUAL(jc.get_fcntlp(0)->rd_pin_cnt(), u_int32_t(1));
+        }
+        pin.release();
+        BOOST_CHECK(!pin.is_set());
+        BOOST_CHECK_EQUAL(jc.get_fcntlp(0)->rd_pin_cnt(), u_int32_t(0));
+        BOOST_CHECK(!rc->pages_allocated());
+        BOOST_CHECK_EQUAL(buf.capacity(), std::size_t(0));
+        jc.close_rcursor(rc);
+        for (int m=0; m<NUM_MSGS; m++)
+            deq_msg(jc, m, m+NUM_MSGS);
+    }
+    catch(const exception& e) { BOOST_FAIL(e.what()); }
+    cout << "ok" << endl;
+}
+
 #else
 /*
  * ==============================================
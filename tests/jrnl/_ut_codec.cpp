@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2007, 2008 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#include "../unit_test.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "jrnl/codec.hpp"
+#include "jrnl/jerrno.hpp"
+#include "jrnl/jexception.hpp"
+#include "jrnl/lzf_codec.hpp"
+#include <vector>
+
+using namespace boost::unit_test;
+using namespace mrg::journal;
+using namespace std;
+
+QPID_AUTO_TEST_SUITE(codec_suite)
+
+const string test_filename("_ut_codec");
+
+// Compress and decompress buf with the registered LZF codec, return the packed size (0 = no fit)
+size_t round_trip(const vector<char>& buf)
+{
+    const codec* cp = codec::get(lzf_codec::LZF_CODEC_ID);
+    vector<char> packed(codec_hdr::size() + buf.size() + buf.size() / 32 + 1); // worst case
+    size_t psize = codec::pack(cp, &buf[0], buf.size(), &packed[0], packed.size());
+    if (psize == 0)
+        return 0;
+    BOOST_CHECK_EQUAL(codec::unpacked_size(&packed[0], psize), buf.size());
+    vector<char> unpacked(buf.size() + 1);
+    codec::unpack(&packed[0], psize, &unpacked[0], buf.size());
+    BOOST_CHECK(std::memcmp(&buf[0], &unpacked[0], buf.size()) == 0);
+    return psize;
+}
+
+QPID_AUTO_TEST_CASE(registry)
+{
+    cout << test_filename << ".registry: " << flush;
+    const codec* cp = codec::get(lzf_codec::LZF_CODEC_ID);
+    BOOST_CHECK_EQUAL(cp->id(), lzf_codec::LZF_CODEC_ID);
+    BOOST_CHECK(std::strcmp(cp->name(), "lzf") == 0);
+    codec::register_codec(cp); // re-registering the same instance is harmless
+    try
+    {
+        codec::get(0xff);
+        BOOST_ERROR("Failed to throw for unknown codec id");
+    }
+    catch (const jexception& e) { BOOST_CHECK_EQUAL(e.err_code(), jerrno::JERR_CODEC_UNKNOWN); }
+    lzf_codec another;
+    try
+    {
+        codec::register_codec(&another);
+        BOOST_ERROR("Failed to throw for duplicate codec id");
+    }
+    catch (const jexception& e) { BOOST_CHECK_EQUAL(e.err_code(), jerrno::JERR_CODEC_DUPLICATE); }
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(lzf_compressible)
+{
+    cout << test_filename << ".lzf_compressible: " << flush;
+    vector<char> buf(65536);
+    for (size_t i=0; i<buf.size(); i++)
+        buf[i] = "MSG_000000_0123456789"[i % 21];
+    size_t psize = round_trip(buf);
+    BOOST_CHECK(psize > 0);
+    BOOST_CHECK(psize < buf.size() / 10);
+
+    // Single repeated byte exercises overlapping back references
+    vector<char> buf2(10000, 'x');
+    BOOST_CHECK(round_trip(buf2) > 0);
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(lzf_incompressible)
+{
+    cout << test_filename << ".lzf_incompressible: " << flush;
+    ::srand48(1);
+    vector<char> buf(8192);
+    for (size_t i=0; i<buf.size(); i++)
+        buf[i] = (char)(::lrand48() & 0xff);
+    const codec* cp = codec::get(lzf_codec::LZF_CODEC_ID);
+    vector<char> packed(buf.size());
+    // Random data cannot be made smaller, so must be rejected when dest is no larger than src
+    BOOST_CHECK_EQUAL(codec::pack(cp, &buf[0], buf.size(), &packed[0], packed.size()), size_t(0));
+    // ... but must still round-trip if there is room for the literal run overhead
+    BOOST_CHECK(round_trip(buf) > 0);
+
+    // Short inputs (shorter than the minimum match) are stored as literals
+    for (size_t len=1; len<5; len++)
+    {
+        vector<char> sbuf(buf.begin(), buf.begin() + len);
+        BOOST_CHECK(round_trip(sbuf) > 0);
+    }
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(lzf_corrupt)
+{
+    cout << test_filename << ".lzf_corrupt: " << flush;
+    vector<char> buf(4096);
+    for (size_t i=0; i<buf.size(); i++)
+        buf[i] = "abcdefgh"[i % 8];
+    const codec* cp = codec::get(lzf_codec::LZF_CODEC_ID);
+    vector<char> packed(buf.size());
+    size_t psize = codec::pack(cp, &buf[0], buf.size(), &packed[0], packed.size());
+    BOOST_REQUIRE(psize > codec_hdr::size());
+    vector<char> unpacked(buf.size());
+
+    // Truncated data
+    try
+    {
+        codec::unpack(&packed[0], psize - 1, &unpacked[0], unpacked.size());
+        BOOST_ERROR("Failed to throw for truncated data");
+    }
+    catch (const jexception& e) { BOOST_CHECK_EQUAL(e.err_code(), jerrno::JERR_CODEC_DECOMPFAIL); }
+
+    // Header too short
+    try
+    {
+        codec::unpacked_size(&packed[0], codec_hdr::size() - 1);
+        BOOST_ERROR("Failed to throw for short header");
+    }
+    catch (const jexception& e) { BOOST_CHECK_EQUAL(e.err_code(), jerrno::JERR_CODEC_BADHDR); }
+
+    // Back reference before start of output
+    packed[codec_hdr::size()] = (char)0xff;
+    try
+    {
+        codec::unpack(&packed[0], psize, &unpacked[0], unpacked.size());
+        BOOST_ERROR("Failed to throw for bad back reference");
+    }
+    catch (const jexception& e) { BOOST_CHECK_EQUAL(e.err_code(), jerrno::JERR_CODEC_DECOMPFAIL); }
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_SUITE_END()
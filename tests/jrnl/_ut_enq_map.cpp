@@ -26,6 +26,7 @@
 #include <iostream>
 #include "jrnl/enq_map.hpp"
 #include "jrnl/jerrno.hpp"
+#include <pthread.h>
 
 using namespace boost::unit_test;
 using namespace mrg::journal;
@@ -35,6 +36,25 @@ QPID_AUTO_TEST_SUITE(enq_map_suite)
 
 const string test_filename("_ut_enq_map");
 
+// Each thread inserts its own interleaved set of rids, then removes every second one
+struct mt_args
+{
+    enq_map* _emap;
+    u_int64_t _first_rid;
+    u_int64_t _num_threads;
+    u_int64_t _num_rids;
+};
+
+void* mt_insert_remove(void* arg)
+{
+    mt_args* a = static_cast<mt_args*>(arg);
+    for (u_int64_t i = 0; i < a->_num_rids; i++)
+        a->_emap->insert_pfid(a->_first_rid + i * a->_num_threads, u_int16_t(i % 4));
+    for (u_int64_t i = 0; i < a->_num_rids; i += 2)
+        a->_emap->get_remove_pfid(a->_first_rid + i * a->_num_threads);
+    return 0;
+}
+
 QPID_AUTO_TEST_CASE(constructor)
 {
     cout << test_filename << ".constructor: " << flush;
@@ -290,6 +310,109 @@ QPID_AUTO_TEST_CASE(enq_count)
     cout << "ok" << endl;
 }
 
+QPID_AUTO_TEST_CASE(range)
+{
+    cout << test_filename << ".range: " << flush;
+    bool locked;
+    std::vector<u_int32_t> pfid_cnt;
+
+    enq_map e8;
+    e8.set_num_jfiles(4);
+
+    // Even rids 0 - 98, 25 to each file
+    for (u_int64_t rid=0; rid<100; rid+=2)
+        BOOST_CHECK_EQUAL(e8.insert_pfid(rid, u_int16_t(rid/25)), enq_map::EMAP_OK);
+    BOOST_CHECK_EQUAL(e8.range_cnt(0, 99, locked), u_int32_t(50));
+    BOOST_CHECK(!locked);
+    BOOST_CHECK_EQUAL(e8.range_cnt(1, 1, locked), u_int32_t(0));
+    BOOST_CHECK_EQUAL(e8.range_cnt(10, 20, locked), u_int32_t(6));
+    BOOST_CHECK_EQUAL(e8.range_cnt(200, 300, locked), u_int32_t(0));
+
+    // Locked records are counted and reported, but not removed
+    BOOST_CHECK_EQUAL(e8.lock(10), enq_map::EMAP_OK);
+    BOOST_CHECK_EQUAL(e8.range_cnt(10, 20, locked), u_int32_t(6));
+    BOOST_CHECK(locked);
+    BOOST_CHECK_EQUAL(e8.remove_range(0, 29, pfid_cnt), u_int32_t(14));
+    BOOST_CHECK_EQUAL(pfid_cnt.size(), std::size_t(4));
+    BOOST_CHECK_EQUAL(pfid_cnt[0], u_int32_t(12));
+    BOOST_CHECK_EQUAL(pfid_cnt[1], u_int32_t(2));
+    BOOST_CHECK_EQUAL(e8.get_enq_cnt(0), u_int32_t(1));
+    BOOST_CHECK_EQUAL(e8.get_enq_cnt(1), u_int32_t(10));
+    BOOST_CHECK(e8.is_enqueued(10, true));
+    BOOST_CHECK(!e8.is_enqueued(28));
+    BOOST_CHECK(e8.is_enqueued(30));
+
+    // Watermark: remove all remaining unlocked records up to rid 98
+    BOOST_CHECK_EQUAL(e8.unlock(10), enq_map::EMAP_OK);
+    pfid_cnt.clear();
+    BOOST_CHECK_EQUAL(e8.remove_range(0, 98, pfid_cnt), u_int32_t(36));
+    BOOST_CHECK(e8.empty());
+    for (u_int16_t pfid=0; pfid<4; pfid++)
+        BOOST_CHECK_EQUAL(e8.get_enq_cnt(pfid), u_int32_t(0));
+
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(mem_bytes)
+{
+    cout << test_filename << ".mem_bytes: " << flush;
+    enq_map e10;
+    e10.set_num_jfiles(4);
+    const std::size_t empty_bytes = e10.mem_bytes();
+
+    // Estimate grows with each rid and shrinks again as rids are removed
+    for (u_int64_t rid=0; rid<100; rid++)
+        BOOST_CHECK_EQUAL(e10.insert_pfid(rid, 0), enq_map::EMAP_OK);
+    const std::size_t full_bytes = e10.mem_bytes();
+    BOOST_CHECK(full_bytes >= empty_bytes + 100 * (sizeof(u_int64_t) + JRNL_MAP_NODE_OVERHEAD));
+    for (u_int64_t rid=0; rid<50; rid++)
+        BOOST_CHECK(e10.get_remove_pfid(rid) >= enq_map::EMAP_OK);
+    BOOST_CHECK(e10.mem_bytes() < full_bytes);
+    e10.clear();
+    BOOST_CHECK_EQUAL(e10.mem_bytes(), empty_bytes);
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(multi_thread)
+{
+    cout << test_filename << ".multi_thread: " << flush;
+    const u_int64_t num_threads = 8;
+    const u_int64_t num_rids = 1000;
+    enq_map e9;
+    e9.set_num_jfiles(4);
+
+    pthread_t threads[num_threads];
+    mt_args args[num_threads];
+    for (u_int64_t t = 0; t < num_threads; t++)
+    {
+        args[t]._emap = &e9;
+        args[t]._first_rid = t;
+        args[t]._num_threads = num_threads;
+        args[t]._num_rids = num_rids;
+        BOOST_REQUIRE_EQUAL(::pthread_create(&threads[t], 0, mt_insert_remove, &args[t]), 0);
+    }
+    for (u_int64_t t = 0; t < num_threads; t++)
+        ::pthread_join(threads[t], 0);
+
+    // Odd multiples of num_threads (offset by thread number) remain
+    BOOST_CHECK_EQUAL(e9.size(), u_int32_t(num_threads * num_rids / 2));
+    u_int32_t tot_cnt = 0;
+    for (u_int16_t pfid=0; pfid<4; pfid++)
+        tot_cnt += e9.get_enq_cnt(pfid);
+    BOOST_CHECK_EQUAL(tot_cnt, e9.size());
+
+    // Lists are returned in rid order regardless of striping
+    vector<u_int64_t> rv;
+    e9.rid_list(rv);
+    BOOST_CHECK_EQUAL(rv.size(), std::size_t(e9.size()));
+    for (unsigned i=1; i<rv.size(); i++)
+        BOOST_CHECK(rv[i-1] < rv[i]);
+    bool locked;
+    BOOST_CHECK_EQUAL(e9.range_cnt(0, num_threads * num_rids, locked), e9.size());
+    BOOST_CHECK(!locked);
+    cout << "ok" << endl;
+}
+
 QPID_AUTO_TEST_CASE(stress)
 {
     cout << test_filename << ".stress: " << flush;
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2007, 2008, 2009 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#include "../unit_test.h"
+
+#include <cstring>
+#include <iostream>
+#include "jrnl/jcfg.hpp"
+#include "jrnl/page_alloc.hpp"
+#include "jrnl/page_pool.hpp"
+
+using namespace boost::unit_test;
+using namespace mrg::journal;
+using namespace std;
+
+QPID_AUTO_TEST_SUITE(page_alloc_suite)
+
+const string test_filename("_ut_page_alloc");
+
+// === Test suite ===
+
+QPID_AUTO_TEST_CASE(set_policy)
+{
+    cout << test_filename << ".set_policy: " << flush;
+    BOOST_CHECK_EQUAL(page_alloc::policy(), u_int32_t(page_alloc::PA_DEFAULT));
+    BOOST_CHECK(page_alloc::set_policy(page_alloc::PA_HUGE_PAGES | page_alloc::PA_NUMA_LOCAL));
+    BOOST_CHECK(page_alloc::huge_pages());
+    BOOST_CHECK(page_alloc::numa_local());
+
+    // The policy cannot change while memory allocated under it is outstanding
+    void* p = page_alloc::alloc(JRNL_DBLK_SIZE * JRNL_SBLK_SIZE, JRNL_DBLK_SIZE * JRNL_SBLK_SIZE);
+    BOOST_CHECK(!page_alloc::set_policy(page_alloc::PA_DEFAULT));
+    BOOST_CHECK(page_alloc::set_policy(page_alloc::PA_HUGE_PAGES | page_alloc::PA_NUMA_LOCAL));
+    page_alloc::free(p, JRNL_DBLK_SIZE * JRNL_SBLK_SIZE);
+    BOOST_CHECK(page_alloc::set_policy(page_alloc::PA_DEFAULT));
+    BOOST_CHECK(!page_alloc::huge_pages());
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(alloc_free)
+{
+    cout << test_filename << ".alloc_free: " << flush;
+    const size_t sblksize = JRNL_DBLK_SIZE * JRNL_SBLK_SIZE;
+    const u_int32_t policies[] = {page_alloc::PA_DEFAULT, page_alloc::PA_HUGE_PAGES, page_alloc::PA_NUMA_LOCAL,
+            page_alloc::PA_HUGE_PAGES | page_alloc::PA_NUMA_LOCAL};
+    for (unsigned i=0; i<sizeof(policies)/sizeof(policies[0]); i++)
+    {
+        BOOST_CHECK(page_alloc::set_policy(policies[i]));
+        // Huge page sized allocations fall back to normal pages if no huge pages are available
+        const size_t sizes[] = {sblksize, 64 * sblksize, JRNL_HUGE_PAGE_SIZE, 2 * JRNL_HUGE_PAGE_SIZE};
+        for (unsigned j=0; j<sizeof(sizes)/sizeof(sizes[0]); j++)
+        {
+            char* p = (char*)page_alloc::alloc(sizes[j], sblksize);
+            BOOST_CHECK(p != 0);
+            BOOST_CHECK_EQUAL((unsigned long)p % sblksize, 0UL); // aligned for O_DIRECT
+            std::memset(p, 0xff, sizes[j]);
+            page_alloc::free(p, sizes[j]);
+        }
+    }
+    BOOST_CHECK(page_alloc::set_policy(page_alloc::PA_DEFAULT));
+    cout << "ok" << endl;
+}
+
+// Run last, as the idle pages kept by page_pool fix the policy for the rest of the process
+QPID_AUTO_TEST_CASE(page_pool_slabs)
+{
+    cout << test_filename << ".page_pool_slabs: " << flush;
+    const size_t pgsize = 64 * JRNL_DBLK_SIZE * JRNL_SBLK_SIZE;
+    const u_int32_t slab_pages = JRNL_HUGE_PAGE_SIZE / pgsize;
+    BOOST_CHECK(page_alloc::set_policy(page_alloc::PA_HUGE_PAGES));
+    const u_int32_t alloc = page_pool::alloc_pages();
+    const u_int64_t bytes = page_pool::alloc_bytes();
+
+    // The first page allocates a whole slab; the rest of the slab is lent out before another is allocated
+    void* p1 = page_pool::get_page(pgsize);
+    BOOST_CHECK_EQUAL(page_pool::alloc_pages(), alloc + slab_pages);
+    BOOST_CHECK_EQUAL(page_pool::alloc_bytes(), bytes + JRNL_HUGE_PAGE_SIZE);
+    void* p2 = page_pool::get_page(pgsize);
+    BOOST_CHECK_EQUAL((char*)p2 - (char*)p1, long(pgsize * (slab_pages - 1)));
+    BOOST_CHECK_EQUAL(page_pool::alloc_pages(), alloc + slab_pages);
+
+    // Slab pages are never freed on their own
+    page_pool::put_page(p2, pgsize);
+    page_pool::drop_page(p1, pgsize);
+    BOOST_CHECK_EQUAL(page_pool::alloc_pages(), alloc + slab_pages);
+    BOOST_CHECK_EQUAL(page_pool::used_pages(), 0U);
+    BOOST_CHECK(!page_alloc::set_policy(page_alloc::PA_DEFAULT));
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_SUITE_END()
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2007, 2008, 2009 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+
+#include "../unit_test.h"
+
+#include <iostream>
+#include "jrnl/jcfg.hpp"
+#include "jrnl/page_pool.hpp"
+
+using namespace boost::unit_test;
+using namespace mrg::journal;
+using namespace std;
+
+QPID_AUTO_TEST_SUITE(page_pool_suite)
+
+const string test_filename("_ut_page_pool");
+
+// Listener which keeps a running total of the page count changes reported to it
+class test_listener : public page_pool_listener
+{
+public:
+    int32_t _alloc;
+    int32_t _used;
+    test_listener() : _alloc(0), _used(0) {}
+    void pool_pages_chg(const int32_t alloc_chg, const int32_t used_chg) { _alloc += alloc_chg; _used += used_chg; }
+};
+
+// === Test suite ===
+
+QPID_AUTO_TEST_CASE(get_put_page)
+{
+    cout << test_filename << ".get_put_page: " << flush;
+    const size_t pgsize = 4 * JRNL_DBLK_SIZE * JRNL_SBLK_SIZE;
+    const u_int32_t alloc = page_pool::alloc_pages();
+    const u_int32_t used = page_pool::used_pages();
+
+    void* p1 = page_pool::get_page(pgsize);
+    BOOST_CHECK(p1 != 0);
+    BOOST_CHECK_EQUAL((unsigned long)p1 % JRNL_DBLK_SIZE, 0UL); // aligned for O_DIRECT
+    void* p2 = page_pool::get_page(pgsize);
+    BOOST_CHECK(p2 != p1);
+    BOOST_CHECK_EQUAL(page_pool::alloc_pages(), alloc + 2);
+    BOOST_CHECK_EQUAL(page_pool::used_pages(), used + 2);
+
+    // A returned page stays allocated and is lent out again before a new page is allocated
+    page_pool::put_page(p1, pgsize);
+    BOOST_CHECK_EQUAL(page_pool::alloc_pages(), alloc + 2);
+    BOOST_CHECK_EQUAL(page_pool::used_pages(), used + 1);
+    void* p3 = page_pool::get_page(pgsize);
+    BOOST_CHECK(p3 == p1);
+    BOOST_CHECK_EQUAL(page_pool::alloc_pages(), alloc + 2);
+
+    // Pages of a different size are not shared
+    void* p4 = page_pool::get_page(pgsize * 2);
+    BOOST_CHECK(p4 != p2);
+    BOOST_CHECK_EQUAL(page_pool::alloc_pages(), alloc + 3);
+
+    page_pool::put_page(p2, pgsize);
+    page_pool::put_page(p3, pgsize);
+    page_pool::put_page(p4, pgsize * 2);
+    BOOST_CHECK_EQUAL(page_pool::used_pages(), used);
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(drop_page)
+{
+    cout << test_filename << ".drop_page: " << flush;
+    const size_t pgsize = 8 * JRNL_DBLK_SIZE * JRNL_SBLK_SIZE;
+    const u_int32_t alloc = page_pool::alloc_pages();
+    const u_int64_t bytes = page_pool::alloc_bytes();
+    void* p1 = page_pool::get_page(pgsize);
+    if (page_pool::alloc_pages() == alloc + 1) // not taken from idle pages of an earlier test
+        BOOST_CHECK_EQUAL(page_pool::alloc_bytes(), bytes + pgsize);
+    const u_int32_t alloc1 = page_pool::alloc_pages();
+    page_pool::drop_page(p1, pgsize);
+    BOOST_CHECK_EQUAL(page_pool::alloc_pages(), alloc1 - 1);
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(listener)
+{
+    cout << test_filename << ".listener: " << flush;
+    const size_t pgsize = 16 * JRNL_DBLK_SIZE * JRNL_SBLK_SIZE;
+    test_listener tl;
+    page_pool::set_listener(&tl);
+    // The listener is first told the current totals
+    BOOST_CHECK_EQUAL(u_int32_t(tl._alloc), page_pool::alloc_pages());
+    BOOST_CHECK_EQUAL(u_int32_t(tl._used), page_pool::used_pages());
+
+    void* p1 = page_pool::get_page(pgsize);
+    void* p2 = page_pool::get_page(pgsize);
+    page_pool::put_page(p1, pgsize);
+    page_pool::drop_page(p2, pgsize);
+    BOOST_CHECK_EQUAL(u_int32_t(tl._alloc), page_pool::alloc_pages());
+    BOOST_CHECK_EQUAL(u_int32_t(tl._used), page_pool::used_pages());
+
+    // Once cleared, the listener is no longer told of changes
+    page_pool::clear_listener(&tl);
+    const int32_t a = tl._alloc;
+    page_pool::drop_page(page_pool::get_page(pgsize), pgsize);
+    page_pool::drop_page(page_pool::get_page(pgsize), pgsize);
+    BOOST_CHECK_EQUAL(tl._alloc, a);
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_SUITE_END()
@@ -105,4 +105,70 @@ QPID_AUTO_TEST_CASE(insert_get)
     cout << "ok" << endl;
 }
 
+QPID_AUTO_TEST_CASE(sync_remove)
+{
+    cout << test_filename << ".sync_remove: " << flush;
+    const u_int64_t num_xids = 100;
+    txn_map t3;
+    t3.set_num_jfiles(4);
+
+    // Two enqueues per xid, inserted in reverse xid order
+    for (u_int64_t x = num_xids; x > 0; x--)
+    {
+        string xid = make_xid(x);
+        BOOST_CHECK(t3.insert_txn_data(xid, txn_data(x * 2, 0, u_int16_t(x % 4), true)));
+        BOOST_CHECK(t3.insert_txn_data(xid, txn_data(x * 2 + 1, 0, u_int16_t(x % 4), true)));
+    }
+    BOOST_CHECK_EQUAL(t3.size(), num_xids);
+    BOOST_CHECK_EQUAL(t3.enq_cnt(), u_int32_t(num_xids * 2));
+    BOOST_CHECK(t3.is_enq(num_xids * 2 + 1));
+    BOOST_CHECK(!t3.is_enq(1));
+    BOOST_CHECK(t3.data_exists(make_xid(1), 3));
+    BOOST_CHECK(!t3.data_exists(make_xid(1), 4));
+
+    // xid list is sorted regardless of striping
+    vector<string> xv;
+    t3.xid_list(xv);
+    BOOST_CHECK_EQUAL(xv.size(), num_xids);
+    for (unsigned i=0; i<xv.size(); i++)
+        BOOST_CHECK_EQUAL(xv[i], make_xid(i + 1));
+
+    // Sync state follows AIO completion of each record
+    string xid = make_xid(5);
+    BOOST_CHECK_EQUAL(t3.is_txn_synced(xid), txn_map::TMAP_NOT_SYNCED);
+    BOOST_CHECK_EQUAL(t3.set_aio_compl(xid, 10), txn_map::TMAP_OK);
+    BOOST_CHECK_EQUAL(t3.is_txn_synced(xid), txn_map::TMAP_NOT_SYNCED);
+    BOOST_CHECK_EQUAL(t3.set_aio_compl(xid, 11), txn_map::TMAP_OK);
+    BOOST_CHECK_EQUAL(t3.is_txn_synced(xid), txn_map::TMAP_SYNCED);
+    BOOST_CHECK_EQUAL(t3.set_aio_compl(xid, 12), txn_map::TMAP_RID_NOT_FOUND);
+    BOOST_CHECK_EQUAL(t3.is_txn_synced(make_xid(0)), txn_map::TMAP_XID_NOT_FOUND);
+
+    // Remove all, checking the file counts
+    for (u_int64_t x = 1; x <= num_xids; x++)
+        BOOST_CHECK_EQUAL(t3.get_remove_tdata_list(make_xid(x)).size(), std::size_t(2));
+    BOOST_CHECK(t3.empty());
+    for (u_int16_t pfid=0; pfid<4; pfid++)
+        BOOST_CHECK_EQUAL(t3.get_txn_pfid_cnt(pfid), u_int32_t(0));
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(mem_bytes)
+{
+    cout << test_filename << ".mem_bytes: " << flush;
+    txn_map t4;
+    t4.set_num_jfiles(4);
+    const size_t empty_bytes = t4.mem_bytes();
+
+    // Each xid adds a map node, and each operation a txn_data entry
+    BOOST_CHECK(t4.insert_txn_data(make_xid(1), txn_data(1, 0, 0, true)));
+    const size_t one_bytes = t4.mem_bytes();
+    BOOST_CHECK(one_bytes >= empty_bytes + JRNL_MAP_NODE_OVERHEAD + sizeof(txn_data));
+    for (u_int64_t rid=2; rid<10; rid++)
+        BOOST_CHECK(t4.insert_txn_data(make_xid(1), txn_data(rid, 0, 0, true)));
+    BOOST_CHECK(t4.mem_bytes() >= one_bytes + 8 * sizeof(txn_data));
+    t4.get_remove_tdata_list(make_xid(1));
+    BOOST_CHECK_EQUAL(t4.mem_bytes(), empty_bytes);
+    cout << "ok" << endl;
+}
+
 QPID_AUTO_TEST_SUITE_END()
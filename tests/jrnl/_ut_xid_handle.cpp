@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2007, 2008, 2009 Red Hat, Inc.
+ *
+ * This file is part of the Qpid async store library msgstore.so.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *
+ * The GNU Lesser General Public License is available in the file COPYING.
+ */
+
+#include "../unit_test.h"
+
+#include <iostream>
+#include "jrnl/xid_handle.hpp"
+#include <set>
+#include <sstream>
+#include <vector>
+
+using namespace boost::unit_test;
+using namespace mrg::journal;
+using namespace std;
+
+QPID_AUTO_TEST_SUITE(xid_handle_suite)
+
+const string test_filename("_ut_xid_handle");
+
+// === Test suite ===
+
+QPID_AUTO_TEST_CASE(empty_handle)
+{
+    cout << test_filename << ".empty_handle: " << flush;
+    xid_handle h1;
+    BOOST_CHECK(h1.empty());
+    BOOST_CHECK_EQUAL(h1.size(), std::size_t(0));
+    BOOST_CHECK(h1.data() == 0);
+    BOOST_CHECK(h1.str().empty());
+    BOOST_CHECK_EQUAL(h1.hash(), u_int32_t(0));
+
+    xid_handle h2(string(""));
+    BOOST_CHECK(h2.empty());
+    BOOST_CHECK(h1 == h2);
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(interning)
+{
+    cout << test_filename << ".interning: " << flush;
+    const std::size_t cnt = xid_handle::interned_cnt();
+    const string xid("XID-0123456789abcdef");
+    {
+        xid_handle h1(xid);
+        xid_handle h2(xid.data(), xid.size());
+        xid_handle h3(string("XID-fedcba9876543210"));
+        BOOST_CHECK_EQUAL(xid_handle::interned_cnt(), cnt + 2);
+        BOOST_CHECK(h1 == h2);
+        BOOST_CHECK(h1 != h3);
+        BOOST_CHECK(h1.data() == h2.data()); // Same interned string, not a copy
+        BOOST_CHECK_EQUAL(h1.str(), xid);
+        BOOST_CHECK_EQUAL(h1.size(), xid.size());
+        BOOST_CHECK_EQUAL(h1.hash(), xid_handle::hash(xid.data(), xid.size()));
+
+        // Binary xids are interned by content, including embedded nulls
+        const char bxid[] = {'a', '\0', 'b'};
+        xid_handle h4(bxid, sizeof(bxid));
+        xid_handle h5(string(bxid, sizeof(bxid)));
+        BOOST_CHECK(h4 == h5);
+        BOOST_CHECK_EQUAL(h4.size(), sizeof(bxid));
+        BOOST_CHECK_EQUAL(xid_handle::interned_cnt(), cnt + 3);
+
+        set<xid_handle> s;
+        s.insert(h1);
+        s.insert(h2);
+        s.insert(h3);
+        BOOST_CHECK_EQUAL(s.size(), std::size_t(2));
+
+        ostringstream oss;
+        oss << h1;
+        BOOST_CHECK_EQUAL(oss.str(), xid);
+    }
+    BOOST_CHECK_EQUAL(xid_handle::interned_cnt(), cnt);
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(ref_count)
+{
+    cout << test_filename << ".ref_count: " << flush;
+    const std::size_t cnt = xid_handle::interned_cnt();
+    const string xid("XID-ref-count");
+    xid_handle h1(xid);
+    {
+        xid_handle h2(h1);
+        xid_handle h3;
+        h3 = h2;
+        h3 = h3; // self-assignment
+        BOOST_CHECK(h3 == h1);
+        BOOST_CHECK_EQUAL(xid_handle::interned_cnt(), cnt + 1);
+    }
+    BOOST_CHECK_EQUAL(xid_handle::interned_cnt(), cnt + 1);
+    BOOST_CHECK_EQUAL(h1.str(), xid);
+    h1.clear();
+    BOOST_CHECK(h1.empty());
+    BOOST_CHECK_EQUAL(xid_handle::interned_cnt(), cnt);
+
+    // Once released, a re-interned xid is a new entry with the same content
+    xid_handle h4(xid);
+    BOOST_CHECK_EQUAL(h4.str(), xid);
+    BOOST_CHECK_EQUAL(xid_handle::interned_cnt(), cnt + 1);
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_CASE(ordering)
+{
+    cout << test_filename << ".ordering: " << flush;
+    // The order of a set of handles depends only on the xids, not on the order in which they were interned
+    const std::size_t num_xids = 100;
+    vector<string> order[2];
+    for (int pass = 0; pass < 2; pass++)
+    {
+        set<xid_handle> s;
+        for (std::size_t i = 0; i < num_xids; i++)
+        {
+            ostringstream oss;
+            oss << "XID-order-" << (pass ? num_xids - 1 - i : i);
+            s.insert(xid_handle(oss.str()));
+        }
+        BOOST_CHECK_EQUAL(s.size(), num_xids);
+        xid_handle prev;
+        for (set<xid_handle>::const_iterator i = s.begin(); i != s.end(); i++)
+        {
+            if (!prev.empty())
+                BOOST_CHECK(prev.hash() < i->hash() || (prev.hash() == i->hash() && prev.str() < i->str()));
+            prev = *i;
+            order[pass].push_back(i->str());
+        }
+    }
+    BOOST_CHECK(order[0] == order[1]);
+
+    // Handles to the same xid are equivalent
+    xid_handle h1(string("XID-order-same"));
+    xid_handle h2(string("XID-order-same"));
+    BOOST_CHECK(!(h1 < h2) && !(h2 < h1));
+    BOOST_CHECK(xid_handle() < h1);
+    cout << "ok" << endl;
+}
+
+QPID_AUTO_TEST_SUITE_END()
@@ -57,6 +57,13 @@ class EnqMap(object):
         else:
             raise jerr.JWarning("ERROR: Deleting non-existent rid from EnqMap: rid=0x%x" % rid)
     
+    def delete_range(self, first_rid, last_rid):
+        """Delete all unlocked rids from first_rid to last_rid (inclusive) from the map, return the number deleted"""
+        rids = [rid for rid in self.__map if first_rid <= rid <= last_rid and not self.__map[rid][2]]
+        for rid in rids:
+            del self.__map[rid]
+        return len(rids)
+    
     def get(self, rid):
         """Return a list [fid, hdr, lock] for the given rid"""
         if self.contains(rid):
@@ -506,8 +513,14 @@ class JrnlReader(object):
             stop = self._handle_enq_rec(hdr)
         elif isinstance(hdr, jrnl.DeqRec):
             stop = self._handle_deq_rec(hdr)
+        elif isinstance(hdr, jrnl.MdeqRec):
+            stop = self._handle_mdeq_rec(hdr)
+        elif isinstance(hdr, jrnl.RdeqRec):
+            stop = self._handle_rdeq_rec(hdr)
         elif isinstance(hdr, jrnl.TxnRec):
             stop = self._handle_txn_rec(hdr)
+        elif isinstance(hdr, jrnl.PackRec):
+            stop = self._handle_pack_rec(hdr)
         wstr = ""
         for warn in self._warning:
             wstr += " (%s)" % warn
@@ -538,6 +551,34 @@ class JrnlReader(object):
             self._warning.append(str(warn))
         return False
     
+    def _handle_mdeq_rec(self, hdr):
+        """Process a multi-rid dequeue ("RHMm") record"""
+        if self._load_rec(hdr):
+            return True
+        
+        # Check OWI flag
+        if not self._check_owi(hdr):
+            self._warning.append("WARNING: OWI mismatch - could be overwrite boundary.")
+            return True
+        
+        for drid in hdr.deq_rids():
+            try:
+                self._emap.delete(drid)
+            except jerr.JWarning, warn:
+                self._warning.append(str(warn))
+        return False
+    
+    def _handle_rdeq_rec(self, hdr):
+        """Process a range dequeue ("RHMr") record"""
+        # Check OWI flag
+        if not self._check_owi(hdr):
+            self._warning.append("WARNING: OWI mismatch - could be overwrite boundary.")
+            return True
+        
+        if self._emap.delete_range(hdr.first_rid, hdr.last_rid) == 0:
+            self._warning.append("WARNING: No records dequeued by range dequeue")
+        return False
+    
     def _handle_enq_rec(self, hdr):
         """Process a dequeue ("RHMe") record"""
         if self._load_rec(hdr):
@@ -562,6 +603,21 @@ class JrnlReader(object):
         self._msg_cnt += 1
         return False
     
+    def _handle_pack_rec(self, hdr):
+        """Process a packed ("RHMp") data block by processing each of the records it contains"""
+        # Check OWI flag
+        if not self._check_owi(hdr):
+            self._warning.append("WARNING: OWI mismatch - could be overwrite boundary.")
+            return True
+        for rec in hdr.recs:
+            if isinstance(rec, jrnl.EnqRec):
+                stop = self._handle_enq_rec(rec)
+            else:
+                stop = self._handle_deq_rec(rec)
+            if stop:
+                return True
+        return False
+    
     def _handle_txn_rec(self, hdr):
         """Process a transaction ("RHMa or RHMc") record"""
         if self._load_rec(hdr):
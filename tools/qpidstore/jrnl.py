@@ -23,6 +23,7 @@ The GNU Lesser General Public License is available in the file COPYING.
 
 import jerr
 import os.path, sys, xml.parsers.expat
+from cStringIO import StringIO
 from struct import pack, unpack, calcsize
 from time import gmtime, strftime
 
@@ -215,7 +216,7 @@ class Hdr:
             return "0x%08x: <empty>" % (self.foffs)
         if self.magic[-1] == "x":
             return "0x%08x: [\"%s\"]" % (self.foffs, self.magic)
-        if self.magic[-1] in ["a", "c", "d", "e", "f", "x"]:
+        if self.magic[-1] in ["a", "c", "d", "e", "f", "m", "p", "r", "x"]:
             return "0x%08x: [\"%s\" v=%d e=%d f=0x%04x rid=0x%x]" % (self.foffs, self.magic, self.ver, self.endn,
                                                                      self.flags, self.rid)
         return "0x%08x: <error, unknown magic \"%s\" (possible overwrite boundary?)>" %  (self.foffs, self.magic)
@@ -244,7 +245,7 @@ class Hdr:
 
     def check(self):
         """Check that this record is valid"""
-        if self.empty() or self.magic[:3] != "RHM" or self.magic[3] not in ["a", "c", "d", "e", "f", "x"]:
+        if self.empty() or self.magic[:3] != "RHM" or self.magic[3] not in ["a", "c", "d", "e", "f", "m", "p", "r", "x"]:
             return True
         if self.magic[-1] != "x":
             if self.ver != self.HDR_VER:
@@ -348,6 +349,88 @@ class DeqRec(Hdr):
         return self.xid_complete and self.tail_complete
 
 
+#== class MdeqRec =============================================================
+
+class MdeqRec(Hdr):
+    """Class for a multi-rid dequeue record, which dequeues several records at once"""
+
+    FORMAT = "=Q"
+
+    def __str__(self):
+        """Return a string representation of the this MdeqRec instance"""
+        return "%s deq_cnt=%d drids=[%s]" % (Hdr.__str__(self), self.deq_cnt,
+                                             ", ".join(["0x%x" % drid for drid in self.deq_rids()]))
+
+    def init(self, fhandle, foffs, deq_cnt):
+        """Initialize this instance to known values"""
+        self.deq_cnt = deq_cnt
+        self.drids_bin = None
+        self.deq_tail = None
+        self.drids_complete = False
+        self.tail_complete = False
+        self.tail_bin = None
+        self.tail_offs = 0
+        self.load(fhandle)
+
+    def deq_rids(self):
+        """Return the list of dequeued rids, or an empty list if they have not been completely loaded"""
+        if not self.drids_complete or self.drids_bin == None:
+            return []
+        return list(unpack("=%dQ" % self.deq_cnt, self.drids_bin))
+
+    def encode(self):
+        """Encode this class into a binary string"""
+        return Hdr.encode(self) + pack(MdeqRec.FORMAT, self.deq_cnt) + self.drids_bin + self.deq_tail.encode()
+
+    def load(self, fhandle):
+        """Load the remainder of this record (after the header has been loaded"""
+        if not self.drids_complete:
+            ret = Utils.load_file_data(fhandle, self.deq_cnt * calcsize("=Q"), self.drids_bin)
+            self.drids_bin = ret[0]
+            self.drids_complete = ret[1]
+        if self.drids_complete and not self.tail_complete:
+            ret = Utils.load_file_data(fhandle, calcsize(RecTail.FORMAT), self.tail_bin)
+            self.tail_bin = ret[0]
+            if ret[1]:
+                self.deq_tail = RecTail(self.tail_offs, *unpack(RecTail.FORMAT, self.tail_bin))
+                magic_err = self.deq_tail.magic_inv != Utils.inv_str(self.magic)
+                rid_err = self.deq_tail.rid != self.rid
+                if magic_err or rid_err:
+                    raise jerr.InvalidRecordTailError(magic_err, rid_err, self)
+                self.skip(fhandle)
+            self.tail_complete = ret[1]
+        return self.complete()
+
+    def complete(self):
+        """Returns True if the entire record is loaded, False otherwise"""
+        return self.drids_complete and self.tail_complete
+
+
+#== class RdeqRec =============================================================
+
+class RdeqRec(Hdr):
+    """Class for a range dequeue record, which dequeues all enqueued records within a range of rids"""
+
+    FORMAT = "=QQ"
+
+    def __str__(self):
+        """Return a string representation of the this RdeqRec instance"""
+        return "%s drids=0x%x-0x%x" % (Hdr.__str__(self), self.first_rid, self.last_rid)
+
+    def init(self, fhandle, foffs, first_rid, last_rid):
+        """Initialize this instance to known values"""
+        self.first_rid = first_rid
+        self.last_rid = last_rid
+
+    def encode(self):
+        """Encode this class into a binary string"""
+        return Hdr.encode(self) + pack(RdeqRec.FORMAT, self.first_rid, self.last_rid)
+
+    def complete(self):
+        """Returns True if the entire record is loaded, False otherwise"""
+        return True
+
+
 #== class TxnRec ==============================================================
 
 class TxnRec(Hdr):
@@ -407,6 +490,7 @@ class EnqRec(Hdr):
     FORMAT = "=QQ"
     TRANSIENT_MASK = 0x10
     EXTERN_MASK = 0x20
+    COMPRESSED_MASK = 0x40
 
     def __str__(self):
         """Return a string representation of the this EnqRec instance"""
@@ -430,6 +514,7 @@ class EnqRec(Hdr):
         self.dsize = dsize
         self.transient = self.flags & self.TRANSIENT_MASK > 0
         self.extern = self.flags & self.EXTERN_MASK > 0
+        self.compressed = self.flags & self.COMPRESSED_MASK > 0
         self.xid = None
         self.data = None
         self.enq_tail = None
@@ -480,11 +565,79 @@ class EnqRec(Hdr):
                 fstr += ",EXTERNAL"
             else:
                 fstr = "*EXTERNAL"
+        if self.compressed:
+            if len(fstr) > 0:
+                fstr += ",COMPRESSED"
+            else:
+                fstr = "*COMPRESSED"
         if len(fstr) > 0:
             fstr += "*"
         return fstr
 
 
+#== class PackRec =============================================================
+
+class PackRec(Hdr):
+    """Class for a packed data block, which contains several small non-transactional enqueue and dequeue records"""
+
+    FORMAT = ""
+    PACK_ALIGN = 8
+
+    def __str__(self):
+        """Return a string representation of the this PackRec instance"""
+        rstr = "%s recs=%d" % (Hdr.__str__(self), len(self.recs))
+        for rec in self.recs:
+            rstr += "\n     + %s" % rec
+        return rstr
+
+    def encode(self):
+        """Encode this class into a binary string"""
+        buf = Hdr.encode(self)
+        for rec in self.recs:
+            buf += rec.encode()
+            buf += "\x00" * (Utils.size_in_bytes_to_blk(len(buf), self.PACK_ALIGN) - len(buf))
+        return buf + "\x00" * (DBLK_SIZE - len(buf))
+
+    def init(self, fhandle, foffs):
+        """Initialize this instance by loading the records contained in the rest of the data block"""
+        hdr_size = calcsize(Hdr.FORMAT)
+        fbin = fhandle.read(DBLK_SIZE - hdr_size)
+        if len(fbin) != DBLK_SIZE - hdr_size:
+            raise jerr.UnexpectedEndOfFileError(DBLK_SIZE - hdr_size, len(fbin))
+        # Offsets within the buffer are those within the dblk, so that alignment of the records is preserved
+        dblk = StringIO("\x00" * hdr_size + fbin)
+        dblk.seek(hdr_size)
+        self.recs = []
+        while DBLK_SIZE - dblk.tell() >= hdr_size:
+            args = Utils._load_args(dblk, Hdr)
+            klass = _PACKED_CLASSES.get(args[1][-1])
+            if args[1][:3] != "RHM" or klass == None:
+                break
+            rec = klass(*args)
+            rec.init(dblk, *Utils._load_args(dblk, klass))
+            rec.skip(dblk)
+            rec.foffs += self.foffs
+            self.recs.append(rec)
+
+    def complete(self):
+        """Returns True if the entire record is loaded, False otherwise"""
+        return True
+
+
+#== class PackedDeqRec ========================================================
+
+class PackedDeqRec(DeqRec):
+    """Class for a dequeue record contained in a packed data block"""
+    REC_BOUNDARY = PackRec.PACK_ALIGN
+
+
+#== class PackedEnqRec ========================================================
+
+class PackedEnqRec(EnqRec):
+    """Class for an enqueue record contained in a packed data block"""
+    REC_BOUNDARY = PackRec.PACK_ALIGN
+
+
 #== class RecTail =============================================================
 
 class RecTail:
@@ -791,7 +944,15 @@ _CLASSES = {
     "c": TxnRec,
     "d": DeqRec,
     "e": EnqRec,
-    "f": FileHdr
+    "f": FileHdr,
+    "m": MdeqRec,
+    "p": PackRec,
+    "r": RdeqRec
+}
+
+_PACKED_CLASSES = {
+    "d": PackedDeqRec,
+    "e": PackedEnqRec
 }
 
 if __name__ == "__main__":